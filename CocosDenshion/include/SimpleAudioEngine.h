@@ -30,6 +30,27 @@ static inline unsigned int getHashCodeByString(const char *key)
 	return (hash);
 }
 
+/**
+@brief          the figures of the sound effects, see SimpleAudioEngine::getEffectsStats
+@details        a platform that doesn't keep them leaves them at 0
+*/
+struct EffectsStats
+{
+    unsigned int cachedEffects;     ///< effects decoded and kept
+    unsigned int cachedBytes;       ///< the bytes they take
+    unsigned int cacheSize;         ///< see setEffectsCacheSize
+    unsigned int hits;              ///< plays of an effect already decoded
+    unsigned int misses;            ///< plays that had to decode their effect first
+    unsigned int evictions;         ///< effects unloaded to stay in cacheSize
+    unsigned int decodes;
+    float        decodeTime;        ///< milliseconds spent decoding, in total
+    float        maxDecodeTime;     ///< the longest decode, in milliseconds
+    unsigned int voices;            ///< the sources that play the effects
+    unsigned int activeVoices;      ///< those playing or paused
+    unsigned int stolenVoices;      ///< plays that stopped another effect to get a voice
+    unsigned int droppedPlays;      ///< plays that found no voice of a priority as low as theirs
+};
+
 /**
 @class          SimpleAudioEngine
 @brief          offer a VERY simple interface to play background music & sound effect
@@ -164,6 +185,13 @@ public:
     	return this->playEffect(pszFilePath, false);
     }
 
+    /**
+    @brief Play sound effect with a priority
+    @param nPriority When all the voices are busy, the effect stops the one of the lowest
+    priority not above its own, the oldest first, or it isn't played. The other playEffect use 0.
+    */
+    unsigned int playEffect(const char* pszFilePath, bool bLoop, int nPriority);
+
     /**
     @brief Pause playing sound effect
     @param nSoundId The return value of function playEffect
@@ -206,11 +234,26 @@ public:
     */
     void preloadEffect(const char* pszFilePath);
 
+    /**
+    @brief          preload an effect on a background thread
+    @details        playing it before it's loaded waits for it
+    */
+    void preloadEffectAsync(const char* pszFilePath);
+
     /**
     @brief          unload the preloaded effect from internal buffer
     @param[in]        pszFilePath        The path of the effect file,or the FileName of T_SoundResInfo
     */
     void unloadEffect(const char* pszFilePath);
+
+    /**
+    @brief set how many bytes of decoded effects are kept, past it the least recently played are unloaded
+    */
+    void setEffectsCacheSize(unsigned int nBytes);
+
+    unsigned int getEffectsCacheSize();
+
+    EffectsStats getEffectsStats();
 };
 
 } // end of namespace CocosDenshion
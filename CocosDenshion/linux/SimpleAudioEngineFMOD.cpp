@@ -91,6 +91,31 @@ void SimpleAudioEngine::unloadEffect(const char* pszFilePath) {
 	return oAudioPlayer->unloadEffect(fullPath.c_str());
 }
 
+static unsigned int s_uEffectsCacheSize = 0;
+
+unsigned int SimpleAudioEngine::playEffect(const char* pszFilePath, bool bLoop, int nPriority) {
+	CC_UNUSED_PARAM(nPriority);
+	return playEffect(pszFilePath, bLoop);
+}
+
+void SimpleAudioEngine::preloadEffectAsync(const char* pszFilePath) {
+	preloadEffect(pszFilePath);
+}
+
+void SimpleAudioEngine::setEffectsCacheSize(unsigned int nBytes) {
+	s_uEffectsCacheSize = nBytes;
+}
+
+unsigned int SimpleAudioEngine::getEffectsCacheSize() {
+	return s_uEffectsCacheSize;
+}
+
+EffectsStats SimpleAudioEngine::getEffectsStats() {
+	EffectsStats stats = EffectsStats();
+	stats.cacheSize = s_uEffectsCacheSize;
+	return stats;
+}
+
 void SimpleAudioEngine::pauseEffect(unsigned int uSoundId) {
 	oAudioPlayer->pauseEffect(uSoundId);
 }
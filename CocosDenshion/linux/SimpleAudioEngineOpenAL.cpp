@@ -23,9 +23,16 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include <map>
+#include <list>
+#include <deque>
+#include <vector>
 #include <string>
+#include <algorithm>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
 
 #include <AL/al.h>
 #include <AL/alc.h>
@@ -37,89 +44,1093 @@ THE SOFTWARE.
 #endif
 
 #include "SimpleAudioEngine.h"
-#include "cocos2d.h"
+#include "CrossApp.h"
 USING_NS_CC;
 
 using namespace std;
 
 namespace CocosDenshion
 {
+	#define EFFECT_VOICE_COUNT		32
+	#define EFFECT_CACHE_SIZE		(8 * 1024 * 1024)
+
 	struct soundData {
-		ALuint buffer;
-		ALuint source;
-		bool   isLooped;
+		ALuint					buffer;
+		unsigned int			size;
+		list<string>::iterator	lru;		// its place in s_effectsLRU
+	};
+
+	typedef map<string, soundData *> EffectsMap;
+	EffectsMap s_effects;
+
+	// a source of the pool that plays the effects
+	struct effectVoice {
+		ALuint			source;
+		unsigned int	id;			// what playEffect returned for it
+		soundData	   *effect;
+		int				priority;
+		unsigned int	sequence;
 	};
 
-	typedef map<string, soundData *> EffectsMap;
-	EffectsMap s_effects;
+	static list<string>		s_effectsLRU;		// the most recently played first
+	static unsigned int		s_effectsCacheSize	= EFFECT_CACHE_SIZE;
+	static EffectsStats		s_effectsStats;
+	static effectVoice		s_voices[EFFECT_VOICE_COUNT];
+	static int				s_voiceCount		= 0;
+	static int				s_voiceLimit		= EFFECT_VOICE_COUNT;
+	static unsigned int		s_voiceSequence		= 0;
+
+	// guards all of the above, preloadEffectAsync decodes on s_effectsThread
+	static pthread_mutex_t	s_effectsMutex		= PTHREAD_MUTEX_INITIALIZER;
+	static pthread_cond_t	s_effectsCondition	= PTHREAD_COND_INITIALIZER;
+	static deque<string>	s_effectsQueue;
+	static string			s_loadingEffect;
+	static pthread_t		s_effectsThread;
+	static bool				s_effectsThreadRunning	= false;
+	static bool				s_effectsThreadQuit		= false;
+
+	typedef enum {
+		PLAYING,
+		STOPPED,
+		PAUSED,
+	} playStatus;
+
+	static float s_volume 				   = 1.0f;
+	static float s_effectVolume			   = 1.0f;
+
+	class BackgroundMusicStream;
+	typedef map<string, BackgroundMusicStream *> BackgroundMusicsMap;
+	BackgroundMusicsMap s_backgroundMusics;
+
+	static BackgroundMusicStream *s_backgroundMusic = NULL;
+
+	static SimpleAudioEngine  *s_engine = 0;
+
+	static int checkALError(const char *funcName)
+	{
+		int err = alGetError();
+
+		if (err != AL_NO_ERROR)
+		{
+			switch (err)
+			{
+				case AL_INVALID_NAME:
+					fprintf(stderr, "AL_INVALID_NAME in %s\n", funcName);
+					break;
+
+				case AL_INVALID_ENUM:
+					fprintf(stderr, "AL_INVALID_ENUM in %s\n", funcName);
+					break;
+
+				case AL_INVALID_VALUE:
+					fprintf(stderr, "AL_INVALID_VALUE in %s\n", funcName);
+					break;
+
+				case AL_INVALID_OPERATION:
+					fprintf(stderr, "AL_INVALID_OPERATION in %s\n", funcName);
+					break;
+
+				case AL_OUT_OF_MEMORY:
+					fprintf(stderr, "AL_OUT_OF_MEMORY in %s\n", funcName);
+					break;
+			}
+		}
+
+		return err;
+	}
+
+	//
+	// background music, streamed from the file
+	//
+	#define STREAM_BUFFER_COUNT		4
+	#define STREAM_BUFFER_SIZE		(64 * 1024)
+	#define STREAM_POLL_INTERVAL	20		// milliseconds
+
+	static unsigned int readLE16(const unsigned char *p)
+	{
+		return p[0] | (p[1] << 8);
+	}
+
+	static unsigned long readLE32(const unsigned char *p)
+	{
+		return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned long)p[3] << 24);
+	}
+
+	/**
+	 * Opens a PCM WAV file at the start of its samples.
+	 * @return false, with nothing left open, for any other file.
+	 */
+	static bool openPCMWave(const char *pszFilePath, FILE **pFile, ALenum *pFormat, ALsizei *pRate,
+		unsigned int *pBlockAlign, long *pDataOffset, unsigned long *pDataSize)
+	{
+		FILE *file = fopen(pszFilePath, "rb");
+		if (!file)
+		{
+			return false;
+		}
+
+		unsigned char header[12];
+		bool valid = fread(header, 1, 12, file) == 12 && memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0;
+		bool isPCM = false;
+		unsigned int channels = 0;
+		unsigned int bits = 0;
+		unsigned int blockAlign = 0;
+		unsigned long rate = 0;
+
+		while (valid)
+		{
+			unsigned char chunk[8];
+			if (fread(chunk, 1, 8, file) != 8)
+			{
+				break;
+			}
+			unsigned long size = readLE32(chunk + 4);
+
+			if (memcmp(chunk, "fmt ", 4) == 0)
+			{
+				unsigned char format[40];
+				unsigned long length = size < sizeof(format) ? size : sizeof(format);
+				if (size < 16 || fread(format, 1, length, file) != length)
+				{
+					break;
+				}
+				unsigned int tag = readLE16(format);
+				// WAVE_FORMAT_EXTENSIBLE has the actual format at the start of its sub format
+				if (tag == 0xfffe && length >= 26)
+				{
+					tag = readLE16(format + 24);
+				}
+				isPCM = tag == 1;
+				channels = readLE16(format + 2);
+				rate = readLE32(format + 4);
+				blockAlign = readLE16(format + 12);
+				bits = readLE16(format + 14);
+				valid = fseek(file, size - length + (size & 1), SEEK_CUR) == 0;
+			}
+			else if (memcmp(chunk, "data", 4) == 0)
+			{
+				if (!isPCM || (channels != 1 && channels != 2) || (bits != 8 && bits != 16)
+					|| blockAlign != channels * bits / 8 || rate == 0)
+				{
+					break;
+				}
+
+				// a file cut short, or written while streaming, has a wrong size
+				long offset = ftell(file);
+				fseek(file, 0, SEEK_END);
+				long end = ftell(file);
+				if (offset < 0 || end < offset || fseek(file, offset, SEEK_SET) != 0)
+				{
+					break;
+				}
+				if (size > (unsigned long)(end - offset))
+				{
+					size = end - offset;
+				}
+
+				if (channels == 1)
+					*pFormat = bits == 8 ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+				else
+					*pFormat = bits == 8 ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
+
+				*pFile = file;
+				*pRate = rate;
+				*pBlockAlign = blockAlign;
+				*pDataOffset = offset;
+				*pDataSize = size - size % blockAlign;
+				return true;
+			}
+			else
+			{
+				// chunks are padded to an even size
+				valid = fseek(file, size + (size & 1), SEEK_CUR) == 0;
+			}
+		}
+
+		fclose(file);
+		return false;
+	}
+
+	/**
+	 * Background music played from a few OpenAL buffers that a thread refills and
+	 * queues again as they are played, so the file is decoded while it plays and
+	 * only STREAM_BUFFER_COUNT buffers of PCM are ever held. OGG and PCM WAV are
+	 * streamed, any other file is still loaded whole with alut.
+	 */
+	class BackgroundMusicStream
+	{
+	public:
+		BackgroundMusicStream();
+
+		~BackgroundMusicStream();
+
+		bool open(const char *pszFilePath);
+
+		void play(bool bLoop);
+
+		void stop();
+
+		void pause();
+
+		void resume();
+
+		void rewind();
+
+		bool isPlaying();
+
+		void setVolume(float volume);
+
+	private:
+		typedef enum {
+			DECODER_NONE,
+			DECODER_OGG,
+			DECODER_WAV,
+		} decoderType;
+
+		bool openWAV(const char *pszFilePath);
+
+		// the rest is called with m_mutex held
+		unsigned int decode(char *data, unsigned int size);
+
+		bool seekToStart();
+
+		bool fillBuffer();
+
+		void update();
+
+		void reset();
+
+		static void* threadLoop(void *data);
+
+		ALuint			m_source;
+		ALuint			m_buffers[STREAM_BUFFER_COUNT];
+		ALuint			m_freeBuffers[STREAM_BUFFER_COUNT];
+		int				m_freeCount;
+		ALuint			m_wholeBuffer;
+		ALenum			m_format;
+		ALsizei			m_rate;
+		decoderType		m_decoder;
+#ifndef DISABLE_VORBIS
+		OggVorbis_File	m_ogg;
+#endif
+		FILE		   *m_wav;
+		long			m_wavDataOffset;
+		unsigned long	m_wavDataSize;
+		unsigned long	m_wavRemaining;
+		unsigned int	m_blockAlign;
+		bool			m_bLoop;
+		bool			m_bEnded;		// the decoder has nothing more to queue
+		bool			m_bPlaying;
+		bool			m_bPaused;
+		bool			m_bAtStart;		// what is queued is the beginning of the file
+		bool			m_bQuit;
+		bool			m_bThread;
+		pthread_t		m_thread;
+		pthread_mutex_t	m_mutex;
+		pthread_cond_t	m_condition;
+		char			m_pcm[STREAM_BUFFER_SIZE];
+	};
+
+	BackgroundMusicStream::BackgroundMusicStream()
+	: m_source(AL_NONE)
+	, m_freeCount(0)
+	, m_wholeBuffer(AL_NONE)
+	, m_format(AL_FORMAT_STEREO16)
+	, m_rate(0)
+	, m_decoder(DECODER_NONE)
+	, m_wav(NULL)
+	, m_wavDataOffset(0)
+	, m_wavDataSize(0)
+	, m_wavRemaining(0)
+	, m_blockAlign(1)
+	, m_bLoop(false)
+	, m_bEnded(false)
+	, m_bPlaying(false)
+	, m_bPaused(false)
+	, m_bAtStart(true)
+	, m_bQuit(false)
+	, m_bThread(false)
+	{
+		for (int i = 0; i < STREAM_BUFFER_COUNT; ++i)
+		{
+			m_buffers[i] = AL_NONE;
+		}
+		pthread_mutex_init(&m_mutex, NULL);
+		pthread_cond_init(&m_condition, NULL);
+	}
+
+	BackgroundMusicStream::~BackgroundMusicStream()
+	{
+		if (m_bThread)
+		{
+			pthread_mutex_lock(&m_mutex);
+			m_bQuit = true;
+			pthread_cond_signal(&m_condition);
+			pthread_mutex_unlock(&m_mutex);
+			pthread_join(m_thread, NULL);
+		}
+
+		if (m_source != AL_NONE)
+		{
+			alSourceStop(m_source);
+			alDeleteSources(1, &m_source);
+			checkALError("~BackgroundMusicStream:alDeleteSources");
+		}
+		if (m_buffers[0] != AL_NONE)
+		{
+			alDeleteBuffers(STREAM_BUFFER_COUNT, m_buffers);
+			checkALError("~BackgroundMusicStream:alDeleteBuffers");
+		}
+		if (m_wholeBuffer != AL_NONE)
+		{
+			alDeleteBuffers(1, &m_wholeBuffer);
+			checkALError("~BackgroundMusicStream:alDeleteBuffers");
+		}
+
+#ifndef DISABLE_VORBIS
+		if (m_decoder == DECODER_OGG)
+		{
+			ov_clear(&m_ogg);
+		}
+#endif
+		if (m_wav)
+		{
+			fclose(m_wav);
+		}
+
+		pthread_cond_destroy(&m_condition);
+		pthread_mutex_destroy(&m_mutex);
+	}
+
+	bool BackgroundMusicStream::open(const char *pszFilePath)
+	{
+		checkALError("BackgroundMusicStream:init");
+
+#ifndef DISABLE_VORBIS
+		if (ov_fopen(pszFilePath, &m_ogg) == 0)
+		{
+			vorbis_info *info = ov_info(&m_ogg, -1);
+			m_decoder = DECODER_OGG;
+			if (info->channels > 2)
+			{
+				fprintf(stderr, "OGG file with %d channels %s\n", info->channels, pszFilePath);
+				return false;
+			}
+			m_format = info->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+			m_rate = info->rate;
+			m_blockAlign = info->channels * 2;
+		}
+		else
+#endif
+		if (!openWAV(pszFilePath))
+		{
+			m_wholeBuffer = alutCreateBufferFromFile(pszFilePath);
+			checkALError("BackgroundMusicStream:alutCreateBufferFromFile");
+			if (m_wholeBuffer == AL_NONE)
+			{
+				return false;
+			}
+		}
+
+		alGenSources(1, &m_source);
+		if (checkALError("BackgroundMusicStream:alGenSources") != AL_NO_ERROR)
+		{
+			m_source = AL_NONE;
+			return false;
+		}
+
+		if (m_decoder == DECODER_NONE)
+		{
+			alSourcei(m_source, AL_BUFFER, m_wholeBuffer);
+			checkALError("BackgroundMusicStream:alSourcei");
+			return true;
+		}
+
+		alGenBuffers(STREAM_BUFFER_COUNT, m_buffers);
+		if (checkALError("BackgroundMusicStream:alGenBuffers") != AL_NO_ERROR)
+		{
+			m_buffers[0] = AL_NONE;
+			return false;
+		}
+		for (int i = 0; i < STREAM_BUFFER_COUNT; ++i)
+		{
+			m_freeBuffers[i] = m_buffers[i];
+		}
+		m_freeCount = STREAM_BUFFER_COUNT;
+
+		// one buffer right away, so that playing can start, the thread queues the others
+		fillBuffer();
+
+		m_bThread = pthread_create(&m_thread, NULL, &BackgroundMusicStream::threadLoop, this) == 0;
+		if (!m_bThread)
+		{
+			fprintf(stderr, "Could not start the streaming thread for %s\n", pszFilePath);
+			return false;
+		}
+		return true;
+	}
+
+	bool BackgroundMusicStream::openWAV(const char *pszFilePath)
+	{
+		if (!openPCMWave(pszFilePath, &m_wav, &m_format, &m_rate, &m_blockAlign, &m_wavDataOffset, &m_wavDataSize))
+		{
+			return false;
+		}
+		m_decoder = DECODER_WAV;
+		m_wavRemaining = m_wavDataSize;
+		return true;
+	}
+
+	unsigned int BackgroundMusicStream::decode(char *data, unsigned int size)
+	{
+		unsigned int filled = 0;
+		bool rewound = false;
+
+		while (filled < size)
+		{
+			long result = 0;
+#ifndef DISABLE_VORBIS
+			if (m_decoder == DECODER_OGG)
+			{
+				int section;
+				result = ov_read(&m_ogg, data + filled, size - filled, 0, 2, 1, &section);
+				if (result == OV_HOLE)
+				{
+					continue;
+				}
+				else if (result < 0)
+				{
+					fprintf(stderr, "OGG stream problem %ld\n", result);
+					break;
+				}
+			}
+			else
+#endif
+			{
+				unsigned long count = size - filled;
+				if (count > m_wavRemaining)
+				{
+					count = m_wavRemaining;
+				}
+				count -= count % m_blockAlign;
+				result = count > 0 ? fread(data + filled, 1, count, m_wav) : 0;
+				m_wavRemaining = (unsigned long)result == count ? m_wavRemaining - result : 0;
+			}
+
+			if (result > 0)
+			{
+				filled += result;
+				rewound = false;
+			}
+			else if (!m_bLoop || rewound || !seekToStart())
+			{
+				break;
+			}
+			else
+			{
+				// the loop goes on in the same buffer, without a gap
+				rewound = true;
+			}
+		}
+
+		return filled;
+	}
+
+	bool BackgroundMusicStream::seekToStart()
+	{
+#ifndef DISABLE_VORBIS
+		if (m_decoder == DECODER_OGG)
+		{
+			return ov_raw_seek(&m_ogg, 0) == 0;
+		}
+#endif
+		m_wavRemaining = m_wavDataSize;
+		return fseek(m_wav, m_wavDataOffset, SEEK_SET) == 0;
+	}
+
+	bool BackgroundMusicStream::fillBuffer()
+	{
+		if (m_freeCount == 0 || m_bEnded)
+		{
+			return false;
+		}
+
+		unsigned int size = decode(m_pcm, STREAM_BUFFER_SIZE);
+		if (size == 0)
+		{
+			m_bEnded = true;
+			return false;
+		}
+
+		ALuint buffer = m_freeBuffers[m_freeCount - 1];
+		alBufferData(buffer, m_format, m_pcm, size, m_rate);
+		alSourceQueueBuffers(m_source, 1, &buffer);
+		if (checkALError("BackgroundMusicStream:alSourceQueueBuffers") != AL_NO_ERROR)
+		{
+			m_bEnded = true;
+			return false;
+		}
+		--m_freeCount;
+		return true;
+	}
+
+	void BackgroundMusicStream::update()
+	{
+		ALint processed = 0;
+		alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processed);
+		for (; processed > 0; --processed)
+		{
+			ALuint buffer;
+			alSourceUnqueueBuffers(m_source, 1, &buffer);
+			m_freeBuffers[m_freeCount++] = buffer;
+		}
+
+		while (fillBuffer());
+
+		if (m_bPlaying && !m_bPaused)
+		{
+			ALint state;
+			alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+			if (state != AL_PLAYING)
+			{
+				if (m_freeCount < STREAM_BUFFER_COUNT)
+				{
+					// the source ran out of buffers before they were refilled
+					alSourcePlay(m_source);
+				}
+				else
+				{
+					m_bPlaying = false;
+				}
+			}
+		}
+		checkALError("BackgroundMusicStream:update");
+	}
+
+	void BackgroundMusicStream::reset()
+	{
+		// a rewound source is initial, so the buffers queued from now on aren't processed ones
+		alSourceStop(m_source);
+		alSourceRewind(m_source);
+		alSourcei(m_source, AL_BUFFER, AL_NONE);
+		checkALError("BackgroundMusicStream:reset");
+
+		for (int i = 0; i < STREAM_BUFFER_COUNT; ++i)
+		{
+			m_freeBuffers[i] = m_buffers[i];
+		}
+		m_freeCount = STREAM_BUFFER_COUNT;
+
+		m_bLoop = false;
+		m_bEnded = !seekToStart();
+		m_bAtStart = true;
+	}
+
+	void* BackgroundMusicStream::threadLoop(void *data)
+	{
+		BackgroundMusicStream *stream = (BackgroundMusicStream *)data;
+
+		pthread_mutex_lock(&stream->m_mutex);
+		while (!stream->m_bQuit)
+		{
+			stream->update();
+
+			if ((!stream->m_bPlaying || stream->m_bPaused) && (stream->m_freeCount == 0 || stream->m_bEnded))
+			{
+				// nothing to do until it is played
+				pthread_cond_wait(&stream->m_condition, &stream->m_mutex);
+			}
+			else
+			{
+				struct timeval now;
+				gettimeofday(&now, NULL);
+				long nanoseconds = now.tv_usec * 1000L + STREAM_POLL_INTERVAL * 1000000L;
+				struct timespec timeout;
+				timeout.tv_sec = now.tv_sec + nanoseconds / 1000000000L;
+				timeout.tv_nsec = nanoseconds % 1000000000L;
+				pthread_cond_timedwait(&stream->m_condition, &stream->m_mutex, &timeout);
+			}
+		}
+		pthread_mutex_unlock(&stream->m_mutex);
+
+		return NULL;
+	}
+
+	void BackgroundMusicStream::play(bool bLoop)
+	{
+		pthread_mutex_lock(&m_mutex);
+
+		if (m_decoder == DECODER_NONE)
+		{
+			alSourcei(m_source, AL_LOOPING, bLoop ? AL_TRUE : AL_FALSE);
+		}
+		else
+		{
+			if (!m_bAtStart)
+			{
+				reset();
+			}
+
+			m_bLoop = bLoop;
+			// a file shorter than the buffers was read to its end while it was preloaded
+			if (m_bEnded && m_bLoop && seekToStart())
+			{
+				m_bEnded = false;
+			}
+			if (m_freeCount == STREAM_BUFFER_COUNT)
+			{
+				fillBuffer();
+			}
+
+			m_bPlaying = true;
+			m_bPaused = false;
+			m_bAtStart = false;
+		}
+
+		alSourcePlay(m_source);
+		checkALError("BackgroundMusicStream:alSourcePlay");
+
+		pthread_cond_signal(&m_condition);
+		pthread_mutex_unlock(&m_mutex);
+	}
+
+	void BackgroundMusicStream::stop()
+	{
+		pthread_mutex_lock(&m_mutex);
+
+		if (m_decoder == DECODER_NONE)
+		{
+			alSourceStop(m_source);
+		}
+		else
+		{
+			m_bPlaying = false;
+			m_bPaused = false;
+			reset();
+		}
+
+		pthread_cond_signal(&m_condition);
+		pthread_mutex_unlock(&m_mutex);
+	}
+
+	void BackgroundMusicStream::pause()
+	{
+		pthread_mutex_lock(&m_mutex);
+
+		ALint state;
+		alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+		if (state == AL_PLAYING || (m_bPlaying && !m_bPaused))
+		{
+			alSourcePause(m_source);
+			m_bPaused = m_bPlaying;
+		}
+		checkALError("pauseBackgroundMusic:alSourcePause");
+
+		pthread_mutex_unlock(&m_mutex);
+	}
+
+	void BackgroundMusicStream::resume()
+	{
+		pthread_mutex_lock(&m_mutex);
+
+		ALint state;
+		alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+		if ((m_decoder == DECODER_NONE && state == AL_PAUSED) || (m_bPlaying && m_bPaused))
+		{
+			alSourcePlay(m_source);
+			m_bPaused = false;
+		}
+		checkALError("resumeBackgroundMusic:alSourcePlay");
+
+		pthread_cond_signal(&m_condition);
+		pthread_mutex_unlock(&m_mutex);
+	}
+
+	void BackgroundMusicStream::rewind()
+	{
+		// like alSourceRewind, the music is back at its start and stopped
+		this->stop();
+	}
+
+	bool BackgroundMusicStream::isPlaying()
+	{
+		pthread_mutex_lock(&m_mutex);
+
+		bool playing = m_bPlaying && !m_bPaused;
+		if (m_decoder == DECODER_NONE)
+		{
+			ALint state;
+			alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+			playing = state == AL_PLAYING;
+		}
+
+		pthread_mutex_unlock(&m_mutex);
+		return playing;
+	}
+
+	void BackgroundMusicStream::setVolume(float volume)
+	{
+		alSourcef(m_source, AL_GAIN, volume);
+	}
+
+	//
+	// sound effects, decoded once into a cache of buffers and played by a pool of sources
+	//
+	static double currentMilliseconds()
+	{
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+	}
+
+	static void countDecode(double start)
+	{
+		float time = (float)(currentMilliseconds() - start);
+		++s_effectsStats.decodes;
+		s_effectsStats.decodeTime += time;
+		if (time > s_effectsStats.maxDecodeTime)
+			s_effectsStats.maxDecodeTime = time;
+	}
+
+	/** decodes an OGG or PCM WAV file, any other file is left to alut */
+	static bool decodeEffect(const char *pszFilePath, vector<char>& pcm, ALenum *pFormat, ALsizei *pRate)
+	{
+#ifndef DISABLE_VORBIS
+		OggVorbis_File ogg_file;
+		if (ov_fopen(pszFilePath, &ogg_file) == 0)
+		{
+			vorbis_info *info = ov_info(&ogg_file, -1);
+			bool valid = info->channels == 1 || info->channels == 2;
+			*pFormat = info->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+			*pRate = info->rate;
+
+			long long samples = ov_pcm_total(&ogg_file, -1);
+			if (valid && samples > 0)
+				pcm.reserve(samples * info->channels * 2);
+
+			char data[4096];
+			int section;
+			while (valid)
+			{
+				long result = ov_read(&ogg_file, data, sizeof(data), 0, 2, 1, &section);
+				if (result > 0)
+					pcm.insert(pcm.end(), data, data + result);
+				else if (result != OV_HOLE)
+				{
+					valid = result == 0;
+					break;
+				}
+			}
+			ov_clear(&ogg_file);
+
+			if (!valid)
+				fprintf(stderr, "OGG file problem %s\n", pszFilePath);
+			return valid && !pcm.empty();
+		}
+#endif
+
+		FILE *file;
+		unsigned int blockAlign;
+		long offset;
+		unsigned long size;
+		if (openPCMWave(pszFilePath, &file, pFormat, pRate, &blockAlign, &offset, &size))
+		{
+			pcm.resize(size);
+			bool valid = size > 0 && fread(&pcm[0], 1, size, file) == size;
+			fclose(file);
+			return valid;
+		}
+		return false;
+	}
+
+	static ALuint createEffectBuffer(const vector<char>& pcm, ALenum format, ALsizei rate)
+	{
+		ALuint buffer = AL_NONE;
 
-	typedef enum {
-		PLAYING,
-		STOPPED,
-		PAUSED,
-	} playStatus;
+		checkALError("createEffectBuffer:init");
+		alGenBuffers(1, &buffer);
+		if (checkALError("createEffectBuffer:alGenBuffers") != AL_NO_ERROR)
+			return AL_NONE;
 
-	static float s_volume 				   = 1.0f;
-	static float s_effectVolume			   = 1.0f;
+		alBufferData(buffer, format, &pcm[0], pcm.size(), rate);
+		if (checkALError("createEffectBuffer:alBufferData") != AL_NO_ERROR)
+		{
+			alDeleteBuffers(1, &buffer);
+			return AL_NONE;
+		}
+		return buffer;
+	}
 
-	struct backgroundMusicData {
-		ALuint buffer;
-		ALuint source;
-	};
-	typedef map<string, backgroundMusicData *> BackgroundMusicsMap;
-	BackgroundMusicsMap s_backgroundMusics;
+	static bool isVoiceBusy(const effectVoice& voice)
+	{
+		ALint state;
+		alGetSourcei(voice.source, AL_SOURCE_STATE, &state);
+		return state == AL_PLAYING || state == AL_PAUSED;
+	}
 
-	static ALuint s_backgroundSource = AL_NONE;
+	// the rest is called with s_effectsMutex held
 
-	static SimpleAudioEngine  *s_engine = 0;
+	static effectVoice* findVoice(unsigned int nSoundId)
+	{
+		int index = nSoundId % EFFECT_VOICE_COUNT;
+		return index < s_voiceCount && s_voices[index].id == nSoundId ? &s_voices[index] : NULL;
+	}
 
-	static int checkALError(const char *funcName)
+	/**
+	 * A voice that isn't playing, a new one while the pool isn't full, or else the
+	 * one of the lowest priority not above priority, the oldest first, which is stopped.
+	 * NULL when every voice plays something more important.
+	 */
+	static effectVoice* getVoice(int priority)
 	{
-		int err = alGetError();
+		effectVoice *stolen = NULL;
+		for (int i = 0; i < s_voiceCount; ++i)
+		{
+			effectVoice *voice = &s_voices[i];
+			if (!isVoiceBusy(*voice))
+				return voice;
 
-		if (err != AL_NO_ERROR)
+			if (voice->priority <= priority && (stolen == NULL || voice->priority < stolen->priority
+				|| (voice->priority == stolen->priority && (int)(voice->sequence - stolen->sequence) < 0)))
+			{
+				stolen = voice;
+			}
+		}
+
+		if (s_voiceCount < s_voiceLimit)
 		{
-			switch (err)
+			effectVoice *voice = &s_voices[s_voiceCount];
+			checkALError("getVoice:init");
+			alGenSources(1, &voice->source);
+			if (checkALError("getVoice:alGenSources") == AL_NO_ERROR)
 			{
-				case AL_INVALID_NAME:
-					fprintf(stderr, "AL_INVALID_NAME in %s\n", funcName);
-					break;
+				voice->id = 0;
+				voice->effect = NULL;
+				voice->priority = 0;
+				voice->sequence = 0;
+				++s_voiceCount;
+				return voice;
+			}
+			// the device has no more sources, the pool stays at this size
+			s_voiceLimit = s_voiceCount;
+		}
 
-				case AL_INVALID_ENUM:
-					fprintf(stderr, "AL_INVALID_ENUM in %s\n", funcName);
-					break;
+		if (stolen)
+		{
+			alSourceStop(stolen->source);
+			++s_effectsStats.stolenVoices;
+		}
+		return stolen;
+	}
 
-				case AL_INVALID_VALUE:
-					fprintf(stderr, "AL_INVALID_VALUE in %s\n", funcName);
-					break;
+	static void releaseEffect(EffectsMap::iterator it)
+	{
+		soundData *data = it->second;
+		for (int i = 0; i < s_voiceCount; ++i)
+		{
+			if (s_voices[i].effect == data)
+			{
+				alSourceStop(s_voices[i].source);
+				alSourcei(s_voices[i].source, AL_BUFFER, AL_NONE);
+				s_voices[i].effect = NULL;
+				s_voices[i].id = 0;
+			}
+		}
+		alDeleteBuffers(1, &data->buffer);
+		checkALError("releaseEffect:alDeleteBuffers");
+
+		s_effectsStats.cachedBytes -= data->size;
+		--s_effectsStats.cachedEffects;
+		s_effectsLRU.erase(data->lru);
+		delete data;
+		s_effects.erase(it);
+	}
 
-				case AL_INVALID_OPERATION:
-					fprintf(stderr, "AL_INVALID_OPERATION in %s\n", funcName);
-					break;
+	/** unloads the least recently played effects until they fit in the cache, except keep and those playing */
+	static void trimEffects(soundData *keep)
+	{
+		list<string>::iterator it = s_effectsLRU.end();
+		while (s_effectsStats.cachedBytes > s_effectsCacheSize && it != s_effectsLRU.begin())
+		{
+			list<string>::iterator victim = --it;
+			EffectsMap::iterator effect = s_effects.find(*victim);
 
-				case AL_OUT_OF_MEMORY:
-					fprintf(stderr, "AL_OUT_OF_MEMORY in %s\n", funcName);
-					break;
+			bool busy = effect->second == keep;
+			for (int i = 0; i < s_voiceCount && !busy; ++i)
+			{
+				busy = s_voices[i].effect == effect->second && isVoiceBusy(s_voices[i]);
+			}
+			if (busy)
+				continue;
+
+			++it;
+			releaseEffect(effect);
+			++s_effectsStats.evictions;
+		}
+	}
+
+	static soundData* addEffect(const string& path, ALuint buffer)
+	{
+		EffectsMap::iterator it = s_effects.find(path);
+		if (it != s_effects.end())
+		{
+			// loaded by another thread meanwhile
+			alDeleteBuffers(1, &buffer);
+			return it->second;
+		}
+
+		ALint size = 0;
+		alGetBufferi(buffer, AL_SIZE, &size);
+
+		soundData *data = new soundData();
+		data->buffer = buffer;
+		data->size = size;
+		s_effectsLRU.push_front(path);
+		data->lru = s_effectsLRU.begin();
+		s_effects.insert(EffectsMap::value_type(path, data));
+
+		s_effectsStats.cachedBytes += data->size;
+		++s_effectsStats.cachedEffects;
+		trimEffects(data);
+		return data;
+	}
+
+	/**
+	 * The effect, decoded here unless it's cached or being preloaded, which is waited for.
+	 * s_effectsMutex is released while decoding.
+	 * @param pDecoded Set when the effect was decoded by this call.
+	 */
+	static soundData* loadEffect(const string& path, bool *pDecoded)
+	{
+		*pDecoded = false;
+
+		EffectsMap::iterator it = s_effects.find(path);
+		if (it == s_effects.end())
+		{
+			deque<string>::iterator queued = find(s_effectsQueue.begin(), s_effectsQueue.end(), path);
+			if (queued != s_effectsQueue.end())
+				s_effectsQueue.erase(queued);
+
+			while (s_loadingEffect == path)
+				pthread_cond_wait(&s_effectsCondition, &s_effectsMutex);
+			it = s_effects.find(path);
+		}
+
+		if (it != s_effects.end())
+		{
+			s_effectsLRU.splice(s_effectsLRU.begin(), s_effectsLRU, it->second->lru);
+			return it->second;
+		}
+
+		pthread_mutex_unlock(&s_effectsMutex);
+
+		double start = currentMilliseconds();
+		vector<char> pcm;
+		ALenum format;
+		ALsizei rate;
+		ALuint buffer = AL_NONE;
+		if (decodeEffect(path.c_str(), pcm, &format, &rate))
+		{
+			buffer = createEffectBuffer(pcm, format, rate);
+		}
+		else
+		{
+			checkALError("loadEffect:init");
+			buffer = alutCreateBufferFromFile(path.c_str());
+			checkALError("loadEffect:alutCreateBufferFromFile");
+		}
+
+		pthread_mutex_lock(&s_effectsMutex);
+
+		if (buffer == AL_NONE)
+			return NULL;
+
+		countDecode(start);
+		*pDecoded = true;
+		return addEffect(path, buffer);
+	}
+
+	static void* loadEffects(void *)
+	{
+		pthread_mutex_lock(&s_effectsMutex);
+		while (!s_effectsThreadQuit)
+		{
+			if (s_effectsQueue.empty())
+			{
+				pthread_cond_wait(&s_effectsCondition, &s_effectsMutex);
+				continue;
+			}
+
+			string path = s_effectsQueue.front();
+			s_effectsQueue.pop_front();
+			s_loadingEffect = path;
+			pthread_mutex_unlock(&s_effectsMutex);
+
+			// alut isn't used here, the files it reads are loaded when they are played
+			double start = currentMilliseconds();
+			vector<char> pcm;
+			ALenum format;
+			ALsizei rate;
+			ALuint buffer = AL_NONE;
+			if (decodeEffect(path.c_str(), pcm, &format, &rate))
+				buffer = createEffectBuffer(pcm, format, rate);
+
+			pthread_mutex_lock(&s_effectsMutex);
+			if (buffer != AL_NONE)
+			{
+				countDecode(start);
+				addEffect(path, buffer);
 			}
+			s_loadingEffect.clear();
+			pthread_cond_broadcast(&s_effectsCondition);
 		}
+		pthread_mutex_unlock(&s_effectsMutex);
 
-		return err;
+		return NULL;
+	}
+
+	static void releaseEffects()
+	{
+		if (s_effectsThreadRunning)
+		{
+			pthread_mutex_lock(&s_effectsMutex);
+			s_effectsThreadQuit = true;
+			s_effectsQueue.clear();
+			pthread_cond_broadcast(&s_effectsCondition);
+			pthread_mutex_unlock(&s_effectsMutex);
+			pthread_join(s_effectsThread, NULL);
+			s_effectsThreadRunning = false;
+		}
+
+		pthread_mutex_lock(&s_effectsMutex);
+		while (!s_effects.empty())
+		{
+			releaseEffect(s_effects.begin());
+		}
+		for (int i = 0; i < s_voiceCount; ++i)
+		{
+			alSourceStop(s_voices[i].source);
+			alDeleteSources(1, &s_voices[i].source);
+			checkALError("end:alDeleteSources");
+		}
+		s_voiceCount = 0;
+		s_voiceLimit = EFFECT_VOICE_COUNT;
+		pthread_mutex_unlock(&s_effectsMutex);
 	}
 
     static void stopBackground(bool bReleaseData)
     {
-		alSourceStop(s_backgroundSource);
+		if (s_backgroundMusic == NULL)
+			return;
+
+		s_backgroundMusic->stop();
 
 		if (bReleaseData)
 		{
 			for (BackgroundMusicsMap::iterator it = s_backgroundMusics.begin(); it != s_backgroundMusics.end(); ++it)
 			{
-				if (it->second->source == s_backgroundSource)
+				if (it->second == s_backgroundMusic)
 				{
-					alDeleteBuffers(1, &it->second->buffer);
-					checkALError("stopBackground:alDeleteBuffers");
-					alDeleteSources(1, &it->second->source);
-					checkALError("stopBackground:alDeleteSources");
 					delete it->second;
 					s_backgroundMusics.erase(it);
 					break;
@@ -127,12 +1138,13 @@ namespace CocosDenshion
 			}
 		}
 
-		s_backgroundSource = AL_NONE;
+		s_backgroundMusic = NULL;
     }
 
     static void setBackgroundVolume(float volume)
     {
-    	alSourcef(s_backgroundSource, AL_GAIN, volume);
+		if (s_backgroundMusic)
+			s_backgroundMusic->setVolume(volume);
     }
 
 	SimpleAudioEngine::SimpleAudioEngine()
@@ -159,130 +1171,18 @@ namespace CocosDenshion
 		checkALError("end:init");
 
 		// clear all the sounds
-	    EffectsMap::const_iterator end = s_effects.end();
-	    for (EffectsMap::iterator it = s_effects.begin(); it != end; it++)
-	    {
-	        alSourceStop(it->second->source);
-	        checkALError("end:alSourceStop");
-			alDeleteBuffers(1, &it->second->buffer);
-			checkALError("end:alDeleteBuffers");
-			alDeleteSources(1, &it->second->source);
-			checkALError("end:alDeleteSources");
-			delete it->second;
-	    }
-	    s_effects.clear();
+		releaseEffects();
 
 		// and the background too
 		stopBackground(true);
 
 		for (BackgroundMusicsMap::iterator it = s_backgroundMusics.begin(); it != s_backgroundMusics.end(); ++it)
 		{
-			alSourceStop(it->second->source);
-			checkALError("end:alSourceStop");
-			alDeleteBuffers(1, &it->second->buffer);
-			checkALError("end:alDeleteBuffers");
-			alDeleteSources(1, &it->second->source);
-			checkALError("end:alDeleteSources");
 			delete it->second;
 		}
 		s_backgroundMusics.clear();
 	}
 	
-#ifndef DISABLE_VORBIS
-
-	//
-	// OGG support
-	//
-	static bool isOGGFile(const char *pszFilePath)
-	{
-		FILE			*file;
-		OggVorbis_File   ogg_file;
-		int				 result;
-
-		file = fopen(pszFilePath, "rb");
-		result = ov_test(file, &ogg_file, 0, 0);
-		ov_clear(&ogg_file);
-
-		return (result == 0);
-	}
-
-	static ALuint createBufferFromOGG(const char *pszFilePath)
-	{
-		ALuint 			buffer;
-		OggVorbis_File  ogg_file;
-		vorbis_info*    info;
-		ALenum 			format;
-		int 			result;
-		int 			section;
-		unsigned int 	size = 0;
-
-		if (ov_fopen(pszFilePath, &ogg_file) < 0)
-		{
-			ov_clear(&ogg_file);
-			fprintf(stderr, "Could not open OGG file %s\n", pszFilePath);
-			return -1;
-		}
-
-		info = ov_info(&ogg_file, -1);
-
-		if (info->channels == 1)
-			format = AL_FORMAT_MONO16;
-		else
-			format = AL_FORMAT_STEREO16;
-
-		// size = #samples * #channels * 2 (for 16 bit)
-		unsigned int data_size = ov_pcm_total(&ogg_file, -1) * info->channels * 2;
-		char* data = new char[data_size];
-
-		while (size < data_size)
-		{
-			result = ov_read(&ogg_file, data + size, data_size - size, 0, 2, 1, &section);
-			if (result > 0)
-			{
-				size += result;
-			}
-			else if (result < 0)
-			{
-				delete [] data;
-				fprintf(stderr, "OGG file problem %s\n", pszFilePath);
-				return -1;
-			}
-			else
-			{
-				break;
-			}
-		}
-
-		if (size == 0)
-		{
-			delete [] data;
-			fprintf(stderr, "Unable to read OGG data\n");
-			return -1;
-		}
-
-		// clear al errors
-		checkALError("createBufferFromOGG:init");
-
-	    // Load audio data into a buffer.
-	    alGenBuffers(1, &buffer);
-
-	    if (checkALError("createBufferFromOGG:alGenBuffers") != AL_NO_ERROR)
-	    {
-	        fprintf(stderr, "Couldn't generate a buffer for OGG file\n");
-	        delete [] data;
-	        return buffer;
-	    }
-
-		alBufferData(buffer, format, data, data_size, info->rate);
-		checkALError("createBufferFromOGG:alBufferData");
-
-		delete [] data;
-		ov_clear(&ogg_file);
-
-		return buffer;
-	}
-#endif
-
 	//
 	// background audio
 	//
@@ -294,43 +1194,22 @@ namespace CocosDenshion
     	BackgroundMusicsMap::const_iterator it = s_backgroundMusics.find(fullPath);
 		if (it == s_backgroundMusics.end())
 		{
-			ALuint buffer = AL_NONE;
-#ifndef DISABLE_VORBIS			
-			if (isOGGFile(fullPath.data()))
-			{
-				buffer = createBufferFromOGG(fullPath.data());
-			}
-			else
-#endif			
-				buffer = alutCreateBufferFromFile(fullPath.data());
-			
-
-			checkALError("preloadBackgroundMusic:createBuffer");
-
-			if (buffer == AL_NONE)
+			// only opens the file and decodes its first buffers, the rest is decoded while playing
+			BackgroundMusicStream* stream = new BackgroundMusicStream();
+			if (!stream->open(fullPath.c_str()))
 			{
-				fprintf(stderr, "Error loading file: '%s'\n", fullPath.data());
-				alDeleteBuffers(1, &buffer);
+				fprintf(stderr, "Error loading file: '%s'\n", fullPath.c_str());
+				delete stream;
 				return;
 			}
 
-			ALuint source = AL_NONE;
-			alGenSources(1, &source);
-			checkALError("preloadBackgroundMusic:alGenSources");
-
-			alSourcei(source, AL_BUFFER, buffer);
-			checkALError("preloadBackgroundMusic:alSourcei");
-
-			backgroundMusicData* data = new backgroundMusicData();
-			data->buffer = buffer;
-			data->source = source;
-			s_backgroundMusics.insert(BackgroundMusicsMap::value_type(fullPath, data));
+			s_backgroundMusics.insert(BackgroundMusicsMap::value_type(fullPath, stream));
 		}
 	}
 
 	void SimpleAudioEngine::playBackgroundMusic(const char* pszFilePath, bool bLoop)
 	{
-		if (s_backgroundSource != AL_NONE)
+		if (s_backgroundMusic != NULL)
 			stopBackgroundMusic(false);
 
 		// Changing file path to full path
@@ -345,10 +1224,9 @@ namespace CocosDenshion
 
 		if (it != s_backgroundMusics.end())
 		{
-			s_backgroundSource = it->second->source;
-			alSourcei(s_backgroundSource, AL_LOOPING, bLoop ? AL_TRUE : AL_FALSE);
-			alSourcePlay(s_backgroundSource);
-			checkALError("playBackgroundMusic:alSourcePlay");
+			s_backgroundMusic = it->second;
+			s_backgroundMusic->setVolume(s_volume);
+			s_backgroundMusic->play(bLoop);
 		}
 	}
 
@@ -359,26 +1237,20 @@ namespace CocosDenshion
 
 	void SimpleAudioEngine::pauseBackgroundMusic()
 	{
-		ALint state;
-		alGetSourcei(s_backgroundSource, AL_SOURCE_STATE, &state);
-		if (state == AL_PLAYING)
-			alSourcePause(s_backgroundSource);
-		checkALError("pauseBackgroundMusic:alSourcePause");
+		if (s_backgroundMusic)
+			s_backgroundMusic->pause();
 	}
 
 	void SimpleAudioEngine::resumeBackgroundMusic()
 	{
-		ALint state;
-		alGetSourcei(s_backgroundSource, AL_SOURCE_STATE, &state);
-		if (state == AL_PAUSED)
-			alSourcePlay(s_backgroundSource);
-		checkALError("resumeBackgroundMusic:alSourcePlay");
+		if (s_backgroundMusic)
+			s_backgroundMusic->resume();
 	} 
 
 	void SimpleAudioEngine::rewindBackgroundMusic()
 	{
-		alSourceRewind(s_backgroundSource);
-		checkALError("rewindBackgroundMusic:alSourceRewind");
+		if (s_backgroundMusic)
+			s_backgroundMusic->rewind();
 	}
 
 	bool SimpleAudioEngine::willPlayBackgroundMusic()
@@ -388,10 +1260,7 @@ namespace CocosDenshion
 
 	bool SimpleAudioEngine::isBackgroundMusicPlaying()
 	{
-	    ALint play_status;
-	    alGetSourcei(s_backgroundSource, AL_SOURCE_STATE, &play_status);
-
-		return (play_status == AL_PLAYING);
+		return s_backgroundMusic && s_backgroundMusic->isPlaying();
 	}
 
 	float SimpleAudioEngine::getBackgroundMusicVolume()
@@ -421,49 +1290,86 @@ namespace CocosDenshion
 	{
 		if (volume != s_effectVolume)
 		{
-			EffectsMap::const_iterator end = s_effects.end();
-			for (EffectsMap::const_iterator it = s_effects.begin(); it != end; it++)
+			pthread_mutex_lock(&s_effectsMutex);
+			for (int i = 0; i < s_voiceCount; ++i)
 			{
-				alSourcef(it->second->source, AL_GAIN, volume);
+				alSourcef(s_voices[i].source, AL_GAIN, volume);
 			}
+			pthread_mutex_unlock(&s_effectsMutex);
 
 			s_effectVolume = volume;
 		}
 	}
 
 	unsigned int SimpleAudioEngine::playEffect(const char* pszFilePath, bool bLoop)
+	{
+		return this->playEffect(pszFilePath, bLoop, 0);
+	}
+
+	unsigned int SimpleAudioEngine::playEffect(const char* pszFilePath, bool bLoop, int nPriority)
 	{
 		// Changing file path to full path
     	std::string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(pszFilePath);
 
-		EffectsMap::iterator iter = s_effects.find(fullPath);
+		pthread_mutex_lock(&s_effectsMutex);
 
-		if (iter == s_effects.end())
+		bool decoded;
+		soundData *data = loadEffect(fullPath, &decoded);
+		if (data == NULL)
 		{
-			preloadEffect(fullPath.c_str());
+			pthread_mutex_unlock(&s_effectsMutex);
+			fprintf(stderr, "could not find play sound %s\n", fullPath.c_str());
+			return -1;
+		}
+		if (decoded)
+			++s_effectsStats.misses;
+		else
+			++s_effectsStats.hits;
 
-			// let's try again
-			iter = s_effects.find(fullPath);
-			if (iter == s_effects.end())
-			{
-				fprintf(stderr, "could not find play sound %s\n", fullPath.c_str());
-				return -1;
-			}
+		effectVoice *voice = getVoice(nPriority);
+		if (voice == NULL)
+		{
+			++s_effectsStats.droppedPlays;
+			pthread_mutex_unlock(&s_effectsMutex);
+			return -1;
 		}
 
 		checkALError("playEffect:init");
-		iter->second->isLooped = bLoop;
-		alSourcei(iter->second->source, AL_LOOPING, iter->second->isLooped ? AL_TRUE : AL_FALSE);
-		alSourcePlay(iter->second->source);
+		if (voice->effect != data)
+		{
+			alSourcei(voice->source, AL_BUFFER, data->buffer);
+			voice->effect = data;
+		}
+		alSourcei(voice->source, AL_LOOPING, bLoop ? AL_TRUE : AL_FALSE);
+		alSourcef(voice->source, AL_GAIN, s_effectVolume);
+		alSourcePlay(voice->source);
 		checkALError("playEffect:alSourcePlay");
 
-		return iter->second->source;
+		// the index of the voice with a serial number, so that the id of a reused voice is a new one
+		unsigned int index = voice - s_voices;
+		do
+		{
+			voice->sequence = ++s_voiceSequence;
+			voice->id = voice->sequence * EFFECT_VOICE_COUNT + index;
+		}
+		while (voice->id == 0 || voice->id == (unsigned int)-1);
+		voice->priority = nPriority;
+
+		unsigned int nSoundId = voice->id;
+		pthread_mutex_unlock(&s_effectsMutex);
+		return nSoundId;
 	}
 
 	void SimpleAudioEngine::stopEffect(unsigned int nSoundId)
 	{
-		alSourceStop(nSoundId);
-		checkALError("stopEffect:alSourceStop");
+		pthread_mutex_lock(&s_effectsMutex);
+		effectVoice *voice = findVoice(nSoundId);
+		if (voice)
+		{
+			alSourceStop(voice->source);
+			checkALError("stopEffect:alSourceStop");
+		}
+		pthread_mutex_unlock(&s_effectsMutex);
 	}
 
 	void SimpleAudioEngine::preloadEffect(const char* pszFilePath)
@@ -471,53 +1377,44 @@ namespace CocosDenshion
 		// Changing file path to full path
     	std::string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(pszFilePath);
 
-		EffectsMap::iterator iter = s_effects.find(fullPath);
-
-		// check if we have this already
-		if (iter == s_effects.end())
+		pthread_mutex_lock(&s_effectsMutex);
+		bool decoded;
+		if (loadEffect(fullPath, &decoded) == NULL)
 		{
-			ALuint 		buffer;
-			ALuint 		source;
-			soundData  *data = new soundData;
-			string 	    path = fullPath;
+			fprintf(stderr, "Error loading file: '%s'\n", fullPath.c_str());
+		}
+		pthread_mutex_unlock(&s_effectsMutex);
+	}
 
-			checkALError("preloadEffect:init");
-#ifndef DISABLE_VORBIS
-			if (isOGGFile(path.data()))
-			{
-				buffer = createBufferFromOGG(path.data());
-			}
-			else
-#endif			
+	void SimpleAudioEngine::preloadEffectAsync(const char* pszFilePath)
+	{
+		// Changing file path to full path
+    	std::string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(pszFilePath);
+
+		pthread_mutex_lock(&s_effectsMutex);
+
+		if (s_effects.find(fullPath) == s_effects.end() && s_loadingEffect != fullPath
+			&& find(s_effectsQueue.begin(), s_effectsQueue.end(), fullPath) == s_effectsQueue.end())
+		{
+			if (!s_effectsThreadRunning)
 			{
-				buffer = alutCreateBufferFromFile(path.data());
-				checkALError("preloadEffect:createBufferFromFile");
+				s_effectsThreadQuit = false;
+				s_effectsThreadRunning = pthread_create(&s_effectsThread, NULL, &loadEffects, NULL) == 0;
 			}
 
-			if (buffer == AL_NONE)
+			if (s_effectsThreadRunning)
 			{
-				fprintf(stderr, "Error loading file: '%s'\n", path.data());
-				alDeleteBuffers(1, &buffer);
-				return;
+				s_effectsQueue.push_back(fullPath);
+				pthread_cond_broadcast(&s_effectsCondition);
 			}
-
-			alGenSources(1, &source);
-
-			if (checkALError("preloadEffect:alGenSources") != AL_NO_ERROR)
+			else
 			{
-				alDeleteBuffers(1, &buffer);
-				return;
+				bool decoded;
+				loadEffect(fullPath, &decoded);
 			}
-
-			alSourcei(source, AL_BUFFER, buffer);
-			checkALError("preloadEffect:alSourcei");
-
-			data->isLooped = false;
-			data->buffer = buffer;
-			data->source = source;
-
-			s_effects.insert(EffectsMap::value_type(fullPath, data));
 		}
+
+		pthread_mutex_unlock(&s_effectsMutex);
 	}
 
 	void SimpleAudioEngine::unloadEffect(const char* pszFilePath)
@@ -525,82 +1422,121 @@ namespace CocosDenshion
 		// Changing file path to full path
     	std::string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(pszFilePath);
     	
-		EffectsMap::iterator iter = s_effects.find(fullPath);
-
-		if (iter != s_effects.end())
-	    {
-			checkALError("unloadEffect:init");
+		pthread_mutex_lock(&s_effectsMutex);
 
-	        alSourceStop(iter->second->source);
-	        checkALError("unloadEffect:alSourceStop");
+		deque<string>::iterator queued = find(s_effectsQueue.begin(), s_effectsQueue.end(), fullPath);
+		if (queued != s_effectsQueue.end())
+			s_effectsQueue.erase(queued);
 
-			alDeleteSources(1, &iter->second->source);
-			checkALError("unloadEffect:DeletSources");
+		while (s_loadingEffect == fullPath)
+			pthread_cond_wait(&s_effectsCondition, &s_effectsMutex);
 
-			alDeleteBuffers(1, &iter->second->buffer);
-			checkALError("unloadEffect:alDeleteBuffers");
-			delete iter->second;
+		EffectsMap::iterator iter = s_effects.find(fullPath);
+		if (iter != s_effects.end())
+		{
+			releaseEffect(iter);
+		}
 
-			s_effects.erase(iter);
-	    }
+		pthread_mutex_unlock(&s_effectsMutex);
 	}
 
 	void SimpleAudioEngine::pauseEffect(unsigned int nSoundId)
 	{
-		ALint state;
-		alGetSourcei(nSoundId, AL_SOURCE_STATE, &state);
-		if (state == AL_PLAYING)
-			alSourcePause(nSoundId);
-		checkALError("pauseEffect:alSourcePause");
+		pthread_mutex_lock(&s_effectsMutex);
+		effectVoice *voice = findVoice(nSoundId);
+		if (voice)
+		{
+			ALint state;
+			alGetSourcei(voice->source, AL_SOURCE_STATE, &state);
+			if (state == AL_PLAYING)
+				alSourcePause(voice->source);
+			checkALError("pauseEffect:alSourcePause");
+		}
+		pthread_mutex_unlock(&s_effectsMutex);
 	}
 
 	void SimpleAudioEngine::pauseAllEffects()
 	{
-		EffectsMap::iterator iter = s_effects.begin();
+		pthread_mutex_lock(&s_effectsMutex);
 		ALint state;
-		while (iter != s_effects.end())
+		for (int i = 0; i < s_voiceCount; ++i)
 	    {
-			alGetSourcei(iter->second->source, AL_SOURCE_STATE, &state);
+			alGetSourcei(s_voices[i].source, AL_SOURCE_STATE, &state);
 			if (state == AL_PLAYING)
-				alSourcePause(iter->second->source);
+				alSourcePause(s_voices[i].source);
 			checkALError("pauseAllEffects:alSourcePause");
-			++iter;
 	    }
+		pthread_mutex_unlock(&s_effectsMutex);
 	}
 
 	void SimpleAudioEngine::resumeEffect(unsigned int nSoundId)
 	{
-		ALint state;
-		alGetSourcei(nSoundId, AL_SOURCE_STATE, &state);
-		if (state == AL_PAUSED)
-			alSourcePlay(nSoundId);
-		checkALError("resumeEffect:alSourcePlay");
+		pthread_mutex_lock(&s_effectsMutex);
+		effectVoice *voice = findVoice(nSoundId);
+		if (voice)
+		{
+			ALint state;
+			alGetSourcei(voice->source, AL_SOURCE_STATE, &state);
+			if (state == AL_PAUSED)
+				alSourcePlay(voice->source);
+			checkALError("resumeEffect:alSourcePlay");
+		}
+		pthread_mutex_unlock(&s_effectsMutex);
 	}
 
 	void SimpleAudioEngine::resumeAllEffects()
 	{
-		EffectsMap::iterator iter = s_effects.begin();
+		pthread_mutex_lock(&s_effectsMutex);
 		ALint state;
-		while (iter != s_effects.end())
+		for (int i = 0; i < s_voiceCount; ++i)
 	    {
-			alGetSourcei(iter->second->source, AL_SOURCE_STATE, &state);
+			alGetSourcei(s_voices[i].source, AL_SOURCE_STATE, &state);
 			if (state == AL_PAUSED)
-				alSourcePlay(iter->second->source);
+				alSourcePlay(s_voices[i].source);
 			checkALError("resumeAllEffects:alSourcePlay");
-			++iter;
 	    }
+		pthread_mutex_unlock(&s_effectsMutex);
 	}
 
     void SimpleAudioEngine::stopAllEffects()
     {
-		EffectsMap::iterator iter = s_effects.begin();
-
-		if (iter != s_effects.end())
+		pthread_mutex_lock(&s_effectsMutex);
+		checkALError("stopAllEffects:init");
+		for (int i = 0; i < s_voiceCount; ++i)
 	    {
-			checkALError("stopAllEffects:init");
-	        alSourceStop(iter->second->source);
+	        alSourceStop(s_voices[i].source);
 			checkALError("stopAllEffects:alSourceStop");
 	    }
+		pthread_mutex_unlock(&s_effectsMutex);
     }
 
+	void SimpleAudioEngine::setEffectsCacheSize(unsigned int nBytes)
+	{
+		pthread_mutex_lock(&s_effectsMutex);
+		s_effectsCacheSize = nBytes;
+		trimEffects(NULL);
+		pthread_mutex_unlock(&s_effectsMutex);
+	}
+
+	unsigned int SimpleAudioEngine::getEffectsCacheSize()
+	{
+		return s_effectsCacheSize;
+	}
+
+	EffectsStats SimpleAudioEngine::getEffectsStats()
+	{
+		pthread_mutex_lock(&s_effectsMutex);
+		EffectsStats stats = s_effectsStats;
+		stats.cacheSize = s_effectsCacheSize;
+		stats.voices = s_voiceCount;
+		stats.activeVoices = 0;
+		for (int i = 0; i < s_voiceCount; ++i)
+		{
+			if (isVoiceBusy(s_voices[i]))
+				++stats.activeVoices;
+		}
+		pthread_mutex_unlock(&s_effectsMutex);
+		return stats;
+	}
+
 }
@@ -230,6 +230,36 @@ void SimpleAudioEngine::unloadEffect(const char* pszFilePath)
     }    
 }
 
+static unsigned int s_uEffectsCacheSize = 0;
+
+unsigned int SimpleAudioEngine::playEffect(const char* pszFilePath, bool bLoop, int nPriority)
+{
+    CC_UNUSED_PARAM(nPriority);
+    return playEffect(pszFilePath, bLoop);
+}
+
+void SimpleAudioEngine::preloadEffectAsync(const char* pszFilePath)
+{
+    preloadEffect(pszFilePath);
+}
+
+void SimpleAudioEngine::setEffectsCacheSize(unsigned int nBytes)
+{
+    s_uEffectsCacheSize = nBytes;
+}
+
+unsigned int SimpleAudioEngine::getEffectsCacheSize()
+{
+    return s_uEffectsCacheSize;
+}
+
+EffectsStats SimpleAudioEngine::getEffectsStats()
+{
+    EffectsStats stats = EffectsStats();
+    stats.cacheSize = s_uEffectsCacheSize;
+    return stats;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // volume interface
 //////////////////////////////////////////////////////////////////////////
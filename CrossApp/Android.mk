@@ -12,8 +12,10 @@ endif
 
 ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
 MATHNEONFILE := math/CAMathUtil.cpp.neon
+PIXELKERNELSFILE := images/CAPixelKernels.cpp.neon
 else
 MATHNEONFILE := math/CAMathUtil.cpp
+PIXELKERNELSFILE := images/CAPixelKernels.cpp
 endif
 
 LOCAL_SRC_FILES := \
@@ -55,9 +57,12 @@ controller/CAFont.cpp \
 dispatcher/CAKeypadDelegate.cpp \
 dispatcher/CAKeypadDispatcher.cpp \
 dispatcher/CATouchDispatcher.cpp \
+dispatcher/CAHitTestGrid.cpp \
 dispatcher/CATouch.cpp \
 images/CAImage.cpp \
+$(PIXELKERNELSFILE) \
 images/CAImageCache.cpp \
+images/CAImageDiskCache.cpp \
 images/CAGif.cpp \
 images/gif_lib/egif_lib.c \
 images/gif_lib/openbsd-reallocarray.c \
@@ -81,6 +86,7 @@ support/ConvertUTF.cpp \
 support/ConvertUTFWrapper.cpp \
 support/ccUtils.cpp \
 support/CAUIEditorParser.cpp \
+support/CAUILayoutFile.cpp \
 support/CAThemeManager.cpp \
 support/data_support/ccCArray.cpp \
 support/image_support/TGAlib.cpp \
@@ -88,6 +94,7 @@ support/tinyxml2/tinyxml2.cpp \
 support/user_default/CAUserDefault.cpp \
 support/user_default/CAUserDefaultAndroid.cpp \
 support/zip_support/ZipUtils.cpp \
+support/zip_support/ZipArchive.cpp \
 support/zip_support/ioapi.cpp \
 support/zip_support/unzip.cpp \
 support/network/HttpClient.cpp \
@@ -95,6 +102,7 @@ support/network/DownloadManager.cpp \
 support/network/WebSocket.cpp \
 support/LocalStorage/LocalStorageAndroid.cpp \
 support/Json/CSContentJsonDictionary.cpp \
+support/Json/CAJsonDocument.cpp \
 support/Json/lib_json/json_value.cpp \
 support/Json/lib_json/json_reader.cpp \
 support/Json/lib_json/json_writer.cpp \
@@ -148,6 +156,7 @@ kazmath/src/GL/mat4stack.c \
 kazmath/src/GL/matrix.c \
 platform/CASAXParser.cpp \
 platform/CAFileUtils.cpp \
+platform/CAFileUtilsAsync.cpp \
 platform/platform.cpp \
 platform/CAFreeTypeFont.cpp \
 platform/CAFTRichFont.cpp \
@@ -72,6 +72,7 @@
 // images
 #include "images/CAImage.h"
 #include "images/CAImageCache.h"
+#include "images/CAImageDiskCache.h"
 #include "images/CAGif.h"
 
 
@@ -145,6 +146,7 @@
 #include "support/network/HttpClient.h"
 #include "support/network/DownloadManager.h"
 #include "support/Json/CSContentJsonDictionary.h"
+#include "support/Json/CAJsonDocument.h"
 #include "support/sqlite3/sqlite3.h"
 #include "support/LocalStorage/LocalStorage.h"
 #include "support/device/CADevice.h"
@@ -24,8 +24,8 @@
 #include "support/CAProfiling.h"
 #include "CCEGLView.h"
 #include "platform/CADensityDpi.h"
-#include "support/netWork/HttpClient.h"
-#include "support/netWork/DownloadManager.h"
+#include "support/network/HttpClient.h"
+#include "support/network/DownloadManager.h"
 #include "game/actions/CGActionManager.h"
 #include "support/CAThemeManager.h"
 
@@ -66,6 +66,7 @@ bool CAApplication::init(void)
     m_fFrameRate = 0.0f;
     m_pFPSLabel = NULL;
     m_uTotalFrames = m_uFrames = 0;
+    m_uFileSystemProbes = m_uLastFileSystemProbes = 0;
     m_pszFPS = new char[10];
     m_pLastUpdate = new struct cc_timeval();
     m_fSecondsPerFrame = 0.0f;
@@ -159,7 +160,9 @@ void CAApplication::updateDraw()
 }
 
 void CAApplication::drawScene(float dt)
-{    
+{
+    CAView::layoutDirtyViews();
+    
     if (m_nDrawCount > 0)
     {
         --m_nDrawCount;
@@ -196,6 +199,10 @@ void CAApplication::drawScene(float dt)
         
         m_uTotalFrames++;
         
+        unsigned int probes = FileUtils::getInstance()->getFileSystemProbes();
+        m_uFileSystemProbes = probes - m_uLastFileSystemProbes;
+        m_uLastFileSystemProbes = probes;
+        
         // swap buffers
         if (m_pobOpenGLView)
         {
@@ -433,7 +440,7 @@ void CAApplication::setDepthTest(bool bOn)
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LEQUAL);
         
-#if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS && CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS && CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID && CC_TARGET_PLATFORM != CC_PLATFORM_LINUX)
         glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
 #endif
     }
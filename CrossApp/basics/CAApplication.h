@@ -105,6 +105,9 @@ public:
 
     /** How many frames were called since the director started */
     inline unsigned int getTotalFrames(void) { return m_uTotalFrames; }
+
+    /** How many filesystem probes resolving paths took during the last frame, see FileUtils::getFileSystemProbes */
+    inline unsigned int getFileSystemProbesPerFrame(void) { return m_uFileSystemProbes; }
     
      /** reshape projection matrix when canvas has been change"*/
     void reshapeProjection(const DSize& newWindowSize);
@@ -300,6 +303,10 @@ protected:
     /* How many frames were called since the director started */
     unsigned int m_uTotalFrames;
     unsigned int m_uFrames;
+
+    /* filesystem probes during the last frame, and FileUtils' total when it ended */
+    unsigned int m_uFileSystemProbes;
+    unsigned int m_uLastFileSystemProbes;
     float m_fSecondsPerFrame;
      
     /* The running scene */
@@ -45,6 +45,11 @@ void CACamera::restore(void)
 }
 
 void CACamera::locate(void)
+{
+    kmGLMultMatrix(&this->getLookupMatrix());
+}
+
+const kmMat4& CACamera::getLookupMatrix(void)
 {
     if (m_bDirty)
     {
@@ -58,7 +63,7 @@ void CACamera::locate(void)
 
         m_bDirty = false;
     }
-    kmGLMultMatrix( &m_lookupMatrix );
+    return m_lookupMatrix;
 }
 
 float CACamera::getZEye(void)
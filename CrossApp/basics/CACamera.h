@@ -80,6 +80,8 @@ public:
     void restore(void);
     /** Sets the camera using gluLookAt using its eye, center and up_vector */
     void locate(void);
+    /** returns the gluLookAt matrix built from eye, center and up_vector, rebuilding it if dirty */
+    const kmMat4& getLookupMatrix(void);
     /** sets the eye values in points 
      *  @js setEye
      */
@@ -2,6 +2,7 @@
 #include "CAValue.h"
 #include <sstream>
 #include <iomanip>
+#include <string.h>
 #include "support/ccUtils.h"
 
 NS_CC_BEGIN
@@ -14,59 +15,63 @@ const CAValue CAValue::Null;
 
 CAValue::CAValue()
 : _type(Type::NONE)
+, _isSmallString(false)
 {
     memset(&_field, 0, sizeof(_field));
 }
 
 CAValue::CAValue(unsigned char v)
 : _type(Type::BYTE)
+, _isSmallString(false)
 {
     _field.byteVal = v;
 }
 
 CAValue::CAValue(int v)
 : _type(Type::INTEGER)
+, _isSmallString(false)
 {
     _field.intVal = v;
 }
 
 CAValue::CAValue(float v)
 : _type(Type::FLOAT)
+, _isSmallString(false)
 {
     _field.floatVal = v;
 }
 
 CAValue::CAValue(double v)
 : _type(Type::DOUBLE)
+, _isSmallString(false)
 {
     _field.doubleVal = v;
 }
 
 CAValue::CAValue(bool v)
 : _type(Type::BOOLEAN)
+, _isSmallString(false)
 {
     _field.boolVal = v;
 }
 
 CAValue::CAValue(const char* v)
-: _type(Type::STRING)
+: _type(Type::NONE)
+, _isSmallString(false)
 {
-    _field.strVal = new (std::nothrow) std::string();
-    if (v)
-    {
-        *_field.strVal = v;
-    }
+    setString(v ? v : "", v ? strlen(v) : 0);
 }
 
 CAValue::CAValue(const std::string& v)
-: _type(Type::STRING)
+: _type(Type::NONE)
+, _isSmallString(false)
 {
-    _field.strVal = new (std::nothrow) std::string();
-    *_field.strVal = v;
+    setString(v.data(), v.length());
 }
 
 CAValue::CAValue(const CAValueVector& v)
 : _type(Type::VECTOR)
+, _isSmallString(false)
 {
     _field.vectorVal = new (std::nothrow) CAValueVector();
     *_field.vectorVal = v;
@@ -74,6 +79,7 @@ CAValue::CAValue(const CAValueVector& v)
 
 CAValue::CAValue(CAValueVector&& v)
 : _type(Type::VECTOR)
+, _isSmallString(false)
 {
     _field.vectorVal = new (std::nothrow) CAValueVector();
     *_field.vectorVal = std::move(v);
@@ -81,6 +87,7 @@ CAValue::CAValue(CAValueVector&& v)
 
 CAValue::CAValue(const CAValueMap& v)
 : _type(Type::MAP)
+, _isSmallString(false)
 {
     _field.mapVal = new (std::nothrow) CAValueMap();
     *_field.mapVal = v;
@@ -88,6 +95,7 @@ CAValue::CAValue(const CAValueMap& v)
 
 CAValue::CAValue(CAValueMap&& v)
 : _type(Type::MAP)
+, _isSmallString(false)
 {
     _field.mapVal = new (std::nothrow) CAValueMap();
     *_field.mapVal = std::move(v);
@@ -95,6 +103,7 @@ CAValue::CAValue(CAValueMap&& v)
 
 CAValue::CAValue(const CAValueMapIntKey& v)
 : _type(Type::INT_KEY_MAP)
+, _isSmallString(false)
 {
     _field.intKeyMapVal = new (std::nothrow) CAValueMapIntKey();
     *_field.intKeyMapVal = v;
@@ -102,6 +111,7 @@ CAValue::CAValue(const CAValueMapIntKey& v)
 
 CAValue::CAValue(CAValueMapIntKey&& v)
 : _type(Type::INT_KEY_MAP)
+, _isSmallString(false)
 {
     _field.intKeyMapVal = new (std::nothrow) CAValueMapIntKey();
     *_field.intKeyMapVal = std::move(v);
@@ -109,12 +119,14 @@ CAValue::CAValue(CAValueMapIntKey&& v)
 
 CAValue::CAValue(const CAValue& other)
 : _type(Type::NONE)
+, _isSmallString(false)
 {
     *this = other;
 }
 
 CAValue::CAValue(CAValue&& other)
 : _type(Type::NONE)
+, _isSmallString(false)
 {
     *this = std::move(other);
 }
@@ -146,11 +158,7 @@ CAValue& CAValue::operator= (const CAValue& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                if (_field.strVal == nullptr)
-                {
-                    _field.strVal = new std::string();
-                }
-                *_field.strVal = *other._field.strVal;
+                setString(other.getStringData(), other.getStringLength());
                 break;
             case Type::VECTOR:
                 if (_field.vectorVal == nullptr)
@@ -185,42 +193,15 @@ CAValue& CAValue::operator= (CAValue&& other)
     if (this != &other)
     {
         clear();
-        switch (other._type)
-        {
-            case Type::BYTE:
-                _field.byteVal = other._field.byteVal;
-                break;
-            case Type::INTEGER:
-                _field.intVal = other._field.intVal;
-                break;
-            case Type::FLOAT:
-                _field.floatVal = other._field.floatVal;
-                break;
-            case Type::DOUBLE:
-                _field.doubleVal = other._field.doubleVal;
-                break;
-            case Type::BOOLEAN:
-                _field.boolVal = other._field.boolVal;
-                break;
-            case Type::STRING:
-                _field.strVal = other._field.strVal;
-                break;
-            case Type::VECTOR:
-                _field.vectorVal = other._field.vectorVal;
-                break;
-            case Type::MAP:
-                _field.mapVal = other._field.mapVal;
-                break;
-            case Type::INT_KEY_MAP:
-                _field.intKeyMapVal = other._field.intKeyMapVal;
-                break;
-            default:
-                break;
-        }
+
+        // every member of the union is plain data, the pointers change owner with it
+        memcpy(&_field, &other._field, sizeof(_field));
         _type = other._type;
+        _isSmallString = other._isSmallString;
 
         memset(&other._field, 0, sizeof(other._field));
         other._type = Type::NONE;
+        other._isSmallString = false;
     }
 
     return *this;
@@ -263,15 +244,13 @@ CAValue& CAValue::operator= (bool v)
 
 CAValue& CAValue::operator= (const char* v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v ? v : "";
+    setString(v ? v : "", v ? strlen(v) : 0);
     return *this;
 }
 
 CAValue& CAValue::operator= (const std::string& v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v;
+    setString(v.data(), v.length());
     return *this;
 }
 
@@ -341,7 +320,8 @@ bool CAValue::operator== (const CAValue& v) const
     case Type::BYTE:    return v._field.byteVal   == this->_field.byteVal;
     case Type::INTEGER: return v._field.intVal    == this->_field.intVal;
     case Type::BOOLEAN: return v._field.boolVal   == this->_field.boolVal;
-    case Type::STRING:  return *v._field.strVal   == *this->_field.strVal;
+    case Type::STRING:  return v.getStringLength() == this->getStringLength()
+                            && memcmp(v.getStringData(), this->getStringData(), this->getStringLength()) == 0;
     case Type::FLOAT:   return fabs(v._field.floatVal  - this->_field.floatVal)  <= FLT_EPSILON;
     case Type::DOUBLE:  return fabs(v._field.doubleVal - this->_field.doubleVal) <= FLT_EPSILON;
     case Type::VECTOR:
@@ -410,7 +390,7 @@ unsigned char CAValue::asByte() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<unsigned char>(atoi(_field.strVal->c_str()));
+        return static_cast<unsigned char>(atoi(getStringData()));
     }
 
     if (_type == Type::FLOAT)
@@ -446,7 +426,7 @@ int CAValue::asInt() const
 
     if (_type == Type::STRING)
     {
-        return atoi(_field.strVal->c_str());
+        return atoi(getStringData());
     }
 
     if (_type == Type::FLOAT)
@@ -482,7 +462,7 @@ float CAValue::asFloat() const
 
     if (_type == Type::STRING)
     {
-        return atof(_field.strVal->c_str());
+        return atof(getStringData());
     }
 
     if (_type == Type::INTEGER)
@@ -518,7 +498,7 @@ double CAValue::asDouble() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<double>(atof(_field.strVal->c_str()));
+        return static_cast<double>(atof(getStringData()));
     }
 
     if (_type == Type::INTEGER)
@@ -554,7 +534,7 @@ bool CAValue::asBool() const
 
     if (_type == Type::STRING)
     {
-        return (*_field.strVal == "0" || *_field.strVal == "false") ? false : true;
+        return (strcmp(getStringData(), "0") == 0 || strcmp(getStringData(), "false") == 0) ? false : true;
     }
 
     if (_type == Type::INTEGER)
@@ -581,7 +561,7 @@ std::string CAValue::asString() const
 
     if (_type == Type::STRING)
     {
-        return *_field.strVal;
+        return std::string(getStringData(), getStringLength());
     }
 
     std::stringstream ret;
@@ -761,7 +741,10 @@ void CAValue::clear()
             _field.boolVal = false;
             break;
         case Type::STRING:
-            CC_SAFE_DELETE(_field.strVal);
+            if (!_isSmallString)
+            {
+                CC_SAFE_DELETE(_field.strVal);
+            }
             break;
         case Type::VECTOR:
             CC_SAFE_DELETE(_field.vectorVal);
@@ -777,6 +760,7 @@ void CAValue::clear()
     }
     
     _type = Type::NONE;
+    _isSmallString = false;
 }
 
 void CAValue::reset(Type type)
@@ -790,7 +774,9 @@ void CAValue::reset(Type type)
     switch (type)
     {
         case Type::STRING:
-            _field.strVal = new (std::nothrow) std::string();
+            _field.smallStrVal.data[0] = '\0';
+            _field.smallStrVal.length = 0;
+            _isSmallString = true;
             break;
         case Type::VECTOR:
             _field.vectorVal = new (std::nothrow) CAValueVector();
@@ -808,4 +794,41 @@ void CAValue::reset(Type type)
     _type = type;
 }
 
+void CAValue::setString(const char* v, size_t length)
+{
+    if (length <= SMALL_STRING_CAPACITY)
+    {
+        // v may point into the string being replaced
+        char data[SMALL_STRING_CAPACITY + 1];
+        memcpy(data, v, length);
+        clear();
+        memcpy(_field.smallStrVal.data, data, length);
+        _field.smallStrVal.data[length] = '\0';
+        _field.smallStrVal.length = static_cast<unsigned char>(length);
+        _isSmallString = true;
+    }
+    else if (_type == Type::STRING && !_isSmallString)
+    {
+        _field.strVal->assign(v, length);
+    }
+    else
+    {
+        std::string* string = new (std::nothrow) std::string(v, length);
+        clear();
+        _field.strVal = string;
+        _isSmallString = false;
+    }
+    _type = Type::STRING;
+}
+
+const char* CAValue::getStringData() const
+{
+    return _isSmallString ? _field.smallStrVal.data : _field.strVal->c_str();
+}
+
+size_t CAValue::getStringLength() const
+{
+    return _isSmallString ? _field.smallStrVal.length : _field.strVal->length();
+}
+
 NS_CC_END
@@ -26,8 +26,11 @@ CC_DLL extern const CAValueMapIntKey CAValueMapIntKeyNull;
 
 /*
  * This class is provide as a wrapper of basic types, such as int and bool.
+ *
+ * It is a plain value, plist and config trees hold tens of thousands of them:
+ * strings of up to 22 bytes are stored inside the value instead of on the heap.
  */
-class CC_DLL CAValue: public CAObject
+class CC_DLL CAValue
 {
 public:
 
@@ -164,6 +167,15 @@ private:
     void clear();
     void reset(Type type);
 
+    void setString(const char* v, size_t length);
+    const char* getStringData() const;
+    size_t getStringLength() const;
+
+    enum
+    {
+        SMALL_STRING_CAPACITY = 22
+    };
+
     union
     {
         unsigned char byteVal;
@@ -173,12 +185,20 @@ private:
         bool boolVal;
 
         std::string* strVal;
+        struct
+        {
+            char data[SMALL_STRING_CAPACITY + 1];
+            unsigned char length;
+        }smallStrVal;
         CAValueVector* vectorVal;
         CAValueMap* mapVal;
         CAValueMapIntKey* intKeyMapVal;
     }_field;
 
     Type _type;
+
+    /// the string is in _field.smallStrVal rather than _field.strVal
+    bool _isSmallString;
 };
 
 /** @} */
@@ -88,7 +88,7 @@ bool CANavigationBar::init()
     
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CANavigationBar");
     
-    m_pGoBackBarButtonItem = CABarButtonItem::create("", CAImage::create(map.at("leftButtonImage")), nullptr);
+    m_pGoBackBarButtonItem = CABarButtonItem::create("", map.getImage("leftButtonImage"), nullptr);
     m_pGoBackBarButtonItem->setItemWidth(80);
     m_pGoBackBarButtonItem->retain();
     
@@ -175,7 +175,7 @@ void CANavigationBar::showBackground()
     if (m_pBackgroundView == NULL)
     {
         const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CANavigationBar");
-        m_pBackgroundView = CAScale9ImageView::createWithImage(CAImage::create(map.at("backgroundView")));
+        m_pBackgroundView = CAScale9ImageView::createWithImage(map.getImage("backgroundView"));
         CC_SAFE_RETAIN(m_pBackgroundView);
     }
     m_pBackgroundView->setLayout(DLayoutFill);
@@ -443,7 +443,7 @@ bool CABadgeView::init()
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CABadgeView");
     m_pBackground = CAScale9ImageView::createWithLayout(DLayout(DHorizontalLayout_W_C(46, 0.5f), DVerticalLayout_H_C(46, 0.5f)));
     m_pBackground->setCapInsets(DRect(22.5, 22.5, 1, 1));
-    m_pBackground->setImage(CAImage::create(map.at("badgeImage")));
+    m_pBackground->setImage(map.getImage("badgeImage"));
     this->addSubview(m_pBackground);
     
     m_pTextView = CALabel::createWithLayout(DLayout(DHorizontalLayout_W_C(180, 0.5f), DVerticalLayout_H_C(46, 0.5f)));
@@ -498,17 +498,17 @@ CATabBar::CATabBar(bool clearance)
 ,m_bClearance(clearance)
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATabBar");
-    m_pBackgroundImage = CAImage::create(map.at("backgroundView_normal"));
+    m_pBackgroundImage = map.getImage("backgroundView_normal");
     CC_SAFE_RETAIN(m_pBackgroundImage);
     
-    m_pSelectedBackgroundImage = CAImage::create(map.at("backgroundView_selected"));
+    m_pSelectedBackgroundImage = map.getImage("backgroundView_selected");
     CC_SAFE_RETAIN(m_pSelectedBackgroundImage);
     
-    m_pSelectedIndicatorImage = CAImage::create(map.at("bottomLine"));
+    m_pSelectedIndicatorImage = map.getImage("bottomLine");
     CC_SAFE_RETAIN(m_pSelectedIndicatorImage);
     
-    m_sTitleColor = ccc4Int(CrossApp::hex2Int(map.at("titleColor_normal")));
-    m_sSelectedTitleColor = ccc4Int(CrossApp::hex2Int(map.at("titleColor_selected")));
+    m_sTitleColor = map.getColor("titleColor_normal");
+    m_sSelectedTitleColor = map.getColor("titleColor_selected");
 }
 
 CATabBar::~CATabBar()
@@ -176,25 +176,24 @@ bool CAButton::init()
 void CAButton::setBackgroundViewSquareRect()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAButton_SquareRect");
-    std::string fileName[CAControlStateAll] =
+    CAImage* image[CAControlStateAll] =
     {
-        map.at("backgroundView_normal"),
-        map.at("backgroundView_highlighted"),
-        map.at("backgroundView_selected"),
-        map.at("backgroundView_disabled")
+        map.getImage("backgroundView_normal"),
+        map.getImage("backgroundView_highlighted"),
+        map.getImage("backgroundView_selected"),
+        map.getImage("backgroundView_disabled")
     };
     CAColor4B color[CAControlStateAll] =
     {
-        ccc4Int(CrossApp::hex2Int(map.at("titleColor_normal"))),
-        ccc4Int(CrossApp::hex2Int(map.at("titleColor_highlighted"))),
-        ccc4Int(CrossApp::hex2Int(map.at("titleColor_selected"))),
-        ccc4Int(CrossApp::hex2Int(map.at("titleColor_disabled")))
+        map.getColor("titleColor_normal"),
+        map.getColor("titleColor_highlighted"),
+        map.getColor("titleColor_selected"),
+        map.getColor("titleColor_disabled")
     };
     
     for (int i=0; i<CAControlStateAll; i++)
     {
-        CAImage* image = CAImage::create(fileName[i]);
-        CAScale9ImageView* bg = CAScale9ImageView::createWithImage(image);
+        CAScale9ImageView* bg = CAScale9ImageView::createWithImage(image[i]);
         this->setBackgroundViewForState((CAControlState)i, bg);
         m_sTitleColor[i] = color[i];
     }
@@ -203,26 +202,25 @@ void CAButton::setBackgroundViewSquareRect()
 void CAButton::setBackgroundViewRoundedRect()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAButton_RoundedRect");
-    std::string fileName[CAControlStateAll] =
+    CAImage* image[CAControlStateAll] =
     {
-        map.at("backgroundView_normal"),
-        map.at("backgroundView_highlighted"),
-        map.at("backgroundView_selected"),
-        map.at("backgroundView_disabled")
+        map.getImage("backgroundView_normal"),
+        map.getImage("backgroundView_highlighted"),
+        map.getImage("backgroundView_selected"),
+        map.getImage("backgroundView_disabled")
     };
     
     CAColor4B color[CAControlStateAll] =
     {
-        ccc4Int(CrossApp::hex2Int(map.at("titleColor_normal"))),
-        ccc4Int(CrossApp::hex2Int(map.at("titleColor_highlighted"))),
-        ccc4Int(CrossApp::hex2Int(map.at("titleColor_selected"))),
-        ccc4Int(CrossApp::hex2Int(map.at("titleColor_disabled")))
+        map.getColor("titleColor_normal"),
+        map.getColor("titleColor_highlighted"),
+        map.getColor("titleColor_selected"),
+        map.getColor("titleColor_disabled")
     };
     
     for (int i=0; i<CAControlStateAll; i++)
     {
-        CAImage* image = CAImage::create(fileName[i]);
-        CAScale9ImageView* bg = CAScale9ImageView::createWithImage(image);
+        CAScale9ImageView* bg = CAScale9ImageView::createWithImage(image[i]);
         this->setBackgroundViewForState((CAControlState)i, bg);
         m_sTitleColor[i] = color[i];
     }
@@ -756,13 +754,13 @@ void CAButton::setContentSize(const DSize & var)
         if (m_eButtonType==CAButtonTypeSquareRect)
         {
             const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAButton_SquareRect");
-            int h = atoi(map.at("height").c_str());
+            int h = map.getInt("height");
             size.height = (h == 0) ? size.height : h;
         }
         else if(m_eButtonType==CAButtonTypeRoundedRect)
         {
             const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAButton_RoundedRect");
-            int h = atoi(map.at("height").c_str());
+            int h = map.getInt("height");
             size.height = (h == 0) ? size.height : h;
         }
     }
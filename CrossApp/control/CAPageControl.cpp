@@ -94,8 +94,8 @@ CAPageControl* CAPageControl::createWithLayout(const CrossApp::DLayout &layout)
 bool CAPageControl::init()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAPageControl");
-    setPageIndicatorImage(CAImage::create(map.at("backgroundView_normal_custom")));
-    setCurrIndicatorImage(CAImage::create(map.at("backgroundView_selected_custom")));
+    setPageIndicatorImage(map.getImage("backgroundView_normal_custom"));
+    setCurrIndicatorImage(map.getImage("backgroundView_selected_custom"));
 
     return true;
 }
@@ -257,16 +257,16 @@ void CAPageControl::setStyle(const CAPageControlStyle &var)
         const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAPageControl");
         switch (m_style) {
             case CAPageControlStyleDot:
-                setPageIndicatorImage(CAImage::create(map.at("backgroundView_normal_custom")));
-                setCurrIndicatorImage(CAImage::create(map.at("backgroundView_selected_custom")));
+                setPageIndicatorImage(map.getImage("backgroundView_normal_custom"));
+                setCurrIndicatorImage(map.getImage("backgroundView_selected_custom"));
                 break;
             case CAPageControlStyleRound:
-                setPageIndicatorImage(CAImage::create(map.at("backgroundView_normal_round")));
-                setCurrIndicatorImage(CAImage::create(map.at("backgroundView_selected_round")));
+                setPageIndicatorImage(map.getImage("backgroundView_normal_round"));
+                setCurrIndicatorImage(map.getImage("backgroundView_selected_round"));
                 break;
             case CAPageControlStyleRectangle:
-                setPageIndicatorImage(CAImage::create(map.at("backgroundView_normal_rect")));
-                setCurrIndicatorImage(CAImage::create(map.at("backgroundView_selected_rect")));
+                setPageIndicatorImage(map.getImage("backgroundView_normal_rect"));
+                setCurrIndicatorImage(map.getImage("backgroundView_selected_rect"));
                 break;
                 
             default:
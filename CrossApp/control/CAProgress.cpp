@@ -120,12 +120,12 @@ void CAProgress::onEnterTransitionDidFinish()
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAProgress");
     if (m_pProgressTrackImage == NULL)
     {
-        this->setProgressTrackImage(CAImage::create(map.at("trackImage")));
+        this->setProgressTrackImage(map.getImage("trackImage"));
     }
     
     if (m_pProgressTintImage == NULL)
     {
-        this->setProgressTintImage(CAImage::create(map.at("tintImage")));
+        this->setProgressTintImage(map.getImage("tintImage"));
     }
 }
 
@@ -243,7 +243,7 @@ void CAProgress::setContentSize(const DSize & var)
     if (m_bRecSpe)
     {
         const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAProgress");
-        int h = atoi(map.at("height").c_str());
+        int h = map.getInt("height");
         size.height = (h == 0) ? size.height : h;
     }
     CAView::setContentSize(size);
@@ -167,7 +167,7 @@ void CASegmentedControl::initWithView()
     m_pBackgroundView = CAScale9ImageView::createWithFrame(this->getBounds());
     m_pBackgroundView->setVisible(true);
     this->insertSubview(m_pBackgroundView, -2);
-    m_pBackgroundView->setImage(CAImage::create(map.at("backgroundView_normal")));
+    m_pBackgroundView->setImage(map.getImage("backgroundView_normal"));
     
     for (size_t i=0; i<(size_t)m_nItemsCount; i++)
     {
@@ -176,10 +176,10 @@ void CASegmentedControl::initWithView()
         m_vItemSelectedBackgrounds.pushBack(imageView);
     }
     
-    this->setSegmentItemBackgroundImage(CAImage::create(map.at("backgroundView_selected")));
-    m_cTintColor = ccc4Int(CrossApp::hex2Int(map.at("tintColor")));
-    m_cTextColor = ccc4Int(CrossApp::hex2Int(map.at("titleColor_normal")));
-    m_cTextSelectedColor = ccc4Int(CrossApp::hex2Int(map.at("titleColor_selected")));
+    this->setSegmentItemBackgroundImage(map.getImage("backgroundView_selected"));
+    m_cTintColor = map.getColor("tintColor");
+    m_cTextColor = map.getColor("titleColor_normal");
+    m_cTextSelectedColor = map.getColor("titleColor_selected");
     for (size_t i=0; i<(size_t)m_nItemsCount; i++)
     {
         CAView* view = new CAView();
@@ -203,7 +203,7 @@ void CASegmentedControl::setContentSize(const CrossApp::DSize &var)
     {
         size.width = MAX(size.width, size.height);
         const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CASegmentedControl");
-        int h = atoi(map.at("height").c_str());
+        int h = map.getInt("height");
         size.height = (h == 0) ? size.height : h;
     }
     CAControl::setContentSize(size);
@@ -34,7 +34,7 @@ CASlider::CASlider()
     this->setPriorityScroll(true);
     this->setVerticalScrollEnabled(false);
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CASlider");
-    int h = atoi(map.at("trackHeight").c_str());
+    int h = map.getInt("trackHeight");
     m_fTrackHeight = (h == 0) ? m_fTrackHeight : h;
 }
 
@@ -120,17 +120,17 @@ bool CASlider::init()
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CASlider");
     m_pMinTrackTintImageView = CAScale9ImageView::create();
     this->addSubview(m_pMinTrackTintImageView);
-    this->setMinTrackTintImage(CAImage::create(map.at("minTrackTintImage")));
+    this->setMinTrackTintImage(map.getImage("minTrackTintImage"));
     
     
     m_pMaxTrackTintImageView = CAScale9ImageView::create();
     this->addSubview(m_pMaxTrackTintImageView);
-    this->setMaxTrackTintImage(CAImage::create(map.at("maxTrackTintImage")));
+    this->setMaxTrackTintImage(map.getImage("maxTrackTintImage"));
     
     
     m_pThumbTintImageView = CAImageView::create();
     this->addSubview(m_pThumbTintImageView);
-    this->setThumbTintImage(CAImage::create(map.at("thumbTintImage")));
+    this->setThumbTintImage(map.getImage("thumbTintImage"));
     
     return true;
 }
@@ -334,7 +334,7 @@ void CASlider::setContentSize(const DSize & var)
     if (m_bRecSpe)
     {
         const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CASlider");
-        int h = atoi(map.at("height").c_str());
+        int h = map.getInt("height");
         size.height = (h == 0) ? size.height : h;
     }
     CAControl::setContentSize(size);
@@ -40,13 +40,13 @@ CAStepper::CAStepper(const CAStepperOrientation& type)
     memset(m_pIncrementImage, 0x00, sizeof(m_pIncrementImage));
     memset(m_pDecrementImage, 0x00, sizeof(m_pDecrementImage));
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAStepper");
-    setBackgroundImage(CAImage::create(map.at("backgroundView_normal")), CAControlStateNormal);
-    setBackgroundImage(CAImage::create(map.at("backgroundView_selected")), CAControlStateHighlighted);
-    setIncrementImage(CAImage::create(map.at("incImage_highlighted")), CAControlStateAll);
-    setIncrementImage(CAImage::create(map.at("incImage_normal")), CAControlStateNormal);
-    setDecrementImage(CAImage::create(map.at("decImage_highlighted")), CAControlStateAll);
-    setDecrementImage(CAImage::create(map.at("decImage_normal")), CAControlStateNormal);
-    m_cTintColor = ccc4Int(CrossApp::hex2Int(map.at("tintColor")));
+    setBackgroundImage(map.getImage("backgroundView_normal"), CAControlStateNormal);
+    setBackgroundImage(map.getImage("backgroundView_selected"), CAControlStateHighlighted);
+    setIncrementImage(map.getImage("incImage_highlighted"), CAControlStateAll);
+    setIncrementImage(map.getImage("incImage_normal"), CAControlStateNormal);
+    setDecrementImage(map.getImage("decImage_highlighted"), CAControlStateAll);
+    setDecrementImage(map.getImage("decImage_normal"), CAControlStateNormal);
+    m_cTintColor = map.getColor("tintColor");
 }
 
 CAStepper::~CAStepper()
@@ -549,8 +549,8 @@ void CAStepper::setContentSize(const DSize & var)
     if (m_bRecSpe)
     {
         const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAStepper");
-        int w = atoi(map.at("width").c_str());
-        int h = atoi(map.at("height").c_str());
+        int w = map.getInt("width");
+        int h = map.getInt("height");
         if (m_pCAStepperOrientation==CAStepperOrientationHorizontal) {
             size.width = (w == 0) ? size.width : w;
             size.height = (h == 0) ? size.height : h;
@@ -29,9 +29,9 @@ CASwitch::CASwitch()
     , m_pThumbTintImageView(NULL)
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CASwitch");
-    this->setOnImage(CAImage::create(map.at("onImage")));
-    this->setOffImage(CAImage::create(map.at("offImage")));
-    this->setThumbTintImage(CAImage::create(map.at("thumbTintImage")));
+    this->setOnImage(map.getImage("onImage"));
+    this->setOffImage(map.getImage("offImage"));
+    this->setThumbTintImage(map.getImage("thumbTintImage"));
 }
 
 CASwitch::~CASwitch()
@@ -286,8 +286,8 @@ void CASwitch::setContentSize(const DSize & var)
     if (m_bRecSpe)
     {
         const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CASwitch");
-        int h = atoi(map.at("height").c_str());
-        int w = atoi(map.at("width").c_str());
+        int h = map.getInt("height");
+        int w = map.getInt("width");
         size.height = (h == 0) ? size.height : h;
         size.width  = (w == 0) ? size.width : w;
     }
@@ -62,7 +62,7 @@ bool CAViewController::init()
 
 CAView* CAViewController::getViewWithID(const std::string &tag)
 {
-    return m_pParser->m_mViews.getValue(tag);
+    return m_pParser->getView(tag);
 }
 
 void CAViewController::parser()
@@ -294,8 +294,8 @@ CANavigationController::CANavigationController()
     this->setTouchMoved(true);
     this->setVerticalScrollEnabled(false);
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CANavigationBar");
-    this->setNavigationBarBackgroundImage(CAImage::create(map.at("backgroundView")));
-    m_sNavigationBarTitleColor = ccc4Int(CrossApp::hex2Int(map.at("titleColor")));
+    this->setNavigationBarBackgroundImage(map.getImage("backgroundView"));
+    m_sNavigationBarTitleColor = map.getColor("titleColor");
 }
 
 CANavigationController::~CANavigationController()
@@ -1237,14 +1237,14 @@ CATabBarController::CATabBarController()
     
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATabBar");
     
-    this->setTabBarBackgroundImage(CAImage::create(map.at("backgroundView_normal")));
+    this->setTabBarBackgroundImage(map.getImage("backgroundView_normal"));
     
-    this->setTabBarSelectedBackgroundImage(CAImage::create(map.at("backgroundView_selected")));
+    this->setTabBarSelectedBackgroundImage(map.getImage("backgroundView_selected"));
     
-    this->setTabBarSelectedIndicatorImage(CAImage::create(map.at("bottomLine")));
+    this->setTabBarSelectedIndicatorImage(map.getImage("bottomLine"));
     
-    m_sTabBarTitleColor = ccc4Int(CrossApp::hex2Int(map.at("titleColor_normal")));
-    m_sTabBarSelectedTitleColor = ccc4Int(CrossApp::hex2Int(map.at("titleColor_selected")));
+    m_sTabBarTitleColor = map.getColor("titleColor_normal");
+    m_sTabBarSelectedTitleColor = map.getColor("titleColor_selected");
 }
 
 CATabBarController::~CATabBarController()
@@ -0,0 +1,169 @@
+//
+//  CAHitTestGrid.cpp
+//  CrossApp
+//
+//  Copyright (c) 2014 http://9miao.com All rights reserved.
+//
+
+#include "CAHitTestGrid.h"
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+
+NS_CC_BEGIN
+
+static const unsigned int kMaxGridDimension = 32;
+
+const unsigned int CAHitTestGrid::kMinimumItems;
+
+CAHitTestGrid::Box CAHitTestGrid::Box::infinite()
+{
+    Box box = { -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX };
+    return box;
+}
+
+bool CAHitTestGrid::Box::isInfinite() const
+{
+    return minX == -FLT_MAX || minY == -FLT_MAX || maxX == FLT_MAX || maxY == FLT_MAX;
+}
+
+CAHitTestGrid::CAHitTestGrid()
+:m_fOriginX(0)
+,m_fOriginY(0)
+,m_fLimitX(0)
+,m_fLimitY(0)
+,m_fInvCellWidth(0)
+,m_fInvCellHeight(0)
+,m_uColumns(0)
+,m_uRows(0)
+{
+
+}
+
+void CAHitTestGrid::build(const std::vector<Box>& boxes)
+{
+    m_vBoxes = boxes;
+    m_vUnbounded.clear();
+    m_vCellStart.clear();
+    m_vCellItems.clear();
+    m_uColumns = m_uRows = 0;
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    unsigned int bounded = 0;
+
+    for (unsigned int i=0; i<m_vBoxes.size(); i++)
+    {
+        const Box& box = m_vBoxes[i];
+        if (box.isInfinite())
+        {
+            m_vUnbounded.push_back(i);
+            continue;
+        }
+        CC_CONTINUE_IF(box.minX > box.maxX || box.minY > box.maxY);
+
+        minX = std::min(minX, box.minX);
+        minY = std::min(minY, box.minY);
+        maxX = std::max(maxX, box.maxX);
+        maxY = std::max(maxY, box.maxY);
+        ++bounded;
+    }
+    CC_RETURN_IF(bounded == 0);
+
+    unsigned int dimension = (unsigned int)ceilf(sqrtf((float)bounded));
+    dimension = std::max(1u, std::min(dimension, kMaxGridDimension));
+
+    m_uColumns = m_uRows = dimension;
+    m_fOriginX = minX;
+    m_fOriginY = minY;
+    m_fLimitX = maxX;
+    m_fLimitY = maxY;
+    m_fInvCellWidth = maxX > minX ? m_uColumns / (maxX - minX) : 0;
+    m_fInvCellHeight = maxY > minY ? m_uRows / (maxY - minY) : 0;
+
+    unsigned int cells = m_uColumns * m_uRows;
+    std::vector<unsigned int> counts(cells + 1, 0);
+
+    // two passes: count the boxes of every cell, then scatter indices into one flat array
+    for (int pass=0; pass<2; pass++)
+    {
+        for (unsigned int i=0; i<m_vBoxes.size(); i++)
+        {
+            const Box& box = m_vBoxes[i];
+            CC_CONTINUE_IF(box.isInfinite());
+            CC_CONTINUE_IF(box.minX > box.maxX || box.minY > box.maxY);
+
+            unsigned int c0 = std::min((unsigned int)((box.minX - m_fOriginX) * m_fInvCellWidth), m_uColumns - 1);
+            unsigned int c1 = std::min((unsigned int)((box.maxX - m_fOriginX) * m_fInvCellWidth), m_uColumns - 1);
+            unsigned int r0 = std::min((unsigned int)((box.minY - m_fOriginY) * m_fInvCellHeight), m_uRows - 1);
+            unsigned int r1 = std::min((unsigned int)((box.maxY - m_fOriginY) * m_fInvCellHeight), m_uRows - 1);
+
+            for (unsigned int r=r0; r<=r1; r++)
+            {
+                for (unsigned int c=c0; c<=c1; c++)
+                {
+                    unsigned int cell = r * m_uColumns + c;
+                    if (pass == 0)
+                    {
+                        ++counts[cell + 1];
+                    }
+                    else
+                    {
+                        m_vCellItems[counts[cell]++] = i;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0)
+        {
+            for (unsigned int cell=0; cell<cells; cell++)
+            {
+                counts[cell + 1] += counts[cell];
+            }
+            m_vCellStart = counts;
+            m_vCellItems.resize(counts[cells]);
+        }
+    }
+}
+
+void CAHitTestGrid::query(float x, float y, std::vector<unsigned int>& indices) const
+{
+    indices.clear();
+
+    const unsigned int* cellBegin = NULL;
+    const unsigned int* cellEnd = NULL;
+
+    if (!m_vCellItems.empty()
+        && x >= m_fOriginX && x <= m_fLimitX
+        && y >= m_fOriginY && y <= m_fLimitY)
+    {
+        // points on the right and bottom edges belong to the last column and row
+        unsigned int c = std::min((unsigned int)((x - m_fOriginX) * m_fInvCellWidth), m_uColumns - 1);
+        unsigned int r = std::min((unsigned int)((y - m_fOriginY) * m_fInvCellHeight), m_uRows - 1);
+        unsigned int cell = r * m_uColumns + c;
+        cellBegin = &m_vCellItems[0] + m_vCellStart[cell];
+        cellEnd = &m_vCellItems[0] + m_vCellStart[cell + 1];
+    }
+
+    // merge the cell list and the unbounded list, both ascending, into one descending list
+    const unsigned int* a = cellEnd;
+    const unsigned int* b = m_vUnbounded.empty() ? NULL : &m_vUnbounded[0] + m_vUnbounded.size();
+    const unsigned int* bBegin = m_vUnbounded.empty() ? NULL : &m_vUnbounded[0];
+
+    while (a != cellBegin || b != bBegin)
+    {
+        unsigned int index;
+        if (b == bBegin || (a != cellBegin && *(a - 1) > *(b - 1)))
+        {
+            index = *--a;
+            CC_CONTINUE_IF(!m_vBoxes[index].containsPoint(x, y));
+        }
+        else
+        {
+            index = *--b;
+        }
+        indices.push_back(index);
+    }
+}
+
+NS_CC_END
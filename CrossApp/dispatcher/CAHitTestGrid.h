@@ -0,0 +1,86 @@
+//
+//  CAHitTestGrid.h
+//  CrossApp
+//
+//  Copyright (c) 2014 http://9miao.com All rights reserved.
+//
+
+#ifndef __TOUCH_DISPATCHER_CAHIT_TEST_GRID_H__
+#define __TOUCH_DISPATCHER_CAHIT_TEST_GRID_H__
+
+#include "platform/CCPlatformMacros.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * Uniform grid over the bounding boxes of a view's subviews, expressed in the
+ * superview's node space. Used by CATouchDispatcher so that a touch only
+ * tests the subviews whose box covers the touch point instead of all of them.
+ * Boxes are identified by their index in the subview list, and queries return
+ * indices from the topmost (last) subview down, matching the dispatch order.
+ */
+class CC_DLL CAHitTestGrid
+{
+public:
+
+    struct Box
+    {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+
+        /** a box covering the whole plane, for views whose transform is not 2D affine */
+        static Box infinite();
+
+        bool isInfinite() const;
+
+        bool containsPoint(float x, float y) const
+        {
+            return x >= minX && x <= maxX && y >= minY && y <= maxY;
+        }
+    };
+
+    /** below this number of subviews a linear walk is faster than building the grid */
+    static const unsigned int kMinimumItems = 16;
+
+    CAHitTestGrid();
+
+    void build(const std::vector<Box>& boxes);
+
+    /** fills indices of the boxes containing (x, y), in descending order */
+    void query(float x, float y, std::vector<unsigned int>& indices) const;
+
+    unsigned int getItemCount() const { return (unsigned int)m_vBoxes.size(); }
+
+private:
+
+    std::vector<Box>            m_vBoxes;
+
+    std::vector<unsigned int>   m_vUnbounded;   ///< infinite boxes, ascending
+
+    std::vector<unsigned int>   m_vCellStart;   ///< m_vCellItems range of each cell, size = cells + 1
+
+    std::vector<unsigned int>   m_vCellItems;   ///< box indices of every cell, ascending per cell
+
+    float                       m_fOriginX;
+
+    float                       m_fOriginY;
+
+    float                       m_fLimitX;
+
+    float                       m_fLimitY;
+
+    float                       m_fInvCellWidth;
+
+    float                       m_fInvCellHeight;
+
+    unsigned int                m_uColumns;
+
+    unsigned int                m_uRows;
+};
+
+NS_CC_END
+
+#endif // __TOUCH_DISPATCHER_CAHIT_TEST_GRID_H__
@@ -15,6 +15,8 @@
 #include "view/CAWindow.h"
 #include "basics/CAScheduler.h"
 #include "support/CAPointExtension.h"
+#include "support/CAProfiling.h"
+#include "CAHitTestGrid.h"
 
 
 NS_CC_BEGIN
@@ -47,43 +49,60 @@ int CATouchController::getTouchID()
     return m_pTouch ? m_pTouch->getID() : -1;
 }
 
-CAResponder* getLastResponder(CATouch* touch, const CAVector<CAView*>& subviews)
+static CAResponder* getResponderAtTouch(CATouch* touch, CAView* subview)
 {
-    CAResponder* lastResponder = NULL;
-    
-    for (CAVector<CAView*>::const_reverse_iterator itr=subviews.rbegin();
-         itr!=subviews.rend();
-         itr++)
+    if (subview->isVisible())
     {
-        CAView* subview = *itr;
-        if (subview->isVisible())
+        if (CAViewController* viewController = dynamic_cast<CAViewController*>(subview->getContentContainer()))
         {
-            if (CAViewController* viewController = dynamic_cast<CAViewController*>(subview->getContentContainer()))
+            if (viewController->isTouchEnabled()
+                && subview->getBounds().containsPoint(subview->convertTouchToNodeSpace(touch)))
             {
-                CC_CONTINUE_IF(!viewController->isTouchEnabled());
-                
-                DPoint point = subview->convertTouchToNodeSpace(touch);
-                
-                if (subview->getBounds().containsPoint(point))
-                {
-                    lastResponder = viewController;
-                    break;
-                }
+                return viewController;
             }
-            else
+        }
+        else
+        {
+            if (subview->isTouchEnabled()
+                && subview->getBounds().containsPoint(subview->convertTouchToNodeSpace(touch)))
             {
-                CC_CONTINUE_IF(!subview->isTouchEnabled());
-                
-                DPoint point = subview->convertTouchToNodeSpace(touch);
-                
-                if (subview->getBounds().containsPoint(point))
-                {
-                    lastResponder = subview;
-                    break;
-                }
+                return subview;
             }
         }
     }
+    return NULL;
+}
+
+CAResponder* getLastResponder(CATouch* touch, CAView* superview)
+{
+    CAResponder* lastResponder = NULL;
+    
+    const CAVector<CAView*>& subviews = superview->CAView::getSubviews();
+    
+    if (const CAHitTestGrid* grid = superview->getHitTestGrid())
+    {
+        // only the subviews whose box covers the touch need the exact test
+        static std::vector<unsigned int> candidates;
+        
+        DPoint point = superview->convertTouchToNodeSpace(touch);
+        grid->query(point.x, point.y, candidates);
+        
+        for (std::vector<unsigned int>::iterator itr=candidates.begin();
+             itr!=candidates.end();
+             itr++)
+        {
+            CC_BREAK_IF((lastResponder = getResponderAtTouch(touch, subviews.at(*itr))));
+        }
+    }
+    else
+    {
+        for (CAVector<CAView*>::const_reverse_iterator itr=subviews.rbegin();
+             itr!=subviews.rend();
+             itr++)
+        {
+            CC_BREAK_IF((lastResponder = getResponderAtTouch(touch, *itr)));
+        }
+    }
     
     return lastResponder;
 }
@@ -94,6 +113,8 @@ std::vector<CAResponder*> CATouchController::getEventListener(CATouch* touch, CA
     
     std::vector<CAResponder*> vector;
     
+    CC_PROFILER_START_CATEGORY(kCCProfilerCategoryTouch, "CATouchController - hitTest");
+    
     do
     {
 //        CCLog("------ %s", typeid(*responder).name());
@@ -101,15 +122,17 @@ std::vector<CAResponder*> CATouchController::getEventListener(CATouch* touch, CA
 
         if (CAView* view = dynamic_cast<CAView*>(responder))
         {
-            responder = getLastResponder(touch, view->CAView::getSubviews());
+            responder = getLastResponder(touch, view);
         }
         else if (CAViewController* viewController = dynamic_cast<CAViewController*>(responder))
         {
-            responder = getLastResponder(touch, viewController->getView()->CAView::getSubviews());
+            responder = getLastResponder(touch, viewController->getView());
         }
     }
     while (responder);
     
+    CC_PROFILER_STOP_CATEGORY(kCCProfilerCategoryTouch, "CATouchController - hitTest");
+    
     return vector;
 }
 
@@ -536,6 +559,9 @@ void CATouchDispatcher::touchesBegan(CCSet *touches, CAEvent *pEvent)
     CC_RETURN_IF(m_bBanMultipleTouch == true);
     m_bLocked = true;
     
+    // hit-testing reads frames, so pending layouts must be resolved first
+    CAView::layoutDirtyViews();
+    
     CATouch *pTouch;
     CCSetIterator setIter;
     for (setIter = touches->begin(); setIter != touches->end(); setIter++)
@@ -608,6 +634,8 @@ void CATouchDispatcher::touchesCancelled(CCSet *touches, CAEvent *pEvent)
 
 void CATouchDispatcher::mouseMoved(CATouch* pTouch, CAEvent* pEvent)
 {
+    CC_PROFILER_START_CATEGORY(kCCProfilerCategoryTouch, "CATouchDispatcher - mouseMoved");
+    
     for (auto& responder : m_pMouseMoveds)
     {
         if (CAView* view = dynamic_cast<CAView*>(responder))
@@ -637,6 +665,8 @@ void CATouchDispatcher::mouseMoved(CATouch* pTouch, CAEvent* pEvent)
             }
         }
     }
+    
+    CC_PROFILER_STOP_CATEGORY(kCCProfilerCategoryTouch, "CATouchDispatcher - mouseMoved");
 }
 
 void CATouchDispatcher::mouseScrollWheel(CATouch* pTouch, float off_x, float off_y, CAEvent* pEvent)
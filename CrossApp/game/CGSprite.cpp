@@ -21,6 +21,7 @@
 #include "support/CAPointExtension.h"
 #include "math/CAAffineTransform.h"
 #include "math/TransformUtils.h"
+#include "math/CAMathUtil.h"
 #include "math/CAAffineTransform.h"
 #include "support/CAProfiling.h"
 #include "kazmath/GL/matrix.h"
@@ -403,36 +404,29 @@ void CGSprite::updateTransform(void)
             }
             
             DSize size = m_obRect.size;
-
+            
             float x1 = m_obOffsetPosition.x;
             float y1 = m_obOffsetPosition.y;
             
             float x2 = x1 + size.width;
             float y2 = y1 + size.height;
             
-            float x = m_tTransformToBatch.m.mat[12];
-            float y = m_tTransformToBatch.m.mat[13];
-            
-            float cr = m_tTransformToBatch.m.mat[0];
-            float sr = m_tTransformToBatch.m.mat[1];
-            float cr2 = m_tTransformToBatch.m.mat[5];
-            float sr2 = -m_tTransformToBatch.m.mat[4];
-            float ax = x1 * cr - y1 * sr2 + x;
-            float ay = x1 * sr + y1 * cr2 + y;
-            
-            float bx = x2 * cr - y1 * sr2 + x;
-            float by = x2 * sr + y1 * cr2 + y;
+            m_sQuad.bl.vertices = DPoint3D(x1, y1, 0);
+            m_sQuad.br.vertices = DPoint3D(x2, y1, 0);
+            m_sQuad.tl.vertices = DPoint3D(x1, y2, 0);
+            m_sQuad.tr.vertices = DPoint3D(x2, y2, 0);
             
-            float cx = x2 * cr - y2 * sr2 + x;
-            float cy = x2 * sr + y2 * cr2 + y;
+            MathUtil::transformQuads(m_tTransformToBatch, &m_sQuad, &m_sQuad, 1);
             
-            float dx = x1 * cr - y2 * sr2 + x;
-            float dy = x1 * sr + y2 * cr2 + y;
-            
-            m_sQuad.bl.vertices = DPoint3D(RENDER_IN_SUBPIXEL(ax), RENDER_IN_SUBPIXEL(ay), m_fPositionZ);
-            m_sQuad.br.vertices = DPoint3D(RENDER_IN_SUBPIXEL(bx), RENDER_IN_SUBPIXEL(by), m_fPositionZ);
-            m_sQuad.tl.vertices = DPoint3D(RENDER_IN_SUBPIXEL(dx), RENDER_IN_SUBPIXEL(dy), m_fPositionZ);
-            m_sQuad.tr.vertices = DPoint3D(RENDER_IN_SUBPIXEL(cx), RENDER_IN_SUBPIXEL(cy), m_fPositionZ);
+            m_sQuad.bl.vertices.z = m_sQuad.br.vertices.z = m_sQuad.tl.vertices.z = m_sQuad.tr.vertices.z = m_fPositionZ;
+#if !CC_NODE_RENDER_SUBPIXEL
+            ccV3F_C4B_T2F* vertex = &m_sQuad.tl;
+            for (int i = 0; i < 4; ++i)
+            {
+                vertex[i].vertices.x = RENDER_IN_SUBPIXEL(vertex[i].vertices.x);
+                vertex[i].vertices.y = RENDER_IN_SUBPIXEL(vertex[i].vertices.y);
+            }
+#endif
             this->setImageCoords(m_obRect);
         }
         
@@ -11,13 +11,7 @@
 
 NS_CC_BEGIN
 
-static int memReadFuncGif(GifFileType* GifFile, GifByteType* buf, int count)
-{
-    char* ptr = (char*)(GifFile->UserData);
-    memcpy(buf, ptr, count);
-    GifFile->UserData = ptr + count;
-    return count;
-}
+const unsigned int CAGif::kCachedFrames;
 
 static std::map<std::string, CAGif*> s_pGIFs;
 
@@ -28,19 +22,46 @@ const std::map<std::string, CAGif*>& CAGif::getGIFs()
 
 CAGif::CAGif()
 :m_fDelay(0.0f)
+,m_uPixelsWide(0)
+,m_uPixelsHigh(0)
 ,m_pData(nullptr)
+,m_pRestoreData(nullptr)
+,m_pFileData(nullptr)
+,m_pSource(nullptr)
+,m_pGIF(nullptr)
+,m_iDecodedIndex(-1)
+,m_uUseCounter(0)
 {
+    m_tReader.data = nullptr;
+    m_tReader.lenght = 0;
+    m_tReader.offset = 0;
 
+    for (unsigned int i=0; i<kCachedFrames; ++i)
+    {
+        m_tCachedFrames[i].index = -1;
+        m_tCachedFrames[i].lastUse = 0;
+        m_tCachedFrames[i].pixels = nullptr;
+    }
 }
 
 CAGif::~CAGif()
 {
-    int ErrorCode;
-    DGifCloseFile(m_pGIF, &ErrorCode);
+    if (m_pGIF)
+    {
+        int ErrorCode;
+        DGifCloseFile(m_pGIF, &ErrorCode);
+    }
     
     m_vImages.clear();
     
-    CC_SAFE_DELETE(m_pData);
+    for (unsigned int i=0; i<kCachedFrames; ++i)
+    {
+        free(m_tCachedFrames[i].pixels);
+    }
+    free(m_pData);
+    free(m_pRestoreData);
+    free(m_pFileData);
+    CC_SAFE_RELEASE(m_pSource);
     
     s_pGIFs.erase(m_sFilePath);
 }
@@ -74,6 +95,18 @@ CAGif* CAGif::createWithData(unsigned char* data, unsigned long lenght)
     return NULL;
 }
 
+CAGif* CAGif::createWithGif(CAGif* gif)
+{
+    CAGif* ret = new CAGif();
+    if(ret && ret->initWithGif(gif))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return NULL;
+}
+
 bool CAGif::initWithFilePath(const std::string& filePath)
 {
     if (s_pGIFs.find(filePath) != s_pGIFs.end())
@@ -84,14 +117,16 @@ bool CAGif::initWithFilePath(const std::string& filePath)
     unsigned long lenght = 0;
     unsigned char* data = FileUtils::getInstance()->getFileData(filePath, "rb", &lenght);
     
-    if (this->initWithData(data, lenght))
+    bool ret = this->initWithData(data, lenght);
+    delete[] data;
+
+    if (ret)
     {
         m_sFilePath = filePath;
         s_pGIFs.insert(std::make_pair(m_sFilePath, this));
-        return true;
     }
     
-    return false;
+    return ret;
 }
 
 bool CAGif::initWithData(unsigned char* data, unsigned long lenght)
@@ -101,15 +136,14 @@ bool CAGif::initWithData(unsigned char* data, unsigned long lenght)
         return false;
     }
     
-    int error = 0;
+    // only the compressed stream stays in memory, frames are decoded from it when shown
+    m_pFileData = (unsigned char*)malloc(lenght);
+    memcpy(m_pFileData, data, lenght);
+    m_tReader.data = m_pFileData;
+    m_tReader.lenght = lenght;
     
-    m_pGIF = DGifOpen(data, &memReadFuncGif, &error);
-
-    if (nullptr == m_pGIF || DGifSlurp(m_pGIF) != GIF_OK)
+    if (!this->rewind() || !this->scanFrames())
     {
-        int ErrorCode;
-        DGifCloseFile(m_pGIF, &ErrorCode);
-        m_pGIF = nullptr;
         return false;
     }
     
@@ -117,212 +151,357 @@ bool CAGif::initWithData(unsigned char* data, unsigned long lenght)
     m_uPixelsHigh = m_pGIF->SHeight;
     m_pData = (unsigned char*)malloc(sizeof(unsigned char) * m_uPixelsWide * m_uPixelsHigh * 4);
     
-    m_fDelay = this->getImageDelay(&m_pGIF->SavedImages[0]);
+    m_fDelay = m_vFrames.front().delay;
     
-    for (int i=0; i<m_pGIF->ImageCount; ++i)
+    return this->rewind();
+}
+
+bool CAGif::initWithGif(CAGif* gif)
+{
+    if(gif == nullptr || !CAGif::init())
     {
-        m_vImages.pushBack(this->getImage(i));
+        return false;
     }
         
-    return true;
+    m_pSource = gif->m_pSource ? gif->m_pSource : gif;
+    m_pSource->retain();
+    m_tReader.data = m_pSource->m_pFileData;
+    m_tReader.lenght = m_pSource->m_tReader.lenght;
+    m_vFrames = m_pSource->m_vFrames;
+
+    m_uPixelsWide = m_pSource->m_uPixelsWide;
+    m_uPixelsHigh = m_pSource->m_uPixelsHigh;
+    m_pData = (unsigned char*)malloc(sizeof(unsigned char) * m_uPixelsWide * m_uPixelsHigh * 4);
+
+    m_fDelay = m_pSource->m_fDelay;
+
+    return this->rewind();
 }
 
-void CAGif::copyLine(unsigned char* dst, const unsigned char* src, const ColorMapObject* cmap, int transparent, int width)
+int CAGif::readData(GifFileType* gif, GifByteType* buf, int count)
 {
-    for (; width > 0; width--, src++, dst+=4) {
-        if (*src != transparent) {
-            const GifColorType& col = cmap->Colors[*src];
-            *dst     = col.Red;
-            *(dst+1) = col.Green;
-            *(dst+2) = col.Blue;
-            *(dst+3) = 0xFF;
-        }
+    Reader* reader = (Reader*)gif->UserData;
+    unsigned long available = reader->lenght - reader->offset;
+    if ((unsigned long)count > available)
+    {
+        count = (int)available;
     }
+    memcpy(buf, reader->data + reader->offset, count);
+    reader->offset += count;
+    return count;
 }
 
-CAImage* CAGif::getImageWithIndex(unsigned int index)
+bool CAGif::rewind()
 {
-    if (index < m_vImages.size())
+    int error = 0;
+    if (m_pGIF)
+    {
+        DGifCloseFile(m_pGIF, &error);
+    }
+
+    m_tReader.offset = 0;
+    m_pGIF = DGifOpen(&m_tReader, &CAGif::readData, &error);
+    m_iDecodedIndex = -1;
+
+    if (m_pData)
     {
-        return m_vImages.at(index);
+        memset(m_pData, 0, m_uPixelsWide * m_uPixelsHigh * 4);
     }
-    return nullptr;
+
+    return m_pGIF != nullptr;
 }
 
-CAImage* CAGif::getImage(unsigned int index)
+bool CAGif::scanFrames()
 {
-    index = MIN(index, m_pGIF->ImageCount - 1);
- 
-    CAColor4B bgColor;
-    if (m_pGIF->SColorMap != NULL)
+    m_vFrames.clear();
+
+    GifByteType graphicsControl[4] = {0};
+    bool hasGraphicsControl = false;
+
+    GifRecordType type = UNDEFINED_RECORD_TYPE;
+    do
     {
-        const GifColorType& col = m_pGIF->SColorMap->Colors[m_pGIF->SBackGroundColor];
-        bgColor = ccc4(col.Red, col.Green, col.Blue, 0xFF);
+        CC_BREAK_IF(DGifGetRecordType(m_pGIF, &type) == GIF_ERROR);
+
+        if (type == IMAGE_DESC_RECORD_TYPE)
+        {
+            CC_BREAK_IF(DGifGetImageDesc(m_pGIF) == GIF_ERROR);
+
+            Frame frame;
+            frame.left = m_pGIF->Image.Left;
+            frame.top = m_pGIF->Image.Top;
+            frame.width = m_pGIF->Image.Width;
+            frame.height = m_pGIF->Image.Height;
+            frame.disposal = hasGraphicsControl ? ((graphicsControl[0] >> 2) & 7) : 0;
+            frame.transparent = (hasGraphicsControl && (graphicsControl[0] & 1)) ? graphicsControl[3] : -1;
+            frame.delay = this->getImageDelay(hasGraphicsControl ? graphicsControl : NULL);
+            m_vFrames.push_back(frame);
+            hasGraphicsControl = false;
+
+            // skip the raster without decompressing it
+            int codeSize = 0;
+            GifByteType* block = NULL;
+            CC_BREAK_IF(DGifGetCode(m_pGIF, &codeSize, &block) == GIF_ERROR);
+            while (block != NULL && DGifGetCodeNext(m_pGIF, &block) != GIF_ERROR);
+            CC_BREAK_IF(block != NULL);
+        }
+        else if (type == EXTENSION_RECORD_TYPE)
+        {
+            int code = 0;
+            GifByteType* extension = NULL;
+            CC_BREAK_IF(DGifGetExtension(m_pGIF, &code, &extension) == GIF_ERROR);
+
+            if (code == GRAPHICS_EXT_FUNC_CODE && extension != NULL && extension[0] >= 4)
+            {
+                memcpy(graphicsControl, extension + 1, 4);
+                hasGraphicsControl = true;
+            }
+            while (extension != NULL && DGifGetExtensionNext(m_pGIF, &extension) != GIF_ERROR);
+            CC_BREAK_IF(extension != NULL);
+        }
     }
-    
-    static char paintingColor[4] = {0, 0, 0, 0};
-    
-    
-    const SavedImage* curr = &m_pGIF->SavedImages[index];
+    while (type != TERMINATE_RECORD_TYPE);
+
+    // a truncated file still plays the frames before the damage
+    return !m_vFrames.empty() && m_pGIF->SWidth > 0 && m_pGIF->SHeight > 0;
+}
+
+void CAGif::fillRect(const Frame& frame, const unsigned char* source)
+{
+    int left = MAX(frame.left, 0);
+    int top = MAX(frame.top, 0);
+    int right = MIN(frame.left + frame.width, (int)m_uPixelsWide);
+    int bottom = MIN(frame.top + frame.height, (int)m_uPixelsHigh);
+    CC_RETURN_IF(right <= left || bottom <= top);
 
-    if (index == 0)
+    for (int y = top; y < bottom; ++y)
     {
-        bool trans;
-        int disposal;
-        this->getTransparencyAndDisposalMethod(curr, &trans, &disposal);
-        
-        for (unsigned int i = 0; i < m_uPixelsWide * m_uPixelsHigh; i++)
+        unsigned long offset = (y * m_uPixelsWide + left) * 4;
+        if (source)
         {
-            *(m_pData + i * 4)     = '\0';
-            *(m_pData + i * 4 + 1) = '\0';
-            *(m_pData + i * 4 + 2) = '\0';
-            *(m_pData + i * 4 + 3) = '\0';
+            memcpy(m_pData + offset, source + offset, (right - left) * 4);
         }
+        else
+        {
+            memset(m_pData + offset, 0, (right - left) * 4);
+        }
+    }
+}
+
+void CAGif::saveRect(const Frame& frame)
+{
+    if (m_pRestoreData == nullptr)
+    {
+        m_pRestoreData = (unsigned char*)malloc(m_uPixelsWide * m_uPixelsHigh * 4);
     }
-    else
+
+    int left = MAX(frame.left, 0);
+    int top = MAX(frame.top, 0);
+    int right = MIN(frame.left + frame.width, (int)m_uPixelsWide);
+    int bottom = MIN(frame.top + frame.height, (int)m_uPixelsHigh);
+
+    for (int y = top; y < bottom; ++y)
     {
-        const SavedImage* prev = &m_pGIF->SavedImages[index - 1];
-        
-        bool prevTrans;
-        int prevDisposal;
-        this->getTransparencyAndDisposalMethod(prev, &prevTrans, &prevDisposal);
-        
-        bool currTrans;
-        int currDisposal;
-        this->getTransparencyAndDisposalMethod(curr, &currTrans, &currDisposal);
-        
-        
-        if (currTrans || !checkIfCover(curr, prev))
+        unsigned long offset = (y * m_uPixelsWide + left) * 4;
+        memcpy(m_pRestoreData + offset, m_pData + offset, (right - left) * 4);
+    }
+}
+
+void CAGif::decodeNextFrame()
+{
+    int next = m_iDecodedIndex + 1;
+    CC_RETURN_IF(next >= (int)m_vFrames.size());
+
+    if (m_iDecodedIndex >= 0)
+    {
+        // dispose of the previous frame: 2 clears its area, 3 puts back what was under it
+        const Frame& prev = m_vFrames[m_iDecodedIndex];
+        if (prev.disposal == 2)
         {
-            if (prevDisposal == 2)
-            {
-                for (int top = prev->ImageDesc.Top; top < MIN(m_uPixelsHigh, prev->ImageDesc.Top + prev->ImageDesc.Height); top++)
-                {
-                    for(int left = prev->ImageDesc.Left; left < MIN(m_uPixelsWide, prev->ImageDesc.Left + prev->ImageDesc.Width); left++)
-                    {
-                        unsigned char* dst = &m_pData[(top * m_uPixelsWide + left) * 4];
-                        *dst     = paintingColor[0];
-                        *(dst+1) = paintingColor[1];
-                        *(dst+2) = paintingColor[2];
-                        *(dst+3) = paintingColor[3];
-                    }
-                }
-            }
+            this->fillRect(prev, nullptr);
+        }
+        else if (prev.disposal == 3 && m_pRestoreData)
+        {
+            this->fillRect(prev, m_pRestoreData);
         }
     }
-    
+    m_iDecodedIndex = next;
+
+    CC_RETURN_IF(m_pGIF == nullptr);
+
+    const Frame& frame = m_vFrames[next];
+
+    GifRecordType type = UNDEFINED_RECORD_TYPE;
+    while (DGifGetRecordType(m_pGIF, &type) != GIF_ERROR && type != TERMINATE_RECORD_TYPE)
     {
-        int transparent = -1;
-        for (int i = 0; i < curr->ExtensionBlockCount; ++i)
+        if (type == EXTENSION_RECORD_TYPE)
         {
-            ExtensionBlock* eb = curr->ExtensionBlocks + i;
-            if (eb->Function == GRAPHICS_EXT_FUNC_CODE &&
-                eb->ByteCount == 4)
-            {
-                bool has_transparency = ((eb->Bytes[0] & 1) == 1);
-                if (has_transparency)
-                {
-                    transparent = (unsigned char)eb->Bytes[3];
-                }
-            }
+            // already read by scanFrames
+            int code = 0;
+            GifByteType* extension = NULL;
+            CC_BREAK_IF(DGifGetExtension(m_pGIF, &code, &extension) == GIF_ERROR);
+            while (extension != NULL && DGifGetExtensionNext(m_pGIF, &extension) != GIF_ERROR);
+            CC_BREAK_IF(extension != NULL);
+            continue;
         }
-        
-        if (curr->ImageDesc.ColorMap != NULL)
+        CC_CONTINUE_IF(type != IMAGE_DESC_RECORD_TYPE);
+        CC_BREAK_IF(DGifGetImageDesc(m_pGIF) == GIF_ERROR || frame.width <= 0);
+
+        if (frame.disposal == 3)
         {
-            m_pGIF->SColorMap = curr->ImageDesc.ColorMap;
+            this->saveRect(frame);
         }
-        
-        if (m_pGIF->SColorMap && m_pGIF->SColorMap->ColorCount == (1 << m_pGIF->SColorMap->BitsPerPixel))
+
+        const ColorMapObject* cmap = m_pGIF->Image.ColorMap ? m_pGIF->Image.ColorMap : m_pGIF->SColorMap;
+        int copyWidth = MIN(frame.width, (int)m_uPixelsWide - frame.left);
+
+        static const int s_iInterlacedOffset[] = { 0, 4, 2, 1 };
+        static const int s_iInterlacedJumps[] = { 8, 8, 4, 2 };
+        bool interlaced = m_pGIF->Image.Interlace;
+        int passes = interlaced ? 4 : 1;
+
+        std::vector<GifPixelType> line(frame.width);
+        for (int pass = 0; pass < passes; ++pass)
         {
-            unsigned char* src = (unsigned char*)curr->RasterBits;
-            unsigned char* dst = &m_pData[(curr->ImageDesc.Top * m_uPixelsWide + curr->ImageDesc.Left) * 4];
-            
-            GifWord copyWidth = curr->ImageDesc.Width;
-            if (curr->ImageDesc.Left + copyWidth > m_uPixelsWide)
-            {
-                copyWidth = m_uPixelsWide - curr->ImageDesc.Left;
-            }
-            
-            GifWord copyHeight = curr->ImageDesc.Height;
-            if (curr->ImageDesc.Top + copyHeight > m_uPixelsHigh)
-            {
-                copyHeight = m_uPixelsHigh - curr->ImageDesc.Top;
-            }
-            
-            for (; copyHeight > 0; copyHeight--)
+            int y = interlaced ? s_iInterlacedOffset[pass] : 0;
+            int jump = interlaced ? s_iInterlacedJumps[pass] : 1;
+            for (; y < frame.height; y += jump)
             {
-                copyLine(dst, src, m_pGIF->SColorMap, transparent, copyWidth);
-                src += curr->ImageDesc.Width;
-                dst += m_uPixelsWide*4;
+                if (DGifGetLine(m_pGIF, &line[0], frame.width) == GIF_ERROR)
+                {
+                    return;
+                }
+
+                int canvasY = frame.top + y;
+                CC_CONTINUE_IF(cmap == NULL || copyWidth <= 0 || canvasY >= (int)m_uPixelsHigh);
+                this->copyLine(&m_pData[(canvasY * m_uPixelsWide + frame.left) * 4], &line[0], cmap, frame.transparent, copyWidth);
             }
         }
+        break;
+    }
+}
+
+void CAGif::copyLine(unsigned char* dst, const unsigned char* src, const ColorMapObject* cmap, int transparent, int width)
+{
+    for (; width > 0; width--, src++, dst+=4) {
+        if (*src != transparent && *src < cmap->ColorCount) {
+            const GifColorType& col = cmap->Colors[*src];
+            *dst     = col.Red;
+            *(dst+1) = col.Green;
+            *(dst+2) = col.Blue;
+            *(dst+3) = 0xFF;
+        }
     }
+}
 
-    return CAImage::createWithRawDataNoCache(m_pData, CAImage::PixelFormat_RGBA8888, m_uPixelsWide, m_uPixelsHigh);
+unsigned int CAGif::getImageCount()
+{
+    return (unsigned int)m_vFrames.size();
 }
 
-void CAGif::getTransparencyAndDisposalMethod(const SavedImage* frame, bool* trans, int* disposal)
+float CAGif::getImageDelayWithIndex(unsigned int index)
+{
+    if (index < m_vFrames.size())
+    {
+        return m_vFrames[index].delay;
+    }
+    return m_fDelay;
+}
+ 
+const unsigned char* CAGif::getFramePixels(unsigned int index)
 {
-    *trans = false;
-    *disposal = 0;
-    for (int i = 0; i < frame->ExtensionBlockCount; ++i)
+    if (m_vFrames.empty() || m_pData == nullptr)
+    {
+        return nullptr;
+    }
+    index = MIN(index, (unsigned int)m_vFrames.size() - 1);
+    
+    CachedFrame* slot = &m_tCachedFrames[0];
+    for (unsigned int i=0; i<kCachedFrames; ++i)
     {
-        ExtensionBlock* eb = frame->ExtensionBlocks + i;
-        if (eb->Function == GRAPHICS_EXT_FUNC_CODE &&
-            eb->ByteCount == 4)
+        CachedFrame& cached = m_tCachedFrames[i];
+        if (cached.index == (int)index)
         {
-            *trans = ((eb->Bytes[0] & 1) == 1);
-            *disposal = ((eb->Bytes[0] >> 2) & 7);
+            cached.lastUse = ++m_uUseCounter;
+            return cached.pixels;
         }
+        if (cached.lastUse < slot->lastUse)
+        {
+            slot = &cached;
+        }
+    }
+    
+    // frames build on each other, going back means starting over from the first one
+    if ((int)index < m_iDecodedIndex)
+    {
+        this->rewind();
     }
+    while (m_iDecodedIndex < (int)index)
+    {
+        this->decodeNextFrame();
+    }
+
+    unsigned long size = m_uPixelsWide * m_uPixelsHigh * 4;
+    if (slot->pixels == nullptr)
+    {
+        slot->pixels = (unsigned char*)malloc(size);
+    }
+    memcpy(slot->pixels, m_pData, size);
+    slot->index = index;
+    slot->lastUse = ++m_uUseCounter;
+    return slot->pixels;
+}
+
+void CAGif::getFrameDirtyRows(unsigned int index, unsigned int* top, unsigned int* bottom)
+{
+    *top = 0;
+    *bottom = m_uPixelsHigh;
+    CC_RETURN_IF(index == 0 || index >= m_vFrames.size());
+
+    const Frame& frame = m_vFrames[index];
+    const Frame& prev = m_vFrames[index - 1];
+
+    int dirtyTop = frame.top;
+    int dirtyBottom = frame.top + frame.height;
+    if (prev.disposal == 2 || prev.disposal == 3)
+    {
+        dirtyTop = MIN(dirtyTop, prev.top);
+        dirtyBottom = MAX(dirtyBottom, prev.top + prev.height);
+    }
+
+    *top = (unsigned int)MIN(MAX(dirtyTop, 0), (int)m_uPixelsHigh);
+    *bottom = (unsigned int)MIN(MAX(dirtyBottom, dirtyTop), (int)m_uPixelsHigh);
+    *bottom = MAX(*bottom, *top);
 }
 
-bool CAGif::checkIfCover(const SavedImage* target, const SavedImage* covered)
+CAImage* CAGif::getImageWithIndex(unsigned int index)
 {
-    if (target->ImageDesc.Left <= covered->ImageDesc.Left
-        && covered->ImageDesc.Left + covered->ImageDesc.Width <=
-        target->ImageDesc.Left + target->ImageDesc.Width
-        && target->ImageDesc.Top <= covered->ImageDesc.Top
-        && covered->ImageDesc.Top + covered->ImageDesc.Height <=
-        target->ImageDesc.Top + target->ImageDesc.Height) {
-        return true;
-    }
-    return false;
+    const unsigned char* pixels = this->getFramePixels(index);
+    if (pixels == nullptr)
+    {
+        return nullptr;
+    }
+    return CAImage::createWithRawDataNoCache(pixels, CAImage::PixelFormat_RGBA8888, m_uPixelsWide, m_uPixelsHigh);
 }
 
-bool CAGif::checkIfWillBeCleared(const SavedImage* frame)
+const CAVector<CAImage*>& CAGif::getImages()
 {
-    for (int i = 0; i < frame->ExtensionBlockCount; ++i)
+    if (m_vImages.empty())
     {
-        ExtensionBlock* eb = frame->ExtensionBlocks + i;
-        if (eb->Function == GRAPHICS_EXT_FUNC_CODE &&
-            eb->ByteCount == 4)
+        for (unsigned int i=0; i<m_vFrames.size(); ++i)
         {
-            // check disposal method
-            int disposal = ((eb->Bytes[0] >> 2) & 7);
-            if (disposal == 2 || disposal == 3)
-            {
-                return true;
-            }
+            m_vImages.pushBack(this->getImageWithIndex(i));
         }
     }
-    return false;
+    return m_vImages;
 }
 
-float CAGif::getImageDelay(const SavedImage* image)
+float CAGif::getImageDelay(const GifByteType* graphicsControl)
 {
     float duration = 0;
-    for (int j = 0; j < image->ExtensionBlockCount; j++)
+    if (graphicsControl)
     {
-        if (image->ExtensionBlocks[j].Function == GRAPHICS_EXT_FUNC_CODE)
-        {
-            int size = image->ExtensionBlocks[j].ByteCount;
-            //assert(size >= 4);
-            if(size < 4) break;
-            const uint8_t* b = (const uint8_t*)image->ExtensionBlocks[j].Bytes;
-            duration =  ((b[2] << 8) | b[1]) * 5.5;
-            break;
-        }
+        duration = ((graphicsControl[2] << 8) | graphicsControl[1]) * 5.5;
     }
     duration = duration <= 100 ? 100 : duration;
     return duration;
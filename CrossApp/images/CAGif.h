@@ -15,6 +15,12 @@
 
 NS_CC_BEGIN
 
+/**
+ * A GIF kept in its compressed form. Frames are decoded on demand, in order, onto
+ * one RGBA canvas (honouring the disposal methods), and only the last few
+ * composited frames are kept, so memory does not grow with the number of frames.
+ * CAGifView streams the frames into a single texture.
+ */
 class CC_DLL CAGif : public CAObject
 {
 public:
@@ -29,13 +35,37 @@ public:
     
     static CAGif* createWithData(unsigned char* data, unsigned long lenght);
 
+    /**
+     * Shares the compressed stream and frame table of gif but decodes with its own cursor
+     * and canvas. create() hands out one CAGif per file; views playing it out of phase
+     * would otherwise rewind each other's stream.
+     */
+    static CAGif* createWithGif(CAGif* gif);
+
     bool initWithFilePath(const std::string& filePath);
     
     bool initWithData(unsigned char* data, unsigned long lenght);
     
+    bool initWithGif(CAGif* gif);
+
+    unsigned int getImageCount();
+
+    float getImageDelayWithIndex(unsigned int index);
+
+    /**
+     * The premultiplied RGBA8888 canvas after frame index, m_uPixelsWide * m_uPixelsHigh * 4 bytes.
+     * Valid until kCachedFrames other frames have been requested.
+     */
+    const unsigned char* getFramePixels(unsigned int index);
+
+    /** the canvas rows [top, bottom) frame index changes compared to frame index - 1 */
+    void getFrameDirtyRows(unsigned int index, unsigned int* top, unsigned int* bottom);
+
+    /** a new image of frame index, each call decodes and uploads it again */
     CAImage* getImageWithIndex(unsigned int index);
     
-    CC_SYNTHESIZE_READONLY(CAVector<CAImage*>, m_vImages, Images);
+    /** every frame as an image, which costs a full texture per frame */
+    CC_DEPRECATED_ATTRIBUTE const CAVector<CAImage*>& getImages();
     
     CC_SYNTHESIZE_READONLY(float, m_fDelay, Delay);
     
@@ -45,25 +75,74 @@ public:
 
     static const std::map<std::string, CAGif*>& getGIFs();
     
+    static const unsigned int kCachedFrames = 3;
+
 protected:
     
-    void getTransparencyAndDisposalMethod(const SavedImage* frame, bool* trans, int* disposal);
-    
-    bool checkIfCover(const SavedImage* target, const SavedImage* covered);
-    
-    bool checkIfWillBeCleared(const SavedImage* frame);
+    struct Frame
+    {
+        int left;
+        int top;
+        int width;
+        int height;
+        int disposal;
+        int transparent;
+        float delay;
+    };
+    
+    struct Reader
+    {
+        const unsigned char* data;
+        unsigned long lenght;
+        unsigned long offset;
+    };
+    
+    struct CachedFrame
+    {
+        int index;
+        unsigned long lastUse;
+        unsigned char* pixels;
+    };
+
+    static int readData(GifFileType* gif, GifByteType* buf, int count);
+
+    bool scanFrames();
+
+    bool rewind();
+
+    void decodeNextFrame();
+
+    void fillRect(const Frame& frame, const unsigned char* source);
+
+    void saveRect(const Frame& frame);
     
     void copyLine(unsigned char* dst, const unsigned char* src, const ColorMapObject* cmap, int transparent, int width);
     
-    float getImageDelay(const SavedImage* image);
-
-    CAImage* getImage(unsigned int index);
+    float getImageDelay(const GifByteType* graphicsControl);
     
 protected:
 
-    unsigned char*  m_pData;
+    unsigned char*  m_pData;            ///< the canvas
+
+    unsigned char*  m_pRestoreData;     ///< the canvas under a frame with disposal 3
+
+    unsigned char*  m_pFileData;
+
+    CAGif*          m_pSource;          ///< owner of m_pFileData for a gif made by createWithGif
     
     GifFileType*    m_pGIF;
+
+    Reader          m_tReader;
+
+    int             m_iDecodedIndex;
+
+    unsigned long   m_uUseCounter;
+
+    std::vector<Frame>  m_vFrames;
+
+    CachedFrame     m_tCachedFrames[kCachedFrames];
+
+    CAVector<CAImage*>  m_vImages;
     
     std::string     m_sFilePath;
 };
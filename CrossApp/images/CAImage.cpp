@@ -8,6 +8,8 @@
 
 #include "CAImage.h"
 #include "CAImageCache.h"
+#include "CAImageDiskCache.h"
+#include "CAPixelKernels.h"
 #include "ccConfig.h"
 #include "ccMacros.h"
 #include "CCGL.h"
@@ -25,6 +27,7 @@
 #include "view/CARenderImage.h"
 #include <ctype.h>
 #include <cctype>
+#include <algorithm>
 #include <png.h>
 #include <jpeglib.h>
 #include <tiffio.h>
@@ -100,26 +103,9 @@ CAImage* generateMipmapsWithImageRGB(CAImage* image)
     {
         CAImage* newImage = new CAImage();
         unsigned char* data = new unsigned char[new_pitch * new_h];
-        // Resample.  Simple average 2x2 --> 1, in-place.
+        // Resample.  Simple average 2x2 --> 1.
         int	pitch = image->getPixelsWide() * 3;
-        
-        for (int j = 0; j < new_h; j++)
-        {
-            unsigned char*	out = ((unsigned char*)data) + j * new_pitch;
-            unsigned char*	in = ((unsigned char*)image->getData()) + (j << 1) * pitch;
-            for (int i = 0; i < new_w; i++)
-            {
-                int	r, g, b;
-                r = (*(in + 0) + *(in + 3) + *(in + 0 + pitch) + *(in + 3 + pitch));
-                g = (*(in + 1) + *(in + 4) + *(in + 1 + pitch) + *(in + 4 + pitch));
-                b = (*(in + 2) + *(in + 5) + *(in + 2 + pitch) + *(in + 5 + pitch));
-                *(out + 0) = r >> 2;
-                *(out + 1) = g >> 2;
-                *(out + 2) = b >> 2;
-                out += 3;
-                in += 6;
-            }
-        }
+        CAPixelKernels::downsampleRGB888(image->getData(), pitch, data, new_pitch, new_w, new_h);
         
         newImage->initWithRawData(data, CAImage::PixelFormat_RGB888, new_w, new_h);
         newImage->autorelease();
@@ -147,27 +133,10 @@ CAImage* generateMipmapsWithImageRGBA(CAImage* image)
         CAImage* newImage = new CAImage();
         unsigned char* data = new unsigned char[new_pitch * new_h];
         
-        // Resample.  Simple average 2x2 --> 1, in-place.
+        // Resample.  Simple average 2x2 --> 1.
         int	pitch = image->getPixelsWide() * 4;
-        for (int j = 0; j < new_h; j++)
-        {
-            unsigned char*	out = ((unsigned char*)data) + j * new_pitch;
-            unsigned char*	in = ((unsigned char*)image->getData()) + (j << 1) * pitch;
-            for (int i = 0; i < new_w; i++)
-            {
-                int	r, g, b, a;
-                r = (*(in + 0) + *(in + 4) + *(in + 0 + pitch) + *(in + 4 + pitch));
-                g = (*(in + 1) + *(in + 5) + *(in + 1 + pitch) + *(in + 5 + pitch));
-                b = (*(in + 2) + *(in + 6) + *(in + 2 + pitch) + *(in + 6 + pitch));
-                a = (*(in + 3) + *(in + 7) + *(in + 3 + pitch) + *(in + 7 + pitch));
-                *(out + 0) = r >> 2;
-                *(out + 1) = g >> 2;
-                *(out + 2) = b >> 2;
-                *(out + 3) = a >> 2;
-                out += 4;
-                in += 8;
-            }
-        }
+        CAPixelKernels::downsampleRGBA8888(image->getData(), pitch, data, new_pitch, new_w, new_h);
+        
         newImage->initWithRawData(data, CAImage::PixelFormat_RGBA8888, new_w, new_h);
         newImage->autorelease();
         delete[] data;
@@ -181,6 +150,12 @@ CAImage* generateMipmapsWithImageRGBA(CAImage* image)
 
 CAImage* CAImage::generateMipmapsWithImage(CAImage* image)
 {
+    // images wrapping a GPU texture have no pixels to resample
+    if (image->getData() == NULL)
+    {
+        return image;
+    }
+    
     if (DPoint(image->getContentSize()).getLength() < 2895)
     {
         CAImage* newImage = new CAImage();
@@ -300,6 +275,95 @@ namespace
     }
 }
 
+namespace
+{
+    // the factor (<= 1) a width x height image can be scaled by and still cover decodeSize
+    float decodeScaleForSize(unsigned int width, unsigned int height, const DSize& decodeSize)
+    {
+        float scale = 0.0f;
+        if (decodeSize.width > 0 && width > 0)
+        {
+            scale = MAX(scale, decodeSize.width / width);
+        }
+        if (decodeSize.height > 0 && height > 0)
+        {
+            scale = MAX(scale, decodeSize.height / height);
+        }
+        return (scale > 0.0f && scale < 1.0f) ? scale : 1.0f;
+    }
+    
+    // box-filters decoded rows by an integer factor as they arrive, so only one source row is kept
+    struct DecodeRowShrinker
+    {
+        unsigned int factor;
+        unsigned int width;
+        unsigned int channels;
+        unsigned int outWidth;
+        unsigned int rowsInBox;
+        unsigned char* out;
+        unsigned int* sums;
+        unsigned char* source;
+        
+        DecodeRowShrinker()
+        : factor(1), width(0), channels(0), outWidth(0), rowsInBox(0), out(NULL), sums(NULL), source(NULL)
+        {
+        }
+        
+        ~DecodeRowShrinker()
+        {
+            free(sums);
+            free(source);
+        }
+        
+        void begin(unsigned int f, unsigned int w, unsigned int c, unsigned char* dst)
+        {
+            factor = f;
+            width = w;
+            channels = c;
+            outWidth = (w + f - 1) / f;
+            rowsInBox = 0;
+            out = dst;
+            sums = static_cast<unsigned int*>(calloc(outWidth * channels, sizeof(unsigned int)));
+        }
+        
+        void addRow(const unsigned char* row)
+        {
+            for (unsigned int x = 0; x < width; ++x)
+            {
+                unsigned int* sum = sums + (x / factor) * channels;
+                for (unsigned int c = 0; c < channels; ++c)
+                {
+                    sum[c] += row[x * channels + c];
+                }
+            }
+            if (++rowsInBox == factor)
+            {
+                flush();
+            }
+        }
+        
+        void flush()
+        {
+            if (rowsInBox == 0)
+            {
+                return;
+            }
+            for (unsigned int x = 0; x < outWidth; ++x)
+            {
+                // the last box of a row may be narrower than factor
+                unsigned int count = MIN(factor, width - x * factor) * rowsInBox;
+                for (unsigned int c = 0; c < channels; ++c)
+                {
+                    unsigned int& sum = sums[x * channels + c];
+                    *out++ = (sum + count / 2) / count;
+                    sum = 0;
+                }
+            }
+            rowsInBox = 0;
+        }
+    };
+}
+
 namespace
 {
     static tmsize_t tiffReadProc(thandle_t fd, void* buf, tmsize_t size)
@@ -565,48 +629,25 @@ void CAImage::convertAI88ToI8(const unsigned char* data, unsigned long dataLen,
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
 void CAImage::convertRGB888ToRGBA8888(const unsigned char* data, unsigned long dataLen, unsigned char* outData)
 {
-    for (unsigned long i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *outData++ = data[i];         //R
-        *outData++ = data[i + 1];     //G
-        *outData++ = data[i + 2];     //B
-        *outData++ = 0xFF;            //A
-    }
+    CAPixelKernels::convertRGB888ToRGBA8888(data, outData, dataLen / 3);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
 void CAImage::convertRGBA8888ToRGB888(const unsigned char* data, unsigned long dataLen, unsigned char* outData)
 {
-    for (unsigned long i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *outData++ = data[i];         //R
-        *outData++ = data[i + 1];     //G
-        *outData++ = data[i + 2];     //B
-    }
+    CAPixelKernels::convertRGBA8888ToRGB888(data, outData, dataLen / 4);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGGBBBBB
 void CAImage::convertRGB888ToRGB565(const unsigned char* data, unsigned long dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (unsigned long i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-        | (data[i + 1] & 0x00FC) << 3     //G
-        | (data[i + 2] & 0x00F8) >> 3;    //B
-    }
+    CAPixelKernels::convertRGB888ToRGB565(data, outData, dataLen / 3);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
 void CAImage::convertRGBA8888ToRGB565(const unsigned char* data, unsigned long dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (unsigned long i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-        | (data[i + 1] & 0x00FC) << 3     //G
-        | (data[i + 2] & 0x00F8) >> 3;    //B
-    }
+    CAPixelKernels::convertRGBA8888ToRGB565(data, outData, dataLen / 4);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> IIIIIIII
@@ -660,53 +701,25 @@ void CAImage::convertRGBA8888ToAI88(const unsigned char* data, unsigned long dat
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRGGGGBBBBAAAA
 void CAImage::convertRGB888ToRGBA4444(const unsigned char* data, unsigned long dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (unsigned long i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *out16++ = ((data[i] & 0x00F0) << 8           //R
-                    | (data[i + 1] & 0x00F0) << 4     //G
-                    | (data[i + 2] & 0xF0)            //B
-                    |  0x0F);                         //A
-    }
+    CAPixelKernels::convertRGB888ToRGBA4444(data, outData, dataLen / 3);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
 void CAImage::convertRGBA8888ToRGBA4444(const unsigned char* data, unsigned long dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (unsigned long i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F0) << 8    //R
-        | (data[i + 1] & 0x00F0) << 4         //G
-        | (data[i + 2] & 0xF0)                //B
-        |  (data[i + 3] & 0xF0) >> 4;         //A
-    }
+    CAPixelKernels::convertRGBA8888ToRGBA4444(data, outData, dataLen / 4);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
 void CAImage::convertRGB888ToRGB5A1(const unsigned char* data, unsigned long dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (unsigned long i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-        | (data[i + 1] & 0x00F8) << 3     //G
-        | (data[i + 2] & 0x00F8) >> 2     //B
-        |  0x01;                          //A
-    }
+    CAPixelKernels::convertRGB888ToRGB5A1(data, outData, dataLen / 3);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
 void CAImage::convertRGBA8888ToRGB5A1(const unsigned char* data, unsigned long dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (unsigned long i = 0, l = dataLen - 2; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-        | (data[i + 1] & 0x00F8) << 3     //G
-        | (data[i + 2] & 0x00F8) >> 2     //B
-        |  (data[i + 3] & 0x0080) >> 7;   //A
-    }
+    CAPixelKernels::convertRGBA8888ToRGB5A1(data, outData, dataLen / 4);
 }
 
 CAImage::PixelFormat CAImage::convertI8ToFormat(const unsigned char* data, unsigned long dataLen,  CAImage::PixelFormat format, unsigned char** outData, unsigned long* outDataLen)
@@ -982,19 +995,20 @@ CAImage::CAImage()
 , m_uName(0)
 , m_fMaxS(0.0)
 , m_fMaxT(0.0)
-, m_bHasPremultipliedAlpha(false)
-, m_bHasMipmaps(false)
 , m_pShaderProgram(NULL)
 , m_bMonochrome(false)
 , m_pData(NULL)
 , m_uDataLenght(0)
-, m_pImageData(NULL)
-, m_uImageDataLenght(0)
-, m_nBitsPerComponent(0)
 , m_bPremultiplied(false)
+, m_bHasPremultipliedAlpha(false)
+, m_bHasMipmaps(false)
+, m_bTextImage(false)
+, m_nBitsPerComponent(0)
 , m_pGIF(NULL)
 , m_iGIFIndex(0)
-, m_bTextImage(false)
+, m_pImageData(NULL)
+, m_uImageDataLenght(0)
+, m_tDecodeSize(DSizeZero)
 {
     s_pImages.insert(this);
 }
@@ -1053,6 +1067,11 @@ CAImage* CAImage::create(const std::string& file)
     return CAImageCache::sharedImageCache()->addImage(file);
 }
 
+CAImage* CAImage::create(const std::string& file, const DSize& decodeSize)
+{
+    return CAImageCache::sharedImageCache()->addImage(file, decodeSize);
+}
+
 unsigned int CAImage::getGifImageIndex()
 {
     return m_iGIFIndex;
@@ -1282,6 +1301,21 @@ CAImage* CAImage::createWithRawDataNoCache(const unsigned char * data,
     return NULL;
 }
 
+CAImage* CAImage::createWithTextureName(GLuint name,
+                                       const CAImage::PixelFormat& pixelFormat,
+                                       unsigned int pixelsWide,
+                                       unsigned int pixelsHigh)
+{
+    CAImage* image = new CAImage();
+    if (image && image->initWithTextureName(name, pixelFormat, pixelsWide, pixelsHigh))
+    {
+        image->autorelease();
+        return image;
+    }
+    CC_SAFE_DELETE(image);
+    return NULL;
+}
+
 CAImage* CAImage::createWithRawData(const unsigned char * data,
                                     const CAImage::PixelFormat& pixelFormat,
                                     unsigned int pixelsWide,
@@ -1299,12 +1333,77 @@ CAImage* CAImage::createWithRawData(const unsigned char * data,
 bool CAImage::initWithImageFile(const std::string& file, bool isOpenGLThread)
 {
     unsigned long pSize = 0;
+    
+    // images stored uncompressed in an archive are decoded straight from its mapping
+    const unsigned char* view = FileUtils::getInstance()->getFileDataView(file, &pSize);
+    if (view)
+    {
+        return initWithImageData(view, pSize, isOpenGLThread);
+    }
+    
     unsigned char* data = FileUtils::getInstance()->getFileData(file.c_str(), "rb", &pSize);
     bool bRet = initWithImageData(data, pSize, isOpenGLThread);
 	delete[]data;
 	return bRet;
 }
 
+// the formats whose decoders honour m_tDecodeSize, by the extension like CAImageCache's computeImageFormatType
+static CAImage::Format computeDecodeSizeFormatType(const std::string& file)
+{
+    std::string extension = file.substr(file.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    
+    if (extension == "jpg" || extension == "jpeg")
+    {
+        return CAImage::JPG;
+    }
+    else if (extension == "png")
+    {
+        return CAImage::PNG;
+    }
+    else if (extension == "webp")
+    {
+        return CAImage::WEBP;
+    }
+    return CAImage::UNKOWN;
+}
+
+bool CAImage::initWithImageFile(const std::string& file, const DSize& decodeSize, bool isOpenGLThread)
+{
+    // only reduced decodes are worth keeping on disk, full size ones are as fast to decode again.
+    // A GIF would come back as its first frame and TIFF/TGA ignore the decode size, so they aren't kept
+    CAImageDiskCache* diskCache = CAImageDiskCache::getInstance();
+    bool cacheable = diskCache->isEnabled() && (decodeSize.width > 0 || decodeSize.height > 0)
+        && computeDecodeSizeFormatType(file) != CAImage::UNKOWN;
+    if (cacheable && diskCache->loadImage(this, file, decodeSize))
+    {
+        if (isOpenGLThread)
+        {
+            this->premultipliedImageData();
+        }
+        return true;
+    }
+    
+    m_tDecodeSize = decodeSize;
+    bool bRet = initWithImageFile(file, isOpenGLThread);
+    m_tDecodeSize = DSizeZero;
+    
+    // the extension may lie, an animation decoded from it is never kept
+    if (bRet && cacheable && m_pGIF == NULL)
+    {
+        diskCache->storeImage(this, file, decodeSize);
+    }
+    return bRet;
+}
+
+bool CAImage::initWithImageData(const unsigned char * data, unsigned long dataLen, const DSize& decodeSize, bool isOpenGLThread)
+{
+    m_tDecodeSize = decodeSize;
+    bool bRet = initWithImageData(data, dataLen, isOpenGLThread);
+    m_tDecodeSize = DSizeZero;
+    return bRet;
+}
+
 bool CAImage::initWithImageData(const unsigned char * data, unsigned long dataLen, bool isOpenGLThread)
 {
     bool ret = false;
@@ -1387,6 +1486,7 @@ bool CAImage::initWithJpgData(const unsigned char *  data, unsigned long dataLen
     /* libjpeg data structure for storing one row, that is, scanline of an image */
     JSAMPROW row_pointer[1] = {0};
     unsigned long location = 0;
+    DecodeRowShrinker shrinker;
     
     bool bRet = false;
     do
@@ -1430,6 +1530,21 @@ bool CAImage::initWithJpgData(const unsigned char *  data, unsigned long dataLen
             m_ePixelFormat = CAImage::PixelFormat_RGB888;
         }
         
+        // let the IDCT produce the reduced size directly, in eighths
+        float scale = decodeScaleForSize(cinfo.image_width, cinfo.image_height, m_tDecodeSize);
+        if (scale < 1.0f)
+        {
+            unsigned int num = MAX((unsigned int)ceilf(scale * 8), 1u);
+#if (JPEG_LIB_VERSION < 70)
+            // older libjpeg only scales by 1/1, 1/2, 1/4 and 1/8
+            unsigned int pot = 1;
+            while (pot < num) pot <<= 1;
+            num = pot;
+#endif
+            cinfo.scale_num = num;
+            cinfo.scale_denom = 8;
+        }
+        
         /* Start decompression jpeg here */
         jpeg_start_decompress( &cinfo );
         
@@ -1439,17 +1554,42 @@ bool CAImage::initWithJpgData(const unsigned char *  data, unsigned long dataLen
         m_bHasPremultipliedAlpha = false;
         m_nBitsPerComponent = 8;
         
-        m_uImageDataLenght = cinfo.output_width*cinfo.output_height*cinfo.output_components;
+        // the IDCT stops at 1/8, box-filter the scanlines for the rest
+        unsigned int factor = (unsigned int)(1.0f / decodeScaleForSize(m_uPixelsWide, m_uPixelsHigh, m_tDecodeSize));
+        if (factor > 1)
+        {
+            m_uPixelsWide = (cinfo.output_width + factor - 1) / factor;
+            m_uPixelsHigh = (cinfo.output_height + factor - 1) / factor;
+        }
+        
+        m_uImageDataLenght = m_uPixelsWide * m_uPixelsHigh * cinfo.output_components;
         m_pImageData = static_cast<unsigned char*>(malloc(m_uImageDataLenght * sizeof(unsigned char)));
         CC_BREAK_IF(! m_pImageData);
         
-        /* now actually read the jpeg into the raw buffer */
-        /* read one scan line at a time */
-        while (cinfo.output_scanline < cinfo.output_height)
+        if (factor > 1)
         {
-            row_pointer[0] = m_pImageData + location;
-            location += cinfo.output_width*cinfo.output_components;
-            jpeg_read_scanlines(&cinfo, row_pointer, 1);
+            shrinker.begin(factor, cinfo.output_width, cinfo.output_components, m_pImageData);
+            shrinker.source = static_cast<unsigned char*>(malloc(cinfo.output_width * cinfo.output_components));
+            CC_BREAK_IF(! shrinker.source);
+            
+            row_pointer[0] = shrinker.source;
+            while (cinfo.output_scanline < cinfo.output_height)
+            {
+                jpeg_read_scanlines(&cinfo, row_pointer, 1);
+                shrinker.addRow(shrinker.source);
+            }
+            shrinker.flush();
+        }
+        else
+        {
+            /* now actually read the jpeg into the raw buffer */
+            /* read one scan line at a time */
+            while (cinfo.output_scanline < cinfo.output_height)
+            {
+                row_pointer[0] = m_pImageData + location;
+                location += cinfo.output_width*cinfo.output_components;
+                jpeg_read_scanlines(&cinfo, row_pointer, 1);
+            }
         }
         
         /* When read image file with broken data, jpeg_finish_decompress() may cause error.
@@ -1474,6 +1614,7 @@ bool CAImage::initWithPngData(const unsigned char * data, unsigned long dataLen)
     png_byte        header[PNGSIGSIZE]   = {0};
     png_structp     png_ptr     =   0;
     png_infop       info_ptr    = 0;
+    DecodeRowShrinker  shrinker;
     
     do
     {
@@ -1543,6 +1684,9 @@ bool CAImage::initWithPngData(const unsigned char * data, unsigned long dataLen)
             png_set_packing(png_ptr);
         }
         
+        // interlaced images need several passes when read row by row
+        int passes = png_set_interlace_handling(png_ptr);
+        
         // update info
         png_read_update_info(png_ptr, info_ptr);
         bit_depth = png_get_bit_depth(png_ptr, info_ptr);
@@ -1568,10 +1712,69 @@ bool CAImage::initWithPngData(const unsigned char * data, unsigned long dataLen)
         
         // read png data
         m_nBitsPerComponent = bit_depth;
-        png_size_t rowbytes;
-        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * m_uPixelsHigh);
+        png_size_t rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+        unsigned int factor = (unsigned int)(1.0f / decodeScaleForSize(m_uPixelsWide, m_uPixelsHigh, m_tDecodeSize));
+        bool premultiply = (color_type == PNG_COLOR_TYPE_RGB_ALPHA);
+        
+        if (factor > 1)
+        {
+            unsigned int channels = png_get_channels(png_ptr, info_ptr);
+            unsigned int srcWide = m_uPixelsWide;
+            unsigned int srcHigh = m_uPixelsHigh;
+            m_uPixelsWide = (srcWide + factor - 1) / factor;
+            m_uPixelsHigh = (srcHigh + factor - 1) / factor;
+            m_uImageDataLenght = m_uPixelsWide * m_uPixelsHigh * channels;
+            m_pImageData = static_cast<unsigned char*>(malloc(m_uImageDataLenght * sizeof(unsigned char)));
+            CC_BREAK_IF(!m_pImageData);
+            
+            // rows are premultiplied before they are averaged so transparent pixels don't bleed their color
+            shrinker.begin(factor, srcWide, channels, m_pImageData);
+            if (passes == 1)
+            {
+                shrinker.source = static_cast<unsigned char*>(malloc(rowbytes));
+                CC_BREAK_IF(!shrinker.source);
+                for (unsigned int y = 0; y < srcHigh; ++y)
+                {
+                    png_read_row(png_ptr, shrinker.source, NULL);
+                    if (premultiply)
+                    {
+                        CAPixelKernels::premultiplyRGBA8888(shrinker.source, srcWide);
+                    }
+                    shrinker.addRow(shrinker.source);
+                }
+            }
+            else
+            {
+                // interlaced images are only complete after the last pass
+                shrinker.source = static_cast<unsigned char*>(malloc(rowbytes * srcHigh));
+                CC_BREAK_IF(!shrinker.source);
+                for (int pass = 0; pass < passes; ++pass)
+                {
+                    for (unsigned int y = 0; y < srcHigh; ++y)
+                    {
+                        png_read_row(png_ptr, shrinker.source + y * rowbytes, NULL);
+                    }
+                }
+                for (unsigned int y = 0; y < srcHigh; ++y)
+                {
+                    unsigned char* row = shrinker.source + y * rowbytes;
+                    if (premultiply)
+                    {
+                        CAPixelKernels::premultiplyRGBA8888(row, srcWide);
+                    }
+                    shrinker.addRow(row);
+                }
+            }
+            shrinker.flush();
+            
+            png_read_end(png_ptr, nullptr);
+            
+            m_bHasPremultipliedAlpha = premultiply;
+            ret = true;
+            break;
+        }
         
-        rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * m_uPixelsHigh);
         
         m_uImageDataLenght = rowbytes * m_uPixelsHigh;
         m_pImageData = static_cast<unsigned char*>(malloc(m_uImageDataLenght * sizeof(unsigned char)));
@@ -1593,17 +1796,9 @@ bool CAImage::initWithPngData(const unsigned char * data, unsigned long dataLen)
         png_read_end(png_ptr, nullptr);
         
         // premultiplied alpha for RGBA8888
-        if (color_type == PNG_COLOR_TYPE_RGB_ALPHA)
+        if (premultiply)
         {
-            unsigned int* fourBytes = (unsigned int*)m_pImageData;
-            for(int i = 0; i < m_uPixelsWide * m_uPixelsHigh; i++)
-            {
-                unsigned char* p = m_pImageData + i * 4;
-                fourBytes[i] = (unsigned)(((unsigned)((unsigned char)(p[0]) * ((unsigned char)(p[3]) + 1)) >> 8) |
-                                          ((unsigned)((unsigned char)(p[1]) * ((unsigned char)(p[3]) + 1) >> 8) << 8) |
-                                          ((unsigned)((unsigned char)(p[2]) * ((unsigned char)(p[3]) + 1) >> 8) << 16) |
-                                          ((unsigned)(unsigned char)(p[3]) << 24));
-            }
+            CAPixelKernels::premultiplyRGBA8888(m_pImageData, (unsigned long)m_uPixelsWide * m_uPixelsHigh);
             
             m_bHasPremultipliedAlpha = true;
         }
@@ -1731,6 +1926,16 @@ bool CAImage::initWithWebpData(const unsigned char * data, unsigned long dataLen
         m_ePixelFormat = CAImage::PixelFormat_RGBA8888;
         m_uPixelsWide    = config.input.width;
         m_uPixelsHigh   = config.input.height;
+        
+        float scale = decodeScaleForSize(m_uPixelsWide, m_uPixelsHigh, m_tDecodeSize);
+        if (scale < 1.0f)
+        {
+            m_uPixelsWide = MAX((unsigned int)ceilf(m_uPixelsWide * scale), 1u);
+            m_uPixelsHigh = MAX((unsigned int)ceilf(m_uPixelsHigh * scale), 1u);
+            config.options.use_scaling = 1;
+            config.options.scaled_width = m_uPixelsWide;
+            config.options.scaled_height = m_uPixelsHigh;
+        }
         m_nBitsPerComponent = 8;
         
         m_uImageDataLenght = m_uPixelsWide * m_uPixelsHigh * 4;
@@ -1923,6 +2128,40 @@ bool CAImage::initWithRawData(const unsigned char * data,
     return true;
 }
 
+bool CAImage::initWithTextureName(GLuint name,
+                                  const CAImage::PixelFormat& pixelFormat,
+                                  unsigned int pixelsWide,
+                                  unsigned int pixelsHigh)
+{
+    if (name == 0)
+    {
+        return false;
+    }
+    
+    this->freeName();
+    this->releaseData();
+    
+    m_uName = name;
+    m_tContentSize = DSize(pixelsWide, pixelsHigh);
+    m_uPixelsWide = pixelsWide;
+    m_uPixelsHigh = pixelsHigh;
+    m_ePixelFormat = pixelFormat;
+    m_fMaxS = 1;
+    m_fMaxT = 1;
+    m_bHasMipmaps = false;
+    m_bHasPremultipliedAlpha = (pixelFormat == PixelFormat_RGBA8888
+                                || pixelFormat == PixelFormat_RGBA4444
+                                || pixelFormat == PixelFormat_RGB5A1
+                                || pixelFormat == PixelFormat_AI88);
+    
+    // the texture is already uploaded, there is nothing to premultiply
+    m_bPremultiplied = true;
+    
+    setShaderProgram(CAShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionTexture));
+    
+    return true;
+}
+
 void CAImage::setData(const unsigned char* data, unsigned long dataLenght)
 {
     m_uDataLenght = dataLenght;
@@ -2110,6 +2349,71 @@ void CAImage::repremultipliedImageData()
     this->premultipliedImageData();
 }
 
+void CAImage::updateWithData(const unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    CC_RETURN_IF(data == NULL || width == 0 || height == 0);
+    CC_RETURN_IF(x + width > m_uPixelsWide || y + height > m_uPixelsHigh);
+    
+    GLenum format = GL_RGBA;
+    GLenum type = GL_UNSIGNED_BYTE;
+    unsigned int bytesPerPixel = 4;
+    switch (m_ePixelFormat)
+    {
+        case PixelFormat_RGBA8888:
+            break;
+        case PixelFormat_RGB888:
+            format = GL_RGB;
+            bytesPerPixel = 3;
+            break;
+        case PixelFormat_RGBA4444:
+            type = GL_UNSIGNED_SHORT_4_4_4_4;
+            bytesPerPixel = 2;
+            break;
+        case PixelFormat_RGB5A1:
+            type = GL_UNSIGNED_SHORT_5_5_5_1;
+            bytesPerPixel = 2;
+            break;
+        case PixelFormat_RGB565:
+            format = GL_RGB;
+            type = GL_UNSIGNED_SHORT_5_6_5;
+            bytesPerPixel = 2;
+            break;
+        case PixelFormat_AI88:
+            format = GL_LUMINANCE_ALPHA;
+            bytesPerPixel = 2;
+            break;
+        case PixelFormat_A8:
+            format = GL_ALPHA;
+            bytesPerPixel = 1;
+            break;
+        case PixelFormat_I8:
+            format = GL_LUMINANCE;
+            bytesPerPixel = 1;
+            break;
+        default:
+            CCAssert(0, "updateWithData: unsupported pixel format");
+            return;
+    }
+    
+    // keep the CPU copy in step, reloadAllImages uploads from it
+    if (m_pData)
+    {
+        unsigned int pitch = m_uPixelsWide * bytesPerPixel;
+        unsigned int rowBytes = width * bytesPerPixel;
+        for (unsigned int row = 0; row < height; ++row)
+        {
+            memcpy(m_pData + (y + row) * pitch + x * bytesPerPixel, data + row * rowBytes, rowBytes);
+        }
+    }
+    
+    CC_RETURN_IF(m_uName == 0);
+    
+    unsigned int rowBytes = width * bytesPerPixel;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, rowBytes % 4 == 0 ? 4 : (rowBytes % 2 == 0 ? 2 : 1));
+    ccGLBindTexture2D(m_uName);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (GLint)x, (GLint)y, (GLsizei)width, (GLsizei)height, format, type, data);
+}
+
 const CAImage::PixelFormat& CAImage::getPixelFormat()
 {
     return m_ePixelFormat;
@@ -2176,6 +2480,40 @@ void CAImage::releaseData()
     }
 }
 
+bool CAImage::readbackData()
+{
+    CC_RETURN_IF(m_pData) true;
+    CC_RETURN_IF(m_uName == 0 || m_ePixelFormat != PixelFormat_RGBA8888) false;
+    
+    unsigned long length = (unsigned long)m_uPixelsWide * m_uPixelsHigh * 4;
+    unsigned char* data = (unsigned char*)malloc(length);
+    CC_RETURN_IF(data == NULL) false;
+    
+    GLint oldFBO = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+    GLuint fbo = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_uName, 0);
+    
+    bool bRet = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    if (bRet)
+    {
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, m_uPixelsWide, m_uPixelsHigh, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        m_pData = data;
+        m_uDataLenght = length;
+    }
+    else
+    {
+        free(data);
+    }
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+    glDeleteFramebuffers(1, &fbo);
+    return bRet;
+}
+
 void CAImage::releaseData(unsigned char ** data)
 {
     if (*data)
@@ -2638,6 +2976,12 @@ bool CAImage::saveToFile(const std::string& fullPath, bool bIsToRGB)
         return false;
     }
     
+    // GPU only images (e.g. CARenderImage output) are read back first
+    if (m_pData == NULL && !this->readbackData())
+    {
+        return false;
+    }
+    
     bool bRet = false;
     
     do
@@ -2660,6 +3004,8 @@ bool CAImage::saveToFile(const std::string& fullPath, bool bIsToRGB)
             CC_BREAK_IF(!saveImageToPNG(fullPath, bIsToRGB));
         }
         
+        // the file may have been looked up, and found missing, before
+        FileUtils::getInstance()->purgeMissingEntries();
         bRet = true;
     } while (0);
     
@@ -3019,6 +3365,14 @@ void CAImage::reloadAllImages()
     }
 }
 
+void CAImage::readbackAllImages()
+{
+    for (auto& image : s_pImages)
+    {
+        image->readbackData();
+    }
+}
+
 void CAImage::purgeCAImage()
 {
     CC_SAFE_DELETE(s_white_image);
@@ -152,6 +152,15 @@ public:
     
     static CAImage* create(const std::string& file);
 
+    /**
+     * Loads file decoded close to decodeSize pixels instead of at full resolution.
+     * JPEG and WebP are scaled by their decoders, PNG (and JPEG below 1/8) is
+     * box-filtered row by row, so the full-size pixels never exist. The result keeps the aspect ratio and
+     * is never smaller than decodeSize in both dimensions, or the original size.
+     * Cached under a key that includes decodeSize.
+     */
+    static CAImage* create(const std::string& file, const DSize& decodeSize);
+
     static CAImage* createWithImageDataNoCache(const unsigned char * data, unsigned long lenght);
     
     static CAImage* createWithImageData(const unsigned char * data,
@@ -169,21 +178,40 @@ public:
                                       unsigned int pixelsHigh,
                                       const std::string& key);
     
+    // takes ownership of an existing GL texture, the image has no CPU copy of its pixels
+    static CAImage* createWithTextureName(GLuint name,
+                                          const CAImage::PixelFormat& pixelFormat,
+                                          unsigned int pixelsWide,
+                                          unsigned int pixelsHigh);
+    
     bool initWithImageFile(const std::string& file, bool isOpenGLThread = true);
     
     bool initWithImageData(const unsigned char * data, unsigned long dataLen, bool isOpenGLThread = true);
     
+    // decodeSize in pixels, DSizeZero decodes at full resolution; other formats ignore it
+    bool initWithImageFile(const std::string& file, const DSize& decodeSize, bool isOpenGLThread = true);
+    
+    bool initWithImageData(const unsigned char * data, unsigned long dataLen, const DSize& decodeSize, bool isOpenGLThread = true);
+    
     bool initWithRawData(const unsigned char * data,
                          const CAImage::PixelFormat& pixelFormat,
                          unsigned int pixelsWide,
                          unsigned int pixelsHigh);
     
+    bool initWithTextureName(GLuint name,
+                             const CAImage::PixelFormat& pixelFormat,
+                             unsigned int pixelsWide,
+                             unsigned int pixelsHigh);
+    
     const char* description(void);
     
     void releaseData();
     
     void releaseData(unsigned char ** data);
     
+    // fills the CPU copy of an RGBA8888 image that only lives in its texture
+    bool readbackData();
+    
     void drawAtPoint(const DPoint& point);
     
     void drawInRect(const DRect& rect);
@@ -267,6 +295,13 @@ public:
     
     void repremultipliedImageData();
     
+    /**
+     * Replaces a width x height block at (x, y) of the pixels and of the texture with glTexSubImage2D.
+     * data is tightly packed in the image's pixel format; passing whole rows (x = 0) lets a caller
+     * hand in a band of its own buffer without repacking.
+     */
+    void updateWithData(const unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+    
     void freeName();
     
     void updateGifImageWithIndex(unsigned int index);
@@ -277,6 +312,9 @@ public:
     
     static void reloadAllImages();
     
+    // call while the GL context is still alive, reloadAllImages uploads from the CPU copies
+    static void readbackAllImages();
+    
     static const PixelFormatInfoMap& getPixelFormatInfoMap();
     
 protected:
@@ -389,11 +427,17 @@ protected:
     
     unsigned long m_uImageDataLenght;
     
+    DSize m_tDecodeSize;
+    
     static const PixelFormatInfoMap s_pixelFormatInfoTables;
     
 	friend class CAFTRichFont;
     
     friend class CAFreeTypeFont;
+    
+    friend class CARenderImage;
+    
+    friend class CAImageDiskCache;
 };
 
 NS_CC_END
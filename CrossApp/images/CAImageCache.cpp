@@ -46,6 +46,8 @@ typedef enum _AsyncType
 typedef struct _AsyncStruct
 {
     std::string            filename;
+    std::string            key;
+    DSize                  decodeSize;
     CAObject    *target;
     SEL_CallFuncO        selector;
 } AsyncStruct;
@@ -108,10 +110,10 @@ static void loadImageData(AsyncStruct *pAsyncStruct)
         //delete pAsyncStruct;
     }
     CAImage* image = new CAImage();
-    if (image && !image->initWithImageFile(filename, false))
+    if (image && !image->initWithImageFile(filename, pAsyncStruct->decodeSize, false))
     {
-        CC_SAFE_RELEASE(image);
-        return;
+        // still answered, with a NULL image, so that the request is finished on the UI thread
+        CC_SAFE_RELEASE_NULL(image);
     }
     // generate image info
     ImageInfo *pImageInfo = new ImageInfo();
@@ -215,7 +217,28 @@ void CAImageCache::addImageAsync(const std::string& path, CAObject *target, SEL_
 
 void CAImageCache::addImageFullPathAsync(const std::string& path, CAObject *target, SEL_CallFuncO selector)
 {
-    CAImage* image = m_mImages.getValue(path);
+    this->addImageFullPathAsync(path, DSizeZero, target, selector);
+}
+
+std::string CAImageCache::keyForDecodeSize(const std::string& path, const DSize& decodeSize)
+{
+    if (decodeSize.width <= 0 && decodeSize.height <= 0)
+    {
+        return path;
+    }
+    return path + crossapp_format_string("@%dx%d", (int)ceilf(decodeSize.width), (int)ceilf(decodeSize.height));
+}
+
+void CAImageCache::addImageFullPathAsync(const std::string& path, const DSize& decodeSize, CAObject *target, SEL_CallFuncO selector)
+{
+    std::string key = keyForDecodeSize(path, decodeSize);
+    
+    // a full size image already in memory serves every smaller request
+    CAImage* image = m_mImages.getValue(key);
+    if (image == NULL)
+    {
+        image = m_mImages.getValue(path);
+    }
 
     if (image != NULL)
     {
@@ -253,6 +276,8 @@ void CAImageCache::addImageFullPathAsync(const std::string& path, CAObject *targ
     // generate async struct
     AsyncStruct *data = new AsyncStruct();
     data->filename = path;
+    data->key = key;
+    data->decodeSize = decodeSize;
     data->target = target;
     data->selector = selector;
     
@@ -278,16 +303,19 @@ void CAImageCache::addImageAsyncCallBack(float dt)
 
         AsyncStruct *pAsyncStruct = pImageInfo->asyncStruct;
         CAImage *image = pImageInfo->image;
-        image->premultipliedImageData();
         
         CAObject *target = pAsyncStruct->target;
         SEL_CallFuncO selector = pAsyncStruct->selector;
-        const char* filename = pAsyncStruct->filename.c_str();
+        const std::string& key = pAsyncStruct->key;
 
         // cache the image
-        m_mImages.erase(filename);
-        m_mImages.insert(filename, image);
-        image->release();
+        if (image)
+        {
+            image->premultipliedImageData();
+            m_mImages.erase(key);
+            m_mImages.insert(key, image);
+            image->release();
+        }
 
         if (target && selector)
         {
@@ -306,6 +334,37 @@ void CAImageCache::addImageAsyncCallBack(float dt)
     }
 }
 
+CAImage* CAImageCache::addImage(const std::string& path, const DSize& decodeSize)
+{
+    std::string key = keyForDecodeSize(path, decodeSize);
+    if (key == path)
+    {
+        return this->addImage(path);
+    }
+    
+    CAImage* image = m_mImages.getValue(key);
+    if (image == NULL)
+    {
+        image = m_mImages.getValue(path);
+    }
+    
+    if (image == NULL)
+    {
+        image = new CAImage();
+        if (image->initWithImageFile(path, decodeSize))
+        {
+            m_mImages.erase(key);
+            m_mImages.insert(key, image);
+            image->release();
+        }
+        else
+        {
+            CC_SAFE_DELETE(image);
+        }
+    }
+    return image;
+}
+
 CAImage* CAImageCache::addImage(const std::string& path)
 {
     if (path.empty())
@@ -27,10 +27,19 @@ public:
     static void purgeSharedImageCache();
 
     CAImage* addImage(const std::string& fileimage);
+    
+    // decodes at decodeSize pixels, see CAImage::create(file, decodeSize)
+    CAImage* addImage(const std::string& fileimage, const DSize& decodeSize);
 
+    // the selector is called on the UI thread, with NULL when the image can't be loaded
     void addImageAsync(const std::string& path, CAObject *target, SEL_CallFuncO selector);
 
     void addImageFullPathAsync(const std::string& path, CAObject *target, SEL_CallFuncO selector);
+    
+    void addImageFullPathAsync(const std::string& path, const DSize& decodeSize, CAObject *target, SEL_CallFuncO selector);
+    
+    /** the key an image decoded at decodeSize is cached under, path itself for DSizeZero */
+    static std::string keyForDecodeSize(const std::string& path, const DSize& decodeSize);
 
     CAImage* imageForKey(const std::string& key);
     
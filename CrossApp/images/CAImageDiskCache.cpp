@@ -0,0 +1,436 @@
+//
+//  CAImageDiskCache.cpp
+//  CrossApp
+//
+//  Copyright (c) 2014 http://9miao.com All rights reserved.
+//
+
+#include "CAImageDiskCache.h"
+#include "CAPixelKernels.h"
+#include "platform/CAFileUtils.h"
+#include "shaders/CAShaderCache.h"
+#include "shaders/CAGLProgram.h"
+#include "ccTypeInfo.h"
+#include "ccMacros.h"
+#include <sys/stat.h>
+#include <stdio.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT) || (CC_TARGET_PLATFORM == CC_PLATFORM_WP8)
+#define CC_IMAGE_DISK_CACHE_WIN32 1
+#include <windows.h>
+#include <sys/utime.h>
+#else
+#define CC_IMAGE_DISK_CACHE_WIN32 0
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/mman.h>
+#endif
+
+NS_CC_BEGIN
+
+static const char s_uMagic[4] = { 'C', 'A', 'I', 'C' };
+
+static const unsigned short s_uVersion = 1;
+
+// the file is the header, the key it was stored under (to catch hash collisions), padding to 16 bytes, then the pixels
+struct ImageDiskCacheHeader
+{
+    char            magic[4];
+    unsigned short  version;
+    unsigned short  pixelFormat;
+    unsigned int    pixelsWide;
+    unsigned int    pixelsHigh;
+    unsigned int    dataLenght;
+    unsigned int    keyLenght;
+    unsigned int    premultiplied;
+    unsigned int    reserved;
+};
+
+static unsigned long pixelsOffsetForKey(unsigned long keyLenght)
+{
+    return (sizeof(ImageDiskCacheHeader) + keyLenght + 15) & ~15ul;
+}
+
+static CAImageDiskCache* s_pSharedImageDiskCache = NULL;
+
+CAImageDiskCache* CAImageDiskCache::getInstance()
+{
+    if (s_pSharedImageDiskCache == NULL)
+    {
+        s_pSharedImageDiskCache = new CAImageDiskCache();
+    }
+    return s_pSharedImageDiskCache;
+}
+
+void CAImageDiskCache::destroyInstance()
+{
+    CC_SAFE_DELETE(s_pSharedImageDiskCache);
+}
+
+CAImageDiskCache::CAImageDiskCache()
+:m_bEnabled(false)
+,m_bIndexLoaded(false)
+,m_uCapacity(64 * 1024 * 1024)
+,m_uTotalSize(0)
+,m_uUseCounter(0)
+,m_eOpaquePixelFormat(CAImage::PixelFormat_RGB888)
+{
+    pthread_mutex_init(&m_obMutex, NULL);
+}
+
+CAImageDiskCache::~CAImageDiskCache()
+{
+    pthread_mutex_destroy(&m_obMutex);
+}
+
+void CAImageDiskCache::setEnabled(bool enabled)
+{
+    m_bEnabled = enabled;
+}
+
+void CAImageDiskCache::setDirectory(const std::string& directory)
+{
+    pthread_mutex_lock(&m_obMutex);
+    m_sDirectory = directory;
+    if (!m_sDirectory.empty() && m_sDirectory[m_sDirectory.length() - 1] != '/')
+    {
+        m_sDirectory += '/';
+    }
+    m_mEntries.clear();
+    m_uTotalSize = 0;
+    m_bIndexLoaded = false;
+    pthread_mutex_unlock(&m_obMutex);
+}
+
+void CAImageDiskCache::setCapacity(unsigned long capacity)
+{
+    pthread_mutex_lock(&m_obMutex);
+    m_uCapacity = capacity;
+    if (m_bIndexLoaded)
+    {
+        this->evictEntries();
+    }
+    pthread_mutex_unlock(&m_obMutex);
+}
+
+void CAImageDiskCache::setOpaquePixelFormat(const CAImage::PixelFormat& format)
+{
+    CCAssert(format == CAImage::PixelFormat_RGB565 || format == CAImage::PixelFormat_RGB888, "unsupported opaque format");
+    m_eOpaquePixelFormat = format;
+}
+
+std::string CAImageDiskCache::keyForSource(const std::string& source, const DSize& decodeSize)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(source);
+
+    // files inside the apk have no mtime, they only change with the app,
+    // those inside a mounted archive take the archive's
+    long mtime = 0;
+    struct stat st;
+    std::string path = fullPath;
+    while (!path.empty())
+    {
+        if (stat(path.c_str(), &st) == 0)
+        {
+            mtime = (long)st.st_mtime;
+            break;
+        }
+        size_t slash = path.find_last_of('/');
+        CC_BREAK_IF(slash == std::string::npos || slash == 0);
+        path.erase(slash);
+    }
+    return crossapp_format_string("%s|%ld|%dx%d", fullPath.c_str(), mtime,
+                                  (int)ceilf(decodeSize.width), (int)ceilf(decodeSize.height));
+}
+
+std::string CAImageDiskCache::fileNameForKey(const std::string& key)
+{
+    // 64-bit FNV-1a
+    unsigned long long hash = 14695981039346656037ull;
+    for (size_t i = 0; i < key.length(); ++i)
+    {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ull;
+    }
+    return crossapp_format_string("%08x%08x.img", (unsigned int)(hash >> 32), (unsigned int)hash);
+}
+
+void CAImageDiskCache::loadIndex()
+{
+    CC_RETURN_IF(m_bIndexLoaded);
+    m_bIndexLoaded = true;
+
+    if (m_sDirectory.empty())
+    {
+        m_sDirectory = FileUtils::getInstance()->getWritablePath() + "image_cache/";
+    }
+    FileUtils::getInstance()->createDirectory(m_sDirectory);
+
+    // older files count as used longer ago, lastUse only needs to order the entries
+    std::vector<std::pair<long, std::string> > files;
+#if CC_IMAGE_DISK_CACHE_WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE search = FindFirstFileA((m_sDirectory + "*.img").c_str(), &data);
+    if (search != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            std::string path = m_sDirectory + data.cFileName;
+            struct stat st;
+            CC_CONTINUE_IF(stat(path.c_str(), &st) != 0);
+            files.push_back(std::make_pair((long)st.st_mtime, std::string(data.cFileName)));
+            m_mEntries[data.cFileName].size = (unsigned long)st.st_size;
+        }
+        while (FindNextFileA(search, &data));
+        FindClose(search);
+    }
+#else
+    DIR* dir = opendir(m_sDirectory.c_str());
+    if (dir)
+    {
+        struct dirent* ent;
+        while ((ent = readdir(dir)) != NULL)
+        {
+            std::string name = ent->d_name;
+            CC_CONTINUE_IF(name.length() < 4 || name.compare(name.length() - 4, 4, ".img") != 0);
+            struct stat st;
+            CC_CONTINUE_IF(stat((m_sDirectory + name).c_str(), &st) != 0);
+            files.push_back(std::make_pair((long)st.st_mtime, name));
+            m_mEntries[name].size = (unsigned long)st.st_size;
+        }
+        closedir(dir);
+    }
+#endif
+
+    std::sort(files.begin(), files.end());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        Entry& entry = m_mEntries[files[i].second];
+        entry.lastUse = ++m_uUseCounter;
+        m_uTotalSize += entry.size;
+    }
+    this->evictEntries();
+}
+
+void CAImageDiskCache::touchEntry(const std::string& fileName, unsigned long size)
+{
+    std::map<std::string, Entry>::iterator itr = m_mEntries.find(fileName);
+    if (itr == m_mEntries.end())
+    {
+        Entry entry = { size, 0 };
+        itr = m_mEntries.insert(std::make_pair(fileName, entry)).first;
+        m_uTotalSize += size;
+    }
+    else if (itr->second.size != size)
+    {
+        m_uTotalSize += size - itr->second.size;
+        itr->second.size = size;
+    }
+    itr->second.lastUse = ++m_uUseCounter;
+}
+
+void CAImageDiskCache::evictEntries()
+{
+    while (m_uTotalSize > m_uCapacity && !m_mEntries.empty())
+    {
+        std::map<std::string, Entry>::iterator oldest = m_mEntries.begin();
+        for (std::map<std::string, Entry>::iterator itr = m_mEntries.begin(); itr != m_mEntries.end(); ++itr)
+        {
+            if (itr->second.lastUse < oldest->second.lastUse)
+            {
+                oldest = itr;
+            }
+        }
+        remove((m_sDirectory + oldest->first).c_str());
+        m_uTotalSize -= oldest->second.size;
+        m_mEntries.erase(oldest);
+    }
+}
+
+bool CAImageDiskCache::loadImage(CAImage* image, const std::string& source, const DSize& decodeSize)
+{
+    if (!m_bEnabled || image == NULL)
+    {
+        return false;
+    }
+
+    std::string key = this->keyForSource(source, decodeSize);
+    std::string fileName = this->fileNameForKey(key);
+
+    pthread_mutex_lock(&m_obMutex);
+    this->loadIndex();
+    bool known = m_mEntries.find(fileName) != m_mEntries.end();
+    std::string path = m_sDirectory + fileName;
+    pthread_mutex_unlock(&m_obMutex);
+
+    if (!known)
+    {
+        return false;
+    }
+
+    const unsigned char* file = NULL;
+    unsigned long fileLenght = 0;
+
+#if CC_IMAGE_DISK_CACHE_WIN32
+    unsigned char* buffer = FileUtils::getInstance()->getFileData(path, "rb", &fileLenght);
+    file = buffer;
+#else
+    void* mapping = MAP_FAILED;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            fileLenght = (unsigned long)st.st_size;
+            mapping = mmap(NULL, fileLenght, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+    }
+    if (mapping != MAP_FAILED)
+    {
+        file = static_cast<const unsigned char*>(mapping);
+    }
+#endif
+
+    bool ret = false;
+    do
+    {
+        CC_BREAK_IF(file == NULL || fileLenght < sizeof(ImageDiskCacheHeader));
+
+        ImageDiskCacheHeader header;
+        memcpy(&header, file, sizeof(header));
+        CC_BREAK_IF(memcmp(header.magic, s_uMagic, 4) != 0 || header.version != s_uVersion);
+
+        unsigned long offset = pixelsOffsetForKey(header.keyLenght);
+        CC_BREAK_IF(offset + header.dataLenght > fileLenght);
+        CC_BREAK_IF(key.compare(0, std::string::npos, (const char*)file + sizeof(header), header.keyLenght) != 0);
+
+        image->setData(file + offset, header.dataLenght);
+        image->m_ePixelFormat = (CAImage::PixelFormat)header.pixelFormat;
+        image->m_uPixelsWide = header.pixelsWide;
+        image->m_uPixelsHigh = header.pixelsHigh;
+        image->m_tContentSize = DSize(header.pixelsWide, header.pixelsHigh);
+        image->m_fMaxS = 1;
+        image->m_fMaxT = 1;
+        image->m_bHasMipmaps = false;
+        image->m_bHasPremultipliedAlpha = header.premultiplied != 0;
+        image->setShaderProgram(CAShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionTexture));
+        ret = true;
+    }
+    while (0);
+
+#if CC_IMAGE_DISK_CACHE_WIN32
+    delete[] buffer;
+    _utime(path.c_str(), NULL);
+#else
+    if (mapping != MAP_FAILED)
+    {
+        munmap(mapping, fileLenght);
+    }
+    // the mtime doubles as the last use when the index is rebuilt on the next launch
+    utime(path.c_str(), NULL);
+#endif
+
+    pthread_mutex_lock(&m_obMutex);
+    if (ret)
+    {
+        this->touchEntry(fileName, fileLenght);
+    }
+    else if (m_mEntries.count(fileName))
+    {
+        // unreadable or a hash collision, the next store replaces it
+        m_uTotalSize -= m_mEntries[fileName].size;
+        m_mEntries.erase(fileName);
+        remove(path.c_str());
+    }
+    pthread_mutex_unlock(&m_obMutex);
+
+    return ret;
+}
+
+void CAImageDiskCache::storeImage(CAImage* image, const std::string& source, const DSize& decodeSize)
+{
+    CC_RETURN_IF(!m_bEnabled || image == NULL || image->getData() == NULL);
+
+    std::string key = this->keyForSource(source, decodeSize);
+    std::string fileName = this->fileNameForKey(key);
+
+    CAImage::PixelFormat format = image->getPixelFormat();
+    const unsigned char* pixels = image->getData();
+    unsigned long dataLenght = image->getDataLenght();
+    unsigned long count = (unsigned long)image->getPixelsWide() * image->getPixelsHigh();
+
+    std::vector<unsigned char> converted;
+    if (format == CAImage::PixelFormat_RGB888 && m_eOpaquePixelFormat == CAImage::PixelFormat_RGB565)
+    {
+        converted.resize(count * 2);
+        CAPixelKernels::convertRGB888ToRGB565(pixels, &converted[0], count);
+        format = CAImage::PixelFormat_RGB565;
+        pixels = &converted[0];
+        dataLenght = converted.size();
+    }
+
+    ImageDiskCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, s_uMagic, 4);
+    header.version = s_uVersion;
+    header.pixelFormat = (unsigned short)format;
+    header.pixelsWide = image->getPixelsWide();
+    header.pixelsHigh = image->getPixelsHigh();
+    header.dataLenght = (unsigned int)dataLenght;
+    header.keyLenght = (unsigned int)key.length();
+    header.premultiplied = image->hasPremultipliedAlpha() ? 1 : 0;
+
+    unsigned long offset = pixelsOffsetForKey(key.length());
+    std::vector<unsigned char> prefix(offset, 0);
+    memcpy(&prefix[0], &header, sizeof(header));
+    memcpy(&prefix[sizeof(header)], key.data(), key.length());
+
+    pthread_mutex_lock(&m_obMutex);
+    this->loadIndex();
+    std::string path = m_sDirectory + fileName;
+    pthread_mutex_unlock(&m_obMutex);
+
+    // written next to the entry and renamed, a reader never sees half a file
+    std::string temporary = path + crossapp_format_string(".%p.tmp", (void*)image);
+    FILE* fp = fopen(temporary.c_str(), "wb");
+    CC_RETURN_IF(fp == NULL);
+    bool written = fwrite(&prefix[0], 1, offset, fp) == offset
+                && fwrite(pixels, 1, dataLenght, fp) == dataLenght;
+    fclose(fp);
+
+#if CC_IMAGE_DISK_CACHE_WIN32
+    remove(path.c_str());
+#endif
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        remove(temporary.c_str());
+        return;
+    }
+
+    pthread_mutex_lock(&m_obMutex);
+    this->touchEntry(fileName, offset + dataLenght);
+    this->evictEntries();
+    pthread_mutex_unlock(&m_obMutex);
+}
+
+void CAImageDiskCache::removeAllEntries()
+{
+    pthread_mutex_lock(&m_obMutex);
+    this->loadIndex();
+    for (std::map<std::string, Entry>::iterator itr = m_mEntries.begin(); itr != m_mEntries.end(); ++itr)
+    {
+        remove((m_sDirectory + itr->first).c_str());
+    }
+    m_mEntries.clear();
+    m_uTotalSize = 0;
+    pthread_mutex_unlock(&m_obMutex);
+}
+
+NS_CC_END
@@ -0,0 +1,104 @@
+//
+//  CAImageDiskCache.h
+//  CrossApp
+//
+//  Copyright (c) 2014 http://9miao.com All rights reserved.
+//
+
+#ifndef __CAIMAGE_DISK_CACHE_H__
+#define __CAIMAGE_DISK_CACHE_H__
+
+#include "basics/CAObject.h"
+#include "images/CAImage.h"
+#include <string>
+#include <map>
+#include <pthread.h>
+
+NS_CC_BEGIN
+
+/**
+ * Persistent cache of decoded, downsampled images (CAImage::create(file, decodeSize)).
+ * Entries hold raw pixels behind a small header, so a hit maps the file and hands the
+ * pixels to glTexImage2D without touching a decoder. Images are stored in their
+ * decoded format; opaque ones can be stored as RGB565 to halve them, see setOpaquePixelFormat.
+ *
+ * Entries are keyed by the source's full path, modification time and decode size,
+ * and the least recently used ones are deleted once the directory grows past its
+ * capacity. Disabled by default; safe to use from the async image loading thread.
+ */
+class CC_DLL CAImageDiskCache
+{
+public:
+
+    static CAImageDiskCache* getInstance();
+
+    static void destroyInstance();
+
+    void setEnabled(bool enabled);
+
+    bool isEnabled() const { return m_bEnabled; }
+
+    /** defaults to getWritablePath() + "image_cache/" */
+    void setDirectory(const std::string& directory);
+
+    const std::string& getDirectory() const { return m_sDirectory; }
+
+    /** total bytes of all entries, 64 MB by default */
+    void setCapacity(unsigned long capacity);
+
+    unsigned long getCapacity() const { return m_uCapacity; }
+
+    /** PixelFormat_RGB888 (default) or PixelFormat_RGB565 for images without alpha, RGB565 bands gradients */
+    void setOpaquePixelFormat(const CAImage::PixelFormat& format);
+
+    /** fills image from the cache, the texture is not created; false on a miss */
+    bool loadImage(CAImage* image, const std::string& source, const DSize& decodeSize);
+
+    void storeImage(CAImage* image, const std::string& source, const DSize& decodeSize);
+
+    void removeAllEntries();
+
+protected:
+
+    CAImageDiskCache();
+
+    virtual ~CAImageDiskCache();
+
+    struct Entry
+    {
+        unsigned long size;
+        unsigned long lastUse;
+    };
+
+    std::string keyForSource(const std::string& source, const DSize& decodeSize);
+
+    std::string fileNameForKey(const std::string& key);
+
+    void loadIndex();
+
+    void touchEntry(const std::string& fileName, unsigned long size);
+
+    void evictEntries();
+
+    bool m_bEnabled;
+
+    bool m_bIndexLoaded;
+
+    std::string m_sDirectory;
+
+    unsigned long m_uCapacity;
+
+    unsigned long m_uTotalSize;
+
+    unsigned long m_uUseCounter;
+
+    CAImage::PixelFormat m_eOpaquePixelFormat;
+
+    std::map<std::string, Entry> m_mEntries;
+
+    pthread_mutex_t m_obMutex;
+};
+
+NS_CC_END
+
+#endif // __CAIMAGE_DISK_CACHE_H__
@@ -0,0 +1,777 @@
+//
+//  CAPixelKernels.cpp
+//  CrossApp
+//
+//  Copyright (c) 2014 http://9miao.com All rights reserved.
+//
+
+#include "CAPixelKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CC_PIXEL_KERNELS_SSE 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CC_TARGET_SSSE3
+#else
+// SSSE3 is not part of the x86 baseline, those kernels are compiled for it and only called after the CPU check
+#define CC_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#else
+#define CC_PIXEL_KERNELS_SSE 0
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define CC_PIXEL_KERNELS_NEON 1
+#include <arm_neon.h>
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) && !defined(__aarch64__)
+#include <cpu-features.h>
+#endif
+#else
+#define CC_PIXEL_KERNELS_NEON 0
+#endif
+
+NS_CC_BEGIN
+
+static bool s_bImplementationResolved = false;
+
+static CAPixelKernels::Implementation s_eImplementation = CAPixelKernels::Scalar;
+
+static inline CAPixelKernels::Implementation currentImplementation()
+{
+    if (!s_bImplementationResolved)
+    {
+        s_eImplementation = CAPixelKernels::getSupportedImplementation();
+        s_bImplementationResolved = true;
+    }
+    return s_eImplementation;
+}
+
+CAPixelKernels::Implementation CAPixelKernels::getSupportedImplementation()
+{
+#if CC_PIXEL_KERNELS_SSE
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) ? SSSE3 : SSE2;
+#else
+    return __builtin_cpu_supports("ssse3") ? SSSE3 : SSE2;
+#endif
+#elif CC_PIXEL_KERNELS_NEON
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) && !defined(__aarch64__)
+    bool neon = android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM
+             && (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0;
+    return neon ? NEON : Scalar;
+#else
+    return NEON;
+#endif
+#else
+    return Scalar;
+#endif
+}
+
+CAPixelKernels::Implementation CAPixelKernels::getImplementation()
+{
+    return currentImplementation();
+}
+
+void CAPixelKernels::setImplementation(Implementation implementation)
+{
+    Implementation supported = getSupportedImplementation();
+
+    // SSE2 is a subset of SSSE3, anything else must be exactly what the CPU has
+    bool available = implementation == Scalar
+                  || implementation == supported
+                  || (implementation == SSE2 && supported == SSSE3);
+    if (!available)
+    {
+        implementation = supported;
+    }
+
+    s_eImplementation = implementation;
+    s_bImplementationResolved = true;
+}
+
+// scalar reference, also finishes the pixels the vector loops leave over
+
+static void convertRGB888ToRGBA8888Scalar(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    for (unsigned long i = 0; i < pixels; ++i, src += 3)
+    {
+        *dst++ = src[0];
+        *dst++ = src[1];
+        *dst++ = src[2];
+        *dst++ = 0xFF;
+    }
+}
+
+static void convertRGBA8888ToRGB888Scalar(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    for (unsigned long i = 0; i < pixels; ++i, src += 4)
+    {
+        *dst++ = src[0];
+        *dst++ = src[1];
+        *dst++ = src[2];
+    }
+}
+
+static void convertToRGB565Scalar(const unsigned char* src, unsigned int step, unsigned char* dst, unsigned long pixels)
+{
+    unsigned short* out16 = (unsigned short*)dst;
+    for (unsigned long i = 0; i < pixels; ++i, src += step)
+    {
+        *out16++ = (src[0] & 0x00F8) << 8    //R
+        | (src[1] & 0x00FC) << 3             //G
+        | (src[2] & 0x00F8) >> 3;            //B
+    }
+}
+
+static void convertToRGBA4444Scalar(const unsigned char* src, unsigned int step, unsigned char* dst, unsigned long pixels)
+{
+    unsigned short* out16 = (unsigned short*)dst;
+    for (unsigned long i = 0; i < pixels; ++i, src += step)
+    {
+        unsigned char a = step == 4 ? src[3] : 0xFF;
+        *out16++ = (src[0] & 0x00F0) << 8    //R
+        | (src[1] & 0x00F0) << 4             //G
+        | (src[2] & 0xF0)                    //B
+        | (a & 0xF0) >> 4;                   //A
+    }
+}
+
+static void convertToRGB5A1Scalar(const unsigned char* src, unsigned int step, unsigned char* dst, unsigned long pixels)
+{
+    unsigned short* out16 = (unsigned short*)dst;
+    for (unsigned long i = 0; i < pixels; ++i, src += step)
+    {
+        unsigned char a = step == 4 ? src[3] : 0xFF;
+        *out16++ = (src[0] & 0x00F8) << 8    //R
+        | (src[1] & 0x00F8) << 3             //G
+        | (src[2] & 0x00F8) >> 2             //B
+        | (a & 0x0080) >> 7;                 //A
+    }
+}
+
+static void premultiplyRGBA8888Scalar(unsigned char* data, unsigned long pixels)
+{
+    for (unsigned long i = 0; i < pixels; ++i, data += 4)
+    {
+        unsigned int a = data[3] + 1;
+        data[0] = (data[0] * a) >> 8;
+        data[1] = (data[1] * a) >> 8;
+        data[2] = (data[2] * a) >> 8;
+    }
+}
+
+static void downsampleRowScalar(const unsigned char* in, unsigned int srcPitch, unsigned char* out, unsigned int channels, unsigned int from, unsigned int to)
+{
+    in += from * channels * 2;
+    out += from * channels;
+    for (unsigned int i = from; i < to; ++i)
+    {
+        for (unsigned int c = 0; c < channels; ++c)
+        {
+            int sum = in[c] + in[c + channels] + in[c + srcPitch] + in[c + channels + srcPitch];
+            out[c] = sum >> 2;
+        }
+        out += channels;
+        in += channels * 2;
+    }
+}
+
+#if CC_PIXEL_KERNELS_SSE
+
+static inline __m128i packLow16SSE2(__m128i v0, __m128i v1)
+{
+    // the low 16 bits of each 32-bit lane, sign extended so the saturating pack keeps them as is
+    v0 = _mm_srai_epi32(_mm_slli_epi32(v0, 16), 16);
+    v1 = _mm_srai_epi32(_mm_slli_epi32(v1, 16), 16);
+    return _mm_packs_epi32(v0, v1);
+}
+
+static inline __m128i toRGB565SSE2(__m128i px)
+{
+    __m128i r = _mm_slli_epi32(_mm_and_si128(px, _mm_set1_epi32(0xF8)), 8);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(px, 5), _mm_set1_epi32(0x07E0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(px, 19), _mm_set1_epi32(0x001F));
+    return _mm_or_si128(r, _mm_or_si128(g, b));
+}
+
+static inline __m128i toRGBA4444SSE2(__m128i px)
+{
+    __m128i r = _mm_slli_epi32(_mm_and_si128(px, _mm_set1_epi32(0xF0)), 8);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(px, 4), _mm_set1_epi32(0x0F00));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), _mm_set1_epi32(0x00F0));
+    __m128i a = _mm_srli_epi32(px, 28);
+    return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+static inline __m128i toRGB5A1SSE2(__m128i px)
+{
+    __m128i r = _mm_slli_epi32(_mm_and_si128(px, _mm_set1_epi32(0xF8)), 8);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(px, 5), _mm_set1_epi32(0x07C0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(px, 18), _mm_set1_epi32(0x003E));
+    __m128i a = _mm_srli_epi32(px, 31);
+    return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+static unsigned long convertRGBA8888ToRGB565SSE2(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(src + i * 4 + 16));
+        _mm_storeu_si128((__m128i*)(dst + i * 2), packLow16SSE2(toRGB565SSE2(p0), toRGB565SSE2(p1)));
+    }
+    return i;
+}
+
+static unsigned long convertRGBA8888ToRGBA4444SSE2(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(src + i * 4 + 16));
+        _mm_storeu_si128((__m128i*)(dst + i * 2), packLow16SSE2(toRGBA4444SSE2(p0), toRGBA4444SSE2(p1)));
+    }
+    return i;
+}
+
+static unsigned long convertRGBA8888ToRGB5A1SSE2(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(src + i * 4 + 16));
+        _mm_storeu_si128((__m128i*)(dst + i * 2), packLow16SSE2(toRGB5A1SSE2(p0), toRGB5A1SSE2(p1)));
+    }
+    return i;
+}
+
+static unsigned long premultiplyRGBA8888SSE2(unsigned char* data, unsigned long pixels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+
+    unsigned long i = 0;
+    for (; i + 4 <= pixels; i += 4)
+    {
+        __m128i px = _mm_loadu_si128((const __m128i*)(data + i * 4));
+        __m128i lo = _mm_unpacklo_epi8(px, zero);
+        __m128i hi = _mm_unpackhi_epi8(px, zero);
+
+        // a + 1 in every 16-bit lane of its pixel, c * (a + 1) stays below 65536
+        __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        lo = _mm_srli_epi16(_mm_mullo_epi16(lo, _mm_add_epi16(alo, one)), 8);
+        hi = _mm_srli_epi16(_mm_mullo_epi16(hi, _mm_add_epi16(ahi, one)), 8);
+
+        __m128i result = _mm_packus_epi16(lo, hi);
+        result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, px));
+        _mm_storeu_si128((__m128i*)(data + i * 4), result);
+    }
+    return i;
+}
+
+static inline __m128i downsampleRGBAPairSSE2(__m128i row0, __m128i row1)
+{
+    // four pixels of two rows in, two averaged pixels out as 16-bit lanes
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+    lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+    hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+    return _mm_srli_epi16(_mm_unpacklo_epi64(lo, hi), 2);
+}
+
+static unsigned int downsampleRowRGBA8888SSE2(const unsigned char* in, unsigned int srcPitch, unsigned char* out, unsigned int width)
+{
+    unsigned int i = 0;
+    for (; i + 4 <= width; i += 4)
+    {
+        __m128i a = downsampleRGBAPairSSE2(_mm_loadu_si128((const __m128i*)(in + i * 8)),
+                                           _mm_loadu_si128((const __m128i*)(in + i * 8 + srcPitch)));
+        __m128i b = downsampleRGBAPairSSE2(_mm_loadu_si128((const __m128i*)(in + i * 8 + 16)),
+                                           _mm_loadu_si128((const __m128i*)(in + i * 8 + 16 + srcPitch)));
+        _mm_storeu_si128((__m128i*)(out + i * 4), _mm_packus_epi16(a, b));
+    }
+    return i;
+}
+
+// RGB888 sources need byte shuffles, SSE2 leaves them to the scalar code
+
+CC_TARGET_SSSE3
+static inline __m128i expandRGB888SSSE3(const unsigned char* src, __m128i alpha)
+{
+    // four RGB pixels from the low 12 bytes into four RGBA pixels
+    const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    return _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), mask), alpha);
+}
+
+CC_TARGET_SSSE3
+static inline __m128i compactRGBA8888SSSE3(__m128i px)
+{
+    // four RGBA pixels into twelve RGB bytes, the last four bytes are zero
+    const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    return _mm_shuffle_epi8(px, mask);
+}
+
+CC_TARGET_SSSE3
+static unsigned long convertRGB888ToRGBA8888SSSE3(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    unsigned long i = 0;
+    // the 16-byte load reads 4 bytes past the 4 pixels it converts
+    for (; i + 6 <= pixels; i += 4)
+    {
+        _mm_storeu_si128((__m128i*)(dst + i * 4), expandRGB888SSSE3(src + i * 3, alpha));
+    }
+    return i;
+}
+
+CC_TARGET_SSSE3
+static unsigned long convertRGBA8888ToRGB888SSSE3(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long i = 0;
+    // the 16-byte store writes 4 bytes past the 4 pixels, the next iteration overwrites them
+    for (; i + 6 <= pixels; i += 4)
+    {
+        __m128i px = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        _mm_storeu_si128((__m128i*)(dst + i * 3), compactRGBA8888SSSE3(px));
+    }
+    return i;
+}
+
+#define CC_PIXEL_KERNEL_RGB888_TO_16_SSSE3(name, pack)                                      \
+CC_TARGET_SSSE3                                                                             \
+static unsigned long name(const unsigned char* src, unsigned char* dst, unsigned long pixels) \
+{                                                                                           \
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);                                       \
+    unsigned long i = 0;                                                                    \
+    for (; i + 10 <= pixels; i += 8)                                                        \
+    {                                                                                       \
+        __m128i p0 = expandRGB888SSSE3(src + i * 3, alpha);                                 \
+        __m128i p1 = expandRGB888SSSE3(src + i * 3 + 12, alpha);                            \
+        _mm_storeu_si128((__m128i*)(dst + i * 2), packLow16SSE2(pack(p0), pack(p1)));       \
+    }                                                                                       \
+    return i;                                                                               \
+}
+
+CC_PIXEL_KERNEL_RGB888_TO_16_SSSE3(convertRGB888ToRGB565SSSE3, toRGB565SSE2)
+CC_PIXEL_KERNEL_RGB888_TO_16_SSSE3(convertRGB888ToRGBA4444SSSE3, toRGBA4444SSE2)
+CC_PIXEL_KERNEL_RGB888_TO_16_SSSE3(convertRGB888ToRGB5A1SSSE3, toRGB5A1SSE2)
+
+CC_TARGET_SSSE3
+static unsigned int downsampleRowRGB888SSSE3(const unsigned char* in, unsigned int srcPitch, unsigned char* out, unsigned int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    unsigned int i = 0;
+    // reads and writes run a few bytes past the pixels of an iteration, stay 6 pixels away from the row end
+    for (; i + 6 <= width; i += 4)
+    {
+        const unsigned char* p = in + i * 6;
+        __m128i a = downsampleRGBAPairSSE2(expandRGB888SSSE3(p, zero), expandRGB888SSSE3(p + srcPitch, zero));
+        __m128i b = downsampleRGBAPairSSE2(expandRGB888SSSE3(p + 12, zero), expandRGB888SSSE3(p + 12 + srcPitch, zero));
+        _mm_storeu_si128((__m128i*)(out + i * 3), compactRGBA8888SSSE3(_mm_packus_epi16(a, b)));
+    }
+    return i;
+}
+
+#endif // CC_PIXEL_KERNELS_SSE
+
+#if CC_PIXEL_KERNELS_NEON
+
+static unsigned long convertRGB888ToRGBA8888NEON(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+        uint8x16x4_t rgba;
+        rgba.val[0] = rgb.val[0];
+        rgba.val[1] = rgb.val[1];
+        rgba.val[2] = rgb.val[2];
+        rgba.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(dst + i * 4, rgba);
+    }
+    return i;
+}
+
+static unsigned long convertRGBA8888ToRGB888NEON(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x4_t rgba = vld4q_u8(src + i * 4);
+        uint8x16x3_t rgb;
+        rgb.val[0] = rgba.val[0];
+        rgb.val[1] = rgba.val[1];
+        rgb.val[2] = rgba.val[2];
+        vst3q_u8(dst + i * 3, rgb);
+    }
+    return i;
+}
+
+static inline uint16x8_t toRGB565NEON(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    uint16x8_t out = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF8)), 8);
+    out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(vand_u8(g, vdup_n_u8(0xFC))), 3));
+    out = vorrq_u16(out, vmovl_u8(vshr_n_u8(b, 3)));
+    return out;
+}
+
+static inline uint16x8_t toRGBA4444NEON(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    uint16x8_t out = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF0)), 8);
+    out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(vand_u8(g, vdup_n_u8(0xF0))), 4));
+    out = vorrq_u16(out, vmovl_u8(vand_u8(b, vdup_n_u8(0xF0))));
+    out = vorrq_u16(out, vmovl_u8(vshr_n_u8(a, 4)));
+    return out;
+}
+
+static inline uint16x8_t toRGB5A1NEON(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    uint16x8_t out = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF8)), 8);
+    out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(vand_u8(g, vdup_n_u8(0xF8))), 3));
+    out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(vshr_n_u8(b, 3)), 1));
+    out = vorrq_u16(out, vmovl_u8(vshr_n_u8(a, 7)));
+    return out;
+}
+
+#define CC_PIXEL_KERNEL_TO_16_NEON(name, pack)                                              \
+static unsigned long name##RGBA8888NEON(const unsigned char* src, unsigned char* dst, unsigned long pixels) \
+{                                                                                           \
+    unsigned long i = 0;                                                                    \
+    for (; i + 8 <= pixels; i += 8)                                                         \
+    {                                                                                       \
+        uint8x8x4_t p = vld4_u8(src + i * 4);                                               \
+        vst1q_u16((uint16_t*)(dst + i * 2), pack(p.val[0], p.val[1], p.val[2], p.val[3]));  \
+    }                                                                                       \
+    return i;                                                                               \
+}                                                                                           \
+static unsigned long name##RGB888NEON(const unsigned char* src, unsigned char* dst, unsigned long pixels) \
+{                                                                                           \
+    unsigned long i = 0;                                                                    \
+    for (; i + 8 <= pixels; i += 8)                                                         \
+    {                                                                                       \
+        uint8x8x3_t p = vld3_u8(src + i * 3);                                               \
+        vst1q_u16((uint16_t*)(dst + i * 2), pack(p.val[0], p.val[1], p.val[2], vdup_n_u8(0xFF))); \
+    }                                                                                       \
+    return i;                                                                               \
+}
+
+CC_PIXEL_KERNEL_TO_16_NEON(convertToRGB565From, toRGB565NEON)
+CC_PIXEL_KERNEL_TO_16_NEON(convertToRGBA4444From, toRGBA4444NEON)
+CC_PIXEL_KERNEL_TO_16_NEON(convertToRGB5A1From, toRGB5A1NEON)
+
+static unsigned long premultiplyRGBA8888NEON(unsigned char* data, unsigned long pixels)
+{
+    unsigned long i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(data + i * 4);
+        for (int c = 0; c < 3; ++c)
+        {
+            // c * a + c == c * (a + 1)
+            uint16x8_t m = vaddw_u8(vmull_u8(p.val[c], p.val[3]), p.val[c]);
+            p.val[c] = vshrn_n_u16(m, 8);
+        }
+        vst4_u8(data + i * 4, p);
+    }
+    return i;
+}
+
+static unsigned int downsampleRowRGBA8888NEON(const unsigned char* in, unsigned int srcPitch, unsigned char* out, unsigned int width)
+{
+    unsigned int i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        uint8x16x4_t row0 = vld4q_u8(in + i * 8);
+        uint8x16x4_t row1 = vld4q_u8(in + i * 8 + srcPitch);
+        uint8x8x4_t result;
+        for (int c = 0; c < 4; ++c)
+        {
+            uint16x8_t sum = vpadalq_u8(vpaddlq_u8(row0.val[c]), row1.val[c]);
+            result.val[c] = vshrn_n_u16(sum, 2);
+        }
+        vst4_u8(out + i * 4, result);
+    }
+    return i;
+}
+
+static unsigned int downsampleRowRGB888NEON(const unsigned char* in, unsigned int srcPitch, unsigned char* out, unsigned int width)
+{
+    unsigned int i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        uint8x16x3_t row0 = vld3q_u8(in + i * 6);
+        uint8x16x3_t row1 = vld3q_u8(in + i * 6 + srcPitch);
+        uint8x8x3_t result;
+        for (int c = 0; c < 3; ++c)
+        {
+            uint16x8_t sum = vpadalq_u8(vpaddlq_u8(row0.val[c]), row1.val[c]);
+            result.val[c] = vshrn_n_u16(sum, 2);
+        }
+        vst3_u8(out + i * 3, result);
+    }
+    return i;
+}
+
+#endif // CC_PIXEL_KERNELS_NEON
+
+void CAPixelKernels::convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSSE3:
+            done = convertRGB888ToRGBA8888SSSE3(src, dst, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = convertRGB888ToRGBA8888NEON(src, dst, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertRGB888ToRGBA8888Scalar(src + done * 3, dst + done * 4, pixels - done);
+}
+
+void CAPixelKernels::convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSSE3:
+            done = convertRGBA8888ToRGB888SSSE3(src, dst, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = convertRGBA8888ToRGB888NEON(src, dst, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertRGBA8888ToRGB888Scalar(src + done * 4, dst + done * 3, pixels - done);
+}
+
+void CAPixelKernels::convertRGB888ToRGB565(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSSE3:
+            done = convertRGB888ToRGB565SSSE3(src, dst, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = convertToRGB565FromRGB888NEON(src, dst, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertToRGB565Scalar(src + done * 3, 3, dst + done * 2, pixels - done);
+}
+
+void CAPixelKernels::convertRGBA8888ToRGB565(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSE2:
+        case SSSE3:
+            done = convertRGBA8888ToRGB565SSE2(src, dst, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = convertToRGB565FromRGBA8888NEON(src, dst, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertToRGB565Scalar(src + done * 4, 4, dst + done * 2, pixels - done);
+}
+
+void CAPixelKernels::convertRGB888ToRGBA4444(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSSE3:
+            done = convertRGB888ToRGBA4444SSSE3(src, dst, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = convertToRGBA4444FromRGB888NEON(src, dst, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertToRGBA4444Scalar(src + done * 3, 3, dst + done * 2, pixels - done);
+}
+
+void CAPixelKernels::convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSE2:
+        case SSSE3:
+            done = convertRGBA8888ToRGBA4444SSE2(src, dst, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = convertToRGBA4444FromRGBA8888NEON(src, dst, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertToRGBA4444Scalar(src + done * 4, 4, dst + done * 2, pixels - done);
+}
+
+void CAPixelKernels::convertRGB888ToRGB5A1(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSSE3:
+            done = convertRGB888ToRGB5A1SSSE3(src, dst, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = convertToRGB5A1FromRGB888NEON(src, dst, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertToRGB5A1Scalar(src + done * 3, 3, dst + done * 2, pixels - done);
+}
+
+void CAPixelKernels::convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned char* dst, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSE2:
+        case SSSE3:
+            done = convertRGBA8888ToRGB5A1SSE2(src, dst, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = convertToRGB5A1FromRGBA8888NEON(src, dst, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertToRGB5A1Scalar(src + done * 4, 4, dst + done * 2, pixels - done);
+}
+
+void CAPixelKernels::premultiplyRGBA8888(unsigned char* data, unsigned long pixels)
+{
+    unsigned long done = 0;
+    switch (currentImplementation())
+    {
+#if CC_PIXEL_KERNELS_SSE
+        case SSE2:
+        case SSSE3:
+            done = premultiplyRGBA8888SSE2(data, pixels);
+            break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+        case NEON:
+            done = premultiplyRGBA8888NEON(data, pixels);
+            break;
+#endif
+        default:
+            break;
+    }
+    premultiplyRGBA8888Scalar(data + done * 4, pixels - done);
+}
+
+void CAPixelKernels::downsampleRGB888(const unsigned char* src, unsigned int srcPitch, unsigned char* dst, unsigned int dstPitch, unsigned int width, unsigned int height)
+{
+    Implementation implementation = currentImplementation();
+    for (unsigned int j = 0; j < height; ++j)
+    {
+        const unsigned char* in = src + (j << 1) * srcPitch;
+        unsigned char* out = dst + j * dstPitch;
+
+        unsigned int done = 0;
+        switch (implementation)
+        {
+#if CC_PIXEL_KERNELS_SSE
+            case SSSE3:
+                done = downsampleRowRGB888SSSE3(in, srcPitch, out, width);
+                break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+            case NEON:
+                done = downsampleRowRGB888NEON(in, srcPitch, out, width);
+                break;
+#endif
+            default:
+                break;
+        }
+        downsampleRowScalar(in, srcPitch, out, 3, done, width);
+    }
+}
+
+void CAPixelKernels::downsampleRGBA8888(const unsigned char* src, unsigned int srcPitch, unsigned char* dst, unsigned int dstPitch, unsigned int width, unsigned int height)
+{
+    Implementation implementation = currentImplementation();
+    for (unsigned int j = 0; j < height; ++j)
+    {
+        const unsigned char* in = src + (j << 1) * srcPitch;
+        unsigned char* out = dst + j * dstPitch;
+
+        unsigned int done = 0;
+        switch (implementation)
+        {
+#if CC_PIXEL_KERNELS_SSE
+            case SSE2:
+            case SSSE3:
+                done = downsampleRowRGBA8888SSE2(in, srcPitch, out, width);
+                break;
+#endif
+#if CC_PIXEL_KERNELS_NEON
+            case NEON:
+                done = downsampleRowRGBA8888NEON(in, srcPitch, out, width);
+                break;
+#endif
+            default:
+                break;
+        }
+        downsampleRowScalar(in, srcPitch, out, 4, done, width);
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,79 @@
+//
+//  CAPixelKernels.h
+//  CrossApp
+//
+//  Copyright (c) 2014 http://9miao.com All rights reserved.
+//
+
+#ifndef __CAPIXEL_KERNELS_H__
+#define __CAPIXEL_KERNELS_H__
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * Pixel format conversion, alpha premultiplication and 2x2 box downsampling
+ * for CAImage. Every kernel has a scalar reference and, where the target has
+ * them, SSE2, SSSE3 or NEON versions chosen once at runtime. All versions give
+ * bit-identical results.
+ *
+ * Pixel counts are in pixels, not bytes. Buffers need no particular alignment.
+ */
+class CC_DLL CAPixelKernels
+{
+public:
+
+    typedef enum
+    {
+        Scalar = 0,
+        SSE2,
+        SSSE3,
+        NEON
+    }Implementation;
+
+    /** the best implementation the CPU supports */
+    static Implementation getSupportedImplementation();
+
+    static Implementation getImplementation();
+
+    /** forces an implementation, e.g. Scalar to compare against; unsupported ones fall back to the best supported */
+    static void setImplementation(Implementation implementation);
+
+    // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
+    static void convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, unsigned long pixels);
+
+    // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
+    static void convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, unsigned long pixels);
+
+    // RRRRRRRRGGGGGGGGBBBBBBBB(AAAAAAAA) -> RRRRRGGGGGGBBBBB
+    static void convertRGB888ToRGB565(const unsigned char* src, unsigned char* dst, unsigned long pixels);
+
+    static void convertRGBA8888ToRGB565(const unsigned char* src, unsigned char* dst, unsigned long pixels);
+
+    // RRRRRRRRGGGGGGGGBBBBBBBB(AAAAAAAA) -> RRRRGGGGBBBBAAAA
+    static void convertRGB888ToRGBA4444(const unsigned char* src, unsigned char* dst, unsigned long pixels);
+
+    static void convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned char* dst, unsigned long pixels);
+
+    // RRRRRRRRGGGGGGGGBBBBBBBB(AAAAAAAA) -> RRRRRGGGGGBBBBBA
+    static void convertRGB888ToRGB5A1(const unsigned char* src, unsigned char* dst, unsigned long pixels);
+
+    static void convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned char* dst, unsigned long pixels);
+
+    /** c = c * (a + 1) >> 8 for r, g and b, in place */
+    static void premultiplyRGBA8888(unsigned char* data, unsigned long pixels);
+
+    /**
+     * Averages 2x2 blocks of src into dst, (a + b + c + d) >> 2 per channel.
+     * width and height are the size of dst, src rows are srcPitch bytes apart
+     * and dst rows dstPitch bytes apart.
+     */
+    static void downsampleRGB888(const unsigned char* src, unsigned int srcPitch, unsigned char* dst, unsigned int dstPitch, unsigned int width, unsigned int height);
+
+    static void downsampleRGBA8888(const unsigned char* src, unsigned int srcPitch, unsigned char* dst, unsigned int dstPitch, unsigned int width, unsigned int height);
+};
+
+NS_CC_END
+
+#endif // __CAPIXEL_KERNELS_H__
@@ -1,4 +1,5 @@
 #include "math/CAMathUtil.h"
+#include "math/CAMat4.h"
 #include "ccMacros.h"
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
@@ -255,4 +256,35 @@ void MathUtil::crossVec3(const float* v1, const float* v2, float* dst)
 #endif
 }
 
+void MathUtil::transformQuads(const float* m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::transformQuads(m, src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformQuads(m, src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformQuads(m, src, dst, count);
+    else MathUtilC::transformQuads(m, src, dst, count);
+#else
+    MathUtilC::transformQuads(m, src, dst, count);
+#endif
+}
+
+void MathUtil::transformQuads(const Mat4& m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count)
+{
+#ifdef USE_SSE
+    MathUtil::transformQuads(m.col, src, dst, count);
+#else
+    MathUtil::transformQuads(m.m.mat, src, dst, count);
+#endif
+}
+
+void MathUtil::transformQuads(const Mat4* m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        MathUtil::transformQuads(m[i], src + i, dst + i, 1);
+    }
+}
+
 NS_CC_END
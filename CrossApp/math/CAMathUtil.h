@@ -7,6 +7,7 @@
 #endif
 
 #include "math/CAMathBase.h"
+#include "ccTypes.h"
 
 /**
  * @addtogroup base
@@ -15,6 +16,8 @@
 
 NS_CC_BEGIN
 
+class Mat4;
+
 /**
  * Defines a math utility class.
  *
@@ -67,6 +70,27 @@ public:
      * @return interpolated float value
      */
     static float lerp(float from, float to, float alpha);
+    
+    /**
+     * Transforms the vertex positions of an array of quads by one matrix (w = 1).
+     * Colors and texture coordinates are copied unchanged, src and dst may be the same array.
+     *
+     * @param m the transform matrix.
+     * @param src the quads to transform.
+     * @param dst the transformed quads.
+     * @param count the number of quads.
+     */
+    static void transformQuads(const Mat4& m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count);
+    
+    /**
+     * Transforms the vertex positions of src[i] by m[i] for each of the count quads.
+     *
+     * @param m the transform matrices, one per quad.
+     * @param src the quads to transform.
+     * @param dst the transformed quads.
+     * @param count the number of quads.
+     */
+    static void transformQuads(const Mat4* m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count);
 private:
     //Indicates that if neon is enabled
     static bool isNeon32Enabled();
@@ -88,6 +112,8 @@ private:
     static void transposeMatrix(const __m128 m[4], __m128 dst[4]);
         
     static void transformVec4(const __m128 m[4], const __m128& v, __m128& dst);
+    
+    static void transformQuads(const __m128 m[4], const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count);
 #endif
     static void addMatrix(const float* m, float scalar, float* dst);
 
@@ -108,6 +134,8 @@ private:
     static void transformVec4(const float* m, const float* v, float* dst);
 
     static void crossVec3(const float* v1, const float* v2, float* dst);
+    
+    static void transformQuads(const float* m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count);
 
 };
 
@@ -23,6 +23,8 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+    
+    inline static void transformQuads(const float* m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count);
 };
 
 inline void MathUtilC::addMatrix(const float* m, float scalar, float* dst)
@@ -196,4 +198,25 @@ inline void MathUtilC::crossVec3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+inline void MathUtilC::transformQuads(const float* m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] = src[i];
+        
+        // tl, bl, tr, br are laid out back to back
+        ccV3F_C4B_T2F* v = &dst[i].tl;
+        for (int j = 0; j < 4; ++j)
+        {
+            float x = v[j].vertices.x;
+            float y = v[j].vertices.y;
+            float z = v[j].vertices.z;
+            
+            v[j].vertices.x = x * m[0] + y * m[4] + z * m[8] + m[12];
+            v[j].vertices.y = x * m[1] + y * m[5] + z * m[9] + m[13];
+            v[j].vertices.z = x * m[2] + y * m[6] + z * m[10] + m[14];
+        }
+    }
+}
+
 NS_CC_END
@@ -1,4 +1,6 @@
 
+#include <arm_neon.h>
+
 NS_CC_BEGIN
 
 class MathUtilNeon64
@@ -23,6 +25,8 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+    
+    inline static void transformQuads(const float* m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count);
 };
 
 inline void MathUtilNeon64::addMatrix(const float* m, float scalar, float* dst)
@@ -243,4 +247,31 @@ inline void MathUtilNeon64::crossVec3(const float* v1, const float* v2, float* d
     );
 }
 
+inline void MathUtilNeon64::transformQuads(const float* m, const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count)
+{
+    float32x4_t c0 = vld1q_f32(m);
+    float32x4_t c1 = vld1q_f32(m + 4);
+    float32x4_t c2 = vld1q_f32(m + 8);
+    float32x4_t c3 = vld1q_f32(m + 12);
+    
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] = src[i];
+        
+        // tl, bl, tr, br are laid out back to back
+        ccV3F_C4B_T2F* v = &dst[i].tl;
+        for (int j = 0; j < 4; ++j)
+        {
+            float* p = &v[j].vertices.x;
+            
+            float32x4_t r = vmlaq_n_f32(c3, c0, p[0]);
+            r = vmlaq_n_f32(r, c1, p[1]);
+            r = vmlaq_n_f32(r, c2, p[2]);
+            
+            vst1_f32(p, vget_low_f32(r));   // V[x, y]
+            vst1q_lane_f32(p + 2, r, 2);    // V[z]
+        }
+    }
+}
+
 NS_CC_END
@@ -151,6 +151,29 @@ void MathUtil::transformVec4(const __m128 m[4], const __m128& v, __m128& dst)
                      );
 }
 
+void MathUtil::transformQuads(const __m128 m[4], const ccV3F_C4B_T2F_Quad* src, ccV3F_C4B_T2F_Quad* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] = src[i];
+        
+        // tl, bl, tr, br are laid out back to back
+        ccV3F_C4B_T2F* v = &dst[i].tl;
+        for (int j = 0; j < 4; ++j)
+        {
+            float* p = &v[j].vertices.x;
+            
+            __m128 r = _mm_add_ps(
+                                  _mm_add_ps(_mm_mul_ps(m[0], _mm_set1_ps(p[0])), _mm_mul_ps(m[1], _mm_set1_ps(p[1]))),
+                                  _mm_add_ps(_mm_mul_ps(m[2], _mm_set1_ps(p[2])), m[3])
+                                  );
+            
+            _mm_storel_pi((__m64*)p, r);                // V[x, y]
+            _mm_store_ss(p + 2, _mm_movehl_ps(r, r));   // V[z]
+        }
+    }
+}
+
 #endif
 
 
@@ -61,6 +61,10 @@ unsigned char* CAEmojiFont::loadEmojiFontBuffer(unsigned long& size)
 #elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 
 	const char* fontName = "/system/fonts/NotoColorEmoji.ttf";
+
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+
+	const char* fontName = "/usr/share/fonts/truetype/noto/NotoColorEmoji.ttf";
     
 #endif
 
@@ -1,12 +1,14 @@
 #include "platform/CAFileUtils.h"
 
 #include <stack>
+#include <algorithm>
+#include <limits.h>
 #include "ccMacros.h"
 #include "basics/CAApplication.h"
 #include "platform/CASAXParser.h"
 #include "support/ccUtils.h"
 #include "support/tinyxml2/tinyxml2.h"
-#include "support/zip_support/unzip.h"
+#include "support/zip_support/ZipArchive.h"
 
 #include <sys/stat.h>
 
@@ -55,6 +57,9 @@ public:
 public:
     DictMaker()
         : _resultType(SAX_RESULT_NONE)
+        , _state(SAX_NONE)
+        , _curDict(nullptr)
+        , _curArray(nullptr)
     {
     }
 
@@ -62,18 +67,6 @@ public:
     {
     }
 
-    CAValueMap dictionaryWithContentsOfFile(const std::string& fileName)
-    {
-        _resultType = SAX_RESULT_DICT;
-        SAXParser parser;
-
-        CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
-        parser.setDelegator(this);
-
-        parser.parse(fileName);
-        return _rootDict;
-    }
-
     CAValueMap dictionaryWithDataOfFile(const char* filedata, int filesize)
     {
         _resultType = SAX_RESULT_DICT;
@@ -83,10 +76,10 @@ public:
         parser.setDelegator(this);
 
         parser.parse(filedata, filesize);
-        return _rootDict;
+        return std::move(_rootDict);
     }
 
-    CAValueVector arrayWithContentsOfFile(const std::string& fileName)
+    CAValueVector arrayWithDataOfFile(const char* filedata, int filesize)
     {
         _resultType = SAX_RESULT_ARRAY;
         SAXParser parser;
@@ -94,8 +87,8 @@ public:
         CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
         parser.setDelegator(this);
 
-        parser.parse(fileName.c_str());
-        return _rootArray;
+        parser.parse(filedata, filesize);
+        return std::move(_rootArray);
     }
 
     void startElement(void *ctx, const char *name, const char **atts)
@@ -270,12 +263,11 @@ public:
         }
 
         SAXState curState = _stateStack.empty() ? SAX_DICT : _stateStack.top();
-        const std::string text = std::string((char*)ch,len);
 
         switch(_state)
         {
         case SAX_KEY:
-            _curKey = text;
+            _curKey.assign(ch, len);
             break;
         case SAX_INT:
         case SAX_REAL:
@@ -286,7 +278,7 @@ public:
                     CCASSERT(!_curKey.empty(), "key not found : <integer/real>");
                 }
 
-                _curValue.append(text);
+                _curValue.append(ch, len);
             }
             break;
         default:
@@ -295,15 +287,286 @@ public:
     }
 };
 
+// Reads the binary property lists written by "plutil -convert binary1" or plistlib.
+// The objects are built directly, without the XML text and DOM in between.
+class BinaryPlistReader
+{
+public:
+
+    static bool isBinaryPlist(const char* data, size_t size)
+    {
+        return data && size >= 8 + 32 && memcmp(data, "bplist00", 8) == 0;
+    }
+
+    bool parse(const char* data, size_t size, CAValue& root)
+    {
+        CC_RETURN_IF(!isBinaryPlist(data, size)) false;
+        _data = (const unsigned char*)data;
+
+        const unsigned char* trailer = _data + size - 32;
+        _offsetSize = trailer[6];
+        _refSize = trailer[7];
+        unsigned long long objectCount = readInteger(trailer + 8, 8);
+        unsigned long long topObject = readInteger(trailer + 16, 8);
+        unsigned long long tableOffset = readInteger(trailer + 24, 8);
+
+        CC_RETURN_IF(_offsetSize < 1 || _offsetSize > 8 || _refSize < 1 || _refSize > 8) false;
+        CC_RETURN_IF(tableOffset < 8 || tableOffset > size - 32) false;
+        CC_RETURN_IF(objectCount == 0 || objectCount > (size - 32 - tableOffset) / _offsetSize || topObject >= objectCount) false;
+
+        _objectCount = objectCount;
+        _objectsEnd = (size_t)tableOffset;
+        _offsetTable = _data + tableOffset;
+        // shared objects are read once per reference, this bounds what a hostile file can expand to
+        _budget = (size + objectCount) * 4;
+        return readObject(topObject, 0, root);
+    }
+
+private:
+
+    static unsigned long long readInteger(const unsigned char* p, size_t size)
+    {
+        unsigned long long value = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            value = (value << 8) | p[i];
+        }
+        return value;
+    }
+
+    // the length in the low nibble of a marker, or an integer object after it when it is 0xF
+    bool readLength(size_t& position, unsigned char marker, unsigned long long& length)
+    {
+        length = marker & 0x0F;
+        CC_RETURN_IF(length != 0x0F) true;
+
+        CC_RETURN_IF(position >= _objectsEnd || (_data[position] & 0xF0) != 0x10) false;
+        size_t size = (size_t)1 << (_data[position] & 0x0F);
+        CC_RETURN_IF(size > 8 || _objectsEnd - position - 1 < size) false;
+        length = readInteger(_data + position + 1, size);
+        position += 1 + size;
+        return true;
+    }
+
+    bool readObject(unsigned long long ref, int depth, CAValue& out)
+    {
+        CC_RETURN_IF(ref >= _objectCount || depth > 512 || _budget == 0) false;
+        --_budget;
+
+        size_t position = (size_t)readInteger(_offsetTable + ref * _offsetSize, _offsetSize);
+        CC_RETURN_IF(position < 8 || position >= _objectsEnd) false;
+
+        unsigned char marker = _data[position++];
+        size_t available = _objectsEnd - position;
+        switch (marker >> 4)
+        {
+            case 0x0:
+            {
+                if (marker == 0x08 || marker == 0x09)
+                {
+                    out = CAValue(marker == 0x09);
+                    return true;
+                }
+                out = CAValue();
+                return marker == 0x00;
+            }
+            case 0x1:
+            {
+                // 1, 2 and 4 byte integers are unsigned, 8 byte ones signed, of 16 byte ones the low half is kept
+                size_t size = (size_t)1 << (marker & 0x0F);
+                CC_RETURN_IF(size > 16 || available < size) false;
+                long long value = (long long)readInteger(_data + position + (size > 8 ? size - 8 : 0), std::min(size, (size_t)8));
+                if (value >= INT_MIN && value <= INT_MAX)
+                {
+                    out = CAValue((int)value);
+                }
+                else
+                {
+                    out = CAValue((double)value);
+                }
+                return true;
+            }
+            case 0x2:
+            case 0x3:
+            {
+                // reals, and dates as seconds since 2001
+                size_t size = (size_t)1 << (marker & 0x0F);
+                CC_RETURN_IF((size != 4 && size != 8) || available < size || (marker >> 4 == 0x3 && size != 8)) false;
+                unsigned long long bits = readInteger(_data + position, size);
+                if (size == 4)
+                {
+                    unsigned int bits32 = (unsigned int)bits;
+                    float value = 0;
+                    memcpy(&value, &bits32, sizeof(value));
+                    out = CAValue((double)value);
+                }
+                else
+                {
+                    double value = 0;
+                    memcpy(&value, &bits, sizeof(value));
+                    out = CAValue(value);
+                }
+                return true;
+            }
+            case 0x4:
+            case 0x5:
+            case 0x6:
+            {
+                // data is kept as the raw bytes; _text is reused so only long strings allocate
+                CC_RETURN_IF(!readString(position, marker, _text)) false;
+                out = _text;
+                return true;
+            }
+            case 0x8:
+            {
+                // a keyed archiver UID
+                size_t size = (size_t)(marker & 0x0F) + 1;
+                CC_RETURN_IF(available < size) false;
+                out = CAValue((int)readInteger(_data + position, std::min(size, (size_t)4)));
+                return true;
+            }
+            case 0xA:
+            case 0xC:
+            {
+                // arrays and sets
+                unsigned long long count = 0;
+                CC_RETURN_IF(!readLength(position, marker, count)) false;
+                CC_RETURN_IF(count > (_objectsEnd - position) / _refSize) false;
+                CAValueVector array;
+                array.reserve((size_t)count);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    CAValue element;
+                    CC_RETURN_IF(!readObject(readInteger(_data + position + i * _refSize, _refSize), depth + 1, element)) false;
+                    array.push_back(std::move(element));
+                }
+                out = std::move(array);
+                return true;
+            }
+            case 0xD:
+            {
+                unsigned long long count = 0;
+                CC_RETURN_IF(!readLength(position, marker, count)) false;
+                CC_RETURN_IF(count > (_objectsEnd - position) / _refSize / 2) false;
+                CAValueMap dict;
+                dict.reserve((size_t)count);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    // the value first, reading it reuses _text
+                    CAValue value;
+                    CC_RETURN_IF(!readObject(readInteger(_data + position + (count + i) * _refSize, _refSize), depth + 1, value)) false;
+                    CC_RETURN_IF(!readKey(readInteger(_data + position + i * _refSize, _refSize), _text)) false;
+                    dict[_text] = std::move(value);
+                }
+                out = std::move(dict);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    bool readKey(unsigned long long ref, std::string& text)
+    {
+        CC_RETURN_IF(ref >= _objectCount) false;
+        size_t position = (size_t)readInteger(_offsetTable + ref * _offsetSize, _offsetSize);
+        CC_RETURN_IF(position < 8 || position >= _objectsEnd) false;
+        unsigned char marker = _data[position++];
+        CC_RETURN_IF((marker >> 4) != 0x5 && (marker >> 4) != 0x6) false;
+        return readString(position, marker, text);
+    }
+
+    // an ASCII (0x5) or UTF-16 (0x6) string, or data (0x4), as UTF-8
+    bool readString(size_t position, unsigned char marker, std::string& text)
+    {
+        unsigned long long length = 0;
+        CC_RETURN_IF(!readLength(position, marker, length)) false;
+        if ((marker >> 4) != 0x6)
+        {
+            CC_RETURN_IF(length > _objectsEnd - position) false;
+            text.assign((const char*)_data + position, (size_t)length);
+            return true;
+        }
+
+        CC_RETURN_IF(length > (_objectsEnd - position) / 2) false;
+        text.clear();
+        for (size_t i = 0; i < length; ++i)
+        {
+            unsigned int code = (unsigned int)readInteger(_data + position + i * 2, 2);
+            if (code >= 0xD800 && code <= 0xDBFF && i + 1 < length)
+            {
+                unsigned int low = (unsigned int)readInteger(_data + position + i * 2 + 2, 2);
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    ++i;
+                }
+            }
+            appendUTF8(text, code);
+        }
+        return true;
+    }
+
+    static void appendUTF8(std::string& text, unsigned int code)
+    {
+        if (code < 0x80)
+        {
+            text.push_back((char)code);
+        }
+        else if (code < 0x800)
+        {
+            text.push_back((char)(0xC0 | (code >> 6)));
+            text.push_back((char)(0x80 | (code & 0x3F)));
+        }
+        else if (code < 0x10000)
+        {
+            text.push_back((char)(0xE0 | (code >> 12)));
+            text.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+            text.push_back((char)(0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            text.push_back((char)(0xF0 | (code >> 18)));
+            text.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+            text.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+            text.push_back((char)(0x80 | (code & 0x3F)));
+        }
+    }
+
+private:
+
+    const unsigned char* _data;
+    const unsigned char* _offsetTable;
+    size_t _objectsEnd;
+    unsigned long long _objectCount;
+    unsigned long long _budget;
+    size_t _offsetSize;
+    size_t _refSize;
+    std::string _text;
+};
+
 CAValueMap FileUtils::getValueMapFromFile(const std::string& filename)
 {
     const std::string fullPath = fullPathForFilename(filename);
-    DictMaker tMaker;
-    return tMaker.dictionaryWithContentsOfFile(fullPath);
+    CAFileBuffer buffer = getFileBuffer(fullPath);
+    CC_RETURN_IF(buffer.isNull()) CAValueMap();
+    return getValueMapFromData((const char*)buffer.getBytes(), (int)buffer.getSize());
 }
 
 CAValueMap FileUtils::getValueMapFromData(const char* filedata, int filesize)
 {
+    if (BinaryPlistReader::isBinaryPlist(filedata, filesize))
+    {
+        BinaryPlistReader reader;
+        CAValue root;
+        if (reader.parse(filedata, filesize, root) && root.getType() == CAValue::Type::MAP)
+        {
+            return std::move(root.asValueMap());
+        }
+        CCLOG("FileUtils: invalid binary plist");
+        return CAValueMap();
+    }
+
     DictMaker tMaker;
     return tMaker.dictionaryWithDataOfFile(filedata, filesize);
 }
@@ -311,8 +574,24 @@ CAValueMap FileUtils::getValueMapFromData(const char* filedata, int filesize)
 CAValueVector FileUtils::getValueVectorFromFile(const std::string& filename)
 {
     const std::string fullPath = fullPathForFilename(filename);
+    CAFileBuffer buffer = getFileBuffer(fullPath);
+    CC_RETURN_IF(buffer.isNull()) CAValueVector();
+
+    const char* data = (const char*)buffer.getBytes();
+    if (BinaryPlistReader::isBinaryPlist(data, buffer.getSize()))
+    {
+        BinaryPlistReader reader;
+        CAValue root;
+        if (reader.parse(data, buffer.getSize(), root) && root.getType() == CAValue::Type::VECTOR)
+        {
+            return std::move(root.asValueVector());
+        }
+        CCLOG("FileUtils: invalid binary plist %s", fullPath.c_str());
+        return CAValueVector();
+    }
+
     DictMaker tMaker;
-    return tMaker.arrayWithContentsOfFile(fullPath);
+    return tMaker.arrayWithDataOfFile(data, (int)buffer.getSize());
 }
 
 
@@ -365,6 +644,10 @@ bool FileUtils::writeValueMapToFile(const CAValueMap& dict, const std::string& f
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+    {
+        this->fileCreated(fullPath);
+    }
 
     delete doc;
     return ret;
@@ -405,6 +688,10 @@ bool FileUtils::writeValueVectorToFile(const CAValueVector& vecData, const std::
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+    {
+        this->fileCreated(fullPath);
+    }
 
     delete doc;
     return ret;
@@ -509,6 +796,78 @@ bool FileUtils::writeToFile(const CAValueMap& dict, const std::string &fullPath)
 // Implement FileUtils
 FileUtils* FileUtils::s_sharedFileUtils = nullptr;
 
+CAFileBuffer::CAFileBuffer()
+: m_pBytes(NULL)
+, m_uSize(0)
+, m_pDeleter(NULL)
+{
+}
+
+CAFileBuffer::CAFileBuffer(unsigned char* bytes, unsigned long size, Deleter deleter)
+: m_pBytes(bytes)
+, m_uSize(bytes ? size : 0)
+, m_pDeleter(deleter)
+{
+}
+
+CAFileBuffer::CAFileBuffer(CAFileBuffer&& other)
+: m_pBytes(other.m_pBytes)
+, m_uSize(other.m_uSize)
+, m_pDeleter(other.m_pDeleter)
+{
+    other.m_pBytes = NULL;
+    other.m_uSize = 0;
+    other.m_pDeleter = NULL;
+}
+
+CAFileBuffer& CAFileBuffer::operator= (CAFileBuffer&& other)
+{
+    if (this != &other)
+    {
+        this->clear();
+        m_pBytes = other.m_pBytes;
+        m_uSize = other.m_uSize;
+        m_pDeleter = other.m_pDeleter;
+        other.m_pBytes = NULL;
+        other.m_uSize = 0;
+        other.m_pDeleter = NULL;
+    }
+    return *this;
+}
+
+CAFileBuffer::~CAFileBuffer()
+{
+    this->clear();
+}
+
+CAFileBuffer CAFileBuffer::copy(const unsigned char* bytes, unsigned long size)
+{
+    unsigned char* data = (unsigned char*)malloc(size > 0 ? size : 1);
+    if (data && size > 0)
+    {
+        memcpy(data, bytes, size);
+    }
+    return CAFileBuffer(data, size);
+}
+
+void CAFileBuffer::clear()
+{
+    if (m_pBytes)
+    {
+        if (m_pDeleter)
+        {
+            m_pDeleter(m_pBytes);
+        }
+        else
+        {
+            free(m_pBytes);
+        }
+    }
+    m_pBytes = NULL;
+    m_uSize = 0;
+    m_pDeleter = NULL;
+}
+
 void FileUtils::destroyInstance()
 {
     CC_SAFE_DELETE(s_sharedFileUtils);
@@ -523,12 +882,25 @@ void FileUtils::setDelegate(FileUtils *delegate)
 }
 
 FileUtils::FileUtils()
-    : _writablePath("")
+    : _missingPathGeneration(0)
+    , _resourceIndexLoaded(false)
+    , _fileSystemProbes(0)
+    , _writablePath("")
+    , _asyncQueue(NULL)
 {
+    pthread_mutex_init(&_archivesMutex, NULL);
+    pthread_mutex_init(&_fullPathCacheMutex, NULL);
+    pthread_mutex_init(&_asyncQueueMutex, NULL);
 }
 
 FileUtils::~FileUtils()
 {
+    // the queued writes are finished first
+    this->destroyAsyncQueue();
+    _mountedArchives.clear();
+    pthread_mutex_destroy(&_archivesMutex);
+    pthread_mutex_destroy(&_fullPathCacheMutex);
+    pthread_mutex_destroy(&_asyncQueueMutex);
 }
 
 bool FileUtils::writeStringToFile(const std::string& dataStr, const std::string& fullPath)
@@ -553,6 +925,7 @@ bool FileUtils::writeDataToFile(unsigned char* data, size_t lenght, const std::s
 
         fclose(fp);
 
+        this->fileCreated(fullPath);
         return true;
     } while (0);
 
@@ -568,23 +941,145 @@ bool FileUtils::init()
 
 void FileUtils::purgeCachedEntries()
 {
+    pthread_mutex_lock(&_fullPathCacheMutex);
+    _fullPathCache.clear();
+    _missingPathCache.clear();
+    ++_missingPathGeneration;
+    pthread_mutex_unlock(&_fullPathCacheMutex);
+}
+
+void FileUtils::purgeMissingEntries()
+{
+    pthread_mutex_lock(&_fullPathCacheMutex);
+    _missingPathCache.clear();
+    ++_missingPathGeneration;
+    pthread_mutex_unlock(&_fullPathCacheMutex);
+}
+
+bool FileUtils::loadResourceIndex(const std::string& indexFile)
+{
+    this->removeResourceIndex();
+
+    std::string data = getFileString(indexFile);
+    if (data.empty())
+    {
+        CCLOG("CrossApp: loadResourceIndex: can't read %s", indexFile.c_str());
+        return false;
+    }
+
+    std::unordered_set<std::string> index;
+    size_t start = 0;
+    while (start < data.length())
+    {
+        size_t end = data.find('\n', start);
+        if (end == std::string::npos)
+        {
+            end = data.length();
+        }
+
+        size_t last = end;
+        while (last > start && (data[last - 1] == '\r' || data[last - 1] == ' '))
+        {
+            --last;
+        }
+        if (last > start && data[start] != '#')
+        {
+            index.insert(data.substr(start, last - start));
+        }
+        start = end + 1;
+    }
+
+    pthread_mutex_lock(&_fullPathCacheMutex);
+    _resourceIndex.swap(index);
+    _resourceIndexLoaded = true;
     _fullPathCache.clear();
+    _missingPathCache.clear();
+    ++_missingPathGeneration;
+    pthread_mutex_unlock(&_fullPathCacheMutex);
+
+    CCLOG("CrossApp: loadResourceIndex: %u files", (unsigned int)_resourceIndex.size());
+    return true;
+}
+
+void FileUtils::removeResourceIndex()
+{
+    pthread_mutex_lock(&_fullPathCacheMutex);
+    _resourceIndex.clear();
+    _resourceIndexLoaded = false;
+    _missingPathCache.clear();
+    ++_missingPathGeneration;
+    pthread_mutex_unlock(&_fullPathCacheMutex);
+}
+
+bool FileUtils::isExcludedByResourceIndex(const std::string& searchPath, const std::string& path) const
+{
+    // only the bundled files are indexed, search paths elsewhere (the writable path...) are probed
+    if (searchPath.compare(0, _defaultResRootPath.length(), _defaultResRootPath) != 0)
+    {
+        return false;
+    }
+    if (_defaultResRootPath.empty() && isAbsolutePath(searchPath))
+    {
+        return false;
+    }
+
+    std::string relativePath = searchPath.substr(_defaultResRootPath.length()) + path;
+
+    pthread_mutex_lock(&_fullPathCacheMutex);
+    bool excluded = _resourceIndexLoaded && _resourceIndex.find(relativePath) == _resourceIndex.end();
+    pthread_mutex_unlock(&_fullPathCacheMutex);
+    return excluded;
+}
+
+void FileUtils::fileCreated(const std::string& fullPath)
+{
+    pthread_mutex_lock(&_fullPathCacheMutex);
+    _missingPathCache.clear();
+    ++_missingPathGeneration;
+    if (_resourceIndexLoaded
+        && !_defaultResRootPath.empty()
+        && fullPath.compare(0, _defaultResRootPath.length(), _defaultResRootPath) == 0)
+    {
+        _resourceIndex.insert(fullPath.substr(_defaultResRootPath.length()));
+    }
+    pthread_mutex_unlock(&_fullPathCacheMutex);
 }
 
 std::string FileUtils::getFileString(const std::string& pszFilePath)
 {
     std::string data;
-    unsigned long pSize = 0;
-    unsigned char* pData = this->getFileData(pszFilePath, "rb", &pSize);
+    CAFileBuffer buffer = this->getFileBuffer(pszFilePath);
     
-    if (pSize > 0)
+    if (buffer.getSize() > 0)
     {
-        data.resize(pSize);
-        memcpy(&data[0], pData, pSize);
+        data.assign((const char*)buffer.getBytes(), buffer.getSize());
     }
     return data;
 }
 
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+// FileUtilsAndroid::getFileData allocates with new[]
+static void deleteFileData(unsigned char* bytes)
+{
+    delete[] bytes;
+}
+#endif
+
+CAFileBuffer FileUtils::getFileBuffer(const std::string& filename)
+{
+    unsigned long size = 0;
+    unsigned char* data = this->getFileData(filename, "rb", &size);
+    if (data == NULL)
+    {
+        return CAFileBuffer();
+    }
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    return CAFileBuffer(data, size, deleteFileData);
+#else
+    return CAFileBuffer(data, size);
+#endif
+}
+
 unsigned char* FileUtils::getFileData(const std::string& filename, const char* mode, unsigned long *size)
 {
     unsigned char * buffer = nullptr;
@@ -593,6 +1088,12 @@ unsigned char* FileUtils::getFileData(const std::string& filename, const char* m
     {
         // read the file from hardware
         const std::string fullPath = fullPathForFilename(filename);
+        if (getArchiveForFullPath(fullPath, nullptr))
+        {
+            buffer = getFileDataFromArchive(fullPath, size);
+            break;
+        }
+
         FILE *fp = fopen(getSuitableFOpen(fullPath).c_str(), mode);
         CC_BREAK_IF(!fp);
 
@@ -617,45 +1118,191 @@ unsigned char* FileUtils::getFileData(const std::string& filename, const char* m
 unsigned char* FileUtils::getFileDataFromZip(const std::string& zipFilePath, const std::string& filename, unsigned long *size)
 {
     unsigned char * buffer = nullptr;
-    unzFile file = nullptr;
     *size = 0;
 
     do
     {
         CC_BREAK_IF(zipFilePath.empty());
 
-        file = unzOpen(FileUtils::getInstance()->getSuitableFOpen(zipFilePath).c_str());
-        CC_BREAK_IF(!file);
+        // a mounted archive is already indexed, anything else is opened for this one file
+        std::shared_ptr<ZipArchive> archive = getArchiveForFullPath(zipFilePath + "/" + filename, nullptr);
+        if (!archive)
+        {
+            archive = std::make_shared<ZipArchive>();
+            CC_BREAK_IF(!archive->open(zipFilePath));
+        }
 
-        // FIXME: Other platforms should use upstream minizip like mingw-w64
-#ifdef MINIZIP_FROM_SYSTEM
-        int ret = unzLocateFile(file, filename.c_str(), NULL);
-#else
-        int ret = unzLocateFile(file, filename.c_str(), 1);
-#endif
-        CC_BREAK_IF(UNZ_OK != ret);
+        long fileSize = archive->getFileSize(filename);
+        CC_BREAK_IF(fileSize < 0);
 
-        char filePathA[260];
-        unz_file_info fileInfo;
-        ret = unzGetCurrentFileInfo(file, &fileInfo, filePathA, sizeof(filePathA), nullptr, 0, nullptr, 0);
-        CC_BREAK_IF(UNZ_OK != ret);
+        buffer = (unsigned char*)malloc(fileSize > 0 ? fileSize : 1);
+        if (!archive->readFile(filename, buffer, (unsigned long)fileSize))
+        {
+            free(buffer);
+            buffer = nullptr;
+            break;
+        }
+        *size = (unsigned long)fileSize;
+    } while (0);
 
-        ret = unzOpenCurrentFile(file);
-        CC_BREAK_IF(UNZ_OK != ret);
+    return buffer;
+}
 
-        buffer = (unsigned char*)malloc(fileInfo.uncompressed_size);
-        int CC_UNUSED readedSize = unzReadCurrentFile(file, buffer, static_cast<unsigned>(fileInfo.uncompressed_size));
-        CCASSERT(readedSize == 0 || readedSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
+bool FileUtils::mountArchive(const std::string& archivePath, const std::string& root)
+{
+    CCASSERT(!archivePath.empty(), "Invalid path");
 
-        *size = fileInfo.uncompressed_size;
-        unzCloseCurrentFile(file);
-    } while (0);
+    std::string path = isAbsolutePath(archivePath) ? archivePath : fullPathForFilename(archivePath);
+    if (path.empty())
+    {
+        return false;
+    }
 
-    if (file)
+    std::shared_ptr<ZipArchive> archive = std::make_shared<ZipArchive>();
+    if (!archive->open(path))
     {
-        unzClose(file);
+        CCLOG("CrossApp: mountArchive: can't open %s", archivePath.c_str());
+        return false;
     }
 
+    MountedArchive mounted;
+    mounted.path = path;
+    mounted.root = root;
+    if (!mounted.root.empty() && mounted.root[mounted.root.length() - 1] != '/')
+    {
+        mounted.root += '/';
+    }
+    mounted.archive = archive;
+
+    this->unmountArchive(path);
+
+    pthread_mutex_lock(&_archivesMutex);
+    _mountedArchives.push_back(mounted);
+    pthread_mutex_unlock(&_archivesMutex);
+
+    // names that were missing may be found in the archive now
+    this->purgeCachedEntries();
+    return true;
+}
+
+void FileUtils::unmountArchive(const std::string& archivePath)
+{
+    std::string path = isAbsolutePath(archivePath) ? archivePath : fullPathForFilename(archivePath);
+
+    bool unmounted = false;
+    pthread_mutex_lock(&_archivesMutex);
+    for (auto it = _mountedArchives.begin(); it != _mountedArchives.end(); ++it)
+    {
+        if (it->path == path)
+        {
+            // readers still holding the archive keep it open until they are done
+            _mountedArchives.erase(it);
+            unmounted = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_archivesMutex);
+
+    if (unmounted)
+    {
+        this->purgeCachedEntries();
+    }
+}
+
+const unsigned char* FileUtils::getFileDataView(const std::string& filename, unsigned long *size)
+{
+    *size = 0;
+
+    std::string fileName;
+    std::shared_ptr<ZipArchive> archive = getArchiveForFullPath(fullPathForFilename(filename), &fileName);
+    if (!archive)
+    {
+        return nullptr;
+    }
+    return archive->getFileView(fileName, size);
+}
+
+std::shared_ptr<ZipArchive> FileUtils::getArchiveForFullPath(const std::string& fullPath, std::string* fileName) const
+{
+    std::shared_ptr<ZipArchive> archive;
+
+    pthread_mutex_lock(&_archivesMutex);
+    for (auto it = _mountedArchives.rbegin(); it != _mountedArchives.rend(); ++it)
+    {
+        const std::string& path = it->path;
+        if (fullPath.length() > path.length() + 1
+            && fullPath[path.length()] == '/'
+            && fullPath.compare(0, path.length(), path) == 0)
+        {
+            archive = it->archive;
+            if (fileName)
+            {
+                *fileName = fullPath.substr(path.length() + 1);
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_archivesMutex);
+
+    return archive;
+}
+
+std::string FileUtils::getArchivePathForFilename(const std::string& filename) const
+{
+    std::string file = filename;
+    std::string file_path = "";
+    size_t pos = filename.find_last_of("/");
+    if (pos != std::string::npos)
+    {
+        file_path = filename.substr(0, pos+1);
+        file = filename.substr(pos+1);
+    }
+
+    std::string fullpath;
+
+    pthread_mutex_lock(&_archivesMutex);
+    for (auto it = _mountedArchives.rbegin(); it != _mountedArchives.rend() && fullpath.empty(); ++it)
+    {
+        for (const auto& resolutionIt : _searchResolutionsOrderArray)
+        {
+            // root + file_path + resourceDirectory + file
+            std::string name = it->root + file_path + resolutionIt + file;
+            if (it->archive->fileExists(name))
+            {
+                fullpath = it->path + "/" + name;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&_archivesMutex);
+
+    return fullpath;
+}
+
+unsigned char* FileUtils::getFileDataFromArchive(const std::string& fullPath, unsigned long *size) const
+{
+    *size = 0;
+
+    std::string fileName;
+    std::shared_ptr<ZipArchive> archive = getArchiveForFullPath(fullPath, &fileName);
+    if (!archive)
+    {
+        return nullptr;
+    }
+
+    long fileSize = archive->getFileSize(fileName);
+    if (fileSize < 0)
+    {
+        return nullptr;
+    }
+
+    unsigned char* buffer = (unsigned char*)malloc(fileSize > 0 ? fileSize : 1);
+    if (!archive->readFile(fileName, buffer, (unsigned long)fileSize))
+    {
+        free(buffer);
+        return nullptr;
+    }
+    *size = (unsigned long)fileSize;
     return buffer;
 }
 
@@ -710,34 +1357,81 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return filename;
     }
 
-    // Already Cached ?
+    // Already Cached ? Known to be missing ?
+    pthread_mutex_lock(&_fullPathCacheMutex);
     auto cacheIter = _fullPathCache.find(filename);
     if(cacheIter != _fullPathCache.end())
     {
-        return cacheIter->second;
+        std::string fullpath = cacheIter->second;
+        pthread_mutex_unlock(&_fullPathCacheMutex);
+        return fullpath;
+    }
+    bool missing = _missingPathCache.find(filename) != _missingPathCache.end();
+    unsigned int generation = _missingPathGeneration;
+    pthread_mutex_unlock(&_fullPathCacheMutex);
+
+    if (missing)
+    {
+        return "";
     }
 
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
 
+    std::string file = newFilename;
+    std::string file_path = "";
+    size_t pos = newFilename.find_last_of("/");
+    if (pos != std::string::npos)
+    {
+        file_path = newFilename.substr(0, pos+1);
+        file = newFilename.substr(pos+1);
+    }
+
     std::string fullpath;
 
     for (const auto& searchIt : _searchPathArray)
     {
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
+            if (this->isExcludedByResourceIndex(searchIt, file_path + resolutionIt + file))
+            {
+                continue;
+            }
+
+            ++_fileSystemProbes;
             fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
 
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
+                pthread_mutex_lock(&_fullPathCacheMutex);
                 _fullPathCache.insert(std::make_pair(filename, fullpath));
+                pthread_mutex_unlock(&_fullPathCacheMutex);
                 return fullpath;
             }
 
         }
     }
 
+    // then the mounted archives, files on disk override them
+    fullpath = this->getArchivePathForFilename(newFilename);
+    if (!fullpath.empty())
+    {
+        pthread_mutex_lock(&_fullPathCacheMutex);
+        _fullPathCache.insert(std::make_pair(filename, fullpath));
+        pthread_mutex_unlock(&_fullPathCacheMutex);
+        return fullpath;
+    }
+
+    // remembered until the search changes or a file is written,
+    // unless a file was written while searching
+    pthread_mutex_lock(&_fullPathCacheMutex);
+    if (generation == _missingPathGeneration)
+    {
+        _missingPathCache.insert(filename);
+    }
+    pthread_mutex_unlock(&_fullPathCacheMutex);
+
     if(isPopupNotify()){
         CCLOG("CrossApp: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
     }
@@ -754,7 +1448,7 @@ std::string FileUtils::fullPathFromRelativeFile(const std::string &filename, con
 void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& searchResolutionsOrder)
 {
     bool existDefault = false;
-    _fullPathCache.clear();
+    this->purgeCachedEntries();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
     {
@@ -784,6 +1478,7 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     if (!resOrder.empty() && resOrder[resOrder.length()-1] != '/')
         resOrder.append("/");
 
+    this->purgeCachedEntries();
     if (front) {
         _searchResolutionsOrderArray.insert(_searchResolutionsOrderArray.begin(), resOrder);
     } else {
@@ -809,13 +1504,14 @@ void FileUtils::setWritablePath(const std::string& writablePath)
 void FileUtils::setDefaultResourceRootPath(const std::string& path)
 {
     _defaultResRootPath = path;
+    this->purgeCachedEntries();
 }
 
 void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
 {
     bool existDefaultRootPath = false;
 
-    _fullPathCache.clear();
+    this->purgeCachedEntries();
     _searchPathArray.clear();
     for (const auto& iter : searchPaths)
     {
@@ -856,6 +1552,7 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
     {
         path += "/";
     }
+    this->purgeCachedEntries();
     if (front) {
         _searchPathArray.insert(_searchPathArray.begin(), path);
     } else {
@@ -865,7 +1562,7 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
 
 void FileUtils::setFilenameLookupDictionary(const CAValueMap& filenameLookupDict)
 {
-    _fullPathCache.clear();
+    this->purgeCachedEntries();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -909,6 +1606,13 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
+        std::string fileName;
+        std::shared_ptr<ZipArchive> archive = getArchiveForFullPath(filename, &fileName);
+        if (archive)
+        {
+            return archive->fileExists(fileName);
+        }
+        ++_fileSystemProbes;
         return isFileExistInternal(filename);
     }
     else
@@ -932,15 +1636,27 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
 
     if (isAbsolutePath(dirPath))
     {
+        std::string dirName;
+        std::shared_ptr<ZipArchive> archive = getArchiveForFullPath(dirPath, &dirName);
+        if (archive)
+        {
+            return archive->directoryExists(dirName);
+        }
+        ++_fileSystemProbes;
         return isDirectoryExistInternal(dirPath);
     }
 
     // Already Cached ?
+    pthread_mutex_lock(&_fullPathCacheMutex);
     auto cacheIter = _fullPathCache.find(dirPath);
     if( cacheIter != _fullPathCache.end() )
     {
-        return isDirectoryExistInternal(cacheIter->second);
+        std::string fullpath = cacheIter->second;
+        pthread_mutex_unlock(&_fullPathCacheMutex);
+        ++_fileSystemProbes;
+        return isDirectoryExistInternal(fullpath);
     }
+    pthread_mutex_unlock(&_fullPathCacheMutex);
 
     std::string fullpath;
     for (const auto& searchIt : _searchPathArray)
@@ -949,9 +1665,12 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
         {
             // searchPath + file_path + resourceDirectory
             fullpath = searchIt + dirPath + resolutionIt;
+            ++_fileSystemProbes;
             if (isDirectoryExistInternal(fullpath))
             {
+                pthread_mutex_lock(&_fullPathCacheMutex);
                 _fullPathCache.insert(std::make_pair(dirPath, fullpath));
+                pthread_mutex_unlock(&_fullPathCacheMutex);
                 return true;
             }
         }
@@ -1085,6 +1804,7 @@ bool FileUtils::createDirectory(const std::string& path)
             closedir(dir);
         }
     }
+    this->purgeMissingEntries();
     return true;
 }
 
@@ -1132,6 +1852,7 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
         CCLOGERROR("Fail to rename file %s to %s !Error code is %d", oldfullpath.c_str(), newfullpath.c_str(), errorCode);
         return false;
     }
+    this->fileCreated(newfullpath);
     return true;
 }
 
@@ -1162,6 +1883,13 @@ long FileUtils::getFileSize(const std::string &filepath)
             return 0;
     }
 
+    std::string fileName;
+    std::shared_ptr<ZipArchive> archive = getArchiveForFullPath(fullpath, &fileName);
+    if (archive)
+    {
+        return archive->getFileSize(fileName);
+    }
+
     struct stat info;
     // Get data associated with "crt_stat.c":
     int result = stat(fullpath.c_str(), &info);
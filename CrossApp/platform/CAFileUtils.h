@@ -5,6 +5,11 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <pthread.h>
 
 #include "platform/CCPlatformMacros.h"
 #include "ccTypes.h"
@@ -12,11 +17,59 @@
 
 NS_CC_BEGIN
 
+class ZipArchive;
+
 /**
  * @addtogroup platform
  * @{
  */
 
+/**
+ *  The bytes of a file. It owns them and frees them, it can be moved but not copied,
+ *  so that the data FileUtils reads is handed over instead of duplicated.
+ */
+class CC_DLL CAFileBuffer
+{
+public:
+
+    typedef void (*Deleter)(unsigned char* bytes);
+
+    CAFileBuffer();
+
+    /**
+     *  Takes over bytes allocated with malloc(), or freed by deleter.
+     */
+    CAFileBuffer(unsigned char* bytes, unsigned long size, Deleter deleter = NULL);
+
+    CAFileBuffer(CAFileBuffer&& other);
+
+    CAFileBuffer& operator= (CAFileBuffer&& other);
+
+    ~CAFileBuffer();
+
+    /** a buffer holding a copy of bytes */
+    static CAFileBuffer copy(const unsigned char* bytes, unsigned long size);
+
+    unsigned char* getBytes() const { return m_pBytes; }
+
+    unsigned long getSize() const { return m_uSize; }
+
+    bool isNull() const { return m_pBytes == NULL; }
+
+    /** frees the bytes */
+    void clear();
+
+private:
+
+    unsigned char* m_pBytes;
+
+    unsigned long m_uSize;
+
+    Deleter m_pDeleter;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(CAFileBuffer);
+};
+
 /** Helper class to handle file operations. */
 class CC_DLL FileUtils
 {
@@ -64,6 +117,33 @@ public:
      */
     virtual void purgeCachedEntries();
 
+    /**
+     *  Forgets the file names fullPathForFilename found missing.
+     *  FileUtils does it when it writes, renames or creates a directory. Call it after creating
+     *  files some other way, or fullPathForFilename keeps reporting them missing.
+     */
+    virtual void purgeMissingEntries();
+
+    /**
+     *  Loads an index of the files bundled under the default resource root, one path relative
+     *  to the root per line, as written by tools/resource-index/make_resource_index.py.
+     *  fullPathForFilename then skips the candidates under the root that are not in the index
+     *  without asking the filesystem. Load it at startup, before the first lookups.
+     *
+     *  @param indexFile The index file, looked up like any other file.
+     *  @return true if the index was loaded.
+     */
+    virtual bool loadResourceIndex(const std::string& indexFile);
+
+    /** Drops the index loaded by loadResourceIndex, every candidate is probed again. */
+    virtual void removeResourceIndex();
+
+    /**
+     *  The number of filesystem probes (stat calls or asset lookups) made resolving paths since launch.
+     *  @see CAApplication::getFileSystemProbesPerFrame()
+     */
+    unsigned int getFileSystemProbes() const { return _fileSystemProbes; }
+
     /**
      *  Gets string from a file.
      */
@@ -80,6 +160,12 @@ public:
      */
     virtual unsigned char* getFileData(const std::string& filename, const char* mode, unsigned long *size);
 
+    /**
+     *  Gets resource file data, like getFileData, in a buffer that frees it.
+     *  @return A null buffer if the file can't be read.
+     */
+    CAFileBuffer getFileBuffer(const std::string& filename);
+
     /**
      *  Gets resource file data from a zip file.
      *
@@ -90,6 +176,36 @@ public:
      */
     virtual unsigned char* getFileDataFromZip(const std::string& zipFilePath, const std::string& filename, unsigned long *size);
 
+    /**
+     *  Mounts a zip archive, such as an Android OBB expansion file or a downloaded resource pack.
+     *  The archive is mapped and indexed once. After that fullPathForFilename, isFileExist, getFileSize
+     *  and getFileData find its files like files on disk. Archives are searched after the search paths,
+     *  so files on disk override them, and archives mounted later are searched first.
+     *  The full path of a file in an archive is the archive path, '/' and the name of the file in the archive.
+     *  Mounted archives can be read from any thread, and must not be modified while they are mounted.
+     *
+     *  @param archivePath The absolute path of the archive.
+     *  @param root The directory in the archive files are looked up in, for example "assets/". Empty for the top.
+     *  @return true if the archive was mounted, false if it can't be opened.
+     */
+    virtual bool mountArchive(const std::string& archivePath, const std::string& root = "");
+
+    /**
+     *  Unmounts an archive mounted by mountArchive.
+     *  The views that getFileDataView returned for its files become invalid.
+     */
+    virtual void unmountArchive(const std::string& archivePath);
+
+    /**
+     *  Gets a read only view of a file stored uncompressed in a mounted archive, without copying it.
+     *
+     *  @param[in]  filename The resource file name which contains the path.
+     *  @param[out] size If the file can be viewed, it will be the data size, otherwise 0.
+     *  @return The data, valid until the archive is unmounted. nullptr if the file is compressed or not in
+     *          an archive, read it with getFileData then. Don't free it.
+     */
+    virtual const unsigned char* getFileDataView(const std::string& filename, unsigned long *size);
+
 
     /** Returns the fullpath for a given filename.
 
@@ -285,6 +401,7 @@ public:
 
     /**
      *  Converts the contents of a file to a ValueMap.
+     *  Both XML and binary (bplist00) property lists are read, binary ones load several times faster.
      *  @param filename The filename of the file to gets content.
      *  @return ValueMap of the file contents.
      *  @note This method is used internally.
@@ -343,6 +460,56 @@ public:
     */
     virtual bool writeValueVectorToFile(const CAValueVector& vecData, const std::string& fullPath);
 
+    /** @name Asynchronous file access
+     *  These run the synchronous methods on background I/O threads, and call back on the UI thread.
+     *  Reads of the same path that are waiting together are made once; every caller gets its own
+     *  result. Requests for the same path never run at the same time, and they run in the order
+     *  they were made. Paths are compared after fullPathForFilename, so a name and its full path
+     *  are the same file; a file that doesn't exist yet only matches the path as passed in.
+     *  They return a request id for cancelAsyncRequest.
+     */
+    /// @{
+
+    typedef std::function<void(CAFileBuffer&& data)> FileBufferCallback;
+
+    typedef std::function<void(std::string&& data)> FileStringCallback;
+
+    typedef std::function<void(CAValueMap&& dict)> ValueMapCallback;
+
+    typedef std::function<void(bool succeed)> WriteCallback;
+
+    /** getFileBuffer on an I/O thread. The buffer is null if the file can't be read. */
+    unsigned int getFileBufferAsync(const std::string& filename, const FileBufferCallback& callback);
+
+    /** getFileString on an I/O thread. */
+    unsigned int getFileStringAsync(const std::string& filename, const FileStringCallback& callback);
+
+    /** getValueMapFromFile on an I/O thread, the parsing included. */
+    unsigned int getValueMapFromFileAsync(const std::string& filename, const ValueMapCallback& callback);
+
+    /** writeDataToFile on an I/O thread, it takes the buffer over. */
+    unsigned int writeDataToFileAsync(CAFileBuffer&& data, const std::string& fullPath, const WriteCallback& callback = nullptr);
+
+    /** writeStringToFile on an I/O thread. */
+    unsigned int writeStringToFileAsync(const std::string& dataStr, const std::string& fullPath, const WriteCallback& callback = nullptr);
+
+    /** writeValueMapToFile on an I/O thread. */
+    unsigned int writeValueMapToFileAsync(const CAValueMap& dict, const std::string& fullPath, const WriteCallback& callback = nullptr);
+
+    /**
+     *  Cancels a request, its callback won't be called.
+     *  A read or write that has already started still completes. Call it on the UI thread.
+     */
+    void cancelAsyncRequest(unsigned int request);
+
+    /**
+     *  Blocks until the asynchronous writes made so far are on disk, for example when the app
+     *  is sent to the background. Their callbacks still come on the UI thread.
+     */
+    void waitForAsyncWrites();
+
+    /// @}
+
     /**
     * Windows fopen can't support UTF-8 filename
     * Need convert all parameters fopen and other 3rd-party libs
@@ -508,6 +675,37 @@ protected:
      */
     virtual std::string getFullPathForDirectoryAndFilename(const std::string& directory, const std::string& filename) const;
 
+    /**
+     *  Gets the mounted archive a full path points into.
+     *
+     *  @param fullPath The full path of the file.
+     *  @param[out] fileName The name of the file in the archive, may be nullptr.
+     *  @return The archive, nullptr if the path is not in a mounted archive.
+     */
+    std::shared_ptr<ZipArchive> getArchiveForFullPath(const std::string& fullPath, std::string* fileName) const;
+
+    /**
+     *  Gets the full path of a file in the mounted archives.
+     *  @return The full path of the file, or an empty string if no archive holds it.
+     */
+    std::string getArchivePathForFilename(const std::string& filename) const;
+
+    /**
+     *  Whether the resource index rules out a candidate path, so it needn't be probed.
+     */
+    bool isExcludedByResourceIndex(const std::string& searchPath, const std::string& path) const;
+
+    /**
+     *  Invalidates the missing files and adds a file created under the resource root to the index.
+     */
+    void fileCreated(const std::string& fullPath);
+
+    /**
+     *  Gets the data of a file in a mounted archive, allocated with malloc().
+     *  @return nullptr if the path is not in a mounted archive or the file can't be read.
+     */
+    unsigned char* getFileDataFromArchive(const std::string& fullPath, unsigned long *size) const;
+
     /** Dictionary used to lookup filenames based on a key.
      *  It is used internally by the following methods:
      *
@@ -544,11 +742,62 @@ protected:
      */
     mutable std::unordered_map<std::string, std::string> _fullPathCache;
 
+    /**
+     *  The file names fullPathForFilename found missing, so that misses are only searched once.
+     */
+    mutable std::unordered_set<std::string> _missingPathCache;
+
+    /**
+     *  Bumped whenever the missing files are invalidated, a search that overlapped it doesn't record its miss.
+     */
+    unsigned int _missingPathGeneration;
+
+    /**
+     *  Guards _fullPathCache and _missingPathCache, paths are resolved from the loading threads too.
+     */
+    mutable pthread_mutex_t _fullPathCacheMutex;
+
+    /**
+     *  The files bundled under _defaultResRootPath, relative to it, see loadResourceIndex.
+     */
+    std::unordered_set<std::string> _resourceIndex;
+
+    bool _resourceIndexLoaded;
+
+    mutable std::atomic<unsigned int> _fileSystemProbes;
+
     /**
      * Writable path.
      */
     std::string _writablePath;
 
+    struct MountedArchive
+    {
+        std::string path;
+        std::string root;
+        std::shared_ptr<ZipArchive> archive;
+    };
+
+    /**
+     *  The archives mounted by mountArchive, guarded by _archivesMutex.
+     */
+    std::vector<MountedArchive> _mountedArchives;
+
+    mutable pthread_mutex_t _archivesMutex;
+
+    class AsyncQueue;
+
+    /**
+     *  The background I/O threads and their requests, created by the first asynchronous request.
+     */
+    AsyncQueue* _asyncQueue;
+
+    pthread_mutex_t _asyncQueueMutex;
+
+    AsyncQueue* getAsyncQueue();
+
+    void destroyAsyncQueue();
+
     /**
      *  The singleton pointer of FileUtils.
      */
@@ -0,0 +1,482 @@
+#include "platform/CAFileUtils.h"
+#include <list>
+#include <set>
+#include "ccMacros.h"
+#include "basics/CAScheduler.h"
+
+NS_CC_BEGIN
+
+#define ASYNC_IO_THREADS 2
+
+typedef enum
+{
+    AsyncReadBuffer = 0,
+    AsyncReadString,
+    AsyncReadValueMap,
+    AsyncWriteData,
+    AsyncWriteValueMap
+} AsyncJobType;
+
+/** one caller, several ones share a job when their reads are coalesced */
+struct AsyncRequest
+{
+    unsigned int id;
+    std::atomic<bool> canceled;
+    FileUtils::FileBufferCallback bufferCallback;
+    FileUtils::FileStringCallback stringCallback;
+    FileUtils::ValueMapCallback valueMapCallback;
+    FileUtils::WriteCallback writeCallback;
+
+    AsyncRequest() : id(0), canceled(false) {}
+};
+
+struct AsyncJob
+{
+    AsyncJobType type;
+    std::string path;               // as passed in
+    std::string key;                // the full path, the jobs of a key are coalesced and run in order
+    CAFileBuffer data;              // the bytes to write
+    CAValueMap dict;                // the dictionary to write
+    std::vector<std::shared_ptr<AsyncRequest> > requests;
+
+    bool isWrite() const { return type == AsyncWriteData || type == AsyncWriteValueMap; }
+
+    bool isCanceled() const
+    {
+        for (auto& request : requests)
+        {
+            CC_RETURN_IF(!request->canceled) false;
+        }
+        return true;
+    }
+};
+
+class FileUtils::AsyncQueue
+{
+public:
+
+    AsyncQueue(FileUtils* fileUtils);
+
+    ~AsyncQueue();
+
+    unsigned int addJob(AsyncJob* job, const std::shared_ptr<AsyncRequest>& request);
+
+    void cancel(unsigned int id);
+
+    void waitForWrites();
+
+protected:
+
+    static void* threadLoop(void* data);
+
+    void run();
+
+    AsyncJob* nextJob();
+
+    void execute(AsyncJob* job);
+
+    template <typename T, typename C>
+    void deliver(AsyncJob* job, T& result, C AsyncRequest::*callback);
+
+    FileUtils*              m_pFileUtils;
+
+    pthread_t               m_tThreads[ASYNC_IO_THREADS];
+
+    pthread_mutex_t         m_obMutex;
+
+    pthread_cond_t          m_obJobCondition;
+
+    pthread_cond_t          m_obWriteCondition;
+
+    std::list<AsyncJob*>    m_obJobs;
+
+    std::set<std::string>   m_obBusyPaths;  // the keys of the files a thread is reading or writing
+
+    unsigned int            m_uPendingWrites;
+
+    unsigned int            m_uNextID;
+
+    std::unordered_map<unsigned int, std::weak_ptr<AsyncRequest> > m_mRequests;
+
+    bool                    m_bQuit;
+};
+
+FileUtils::AsyncQueue::AsyncQueue(FileUtils* fileUtils)
+: m_pFileUtils(fileUtils)
+, m_uPendingWrites(0)
+, m_uNextID(0)
+, m_bQuit(false)
+{
+    pthread_mutex_init(&m_obMutex, NULL);
+    pthread_cond_init(&m_obJobCondition, NULL);
+    pthread_cond_init(&m_obWriteCondition, NULL);
+
+    for (int i = 0; i < ASYNC_IO_THREADS; ++i)
+    {
+        pthread_create(&m_tThreads[i], NULL, &AsyncQueue::threadLoop, this);
+    }
+}
+
+FileUtils::AsyncQueue::~AsyncQueue()
+{
+    this->waitForWrites();
+
+    pthread_mutex_lock(&m_obMutex);
+    m_bQuit = true;
+    pthread_cond_broadcast(&m_obJobCondition);
+    pthread_mutex_unlock(&m_obMutex);
+
+    for (int i = 0; i < ASYNC_IO_THREADS; ++i)
+    {
+        pthread_join(m_tThreads[i], NULL);
+    }
+
+    for (auto job : m_obJobs)
+    {
+        delete job;
+    }
+    m_obJobs.clear();
+
+    pthread_cond_destroy(&m_obWriteCondition);
+    pthread_cond_destroy(&m_obJobCondition);
+    pthread_mutex_destroy(&m_obMutex);
+}
+
+unsigned int FileUtils::AsyncQueue::addJob(AsyncJob* job, const std::shared_ptr<AsyncRequest>& request)
+{
+    // "a.png" and its full path are the same file, a missing file keeps its name
+    job->key = m_pFileUtils->fullPathForFilename(job->path);
+    if (job->key.empty())
+    {
+        job->key = job->path;
+    }
+
+    pthread_mutex_lock(&m_obMutex);
+
+    if (++m_uNextID == 0)
+    {
+        ++m_uNextID;
+    }
+    request->id = m_uNextID;
+
+    // the requests whose callbacks have run or been dropped
+    for (auto it = m_mRequests.begin(); it != m_mRequests.end();)
+    {
+        if (it->second.expired())
+        {
+            it = m_mRequests.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    m_mRequests[request->id] = request;
+
+    // a read joins a waiting read of the same path, unless something else was queued for the path since
+    AsyncJob* waiting = NULL;
+    if (!job->isWrite())
+    {
+        for (auto it = m_obJobs.rbegin(); it != m_obJobs.rend(); ++it)
+        {
+            if ((*it)->key == job->key)
+            {
+                waiting = (*it)->type == job->type ? *it : NULL;
+                break;
+            }
+        }
+    }
+
+    if (waiting)
+    {
+        waiting->requests.push_back(request);
+        delete job;
+    }
+    else
+    {
+        job->requests.push_back(request);
+        if (job->isWrite())
+        {
+            ++m_uPendingWrites;
+        }
+        m_obJobs.push_back(job);
+        pthread_cond_signal(&m_obJobCondition);
+    }
+
+    unsigned int id = request->id;
+    pthread_mutex_unlock(&m_obMutex);
+    return id;
+}
+
+void FileUtils::AsyncQueue::cancel(unsigned int id)
+{
+    pthread_mutex_lock(&m_obMutex);
+    auto it = m_mRequests.find(id);
+    if (it != m_mRequests.end())
+    {
+        std::shared_ptr<AsyncRequest> request = it->second.lock();
+        if (request)
+        {
+            request->canceled = true;
+        }
+        m_mRequests.erase(it);
+    }
+    pthread_mutex_unlock(&m_obMutex);
+}
+
+void FileUtils::AsyncQueue::waitForWrites()
+{
+    pthread_mutex_lock(&m_obMutex);
+    while (m_uPendingWrites > 0)
+    {
+        pthread_cond_wait(&m_obWriteCondition, &m_obMutex);
+    }
+    pthread_mutex_unlock(&m_obMutex);
+}
+
+void* FileUtils::AsyncQueue::threadLoop(void* data)
+{
+    static_cast<AsyncQueue*>(data)->run();
+    return NULL;
+}
+
+AsyncJob* FileUtils::AsyncQueue::nextJob()
+{
+    // the first job whose path is not busy, the jobs of a path run in order
+    for (auto it = m_obJobs.begin(); it != m_obJobs.end(); ++it)
+    {
+        AsyncJob* job = *it;
+        CC_CONTINUE_IF(m_obBusyPaths.count(job->key) > 0);
+
+        if (job->isCanceled())
+        {
+            // dropping it doesn't change the order of the others
+            m_obJobs.erase(it);
+            if (job->isWrite() && --m_uPendingWrites == 0)
+            {
+                pthread_cond_broadcast(&m_obWriteCondition);
+            }
+            delete job;
+            return this->nextJob();
+        }
+
+        m_obJobs.erase(it);
+        return job;
+    }
+    return NULL;
+}
+
+void FileUtils::AsyncQueue::run()
+{
+    pthread_mutex_lock(&m_obMutex);
+    while (!m_bQuit)
+    {
+        AsyncJob* job = this->nextJob();
+        if (job == NULL)
+        {
+            pthread_cond_wait(&m_obJobCondition, &m_obMutex);
+            continue;
+        }
+
+        m_obBusyPaths.insert(job->key);
+        pthread_mutex_unlock(&m_obMutex);
+
+        this->execute(job);
+
+        pthread_mutex_lock(&m_obMutex);
+        m_obBusyPaths.erase(job->key);
+        if (job->isWrite() && --m_uPendingWrites == 0)
+        {
+            pthread_cond_broadcast(&m_obWriteCondition);
+        }
+        delete job;
+
+        // the next job of the path may be waiting for this one
+        pthread_cond_broadcast(&m_obJobCondition);
+    }
+    pthread_mutex_unlock(&m_obMutex);
+}
+
+template <typename T>
+static T copyResult(const T& result)
+{
+    return result;
+}
+
+static CAFileBuffer copyResult(const CAFileBuffer& result)
+{
+    return result.isNull() ? CAFileBuffer() : CAFileBuffer::copy(result.getBytes(), result.getSize());
+}
+
+template <typename T, typename C>
+void FileUtils::AsyncQueue::deliver(AsyncJob* job, T& result, C AsyncRequest::*callback)
+{
+    std::vector<std::shared_ptr<AsyncRequest> > requests;
+    for (auto& request : job->requests)
+    {
+        if (!request->canceled && request.get()->*callback)
+        {
+            requests.push_back(request);
+        }
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        // the last caller gets the result itself, the others a copy of it
+        std::shared_ptr<T> value = std::make_shared<T>(i + 1 < requests.size() ? copyResult(result) : std::move(result));
+        std::shared_ptr<AsyncRequest> request = requests[i];
+
+        CAScheduler::getScheduler()->performFunctionInUIThread([request, value, callback]()
+        {
+            if (!request->canceled)
+            {
+                ((*request).*callback)(std::move(*value));
+            }
+        });
+    }
+}
+
+void FileUtils::AsyncQueue::execute(AsyncJob* job)
+{
+    switch (job->type)
+    {
+        case AsyncReadBuffer:
+        {
+            CAFileBuffer result = m_pFileUtils->getFileBuffer(job->path);
+            this->deliver(job, result, &AsyncRequest::bufferCallback);
+            break;
+        }
+        case AsyncReadString:
+        {
+            std::string result = m_pFileUtils->getFileString(job->path);
+            this->deliver(job, result, &AsyncRequest::stringCallback);
+            break;
+        }
+        case AsyncReadValueMap:
+        {
+            CAValueMap result = m_pFileUtils->getValueMapFromFile(job->path);
+            this->deliver(job, result, &AsyncRequest::valueMapCallback);
+            break;
+        }
+        case AsyncWriteData:
+        {
+            bool result = m_pFileUtils->writeDataToFile(job->data.getBytes(), job->data.getSize(), job->path);
+            job->data.clear();
+            this->deliver(job, result, &AsyncRequest::writeCallback);
+            break;
+        }
+        case AsyncWriteValueMap:
+        {
+            bool result = m_pFileUtils->writeValueMapToFile(job->dict, job->path);
+            job->dict.clear();
+            this->deliver(job, result, &AsyncRequest::writeCallback);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+FileUtils::AsyncQueue* FileUtils::getAsyncQueue()
+{
+    pthread_mutex_lock(&_asyncQueueMutex);
+    if (_asyncQueue == NULL)
+    {
+        _asyncQueue = new AsyncQueue(this);
+    }
+    pthread_mutex_unlock(&_asyncQueueMutex);
+    return _asyncQueue;
+}
+
+void FileUtils::destroyAsyncQueue()
+{
+    pthread_mutex_lock(&_asyncQueueMutex);
+    CC_SAFE_DELETE(_asyncQueue);
+    pthread_mutex_unlock(&_asyncQueueMutex);
+}
+
+unsigned int FileUtils::getFileBufferAsync(const std::string& filename, const FileBufferCallback& callback)
+{
+    AsyncJob* job = new AsyncJob();
+    job->type = AsyncReadBuffer;
+    job->path = filename;
+
+    std::shared_ptr<AsyncRequest> request = std::make_shared<AsyncRequest>();
+    request->bufferCallback = callback;
+    return this->getAsyncQueue()->addJob(job, request);
+}
+
+unsigned int FileUtils::getFileStringAsync(const std::string& filename, const FileStringCallback& callback)
+{
+    AsyncJob* job = new AsyncJob();
+    job->type = AsyncReadString;
+    job->path = filename;
+
+    std::shared_ptr<AsyncRequest> request = std::make_shared<AsyncRequest>();
+    request->stringCallback = callback;
+    return this->getAsyncQueue()->addJob(job, request);
+}
+
+unsigned int FileUtils::getValueMapFromFileAsync(const std::string& filename, const ValueMapCallback& callback)
+{
+    AsyncJob* job = new AsyncJob();
+    job->type = AsyncReadValueMap;
+    job->path = filename;
+
+    std::shared_ptr<AsyncRequest> request = std::make_shared<AsyncRequest>();
+    request->valueMapCallback = callback;
+    return this->getAsyncQueue()->addJob(job, request);
+}
+
+unsigned int FileUtils::writeDataToFileAsync(CAFileBuffer&& data, const std::string& fullPath, const WriteCallback& callback)
+{
+    AsyncJob* job = new AsyncJob();
+    job->type = AsyncWriteData;
+    job->path = fullPath;
+    job->data = std::move(data);
+
+    std::shared_ptr<AsyncRequest> request = std::make_shared<AsyncRequest>();
+    request->writeCallback = callback;
+    return this->getAsyncQueue()->addJob(job, request);
+}
+
+unsigned int FileUtils::writeStringToFileAsync(const std::string& dataStr, const std::string& fullPath, const WriteCallback& callback)
+{
+    return this->writeDataToFileAsync(CAFileBuffer::copy((const unsigned char*)dataStr.c_str(), dataStr.size()), fullPath, callback);
+}
+
+unsigned int FileUtils::writeValueMapToFileAsync(const CAValueMap& dict, const std::string& fullPath, const WriteCallback& callback)
+{
+    AsyncJob* job = new AsyncJob();
+    job->type = AsyncWriteValueMap;
+    job->path = fullPath;
+    job->dict = dict;
+
+    std::shared_ptr<AsyncRequest> request = std::make_shared<AsyncRequest>();
+    request->writeCallback = callback;
+    return this->getAsyncQueue()->addJob(job, request);
+}
+
+void FileUtils::cancelAsyncRequest(unsigned int request)
+{
+    pthread_mutex_lock(&_asyncQueueMutex);
+    if (_asyncQueue)
+    {
+        _asyncQueue->cancel(request);
+    }
+    pthread_mutex_unlock(&_asyncQueueMutex);
+}
+
+void FileUtils::waitForAsyncWrites()
+{
+    pthread_mutex_lock(&_asyncQueueMutex);
+    AsyncQueue* queue = _asyncQueue;
+    pthread_mutex_unlock(&_asyncQueueMutex);
+
+    if (queue)
+    {
+        queue->waitForWrites();
+    }
+}
+
+NS_CC_END
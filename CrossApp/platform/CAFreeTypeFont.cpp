@@ -1300,6 +1300,19 @@ unsigned char* CAFreeTypeFont::loadFont(const std::string& pFontName, unsigned l
             fontName = "/system/fonts/NotoSansHans-Regular.otf";
             pBuffer = FileUtils::getInstance()->getFileData(fontName, "rb", size);
         }
+
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+
+        const char* fontNames[] =
+        {
+            "/usr/share/fonts/truetype/droid/DroidSansFallbackFull.ttf",
+            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+            "/usr/share/fonts/TTF/DejaVuSans.ttf",
+        };
+        for (int i=0; i<3 && pBuffer == NULL; i++)
+        {
+            pBuffer = FileUtils::getInstance()->getFileData(fontNames[i], "rb", size);
+        }
 #endif
 	}
 
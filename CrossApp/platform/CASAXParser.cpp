@@ -32,6 +32,14 @@ bool XmlSaxHander::VisitEnter( const tinyxml2::XMLElement& element, const tinyxm
 {
     //log(" VisitEnter %s",element.Value());
 
+    if (firstAttribute == nullptr)
+    {
+        // most elements, all of a plist but the root, have no attributes
+        const char* noAttributes[] = { nullptr };
+        SAXParser::startElement(_ccsaxParserImp, (const CC_XML_CHAR *)element.Value(), (const CC_XML_CHAR **)noAttributes);
+        return true;
+    }
+
     std::vector<const char*> attsVector;
     for( const tinyxml2::XMLAttribute* attrib = firstAttribute; attrib; attrib = attrib->Next() )
     {
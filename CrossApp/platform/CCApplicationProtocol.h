@@ -10,7 +10,8 @@ enum TargetPlatform
     kTargetMacOS,
     kTargetAndroid,
     kTargetIphone,
-    kTargetIpad
+    kTargetIpad,
+    kTargetLinux
 };
 
 /**
@@ -490,7 +490,7 @@ bool CATextField::becomeFirstResponder()
 	if (m_eClearBtn == WhileEditing)
 	{
         CAImageView* ima = (CAImageView*)this->getSubviewByTag(0xbbbb);
-        ima->setImage(CAImage::create(map.at("clearImage")));
+        ima->setImage(map.getImage("clearImage"));
 	}
     
     if (CAViewAnimation::areBeginAnimationsWithID(m_s__StrID + "showImage"))
@@ -578,7 +578,7 @@ CATextField* CATextField::createWithLayout(const DLayout& layout)
 bool CATextField::init()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
-    CAImage* image = CAImage::create(map.at("backgroundView_normal"));
+    CAImage* image = map.getImage("backgroundView_normal");
     DRect capInsets = DRect(image->getPixelsWide()/2 ,image->getPixelsHigh()/2 , 1, 1);
     m_pBackgroundView = CAScale9ImageView::createWithImage(image);
     m_pBackgroundView->setLayout(DLayoutFill);
@@ -612,7 +612,7 @@ void CATextField::setContentSize(const DSize& contentSize)
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
     if (m_bRecSpe)
     {
-        int h = atoi(map.at("height").c_str());
+        int h = map.getInt("height");
         size.height = (h == 0) ? size.height : h;
     }
     CAControl::setContentSize(size);
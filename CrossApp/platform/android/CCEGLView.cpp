@@ -12,22 +12,28 @@
 
 
 
-#if CC_TEXTURE_ATLAS_USE_VAO
-
 // <EGL/egl.h> exists since android 2.3
 #include <EGL/egl.h>
+
+#if CC_TEXTURE_ATLAS_USE_VAO
+
 PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOESEXT = 0;
 PFNGLBINDVERTEXARRAYOESPROC glBindVertexArrayOESEXT = 0;
 PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT = 0;
 
 #endif
 
+PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOESEXT = 0;
+PFNGLPROGRAMBINARYOESPROC glProgramBinaryOESEXT = 0;
+
 void initExtensions() {
 #if CC_TEXTURE_ATLAS_USE_VAO
      glGenVertexArraysOESEXT = (PFNGLGENVERTEXARRAYSOESPROC)eglGetProcAddress("glGenVertexArraysOES");
      glBindVertexArrayOESEXT = (PFNGLBINDVERTEXARRAYOESPROC)eglGetProcAddress("glBindVertexArrayOES");
      glDeleteVertexArraysOESEXT = (PFNGLDELETEVERTEXARRAYSOESPROC)eglGetProcAddress("glDeleteVertexArraysOES");
 #endif
+     glGetProgramBinaryOESEXT = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+     glProgramBinaryOESEXT = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
 }
 
 NS_CC_BEGIN
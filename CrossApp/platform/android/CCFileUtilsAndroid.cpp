@@ -1,6 +1,6 @@
 
 #include "CCFileUtilsAndroid.h"
-#include "support/zip_support/ZipUtils.h"
+#include "support/zip_support/ZipArchive.h"
 #include "platform/CACommon.h"
 #include "jni/Java_org_CrossApp_lib_CrossAppHelper.h"
 #include "platform/CCPlatformConfig.h"
@@ -14,7 +14,7 @@ using namespace std;
 
 NS_CC_BEGIN
 
-ZipFile* FileUtilsAndroid::obbfile = nullptr;
+ZipArchive* FileUtilsAndroid::obbfile = nullptr;
 
 FileUtils* FileUtils::getInstance()
 {
@@ -49,7 +49,11 @@ bool FileUtilsAndroid::init()
     _defaultResRootPath = "assets/";
     
     std::string assetsPath(getApkPath());
-    obbfile = new ZipFile(assetsPath, "assets/");
+    obbfile = new ZipArchive();
+    if (!obbfile->open(assetsPath, "assets/"))
+    {
+        CCLOG("ERROR: Could not open the apk %s", assetsPath.c_str());
+    }
     
     return FileUtils::init();
 }
@@ -150,9 +154,6 @@ bool FileUtilsAndroid::isDirectoryExistInternal(const std::string& dirPath) cons
     
     const char* s = dirPath.c_str();
     bool startWithAssets = (dirPath.find("assets/") == 0);
-    int lenOfAssets = 7;
-    
-    std::string tmpStr;
     
     // find absolute path in flash memory
     if (s[0] == '/')
@@ -165,12 +166,11 @@ bool FileUtilsAndroid::isDirectoryExistInternal(const std::string& dirPath) cons
         }
     }
     
-    // find it in apk's assets dir
-    // Found "assets/" at the beginning of the path and we don't want it
+    // find it in apk's assets dir, the apk index keeps the "assets/" prefix
     CCLOG("find in apk dirPath(%s)", s);
-    if (startWithAssets)
+    if (obbfile)
     {
-        s += lenOfAssets;
+        return obbfile->directoryExists(startWithAssets ? dirPath : _defaultResRootPath + dirPath);
     }
     return false;
 }
@@ -196,17 +196,23 @@ unsigned char* FileUtilsAndroid::doGetFileData(const char* pszFileName, const ch
     
     string fullPath = fullPathForFilename(pszFileName);
     
+    std::string archiveFileName;
+    std::shared_ptr<ZipArchive> archive = getArchiveForFullPath(fullPath, &archiveFileName);
+    
     if (fullPath[0] != '/')
     {
-        if (forAsync)
-        {
-            pData = obbfile->getFileData(fullPath.c_str(), pSize, obbfile->_dataThread);
-        }
-        else
+        // the apk index is safe to read from any thread, forAsync no longer needs its own handle
+        CC_UNUSED_PARAM(forAsync);
+        if (obbfile)
         {
-            pData = obbfile->getFileData(fullPath.c_str(), pSize);
+            pData = obbfile->getFileData(fullPath, pSize);
         }
     }
+    else if (archive)
+    {
+        // like the apk, allocated with new[]
+        pData = archive->getFileData(archiveFileName, pSize);
+    }
     else
     {
         do
@@ -242,6 +248,19 @@ unsigned char* FileUtilsAndroid::doGetFileData(const char* pszFileName, const ch
 }
 
 
+const unsigned char* FileUtilsAndroid::getFileDataView(const std::string& filename, unsigned long *size)
+{
+    *size = 0;
+    
+    string fullPath = fullPathForFilename(filename);
+    if (!fullPath.empty() && fullPath[0] != '/')
+    {
+        // aapt stores images and other already compressed assets without deflating them
+        return obbfile ? obbfile->getFileView(fullPath, size) : nullptr;
+    }
+    return FileUtils::getFileDataView(filename, size);
+}
+
 bool FileUtilsAndroid::isAbsolutePath(const std::string& strPath) const
 {
     // On Android, there are two situations for full path.
@@ -11,7 +11,7 @@
 
 NS_CC_BEGIN
 
-class ZipFile;
+class ZipArchive;
 
 class CC_DLL FileUtilsAndroid : public FileUtils
 {
@@ -24,12 +24,13 @@ public:
      */
     virtual ~FileUtilsAndroid();
 
-    static ZipFile* getObbFile() { return obbfile; }
+    static ZipArchive* getObbFile() { return obbfile; }
     
     /* override functions */
     bool init() override;
     
     virtual unsigned char* getFileData(const std::string& filename, const char* mode, unsigned long *size);
+    virtual const unsigned char* getFileDataView(const std::string& filename, unsigned long *size);
     unsigned char* getFileDataForAsync(const std::string& filename, const char* mode, unsigned long *size, bool forAsync);
     virtual std::string getNewFilename(const std::string &filename) const;
     
@@ -42,7 +43,7 @@ private:
     
     unsigned char* doGetFileData(const char* pszFileName, const char* pszMode, unsigned long * pSize, bool forAsync);
     
-    static ZipFile* obbfile;
+    static ZipArchive* obbfile;
 };
 
 
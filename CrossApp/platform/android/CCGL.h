@@ -39,5 +39,11 @@ extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT;
 #define glBindVertexArrayOES glBindVertexArrayOESEXT
 #define glDeleteVertexArraysOES glDeleteVertexArraysOESEXT
 
+// GL_OES_get_program_binary, resolved at runtime, NULL when the driver lacks it
+extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOESEXT;
+extern PFNGLPROGRAMBINARYOESPROC glProgramBinaryOESEXT;
+#define glGetProgramBinaryOES glGetProgramBinaryOESEXT
+#define glProgramBinaryOES glProgramBinaryOESEXT
+
 
 #endif // __CCGL_H__
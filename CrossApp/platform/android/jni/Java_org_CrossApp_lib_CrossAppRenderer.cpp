@@ -1,6 +1,7 @@
 #include "basics/CAApplication.h"
 #include "platform/CAFileUtils.h"
 #include "support/CANotificationCenter.h"
+#include "images/CAImage.h"
 #include "platform/android/CCApplication.h"
 #include "platform/android/CCEGLView.h"
 #include "JniHelper.h"
@@ -16,6 +17,8 @@ extern "C" {
     JNIEXPORT void JNICALL Java_org_CrossApp_lib_CrossAppRenderer_nativeOnPause() {
         CCApplication::sharedApplication()->applicationDidEnterBackground();
 
+        // the context is still current here, render target images have no other copy of their pixels
+        CAImage::readbackAllImages();
         CANotificationCenter::sharedNotificationCenter()->postNotification(EVENT_COME_TO_BACKGROUND, NULL);
     }
 
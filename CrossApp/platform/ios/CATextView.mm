@@ -194,7 +194,7 @@ CATextView* CATextView::createWithLayout(const DLayout& layout)
 bool CATextView::init()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
-    CAImage* image = CAImage::create(map.at("backgroundView_normal"));
+    CAImage* image = map.getImage("backgroundView_normal");
     DRect capInsets = DRect(image->getPixelsWide()/2 ,image->getPixelsHigh()/2 , 1, 1);
     m_pBackgroundView = CAScale9ImageView::createWithImage(image);
     m_pBackgroundView->setLayout(DLayoutFill);
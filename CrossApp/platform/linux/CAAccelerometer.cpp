@@ -0,0 +1,39 @@
+
+#include "CAAccelerometer.h"
+
+#define TG3_GRAVITY_EARTH                    (9.80665f)
+
+namespace CrossApp
+{
+	CAAccelerometer::CAAccelerometer() : m_pAccelDelegate(NULL)
+    {
+    }
+
+	CAAccelerometer::~CAAccelerometer()
+    {
+
+    }
+
+	void CAAccelerometer::setDelegate(CAAccelerometerDelegate* pDelegate)
+    {
+        m_pAccelDelegate = pDelegate;
+    }
+
+	void CAAccelerometer::setAccelerometerInterval(float interval)
+    {
+        // no sensor on the headless backend, samples only arrive through update()
+    }
+
+	void CAAccelerometer::update(float x, float y, float z, long sensorTimeStamp)
+    {
+        if (m_pAccelDelegate)
+        {
+            m_obAccelerationValue.x = -((double)x / TG3_GRAVITY_EARTH);
+            m_obAccelerationValue.y = -((double)y / TG3_GRAVITY_EARTH);
+            m_obAccelerationValue.z = -((double)z / TG3_GRAVITY_EARTH);
+            m_obAccelerationValue.timestamp = (double)sensorTimeStamp;
+
+            m_pAccelDelegate->didAccelerate(&m_obAccelerationValue);
+        }
+    }
+} // end of namespace CrossApp
@@ -0,0 +1,18 @@
+#include "platform/CAClipboard.h"
+
+NS_CC_BEGIN
+
+// there is no desktop session to share a clipboard with, keep it in process
+static std::string s_sClipboardText;
+
+std::string CAClipboard::getText()
+{
+	return s_sClipboardText;
+}
+
+void CAClipboard::setText(const std::string& cszStrText)
+{
+	s_sClipboardText = cszStrText;
+}
+
+NS_CC_END
@@ -0,0 +1,27 @@
+#include "platform/CACommon.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+NS_CC_BEGIN
+
+#define MAX_LEN         (CrossApp::kMaxLogLen + 1)
+
+void CCLog(const char * pszFormat, ...)
+{
+    char buf[MAX_LEN];
+
+    va_list args;
+    va_start(args, pszFormat);
+    vsnprintf(buf, MAX_LEN, pszFormat, args);
+    va_end(args);
+
+    fprintf(stderr, "%s\n", buf);
+}
+
+void CAMessageBox(const char * pszTitle, const char * pszMsg)
+{
+    // headless: nobody can dismiss a dialog, so just log it
+    CCLog("%s: %s", pszTitle, pszMsg);
+}
+
+NS_CC_END
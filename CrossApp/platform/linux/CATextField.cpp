@@ -0,0 +1,504 @@
+//
+//  CATextField.cpp
+//  CrossApp
+//
+//  Copyright (c) 2014 http://9miao.com All rights reserved.
+//
+
+#include "platform/CATextField.h"
+#include "platform/CADensityDpi.h"
+#include "animation/CAViewAnimation.h"
+#include "basics/CAScheduler.h"
+#include "control/CAButton.h"
+#include "support/CAThemeManager.h"
+#include "support/ccUtils.h"
+NS_CC_BEGIN
+
+// The headless backend has no native editor. Text is kept on the control and
+// drawn into the image view, which is what the native backends show whenever
+// their editor is not focused, so layouts and frames render the same way.
+
+CATextField::CATextField()
+: m_pBackgroundView(NULL)
+, m_pImgeView(NULL)
+, m_pTextField(NULL)
+, m_pDelegate(NULL)
+, m_bUpdateImage(true)
+, m_bSecureTextEntry(false)
+, m_bAllowkeyBoardHide(true)
+, m_iMarginLeft(10)
+, m_iMarginRight(10)
+, m_iFontSize(40)
+, m_iMaxLenght(0)
+, m_eClearBtn(None)
+, m_eAlign(Left)
+, m_eReturnType(Done)
+, m_obLastPoint(DPoint(-0xffff, -0xffff))
+{
+    this->setHaveNextResponder(false);
+}
+
+CATextField::~CATextField()
+{
+    CAViewAnimation::removeAnimations(m_s__StrID + "showImage");
+    m_pDelegate = NULL;
+}
+
+void CATextField::onEnterTransitionDidFinish()
+{
+    CAControl::onEnterTransitionDidFinish();
+    
+    this->delayShowImage();
+}
+
+void CATextField::onExitTransitionDidStart()
+{
+    CAControl::onExitTransitionDidStart();
+    if (this->isFirstResponder())
+    {
+        this->resignFirstResponder();
+    }
+}
+
+bool CATextField::resignFirstResponder()
+{
+	if (m_pDelegate && (!m_pDelegate->textFieldShouldEndEditing(this)))
+	{
+		return false;
+	}
+
+    bool result = CAControl::resignFirstResponder();
+
+    this->hideNativeTextField();
+    
+    if (m_eClearBtn == WhileEditing)
+    {
+        CAImageView* ima = (CAImageView*)this->getSubviewByTag(0xbbbb);
+        ima->setImage(NULL);
+    }
+
+    return result;
+}
+
+bool CATextField::becomeFirstResponder()
+{
+	if (m_pDelegate &&( !m_pDelegate->textFieldShouldBeginEditing(this)))
+	{
+		return false;
+	}
+
+	bool result = CAControl::becomeFirstResponder();
+
+    this->showNativeTextField();
+    const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
+	if (m_eClearBtn == WhileEditing)
+	{
+        CAImageView* ima = (CAImageView*)this->getSubviewByTag(0xbbbb);
+        ima->setImage(map.getImage("clearImage"));
+	}
+    
+    if (CAViewAnimation::areBeginAnimationsWithID(m_s__StrID + "showImage"))
+    {
+        CAViewAnimation::removeAnimations(m_s__StrID + "showImage");
+    }
+    
+    return result;
+}
+
+void CATextField::hideTextField()
+{
+//    m_pImgeView->setVisible(false);
+}
+
+void CATextField::showTextField()
+{
+//    m_pImgeView->setVisible(true);
+}
+
+void CATextField::hideNativeTextField()
+{
+    CAScheduler::unschedule(schedule_selector(CATextField::update), this);
+}
+
+void CATextField::showNativeTextField()
+{
+    CAScheduler::schedule(schedule_selector(CATextField::update), this, 1/60.0f);
+}
+
+void CATextField::delayShowImage()
+{
+    if (!CAViewAnimation::areBeginAnimationsWithID(m_s__StrID + "showImage"))
+    {
+        CAViewAnimation::beginAnimations(m_s__StrID + "showImage", NULL);
+        CAViewAnimation::setAnimationDuration(0.1f);
+        CAViewAnimation::setAnimationDidStopSelector(this, CAViewAnimation0_selector(CATextField::showImage));
+        CAViewAnimation::commitAnimations();
+    }
+}
+
+void CATextField::showImage()
+{
+    const std::string& text = m_sText.empty() ? m_sPlaceHolderText : m_sText;
+    const CAColor4B& color = m_sText.empty() ? m_cPlaceHdolderColor : m_cTextColor;
+
+    std::string showText = text;
+    if (m_bSecureTextEntry && !m_sText.empty())
+    {
+        showText = std::string(m_sText.length(), '*');
+    }
+
+    CATextAlignment align = CATextAlignmentLeft;
+    if (m_eAlign == Center)
+    {
+        align = CATextAlignmentCenter;
+    }
+    else if (m_eAlign == Right)
+    {
+        align = CATextAlignmentRight;
+    }
+
+    m_pImgeView->setLayout(DLayout(DHorizontalLayout_L_R(m_iMarginLeft, m_iMarginRight), DVerticalLayoutFill));
+
+    DSize size = DSize(m_obContentSize.width - m_iMarginLeft - m_iMarginRight, m_obContentSize.height);
+    CAImage* image = NULL;
+    if (!showText.empty() && size.width > 0 && size.height > 0)
+    {
+        image = CAImage::createWithString(showText.c_str(), color, "", m_iFontSize, size, align, CAVerticalTextAlignmentCenter, true);
+    }
+    m_pImgeView->setImage(image);
+}
+
+CATextField* CATextField::createWithFrame(const DRect& frame)
+{
+    CATextField *textField = new CATextField();
+    if (textField && textField->initWithFrame(frame))
+    {
+        textField->autorelease();
+        return textField;
+    }
+    CC_SAFE_DELETE(textField);
+    return NULL;
+}
+
+CATextField* CATextField::createWithCenter(const DRect& rect)
+{
+    CATextField* textField = new CATextField();
+    
+    if (textField && textField->initWithCenter(rect))
+    {
+        textField->autorelease();
+        return textField;
+    }
+    
+    CC_SAFE_DELETE(textField);
+    return NULL;
+}
+
+CATextField* CATextField::createWithLayout(const DLayout& layout)
+{
+    CATextField* textField = new CATextField();
+    if (textField && textField->initWithLayout(layout))
+    {
+        textField->autorelease();
+        return textField;
+    }
+    CC_SAFE_DELETE(textField);
+    return NULL;
+}
+
+bool CATextField::init()
+{
+    const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
+    CAImage* image = map.getImage("backgroundView_normal");
+    DRect capInsets = DRect(image->getPixelsWide()/2 ,image->getPixelsHigh()/2 , 1, 1);
+    m_pBackgroundView = CAScale9ImageView::createWithImage(image);
+    m_pBackgroundView->setLayout(DLayoutFill);
+    m_pBackgroundView->setCapInsets(capInsets);
+    this->insertSubview(m_pBackgroundView, -1);
+    
+    m_pImgeView = CAImageView::createWithLayout(DLayoutFill);
+	this->addSubview(m_pImgeView);
+    m_pImgeView->setTag(0xbcda);
+    
+    return true;
+}
+
+void CATextField::update(float dt)
+{
+    // no native editor to keep in place on the headless backend
+}
+
+void CATextField::setContentSize(const DSize& contentSize)
+{
+    DSize size = contentSize;
+    const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
+    if (m_bRecSpe)
+    {
+        int h = map.getInt("height");
+        size.height = (h == 0) ? size.height : h;
+    }
+    CAControl::setContentSize(size);
+    
+    if (m_eClearBtn == CATextField::ClearButtonMode::WhileEditing)
+    {
+        if (CAImageView* rightMarginView = dynamic_cast<CAImageView*>(this->getSubviewByTag(0xbbbb)))
+        {
+            DLayout layout;
+            layout.horizontal.right = 0;
+            layout.horizontal.width = m_obContentSize.height;
+            layout.vertical.height = m_obContentSize.height;
+            layout.vertical.center = 0.5f;
+            rightMarginView->setLayout(layout);
+        }
+    }
+    
+    this->delayShowImage();
+}
+
+bool CATextField::ccTouchBegan(CATouch *pTouch, CAEvent *pEvent)
+{
+    
+    return true;
+}
+
+void CATextField::ccTouchMoved(CATouch *pTouch, CAEvent *pEvent)
+{
+    
+}
+
+void CATextField::ccTouchEnded(CATouch *pTouch, CAEvent *pEvent)
+{
+    DPoint point = this->convertTouchToNodeSpace(pTouch);
+    
+    if (this->getBounds().containsPoint(point))
+    {
+        becomeFirstResponder();
+    }
+    else
+    {
+        resignFirstResponder();
+    }
+}
+
+void CATextField::ccTouchCancelled(CATouch *pTouch, CAEvent *pEvent)
+{
+    this->ccTouchEnded(pTouch, pEvent);
+}
+
+//
+void CATextField::setClearButtonMode(const ClearButtonMode& var)
+{
+    setMarginImageRight(DSize(m_obContentSize.height, m_obContentSize.height), "");
+    m_eClearBtn = var;
+}
+
+const CATextField::ClearButtonMode& CATextField::getClearButtonMode()
+{
+	return m_eClearBtn;
+}
+
+void CATextField::setMarginLeft(int var)
+{
+	m_iMarginLeft = var;
+
+    this->delayShowImage();
+}
+
+int CATextField::getMarginLeft()
+{
+	return m_iMarginLeft;
+}
+
+void CATextField::setMarginRight(int var)
+{
+    if (m_eClearBtn == None)
+    {
+        m_iMarginRight = var;
+            
+        this->delayShowImage();
+    }
+}
+
+int CATextField::getMarginRight()
+{
+	return m_iMarginRight;
+}
+
+void CATextField::setMarginImageLeft(const DSize& imgSize, const std::string& filePath)
+{
+	//set margins
+	setMarginLeft(imgSize.width);
+
+	//setimage
+	CAImageView* leftMarginView = (CAImageView*)this->getSubviewByTag(1010);
+	if (!leftMarginView)
+	{
+		leftMarginView = CAImageView::create();
+		leftMarginView->setTag(1010);
+		this->addSubview(leftMarginView);
+	}
+    DLayout layout;
+    layout.horizontal.left = 0;
+    layout.horizontal.width = imgSize.width;
+    layout.vertical.height = imgSize.height;
+    layout.vertical.center = 0.5f;
+    leftMarginView->setLayout(layout);
+	leftMarginView->setImage(CAImage::create(filePath));
+}
+
+void CATextField::setMarginImageRight(const DSize& imgSize, const std::string& filePath)
+{
+	//set margins
+	setMarginRight(imgSize.width);
+
+    if (m_eClearBtn == None)
+    {
+        //setimage
+        CAImageView* rightMarginView = (CAImageView*)this->getSubviewByTag(0xbbbb);
+        if (!rightMarginView)
+        {
+            rightMarginView = CAImageView::create();
+            rightMarginView->setTag(0xbbbb);
+            this->addSubview(rightMarginView);
+        }
+        DLayout layout;
+        layout.horizontal.right = 0;
+        layout.horizontal.width = imgSize.width;
+        layout.vertical.height = imgSize.height;
+        layout.vertical.center = 0.5f;
+        rightMarginView->setLayout(layout);
+        rightMarginView->setImage(CAImage::create(filePath));
+    }
+}
+
+void CATextField::setFontSize(int var)
+{
+	m_iFontSize = var;
+
+    this->delayShowImage();
+}
+
+int CATextField::getFontSize()
+{
+	return m_iFontSize;
+}
+
+void CATextField::setPlaceHolderText(const std::string& var)
+{
+	m_sPlaceHolderText = var;
+
+    this->delayShowImage();
+}
+
+const std::string& CATextField::getPlaceHolderText()
+{
+	return m_sPlaceHolderText;
+}
+
+void CATextField::setPlaceHolderColor(const CAColor4B& var)
+{
+	m_cPlaceHdolderColor = var;
+
+    this->delayShowImage();
+}
+
+const CAColor4B& CATextField::getPlaceHolderColor()
+{
+	return m_cPlaceHdolderColor;
+}
+
+void CATextField::setText(const std::string& var)
+{
+	m_sText = var;
+    this->delayShowImage();
+}
+
+const std::string& CATextField::getText()
+{
+	return m_sText;
+}
+
+void CATextField::setTextColor(const CAColor4B& var)
+{
+	m_cTextColor = var;
+
+    this->delayShowImage();
+}
+
+const CAColor4B& CATextField::getTextColor()
+{
+	return m_cTextColor; 
+}
+
+void CATextField::setKeyboardType(const KeyboardType& var)
+{
+	m_eKeyBoardType = var;
+}
+
+const CATextField::KeyboardType& CATextField::getKeyboardType()
+{
+	return m_eKeyBoardType;
+}
+
+void CATextField::setReturnType(const ReturnType& var)
+{
+	m_eReturnType = var;
+}
+
+const CATextField::ReturnType& CATextField::getReturnType()
+{
+	return m_eReturnType;
+}
+
+void CATextField::setBackgroundImage(CAImage* image)
+{
+    if (image)
+    {
+        DRect capInsets = DRect(image->getPixelsWide()/2 ,image->getPixelsHigh()/2 , 1, 1);
+        m_pBackgroundView->setCapInsets(capInsets);
+    }
+    m_pBackgroundView->setImage(image);
+}
+
+void CATextField::setTextFieldAlign(const TextFieldAlign& var)
+{
+    m_eAlign = var;
+    
+    this->delayShowImage();
+}
+
+const CATextField::TextFieldAlign& CATextField::getTextFieldAlign()
+{
+    return m_eAlign;
+}
+
+void CATextField::setSecureTextEntry(bool var)
+{
+    m_bSecureTextEntry = var;
+    this->delayShowImage();
+}
+
+bool CATextField::isSecureTextEntry()
+{
+    return m_bSecureTextEntry;
+}
+
+
+void CATextField::setMaxLenght(int var)
+{
+    m_iMaxLenght = var;
+}
+
+int CATextField::getMaxLenght()
+{
+    return m_iMaxLenght;
+}
+
+void CATextField::clearBtnCallBack(CAControl* con, DPoint point)
+{
+	setText("");
+}
+
+
+NS_CC_END
+
@@ -0,0 +1,311 @@
+//
+//  CATextView.cpp
+//  CrossApp
+//
+//  Copyright (c) 2014 http://9miao.com All rights reserved.
+//
+
+#include "platform/CATextView.h"
+#include "platform/CADensityDpi.h"
+#include "animation/CAViewAnimation.h"
+#include "basics/CAScheduler.h"
+#include "support/CAThemeManager.h"
+#include "support/ccUtils.h"
+NS_CC_BEGIN
+
+// Like CATextField on this backend: no native editor, the text is drawn into
+// the image view that the native backends show while unfocused.
+
+CATextView::CATextView()
+: m_pBackgroundView(NULL)
+, m_pShowImageView(NULL)
+, m_pTextView(NULL)
+, m_iFontSize(40)
+, m_pDelegate(NULL)
+, m_eAlign(Left)
+, m_eReturnType(Default)
+, m_obLastPoint(DPoint(-0xffff, -0xffff))
+{
+    this->setHaveNextResponder(false);
+}
+
+CATextView::~CATextView()
+{
+    CAViewAnimation::removeAnimations(m_s__StrID + "showImage");
+    m_pDelegate = NULL;
+}
+
+void CATextView::onEnterTransitionDidFinish()
+{
+    CAControl::onEnterTransitionDidFinish();
+    
+    this->delayShowImage();
+}
+
+void CATextView::onExitTransitionDidStart()
+{
+    CAControl::onExitTransitionDidStart();
+    if (this->isFirstResponder())
+    {
+        this->resignFirstResponder();
+    }
+}
+
+bool CATextView::resignFirstResponder()
+{
+	if (m_pDelegate && (!m_pDelegate->textViewShouldEndEditing(this)))
+	{
+		return false;
+	}
+
+    bool result = CAControl::resignFirstResponder();
+
+    this->hideNativeTextView();
+
+    return result;
+}
+
+bool CATextView::becomeFirstResponder()
+{
+	if (m_pDelegate &&( !m_pDelegate->textViewShouldBeginEditing(this)))
+	{
+		return false;
+	}
+
+	bool result = CAControl::becomeFirstResponder();
+
+	this->showNativeTextView();
+
+    if (CAViewAnimation::areBeginAnimationsWithID(m_s__StrID + "showImage"))
+    {
+        CAViewAnimation::removeAnimations(m_s__StrID + "showImage");
+    }
+    
+    return result;
+}
+
+void CATextView::hideTextView()
+{
+//    m_pImgeView->setVisible(false);
+}
+
+void CATextView::showTextView()
+{
+//    m_pImgeView->setVisible(true);
+}
+
+void CATextView::hideNativeTextView()
+{
+	CAScheduler::unschedule(schedule_selector(CATextView::update), this);
+}
+
+void CATextView::showNativeTextView()
+{
+    this->update(0);
+	CAScheduler::schedule(schedule_selector(CATextView::update), this, 1 / 60.0f);
+}
+
+void CATextView::delayShowImage()
+{
+    if (!CAViewAnimation::areBeginAnimationsWithID(m_s__StrID + "showImage"))
+    {
+        CAViewAnimation::beginAnimations(m_s__StrID + "showImage", NULL);
+        CAViewAnimation::setAnimationDuration(0.1f);
+		CAViewAnimation::setAnimationDidStopSelector(this, CAViewAnimation0_selector(CATextView::showImage));
+        CAViewAnimation::commitAnimations();
+    }
+}
+
+void CATextView::showImage()
+{
+    CATextAlignment align = CATextAlignmentLeft;
+    if (m_eAlign == Center)
+    {
+        align = CATextAlignmentCenter;
+    }
+    else if (m_eAlign == Right)
+    {
+        align = CATextAlignmentRight;
+    }
+
+    CAImage* image = NULL;
+    if (!m_sText.empty() && m_obContentSize.width > 0 && m_obContentSize.height > 0)
+    {
+        image = CAImage::createWithString(m_sText.c_str(), m_sTextColor, "", m_iFontSize, m_obContentSize, align, CAVerticalTextAlignmentTop, true);
+    }
+    m_pShowImageView->setImage(image);
+}
+
+CATextView* CATextView::createWithFrame(const DRect& frame)
+{
+	CATextView *textView = new CATextView();
+	if (textView && textView->initWithFrame(frame))
+    {
+		textView->autorelease();
+		return textView;
+    }
+	CC_SAFE_DELETE(textView);
+    return NULL;
+}
+
+CATextView* CATextView::createWithCenter(const DRect& rect)
+{
+	CATextView* textView = new CATextView();
+    
+	if (textView && textView->initWithCenter(rect))
+    {
+		textView->autorelease();
+		return textView;
+    }
+    
+	CC_SAFE_DELETE(textView);
+    return NULL;
+}
+
+CATextView* CATextView::createWithLayout(const DLayout& layout)
+{
+    CATextView* textView = new CATextView();
+    if (textView&&textView->initWithLayout(layout))
+    {
+        textView->autorelease();
+        return textView;
+    }
+    
+    CC_SAFE_RELEASE_NULL(textView);
+    return NULL;
+}
+
+bool CATextView::init()
+{
+    const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
+    CAImage* image = map.getImage("backgroundView_normal");
+    DRect capInsets = DRect(image->getPixelsWide()/2 ,image->getPixelsHigh()/2 , 1, 1);
+
+	m_pBackgroundView = CAScale9ImageView::createWithImage(image);
+    m_pBackgroundView->setLayout(DLayoutFill);
+	m_pBackgroundView->setCapInsets(capInsets);
+	this->insertSubview(m_pBackgroundView, -1);
+    
+	m_pShowImageView = CAImageView::createWithLayout(DLayoutFill);
+	m_pShowImageView->setTag(0xbcda);
+	this->addSubview(m_pShowImageView);
+	
+    return true;
+}
+
+void CATextView::update(float dt)
+{
+    // no native editor to keep in place on the headless backend
+}
+
+void CATextView::setContentSize(const DSize& contentSize)
+{
+    CAControl::setContentSize(contentSize);
+    
+    this->delayShowImage();
+}
+
+bool CATextView::ccTouchBegan(CATouch *pTouch, CAEvent *pEvent)
+{
+    
+    return true;
+}
+
+void CATextView::ccTouchMoved(CATouch *pTouch, CAEvent *pEvent)
+{
+    
+}
+
+void CATextView::ccTouchEnded(CATouch *pTouch, CAEvent *pEvent)
+{
+    DPoint point = this->convertTouchToNodeSpace(pTouch);
+    
+    if (this->getBounds().containsPoint(point))
+    {
+        becomeFirstResponder();
+    }
+    else
+    {
+        resignFirstResponder();
+    }
+}
+
+void CATextView::ccTouchCancelled(CATouch *pTouch, CAEvent *pEvent)
+{
+    this->ccTouchEnded(pTouch, pEvent);
+}
+
+
+void CATextView::setFontSize(const int& var)
+{
+	m_iFontSize = var;
+
+    this->delayShowImage();
+}
+
+const int& CATextView::getFontSize()
+{
+	return m_iFontSize;
+}
+
+
+
+void CATextView::setText(const std::string& var)
+{
+	m_sText = var;
+    this->delayShowImage();
+}
+
+const std::string& CATextView::getText()
+{
+	return m_sText;
+}
+
+void CATextView::setTextColor(const CAColor4B& var)
+{
+	m_sTextColor = var;
+
+    this->delayShowImage();
+}
+
+const CAColor4B& CATextView::getTextColor()
+{
+	return m_sTextColor; 
+}
+
+void CATextView::setReturnType(const ReturnType& var)
+{
+    m_eReturnType = var;
+}
+
+const CATextView::ReturnType& CATextView::getReturnType()
+{
+    return m_eReturnType;
+}
+
+void CATextView::setBackgroundImage(CAImage* image)
+{
+    if (image)
+    {
+        DRect capInsets = DRect(image->getPixelsWide()/2 ,image->getPixelsHigh()/2 , 1, 1);
+        m_pBackgroundView->setCapInsets(capInsets);
+    }
+    m_pBackgroundView->setImage(image);
+}
+
+void CATextView::setTextViewAlign(const TextViewAlign& var)
+{
+    m_eAlign = var;
+    
+    this->delayShowImage();
+}
+
+const CATextView::TextViewAlign& CATextView::getTextViewAlign()
+{
+    return m_eAlign;
+}
+
+
+
+NS_CC_END
+
@@ -0,0 +1,201 @@
+#include "CCApplication.h"
+#include "CCEGLView.h"
+#include "basics/CAApplication.h"
+#include <cstring>
+#include <cfloat>
+#include <algorithm>
+#include <time.h>
+#include <unistd.h>
+
+NS_CC_BEGIN
+
+static double getMonotonicSeconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1000000000.0;
+}
+
+// sharedApplication pointer
+CCApplication * CCApplication::sm_pSharedApplication = 0;
+
+CCApplication::CCApplication()
+: m_eStatusBarStyle(CAStatusBarStyleDefault)
+, m_dAnimationInterval(1.0 / 60)
+, m_uFrameLimit(0)
+, m_uFrameCount(0)
+, m_dFrameTimeTotal(0)
+, m_dFrameTimeMin(DBL_MAX)
+, m_dFrameTimeMax(0)
+{
+    CC_ASSERT(! sm_pSharedApplication);
+    sm_pSharedApplication = this;
+
+    if (const char* fps = getenv("CROSSAPP_HEADLESS_FPS"))
+    {
+        double value = atof(fps);
+        this->setAnimationInterval(value > 0 ? 1.0 / value : 0);
+    }
+    if (const char* frames = getenv("CROSSAPP_HEADLESS_FRAMES"))
+    {
+        this->setFrameLimit((unsigned int)atoi(frames));
+    }
+}
+
+CCApplication::~CCApplication()
+{
+    CC_ASSERT(this == sm_pSharedApplication);
+    sm_pSharedApplication = NULL;
+}
+
+int CCApplication::run()
+{
+    // Initialize instance and CrossApp.
+    if (! applicationDidFinishLaunching())
+    {
+        return 0;
+    }
+
+    CCEGLView* pMainWnd = CCEGLView::sharedOpenGLView();
+    if (const char* dump = getenv("CROSSAPP_HEADLESS_DUMP"))
+    {
+        const char* every = getenv("CROSSAPP_HEADLESS_DUMP_EVERY");
+        pMainWnd->setFrameDumpDirectory(dump, every ? (unsigned int)atoi(every) : 1);
+    }
+
+    double nextFrame = getMonotonicSeconds();
+
+    while (pMainWnd->isOpenGLReady())
+    {
+        if (m_dAnimationInterval > 0)
+        {
+            // fixed rate: sleep up to the next frame boundary, but never try to catch up on missed frames
+            double now = getMonotonicSeconds();
+            if (now < nextFrame)
+            {
+                usleep((useconds_t)((nextFrame - now) * 1000000));
+            }
+            nextFrame = std::max(nextFrame, now) + m_dAnimationInterval;
+        }
+
+        double frameStart = getMonotonicSeconds();
+        CAApplication::getApplication()->mainLoop();
+        double frameTime = getMonotonicSeconds() - frameStart;
+
+        ++m_uFrameCount;
+        m_dFrameTimeTotal += frameTime;
+        m_dFrameTimeMin = std::min(m_dFrameTimeMin, frameTime);
+        m_dFrameTimeMax = std::max(m_dFrameTimeMax, frameTime);
+
+        CC_BREAK_IF(m_uFrameLimit > 0 && m_uFrameCount >= m_uFrameLimit);
+    }
+
+    this->logFrameStatistics();
+
+    return 0;
+}
+
+void CCApplication::logFrameStatistics()
+{
+    CC_RETURN_IF(m_uFrameCount == 0);
+
+    CCLog("CrossApp headless: %u frames, avg %.3f ms, min %.3f ms, max %.3f ms",
+          m_uFrameCount,
+          m_dFrameTimeTotal * 1000 / m_uFrameCount,
+          m_dFrameTimeMin * 1000,
+          m_dFrameTimeMax * 1000);
+}
+
+void CCApplication::setAnimationInterval(double interval)
+{
+    m_dAnimationInterval = interval;
+}
+
+void CCApplication::setFrameLimit(unsigned int frames)
+{
+    m_uFrameLimit = frames;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// static member function
+//////////////////////////////////////////////////////////////////////////
+CCApplication* CCApplication::sharedApplication()
+{
+    CC_ASSERT(sm_pSharedApplication);
+    return sm_pSharedApplication;
+}
+
+void CCApplication::setStatusBarStyle(const CAStatusBarStyle &var)
+{
+    m_eStatusBarStyle = var;
+}
+
+ccLanguageType CCApplication::getCurrentLanguage()
+{
+    // LANG looks like "zh_CN.UTF-8", only the language code matters here
+    const char* pLanguageName = getenv("LANG");
+    ccLanguageType ret = kLanguageEnglish;
+
+    if (pLanguageName == NULL || strlen(pLanguageName) < 2)
+    {
+        return ret;
+    }
+
+    if (0 == strncmp("zh", pLanguageName, 2))
+    {
+        ret = kLanguageChinese;
+    }
+    else if (0 == strncmp("fr", pLanguageName, 2))
+    {
+        ret = kLanguageFrench;
+    }
+    else if (0 == strncmp("it", pLanguageName, 2))
+    {
+        ret = kLanguageItalian;
+    }
+    else if (0 == strncmp("de", pLanguageName, 2))
+    {
+        ret = kLanguageGerman;
+    }
+    else if (0 == strncmp("es", pLanguageName, 2))
+    {
+        ret = kLanguageSpanish;
+    }
+    else if (0 == strncmp("nl", pLanguageName, 2))
+    {
+        ret = kLanguageDutch;
+    }
+    else if (0 == strncmp("ru", pLanguageName, 2))
+    {
+        ret = kLanguageRussian;
+    }
+    else if (0 == strncmp("ko", pLanguageName, 2))
+    {
+        ret = kLanguageKorean;
+    }
+    else if (0 == strncmp("ja", pLanguageName, 2))
+    {
+        ret = kLanguageJapanese;
+    }
+    else if (0 == strncmp("hu", pLanguageName, 2))
+    {
+        ret = kLanguageHungarian;
+    }
+    else if (0 == strncmp("pt", pLanguageName, 2))
+    {
+        ret = kLanguagePortuguese;
+    }
+    else if (0 == strncmp("ar", pLanguageName, 2))
+    {
+        ret = kLanguageArabic;
+    }
+
+    return ret;
+}
+
+TargetPlatform CCApplication::getTargetPlatform()
+{
+    return kTargetLinux;
+}
+
+NS_CC_END
@@ -0,0 +1,90 @@
+#ifndef __CC_APPLICATION_LINUX_H__
+#define __CC_APPLICATION_LINUX_H__
+
+#include "CCStdC.h"
+#include "platform/CACommon.h"
+#include "platform/CCApplicationProtocol.h"
+#include "ccTypes.h"
+
+NS_CC_BEGIN
+
+class DRect;
+
+/**
+ * Headless application for CI and performance runs. There is no window and
+ * no input; run() drives the director from a plain loop, either at the
+ * animation interval or unthrottled, optionally stopping after a fixed
+ * number of frames and logging frame time statistics when it returns.
+ *
+ * The loop can also be configured from the environment:
+ *   CROSSAPP_HEADLESS_FPS      frames per second, 0 runs unthrottled
+ *   CROSSAPP_HEADLESS_FRAMES   number of frames to run before returning
+ *   CROSSAPP_HEADLESS_DUMP     directory receiving one PNG per dumped frame
+ *   CROSSAPP_HEADLESS_DUMP_EVERY  dump interval in frames, default 1
+ */
+class CC_DLL CCApplication : public CCApplicationProtocol
+{
+public:
+    CCApplication();
+    virtual ~CCApplication();
+
+    /**
+    @brief    Run the frame loop until the director ends or the frame limit is hit.
+    */
+    virtual int run();
+
+    /**
+    @brief    Get current application instance.
+    @return Current application instance pointer.
+    */
+    static CCApplication* sharedApplication();
+
+    /**
+    @brief    Interval between two frames, in seconds. 0 runs unthrottled.
+    */
+    virtual void setAnimationInterval(double interval);
+
+    virtual ccLanguageType getCurrentLanguage();
+
+    /**
+     @brief Get target platform
+     */
+    virtual TargetPlatform getTargetPlatform();
+
+    void setStatusBarStyle(const CAStatusBarStyle& var);
+
+    /**
+    @brief    Stop run() after this many frames, 0 runs until the director ends.
+    */
+    void setFrameLimit(unsigned int frames);
+
+    unsigned int getFrameLimit() const { return m_uFrameLimit; }
+
+    unsigned int getFrameCount() const { return m_uFrameCount; }
+
+protected:
+
+    void logFrameStatistics();
+
+protected:
+
+    static CCApplication * sm_pSharedApplication;
+
+    CAStatusBarStyle    m_eStatusBarStyle;
+
+    double              m_dAnimationInterval;
+
+    unsigned int        m_uFrameLimit;
+
+    unsigned int        m_uFrameCount;
+
+    double              m_dFrameTimeTotal;
+
+    double              m_dFrameTimeMin;
+
+    double              m_dFrameTimeMax;
+};
+
+NS_CC_END
+
+#endif    // __CC_APPLICATION_LINUX_H__
@@ -0,0 +1,262 @@
+#include "CCEGLView.h"
+#include "basics/CAApplication.h"
+#include "images/CAImage.h"
+#include "ccMacros.h"
+#include "CCGL.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+// keep X11 out, the backend never talks to a display server
+#ifndef EGL_NO_X11
+#define EGL_NO_X11
+#endif
+#ifndef MESA_EGL_NO_X11_HEADERS
+#define MESA_EGL_NO_X11_HEADERS
+#endif
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOESEXT = 0;
+PFNGLBINDVERTEXARRAYOESPROC glBindVertexArrayOESEXT = 0;
+PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT = 0;
+PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOESEXT = 0;
+PFNGLPROGRAMBINARYOESPROC glProgramBinaryOESEXT = 0;
+
+static void initExtensions()
+{
+    glGenVertexArraysOESEXT = (PFNGLGENVERTEXARRAYSOESPROC)eglGetProcAddress("glGenVertexArraysOES");
+    glBindVertexArrayOESEXT = (PFNGLBINDVERTEXARRAYOESPROC)eglGetProcAddress("glBindVertexArrayOES");
+    glDeleteVertexArraysOESEXT = (PFNGLDELETEVERTEXARRAYSOESPROC)eglGetProcAddress("glDeleteVertexArraysOES");
+    glGetProgramBinaryOESEXT = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+    glProgramBinaryOESEXT = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+}
+
+static EGLDisplay getHeadlessDisplay()
+{
+    // prefer Mesa's surfaceless platform, it needs neither X11 nor a DRM device
+#if defined(EGL_PLATFORM_SURFACELESS_MESA)
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+        {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            if (display != EGL_NO_DISPLAY)
+            {
+                return display;
+            }
+        }
+    }
+#endif
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+NS_CC_BEGIN
+
+CCEGLView::CCEGLView()
+: m_pDisplay(EGL_NO_DISPLAY)
+, m_pConfig(NULL)
+, m_pContext(EGL_NO_CONTEXT)
+, m_pSurface(EGL_NO_SURFACE)
+, m_bEnded(false)
+, m_uDumpInterval(1)
+, m_uPresentedFrames(0)
+{
+    setViewName("CrossApp");
+}
+
+CCEGLView::~CCEGLView()
+{
+    this->destroyEGL();
+}
+
+bool CCEGLView::initEGL(int width, int height)
+{
+    if (m_pDisplay == EGL_NO_DISPLAY)
+    {
+        EGLDisplay display = getHeadlessDisplay();
+        EGLint major = 0, minor = 0;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+        {
+            CCLOG("CCEGLView: could not initialize an EGL display");
+            return false;
+        }
+        eglBindAPI(EGL_OPENGL_ES_API);
+
+        const EGLint configAttribs[] =
+        {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_STENCIL_SIZE, 8,
+            EGL_NONE
+        };
+        EGLConfig config = NULL;
+        EGLint count = 0;
+        if (!eglChooseConfig(display, configAttribs, &config, 1, &count) || count == 0)
+        {
+            CCLOG("CCEGLView: no RGBA8888 pbuffer config with depth and stencil");
+            eglTerminate(display);
+            return false;
+        }
+
+        const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+        EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (context == EGL_NO_CONTEXT)
+        {
+            CCLOG("CCEGLView: could not create an OpenGL ES 2.0 context");
+            eglTerminate(display);
+            return false;
+        }
+
+        m_pDisplay = display;
+        m_pConfig = config;
+        m_pContext = context;
+        CCLOG("CCEGLView: EGL %d.%d, %s", major, minor, eglQueryString(display, EGL_VENDOR));
+    }
+
+    this->destroySurface();
+
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    EGLSurface surface = eglCreatePbufferSurface(m_pDisplay, m_pConfig, surfaceAttribs);
+    if (surface == EGL_NO_SURFACE)
+    {
+        CCLOG("CCEGLView: could not create a %dx%d pbuffer", width, height);
+        return false;
+    }
+    m_pSurface = surface;
+
+    if (!eglMakeCurrent(m_pDisplay, m_pSurface, m_pSurface, m_pContext))
+    {
+        CCLOG("CCEGLView: eglMakeCurrent failed");
+        this->destroySurface();
+        return false;
+    }
+
+    initExtensions();
+    return true;
+}
+
+void CCEGLView::destroySurface()
+{
+    CC_RETURN_IF(m_pSurface == EGL_NO_SURFACE);
+
+    eglMakeCurrent(m_pDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(m_pDisplay, m_pSurface);
+    m_pSurface = EGL_NO_SURFACE;
+}
+
+void CCEGLView::destroyEGL()
+{
+    CC_RETURN_IF(m_pDisplay == EGL_NO_DISPLAY);
+
+    this->destroySurface();
+    if (m_pContext != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(m_pDisplay, m_pContext);
+        m_pContext = EGL_NO_CONTEXT;
+    }
+    eglTerminate(m_pDisplay);
+    m_pDisplay = EGL_NO_DISPLAY;
+}
+
+bool CCEGLView::isOpenGLReady()
+{
+    return !m_bEnded && m_pSurface != EGL_NO_SURFACE;
+}
+
+void CCEGLView::end()
+{
+    m_bEnded = true;
+    this->destroyEGL();
+}
+
+void CCEGLView::setFrameSize(float width, float height)
+{
+    if (this->initEGL((int)width, (int)height))
+    {
+        CCEGLViewProtocol::setFrameSize(width, height);
+    }
+}
+
+void CCEGLView::swapBuffers()
+{
+    CC_RETURN_IF(m_pSurface == EGL_NO_SURFACE);
+
+    // the back buffer still holds the frame until eglSwapBuffers, read it back first
+    if (!m_sDumpDirectory.empty() && m_uPresentedFrames % m_uDumpInterval == 0)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "frame_%06u.png", m_uPresentedFrames);
+        this->saveFrameToPNG(m_sDumpDirectory + name);
+    }
+
+    eglSwapBuffers(m_pDisplay, m_pSurface);
+    ++m_uPresentedFrames;
+}
+
+void CCEGLView::setFrameDumpDirectory(const std::string& directory, unsigned int interval)
+{
+    m_sDumpDirectory = directory;
+    if (!m_sDumpDirectory.empty() && m_sDumpDirectory[m_sDumpDirectory.length() - 1] != '/')
+    {
+        m_sDumpDirectory += '/';
+    }
+    m_uDumpInterval = std::max(1u, interval);
+}
+
+bool CCEGLView::saveFrameToPNG(const std::string& fullPath)
+{
+    int width = (int)m_obScreenSize.width;
+    int height = (int)m_obScreenSize.height;
+    if (m_pSurface == EGL_NO_SURFACE || width <= 0 || height <= 0)
+    {
+        return false;
+    }
+
+    unsigned int rowBytes = width * 4;
+    unsigned char* pixels = (unsigned char*)malloc(rowBytes * height);
+    unsigned char* row = (unsigned char*)malloc(rowBytes);
+    if (pixels == NULL || row == NULL)
+    {
+        free(pixels);
+        free(row);
+        return false;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    // GL rows run bottom-up, PNG rows top-down
+    for (int top = 0, bottom = height - 1; top < bottom; ++top, --bottom)
+    {
+        memcpy(row, pixels + top * rowBytes, rowBytes);
+        memcpy(pixels + top * rowBytes, pixels + bottom * rowBytes, rowBytes);
+        memcpy(pixels + bottom * rowBytes, row, rowBytes);
+    }
+    free(row);
+
+    bool ret = false;
+    if (CAImage* image = CAImage::createWithRawDataNoCache(pixels, CAImage::PixelFormat_RGBA8888, width, height))
+    {
+        ret = image->saveToFile(fullPath);
+    }
+    free(pixels);
+    return ret;
+}
+
+CCEGLView* CCEGLView::sharedOpenGLView()
+{
+    static CCEGLView instance;
+    return &instance;
+}
+
+NS_CC_END
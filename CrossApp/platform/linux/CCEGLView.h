@@ -0,0 +1,77 @@
+#ifndef __CC_EGLVIEW_LINUX_H__
+#define __CC_EGLVIEW_LINUX_H__
+
+#include "platform/CCEGLViewProtocol.h"
+#include <string>
+
+NS_CC_BEGIN
+
+/**
+ * Offscreen GL view backed by an EGL pbuffer and an OpenGL ES 2.0 context.
+ * Works without a display server, e.g. on Mesa's software rasterizer with
+ * EGL_PLATFORM=surfaceless, so it can run on CI machines without a GPU.
+ * The pbuffer is (re)created by setFrameSize().
+ */
+class CC_DLL CCEGLView : public CCEGLViewProtocol
+{
+public:
+    CCEGLView();
+    virtual ~CCEGLView();
+
+    virtual bool isOpenGLReady();
+
+    virtual void end();
+
+    virtual void swapBuffers();
+
+    virtual void setFrameSize(float width, float height);
+
+    /**
+    @brief    Write every interval-th presented frame to directory/frame_NNNNNN.png.
+              An empty directory turns the dump off.
+    */
+    void setFrameDumpDirectory(const std::string& directory, unsigned int interval = 1);
+
+    /**
+    @brief    Read back the current back buffer and save it as a PNG file.
+    */
+    bool saveFrameToPNG(const std::string& fullPath);
+
+    unsigned int getPresentedFrames() const { return m_uPresentedFrames; }
+
+    /**
+    @brief    get the shared main open gl window
+    */
+    static CCEGLView* sharedOpenGLView();
+
+protected:
+
+    bool initEGL(int width, int height);
+
+    void destroySurface();
+
+    void destroyEGL();
+
+protected:
+
+    // EGL handles are kept opaque so that egl.h stays out of the engine headers
+    void*               m_pDisplay;
+
+    void*               m_pConfig;
+
+    void*               m_pContext;
+
+    void*               m_pSurface;
+
+    bool                m_bEnded;
+
+    std::string         m_sDumpDirectory;
+
+    unsigned int        m_uDumpInterval;
+
+    unsigned int        m_uPresentedFrames;
+};
+
+NS_CC_END
+
+#endif    // end of __CC_EGLVIEW_LINUX_H__
@@ -0,0 +1,117 @@
+#include "CCFileUtilsLinux.h"
+#include "platform/CACommon.h"
+#include "platform/CCPlatformConfig.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+NS_CC_BEGIN
+
+FileUtils* FileUtils::getInstance()
+{
+    if (s_sharedFileUtils == nullptr)
+    {
+        s_sharedFileUtils = new FileUtilsLinux();
+        if (!s_sharedFileUtils->init())
+        {
+            delete s_sharedFileUtils;
+            s_sharedFileUtils = nullptr;
+            CCLOG("ERROR: Could not init CCFileUtilsLinux");
+        }
+    }
+    return s_sharedFileUtils;
+}
+
+FileUtilsLinux::FileUtilsLinux()
+{
+}
+
+bool FileUtilsLinux::init()
+{
+    // resources live next to the executable unless CROSSAPP_RESOURCE_PATH says otherwise
+    std::string executableDir = "./";
+    char fullpath[PATH_MAX] = { 0 };
+    ssize_t length = readlink("/proc/self/exe", fullpath, sizeof(fullpath) - 1);
+    if (length > 0)
+    {
+        std::string executable(fullpath, length);
+        size_t slash = executable.find_last_of('/');
+        executableDir = executable.substr(0, slash + 1);
+        m_strApplicationName = executable.substr(slash + 1);
+    }
+
+    if (const char* resourcePath = getenv("CROSSAPP_RESOURCE_PATH"))
+    {
+        _defaultResRootPath = resourcePath;
+    }
+    else
+    {
+        _defaultResRootPath = executableDir + "Resources/";
+    }
+
+    if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length() - 1] != '/')
+    {
+        _defaultResRootPath += '/';
+    }
+
+    return FileUtils::init();
+}
+
+std::string FileUtilsLinux::getWritablePath()
+{
+    if (!_writablePath.empty())
+    {
+        return _writablePath;
+    }
+
+    // ~/.config/<executable>/, or the working directory when there is no home (e.g. CI containers)
+    std::string dir;
+    const char* home = getenv("HOME");
+    if (home && home[0] != '\0')
+    {
+        dir = std::string(home) + "/.config/" + (m_strApplicationName.empty() ? "CrossApp" : m_strApplicationName) + "/";
+    }
+    else
+    {
+        dir = "./";
+    }
+
+    if (!isDirectoryExist(dir))
+    {
+        createDirectory(dir);
+    }
+    return dir;
+}
+
+bool FileUtilsLinux::isFileExistInternal(const std::string& strFilePath) const
+{
+    if (strFilePath.empty())
+    {
+        return false;
+    }
+
+    std::string strPath = strFilePath;
+    if (!isAbsolutePath(strPath))
+    { // Not absolute path, add the default root path at the beginning.
+        strPath.insert(0, _defaultResRootPath);
+    }
+
+    struct stat sts;
+    return (stat(strPath.c_str(), &sts) == 0) && S_ISREG(sts.st_mode);
+}
+
+bool FileUtilsLinux::isDirectoryExistInternal(const std::string& dirPath) const
+{
+    struct stat sts;
+    return (stat(dirPath.c_str(), &sts) == 0) && S_ISDIR(sts.st_mode);
+}
+
+bool FileUtilsLinux::isAbsolutePath(const std::string& strPath) const
+{
+    return !strPath.empty() && strPath[0] == '/';
+}
+
+NS_CC_END
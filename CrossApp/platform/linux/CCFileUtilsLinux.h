@@ -0,0 +1,35 @@
+#ifndef __CC_FILEUTILS_LINUX_H__
+#define __CC_FILEUTILS_LINUX_H__
+
+#include "platform/CAFileUtils.h"
+#include "platform/CCPlatformMacros.h"
+#include "ccTypes.h"
+#include "ccTypeInfo.h"
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+//! @brief  Helper class to handle file operations
+class CC_DLL FileUtilsLinux : public FileUtils
+{
+    friend class FileUtils;
+    FileUtilsLinux();
+public:
+    /* override functions */
+    bool init();
+    virtual std::string getWritablePath();
+    virtual bool isAbsolutePath(const std::string& strPath) const;
+
+protected:
+
+    virtual bool isFileExistInternal(const std::string& strFilePath) const;
+
+    virtual bool isDirectoryExistInternal(const std::string& dirPath) const;
+
+    std::string m_strApplicationName;
+};
+
+NS_CC_END
+
+#endif    // __CC_FILEUTILS_LINUX_H__
@@ -0,0 +1,44 @@
+#ifndef __CCGL_H__
+#define __CCGL_H__
+
+// the headless backend renders through an EGL pbuffer with an OpenGL ES 2.0
+// context, so it shares the ES code paths with android rather than desktop GL
+#define	glClearDepth				glClearDepthf
+#define glDeleteVertexArrays		glDeleteVertexArraysOES
+#define glGenVertexArrays			glGenVertexArraysOES
+#define glBindVertexArray			glBindVertexArrayOES
+#define glMapBuffer					glMapBufferOES
+#define glUnmapBuffer				glUnmapBufferOES
+
+#define GL_DEPTH24_STENCIL8			GL_DEPTH24_STENCIL8_OES
+#define GL_WRITE_ONLY				GL_WRITE_ONLY_OES
+
+#include <GLES2/gl2platform.h>
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES 1
+#endif
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#ifndef GL_BGRA
+#define GL_BGRA  0x80E1
+#endif
+
+//declare here while define in CCEGLView.cpp
+extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOESEXT;
+extern PFNGLBINDVERTEXARRAYOESPROC glBindVertexArrayOESEXT;
+extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT;
+
+#define glGenVertexArraysOES glGenVertexArraysOESEXT
+#define glBindVertexArrayOES glBindVertexArrayOESEXT
+#define glDeleteVertexArraysOES glDeleteVertexArraysOESEXT
+
+// GL_OES_get_program_binary, resolved at runtime, NULL when the driver lacks it
+extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOESEXT;
+extern PFNGLPROGRAMBINARYOESPROC glProgramBinaryOESEXT;
+#define glGetProgramBinaryOES glGetProgramBinaryOESEXT
+#define glProgramBinaryOES glProgramBinaryOESEXT
+
+
+#endif // __CCGL_H__
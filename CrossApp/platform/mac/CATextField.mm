@@ -567,7 +567,7 @@ CATextField* CATextField::createWithLayout(const DLayout& layout)
 bool CATextField::init()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
-    CAImage* image = CAImage::create(map.at("backgroundView_normal"));
+    CAImage* image = map.getImage("backgroundView_normal");
     DRect capInsets = DRect(image->getPixelsWide()/2 ,image->getPixelsHigh()/2 , 1, 1);
     m_pBackgroundView = CAScale9ImageView::createWithImage(image);
     m_pBackgroundView->setLayout(DLayoutFill);
@@ -608,7 +608,7 @@ void CATextField::setContentSize(const DSize& contentSize)
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
     if (m_bRecSpe)
     {
-        int h = atoi(map.at("height").c_str());
+        int h = map.getInt("height");
         size.height = (h == 0) ? size.height : h;
     }
     CAControl::setContentSize(size);
@@ -866,7 +866,7 @@ void CATextField::setClearButtonMode(const ClearButtonMode &var)
         this->setMarginImageRight(DSize(m_obContentSize.height, m_obContentSize.height), "");
         const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
         CAButton* rightMarginView = (CAButton*)this->getSubviewByTag(1011);
-        rightMarginView->setImageForState(CAControlStateAll, CAImage::create(map.at("clearImage")));
+        rightMarginView->setImageForState(CAControlStateAll, map.getImage("clearImage"));
         rightMarginView->setImageColorForState(CAControlStateHighlighted, ccc4Int(0xff666666));
         rightMarginView->addTarget(this, CAControl_selector(CATextField::clearBtnCallBack), CAControlEventTouchUpInSide);
 
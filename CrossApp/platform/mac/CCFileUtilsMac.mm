@@ -476,6 +476,7 @@ bool FileUtils::writeValueMapToFile(const CAValueMap& dict, const std::string& f
     NSString *file = [NSString stringWithUTF8String:fullPath.c_str()];
     // do it atomically
     [nsDict writeToFile:file atomically:YES];
+    this->fileCreated(fullPath);
     
     return true;
 }
@@ -491,6 +492,7 @@ bool FileUtils::writeValueVectorToFile(const CAValueVector& vecData, const std::
     }
     
     [array writeToFile:path atomically:YES];
+    this->fileCreated(fullPath);
     
     return true;
 }
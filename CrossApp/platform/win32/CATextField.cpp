@@ -771,7 +771,7 @@ bool CATextField::init()
 	this->setColor(CAColor_clear);
 
 	const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CATextField");
-	CAImage* image = CAImage::create(map.at("backgroundView_normal"));
+	CAImage* image = map.getImage("backgroundView_normal");
 	m_pBackgroundView = CAScale9ImageView::createWithFrame(DRect(0, 0, 1, 1));
 	m_pBackgroundView->setLayout(DLayoutFill);
 	m_pBackgroundView->setCapInsets(DRect(image->getPixelsWide() / 2, image->getPixelsHigh() / 2, 1, 1));
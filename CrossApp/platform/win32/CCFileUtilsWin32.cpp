@@ -1,6 +1,7 @@
 
 #include "CCFileUtilsWin32.h"
 #include "platform/CACommon.h"
+#include "support/zip_support/ZipArchive.h"
 #include <Shlobj.h>
 #include <cstdlib>
 #include <regex>
@@ -166,6 +167,13 @@ std::string FileUtilsWin32::getSuitableFOpen(const std::string& filenameUtf8) co
 
 long FileUtilsWin32::getFileSize(const std::string &filepath)
 {
+	std::string fileName;
+	std::shared_ptr<ZipArchive> archive = getArchiveForFullPath(filepath, &fileName);
+	if (archive)
+	{
+		return archive->getFileSize(fileName);
+	}
+
 	WIN32_FILE_ATTRIBUTE_DATA fad;
 	if (!GetFileAttributesEx(StringUtf8ToWideChar(filepath).c_str(), GetFileExInfoStandard, &fad))
 	{
@@ -260,6 +268,12 @@ unsigned char* FileUtilsWin32::getFileData(const std::string& filename, const ch
 		// read the file from hardware
 		std::string fullPath = fullPathForFilename(filename);
 
+		if (getArchiveForFullPath(fullPath, nullptr))
+		{
+			pBuffer = getFileDataFromArchive(fullPath, size);
+			break;
+		}
+
 		// check if the filename uses correct case characters
 		checkFileName(fullPath, filename);
 
@@ -383,6 +397,7 @@ bool FileUtilsWin32::renameFile(const std::string &oldfullpath, const std::strin
 
 	if (MoveFile(_wOld.c_str(), _wNew.c_str()))
 	{
+		this->fileCreated(newfullpath);
 		return true;
 	}
 	else
@@ -459,6 +474,7 @@ bool FileUtilsWin32::createDirectory(const std::string& dirPath)
 			}
 		}
 	}
+	this->purgeMissingEntries();
 	return true;
 }
 
@@ -0,0 +1,101 @@
+# Common rules for the linux makefiles of the engine, the audio engine and the samples.
+# A makefile sets TARGET, SOURCES and optionally INCLUDES, DEFINES, SHAREDLIBS and
+# STATICLIBS, includes this file and writes its own link rule.
+#
+#   make DEBUG=1          debug build, objects and libraries go to .../debug
+#   make V=1              print the full compiler command lines
+#   make USE_WEBSOCKETS=1 also build support/network/WebSocket.cpp, needs libwebsockets
+
+all:
+
+CC ?= gcc
+CXX ?= g++
+AR ?= ar
+ARFLAGS = cr
+
+DEBUG ?= 0
+USE_WEBSOCKETS ?= 0
+
+ifeq ($(DEBUG),1)
+DEFINES += -DCOCOS2D_DEBUG=1
+OPTFLAGS = -g3 -O0
+CONFIG = debug
+else
+DEFINES += -DNDEBUG
+OPTFLAGS = -O2
+CONFIG = release
+endif
+
+LBITS := $(shell getconf LONG_BIT)
+ifeq ($(LBITS),64)
+ARCH_DIR = 64-bit
+else
+ARCH_DIR = 32-bit
+endif
+
+THIS_MAKEFILE := $(lastword $(MAKEFILE_LIST))
+COCOS_ROOT ?= $(realpath $(dir $(THIS_MAKEFILE))/../..)
+CROSSAPP_SRC = $(COCOS_ROOT)/CrossApp
+THIRD_PARTY = $(CROSSAPP_SRC)/the_third_party
+
+OBJ_DIR ?= obj/$(CONFIG)
+LIB_DIR = $(COCOS_ROOT)/lib/linux/$(CONFIG)
+BIN_DIR = bin/$(CONFIG)
+
+DEFINES += -DLINUX -DUSE_FILE32API -D__STDC_CONSTANT_MACROS
+
+CCFLAGS += $(OPTFLAGS) -Wall -Wno-unused-function -fPIC -MMD
+CXXFLAGS += $(OPTFLAGS) -std=c++11 -Wall -Wno-deprecated-declarations -fPIC -MMD
+CXXFLAGS += -fexceptions -pthread
+
+# png, freetype, curl, sqlite3 and zlib come from the system, jpeg, tiff and webp from the_third_party.
+# lib_json goes last, its features.h would hide the one of glibc
+INCLUDES += -I$(CROSSAPP_SRC) \
+	-I$(CROSSAPP_SRC)/kazmath/include \
+	-I$(CROSSAPP_SRC)/platform/linux \
+	-I$(CROSSAPP_SRC)/support/network \
+	-I$(CROSSAPP_SRC)/support/LocalStorage \
+	-I$(CROSSAPP_SRC)/support/Json \
+	-idirafter $(CROSSAPP_SRC)/support/Json/lib_json \
+	-I$(CROSSAPP_SRC)/images/gif_lib \
+	-I$(THIRD_PARTY)/jpeg/include/linux \
+	-I$(THIRD_PARTY)/tiff/include/linux \
+	-I$(THIRD_PARTY)/webp/include/linux \
+	-I$(THIRD_PARTY)/websockets/include/android \
+	-I$(FREETYPE_INCLUDE) \
+	-I$(FREETYPE_INCLUDE)/freetype
+
+# the fonts include <freetype.h> directly, as the bundled freetype headers are laid out
+FREETYPE_INCLUDE ?= /usr/include/freetype2
+
+STATICLIBS_DIR = $(THIRD_PARTY)
+CROSSAPP_STATICLIBS = $(STATICLIBS_DIR)/jpeg/prebuilt/linux/$(ARCH_DIR)/libjpeg.a \
+	$(STATICLIBS_DIR)/tiff/prebuilt/linux/$(ARCH_DIR)/libtiff.a \
+	$(STATICLIBS_DIR)/webp/prebuilt/linux/$(ARCH_DIR)/libwebp.a
+
+CROSSAPP_SHAREDLIBS = -lEGL -lGLESv2 -lpng -lfreetype -lcurl -lsqlite3 -lz -lpthread -ldl
+ifeq ($(USE_WEBSOCKETS),1)
+CROSSAPP_SHAREDLIBS += -lwebsockets
+endif
+
+OBJECTS := $(SOURCES:.cpp=.o)
+OBJECTS := $(OBJECTS:.c=.o)
+OBJECTS := $(subst ../,,$(OBJECTS))
+OBJECTS := $(subst $(COCOS_ROOT)/,,$(OBJECTS))
+OBJECTS := $(addprefix $(OBJ_DIR)/, $(OBJECTS))
+DEPS = $(OBJECTS:.o=.d)
+CORE_MAKEFILE_LIST := $(MAKEFILE_LIST)
+-include $(DEPS)
+
+ifneq ($(V),1)
+LOG_CC = @echo "  CC    $@";
+LOG_CXX = @echo "  CXX   $@";
+LOG_AR = @echo "  AR    $@";
+LOG_LINK = @echo "  LINK  $@";
+endif
+
+clean:
+	rm -rf $(OBJ_DIR)
+	rm -f $(TARGET)
+
+.PHONY: all clean
@@ -9,6 +9,7 @@
 // extern
 #include "kazmath/GL/matrix.h"
 #include "kazmath/kazmath.h"
+#include "math/CAMat4.h"
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
 #include "CAGPUAdapter.h"
@@ -16,6 +17,19 @@
 
 #define GLSL_VERSION_CODE_LEN 64
 
+// program binaries: GL_OES_get_program_binary on GLES2, GL_ARB_get_program_binary through glew
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#define CC_GL_PROGRAM_BINARY_LENGTH         GL_PROGRAM_BINARY_LENGTH_OES
+#define CC_GL_NUM_PROGRAM_BINARY_FORMATS    GL_NUM_PROGRAM_BINARY_FORMATS_OES
+#define ccGLGetProgramBinary                glGetProgramBinaryOES
+#define ccGLProgramBinary                   glProgramBinaryOES
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#define CC_GL_PROGRAM_BINARY_LENGTH         GL_PROGRAM_BINARY_LENGTH
+#define CC_GL_NUM_PROGRAM_BINARY_FORMATS    GL_NUM_PROGRAM_BINARY_FORMATS
+#define ccGLGetProgramBinary                glGetProgramBinary
+#define ccGLProgramBinary                   glProgramBinary
+#endif
+
 NS_CC_BEGIN
 
 typedef struct _hashUniformEntry
@@ -139,6 +153,81 @@ bool CAGLProgram::initWithPrecompiledProgramByteArray(const GLchar* vShaderByteA
 }
 #endif
 
+bool CAGLProgram::initWithProgramBinary(const void* binary, GLsizei length, GLenum binaryFormat)
+{
+#if defined(CC_GL_PROGRAM_BINARY_LENGTH)
+    m_uProgram = glCreateProgram();
+    CHECK_GL_ERROR_DEBUG();
+
+    m_uVertShader = m_uFragShader = 0;
+    m_pHashForUniforms = NULL;
+
+    ccGLProgramBinary(m_uProgram, binaryFormat, binary, length);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(m_uProgram, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        // a stale or foreign binary is an expected miss, don't leave its error behind
+        glGetError();
+        ccGLDeleteProgram(m_uProgram);
+        m_uProgram = 0;
+        return false;
+    }
+    return true;
+#else
+    CC_UNUSED_PARAM(binary);
+    CC_UNUSED_PARAM(length);
+    CC_UNUSED_PARAM(binaryFormat);
+    return false;
+#endif
+}
+
+bool CAGLProgram::getProgramBinary(std::string& binary, GLenum* binaryFormat)
+{
+    binary.clear();
+    CC_RETURN_IF(m_uProgram == 0) false;
+
+#if defined(CC_GL_PROGRAM_BINARY_LENGTH)
+    GLint length = 0;
+    glGetProgramiv(m_uProgram, CC_GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return false;
+    }
+
+    binary.resize(length);
+    GLsizei written = 0;
+    ccGLGetProgramBinary(m_uProgram, length, &written, binaryFormat, &binary[0]);
+    if (glGetError() != GL_NO_ERROR || written <= 0)
+    {
+        binary.clear();
+        return false;
+    }
+    binary.resize(written);
+    return true;
+#else
+    CC_UNUSED_PARAM(binaryFormat);
+    return false;
+#endif
+}
+
+bool CAGLProgram::isProgramBinarySupported()
+{
+#if defined(CC_GL_PROGRAM_BINARY_LENGTH)
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    CC_RETURN_IF(!GLEW_ARB_get_program_binary) false;
+#else
+    CC_RETURN_IF(glGetProgramBinaryOES == NULL || glProgramBinaryOES == NULL) false;
+#endif
+    GLint formats = 0;
+    glGetIntegerv(CC_GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+#else
+    return false;
+#endif
+}
+
 bool CAGLProgram::initWithVertexShaderFilename(const char* vShaderFilename, const char* fShaderFilename)
 {
     const GLchar * vertexSource = (GLchar*) FileUtils::getInstance()->getFileString(vShaderFilename).c_str();
@@ -169,7 +258,7 @@ bool CAGLProgram::compileShader(GLuint * shader, GLenum type, const GLchar* sour
 #endif
 
     const GLchar *sources[] = {
-#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32 && CC_TARGET_PLATFORM != CC_PLATFORM_LINUX && CC_TARGET_PLATFORM != CC_PLATFORM_MAC)
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32 && CC_TARGET_PLATFORM != CC_PLATFORM_MAC)
         (type == GL_VERTEX_SHADER ? "precision highp float;\n" : "precision mediump float;\n"),
 #endif
 
@@ -267,6 +356,14 @@ bool CAGLProgram::link()
 
     GLint status = GL_TRUE;
     
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // desktop drivers only keep the binary around when asked to before linking
+    if (GLEW_ARB_get_program_binary)
+    {
+        glProgramParameteri(m_uProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+#endif
+
     glLinkProgram(m_uProgram);
 
     if (m_uVertShader)
@@ -548,18 +645,24 @@ void CAGLProgram::setUniformLocationWithMatrix4fv(GLint location, GLfloat* matri
 
 void CAGLProgram::setUniformsForBuiltins()
 {
-    kmMat4 matrixP;
-	kmMat4 matrixMV;
-	kmMat4 matrixMVP;
+	Mat4 matrixMV;
+	kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV.m);
+    
+    this->setUniformsForBuiltins(matrixMV);
+}
+
+void CAGLProgram::setUniformsForBuiltins(const Mat4& matrixMV)
+{
+    Mat4 matrixP;
+	Mat4 matrixMVP;
 	
-	kmGLGetMatrix(KM_GL_PROJECTION, &matrixP);
-	kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV);
+	kmGLGetMatrix(KM_GL_PROJECTION, &matrixP.m);
 	
-	kmMat4Multiply(&matrixMVP, &matrixP, &matrixMV);
+	Mat4::multiply(matrixP, matrixMV, &matrixMVP);
     
-    setUniformLocationWithMatrix4fv(m_uUniforms[kCCUniformPMatrix], matrixP.mat, 1);
-    setUniformLocationWithMatrix4fv(m_uUniforms[kCCUniformMVMatrix], matrixMV.mat, 1);
-    setUniformLocationWithMatrix4fv(m_uUniforms[kCCUniformMVPMatrix], matrixMVP.mat, 1);
+    setUniformLocationWithMatrix4fv(m_uUniforms[kCCUniformPMatrix], matrixP.m.mat, 1);
+    setUniformLocationWithMatrix4fv(m_uUniforms[kCCUniformMVMatrix], const_cast<GLfloat*>(matrixMV.m.mat), 1);
+    setUniformLocationWithMatrix4fv(m_uUniforms[kCCUniformMVPMatrix], matrixMVP.m.mat, 1);
 	
 	if(m_bUsesTime)
     {
@@ -10,6 +10,8 @@
 
 NS_CC_BEGIN
 
+class Mat4;
+
 /**
  * @addtogroup shaders
  * @{
@@ -101,6 +103,22 @@ public:
      * @lua NA
      */
     bool initWithVertexShaderFilename(const char* vShaderFilename, const char* fShaderFilename);
+    /** Initializes the CAGLProgram with a program binary returned by getProgramBinary, which is already
+     *  linked with its attributes bound. Fails when the driver rejects it, e.g. after a driver update.
+     * @lua NA
+     */
+    bool initWithProgramBinary(const void* binary, GLsizei length, GLenum binaryFormat);
+
+    /** the linked program as a driver specific binary, false when unsupported
+     * @lua NA
+     */
+    bool getProgramBinary(std::string& binary, GLenum* binaryFormat);
+
+    /** whether the current context can save and restore program binaries
+     * @lua NA
+     */
+    static bool isProgramBinarySupported();
+
     /**  It will add a new attribute to the shader 
      * @lua NA
      */
@@ -218,6 +236,11 @@ public:
      *  @lua NA
      */
     void setUniformsForBuiltins();
+    
+    /** will update the builtin uniforms using the given model view matrix instead of the kazmath matrix stack.
+     *  @lua NA
+     */
+    void setUniformsForBuiltins(const Mat4& matrixMV);
 
     /** returns the vertexShader error log 
      *  @js  getVertexShaderLog
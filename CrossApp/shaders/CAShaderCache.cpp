@@ -4,6 +4,10 @@
 #include "CAGLProgram.h"
 #include "ccMacros.h"
 #include "ccShaders.h"
+#include "platform/CAFileUtils.h"
+#include "platform/platform.h"
+#include "ccTypeInfo.h"
+#include <stdio.h>
 
 
 NS_CC_BEGIN
@@ -22,6 +26,52 @@ enum {
     kCCShaderType_MAX,
 };
 
+// default programs, indexed by shader type
+static const struct
+{
+    const char* key;
+    bool        preload;    // drawn by nearly every scene, the others are built on first use
+}
+s_tDefaultShaders[kCCShaderType_MAX] =
+{
+    { kCCShader_PositionTextureColor,           true },
+    { kCCShader_PositionTextureColorAlphaTest,  false },
+    { kCCShader_PositionColor,                  false },
+    { kCCShader_PositionTexture,                true },
+    { kCCShader_PositionTexture_uColor,         false },
+    { kCCShader_PositionTextureA8Color,         false },
+    { kCCShader_Position_uColor,                false },
+    { kCCShader_PositionLengthTexureColor,      false },
+    { kCCShader_ControlSwitch,                  false },
+};
+
+static int defaultShaderTypeForKey(const char* key)
+{
+    for (int type = 0; type < kCCShaderType_MAX; ++type)
+    {
+        if (strcmp(s_tDefaultShaders[type].key, key) == 0)
+        {
+            return type;
+        }
+    }
+    return -1;
+}
+
+static const char s_uProgramBinaryMagic[4] = { 'C', 'A', 'S', 'B' };
+
+// bump whenever CAGLProgram::compileShader changes the source it adds
+static const unsigned int s_uProgramBinaryVersion = 1;
+
+// the file is the header, the key it was saved under, then the binary
+struct ProgramBinaryHeader
+{
+    char            magic[4];
+    unsigned int    version;
+    unsigned int    binaryFormat;
+    unsigned int    keyLenght;
+    unsigned int    binaryLenght;
+};
+
 static CAShaderCache *_sharedShaderCache = 0;
 
 CAShaderCache* CAShaderCache::sharedShaderCache()
@@ -42,6 +92,11 @@ void CAShaderCache::purgeSharedShaderCache()
 }
 
 CAShaderCache::CAShaderCache()
+: m_fLoadTime(0)
+, m_uProgramBinaryHits(0)
+, m_uProgramBinaryMisses(0)
+, m_bProgramBinaryCacheEnabled(true)
+, m_iProgramBinarySupported(-1)
 {
 
 }
@@ -61,224 +116,299 @@ bool CAShaderCache::init()
 
 void CAShaderCache::loadDefaultShaders()
 {
-    // Position Image Color shader
-    CAGLProgram *p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_PositionTextureColor);
-
-    m_mPrograms.insert(kCCShader_PositionTextureColor, p);
-    p->release();
-
-    // Position Image Color alpha test
-    p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_PositionTextureColorAlphaTest);
-    m_mPrograms.insert(kCCShader_PositionTextureColorAlphaTest, p);
-    p->release();
-
-    //
-    // Position, Color shader
-    //
-    p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_PositionColor);
-    m_mPrograms.insert(kCCShader_PositionColor, p);
-    p->release();
-
-    //
-    // Position Image shader
-    //
-    p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_PositionTexture);
-    m_mPrograms.insert(kCCShader_PositionTexture, p);
-    p->release();
-
-    //
-    // Position, Image attribs, 1 Color as uniform shader
-    //
-    p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_PositionTexture_uColor);
-    m_mPrograms.insert(kCCShader_PositionTexture_uColor, p);
-    p->release();
-
-    //
-    // Position Image A8 Color shader
-    //
-    p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_PositionTextureA8Color);
-    m_mPrograms.insert(kCCShader_PositionTextureA8Color, p);
-    p->release();
-
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_Position_uColor);
-    m_mPrograms.insert(kCCShader_Position_uColor, p);
-    p->release();
-    
-    //
-	// Position, Legth(TexCoords, Color (used by Draw Node basically )
-	//
-    p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_PositionLengthTexureColor);
-    m_mPrograms.insert(kCCShader_PositionLengthTexureColor, p);
-    p->release();
+#if CROSSAPP_DEBUG > 0
+    float loadTime = m_fLoadTime;
+    unsigned int hits = m_uProgramBinaryHits;
+#endif
+
+    for (int type = 0; type < kCCShaderType_MAX; ++type)
+    {
+        CC_CONTINUE_IF(!s_tDefaultShaders[type].preload);
+        CC_CONTINUE_IF(m_mPrograms.contains(s_tDefaultShaders[type].key));
+        loadDefaultProgram(type);
+    }
 
-    //
-	// ControlSwitch
-	//
-    p = new CAGLProgram();
-    loadDefaultShader(p, kCCShaderType_ControlSwitch);
-    m_mPrograms.insert(kCCShader_ControlSwitch, p);
-    p->release();
+    CCLOG("CrossApp: default shaders loaded in %.2f ms, %u of them from program binaries",
+          m_fLoadTime - loadTime, m_uProgramBinaryHits - hits);
 }
 
-
-
 void CAShaderCache::reloadDefaultShaders()
 {
-    // reset all programs and reload them
-    
-    // Position Image Color shader
-    CAGLProgram *p = programForKey(kCCShader_PositionTextureColor);    
-    p->reset();
-    loadDefaultShader(p, kCCShaderType_PositionTextureColor);
-
-    // Position Image Color alpha test
-    p = programForKey(kCCShader_PositionTextureColorAlphaTest);
-    p->reset();    
-    loadDefaultShader(p, kCCShaderType_PositionTextureColorAlphaTest);
-    
-    //
-    // Position, Color shader
-    //
-    p = programForKey(kCCShader_PositionColor);
-    p->reset();
-    loadDefaultShader(p, kCCShaderType_PositionColor);
-    
-    //
-    // Position Image shader
-    //
-    p = programForKey(kCCShader_PositionTexture);
-    p->reset();
-    loadDefaultShader(p, kCCShaderType_PositionTexture);
-    
-    //
-    // Position, Image attribs, 1 Color as uniform shader
-    //
-    p = programForKey(kCCShader_PositionTexture_uColor);
-    p->reset();
-    loadDefaultShader(p, kCCShaderType_PositionTexture_uColor);
-    
-    //
-    // Position Image A8 Color shader
-    //
-    p = programForKey(kCCShader_PositionTextureA8Color);
-    p->reset();
-    loadDefaultShader(p, kCCShaderType_PositionTextureA8Color);
-    
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = programForKey(kCCShader_Position_uColor);
-    p->reset();
-    loadDefaultShader(p, kCCShaderType_Position_uColor);
-    
-    //
-	// Position, Legth(TexCoords, Color (used by Draw Node basically )
-	//
-    p = programForKey(kCCShader_PositionLengthTexureColor);
-    p->reset();
-    loadDefaultShader(p, kCCShaderType_PositionLengthTexureColor);
-}
-
+    // the context was lost with every program in it, the new one may come from another driver
+    m_iProgramBinarySupported = -1;
+    m_sDriver.clear();
+
+#if CROSSAPP_DEBUG > 0
+    float loadTime = m_fLoadTime;
+    unsigned int hits = m_uProgramBinaryHits;
+#endif
+
+    // reset all programs and reload them, those never used stay unloaded
+    for (int type = 0; type < kCCShaderType_MAX; ++type)
+    {
+        CAGLProgram *p = m_mPrograms.getValue(s_tDefaultShaders[type].key);
+        CC_CONTINUE_IF(p == NULL);
+        p->reset();
+        loadDefaultShader(p, type);
+    }
 
+    CCLOG("CrossApp: default shaders reloaded in %.2f ms, %u of them from program binaries",
+          m_fLoadTime - loadTime, m_uProgramBinaryHits - hits);
+}
 
+CAGLProgram* CAShaderCache::loadDefaultProgram(int type)
+{
+    CAGLProgram *p = new CAGLProgram();
+    loadDefaultShader(p, type);
+    m_mPrograms.insert(s_tDefaultShaders[type].key, p);
+    p->release();
+    return p;
+}
 
 void CAShaderCache::loadDefaultShader(CAGLProgram *p, int type)
 {
+    const GLchar* vert = NULL;
+    const GLchar* frag = NULL;
+    const char* position = kCCAttributeNamePosition;
+    bool color = true;
+    bool texCoord = true;
+
     switch (type) {
         case kCCShaderType_PositionTextureColor:
-            p->initWithVertexShaderByteArray(ccPositionTextureColor_vert, ccPositionTextureColor_frag);
-            
-            p->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
-            p->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
-            p->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
-            
+            vert = ccPositionTextureColor_vert;
+            frag = ccPositionTextureColor_frag;
             break;
         case kCCShaderType_PositionTextureColorAlphaTest:
-            p->initWithVertexShaderByteArray(ccPositionTextureColor_vert, ccPositionTextureColorAlphaTest_frag);
-            
-            p->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
-            p->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
-            p->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
-
+            vert = ccPositionTextureColor_vert;
+            frag = ccPositionTextureColorAlphaTest_frag;
             break;
         case kCCShaderType_PositionColor:  
-            p->initWithVertexShaderByteArray(ccPositionColor_vert ,ccPositionColor_frag);
-            
-            p->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
-            p->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
-
+            vert = ccPositionColor_vert;
+            frag = ccPositionColor_frag;
+            texCoord = false;
             break;
         case kCCShaderType_PositionTexture:
-            p->initWithVertexShaderByteArray(ccPositionTexture_vert ,ccPositionTexture_frag);
-            
-            p->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
-            p->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
-
+            vert = ccPositionTexture_vert;
+            frag = ccPositionTexture_frag;
+            color = false;
             break;
         case kCCShaderType_PositionTexture_uColor:
-            p->initWithVertexShaderByteArray(ccPositionTexture_uColor_vert, ccPositionTexture_uColor_frag);
-            
-            p->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
-            p->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
-
+            vert = ccPositionTexture_uColor_vert;
+            frag = ccPositionTexture_uColor_frag;
+            color = false;
             break;
         case kCCShaderType_PositionTextureA8Color:
-            p->initWithVertexShaderByteArray(ccPositionTextureA8Color_vert, ccPositionTextureA8Color_frag);
-            
-            p->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
-            p->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
-            p->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
-
+            vert = ccPositionTextureA8Color_vert;
+            frag = ccPositionTextureA8Color_frag;
             break;
         case kCCShaderType_Position_uColor:
-            p->initWithVertexShaderByteArray(ccPosition_uColor_vert, ccPosition_uColor_frag);    
-            
-            p->addAttribute("aVertex", kCCVertexAttrib_Position);    
-            
+            vert = ccPosition_uColor_vert;
+            frag = ccPosition_uColor_frag;
+            position = "aVertex";
+            color = false;
+            texCoord = false;
             break;
         case kCCShaderType_PositionLengthTexureColor:
-            p->initWithVertexShaderByteArray(ccPositionColorLengthTexture_vert, ccPositionColorLengthTexture_frag);
-            
-            p->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
-            p->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
-            p->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
-            
+            vert = ccPositionColorLengthTexture_vert;
+            frag = ccPositionColorLengthTexture_frag;
             break;
-
        case kCCShaderType_ControlSwitch:
-            p->initWithVertexShaderByteArray(ccPositionTextureColor_vert, ccExSwitchMask_frag);
-
-            p->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
-            p->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
-            p->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
-
+            vert = ccPositionTextureColor_vert;
+            frag = ccExSwitchMask_frag;
             break;
 
         default:
             CCLOG("CrossApp: %s:%d, error shader type", __FUNCTION__, __LINE__);
             return;
     }
-    
-    p->link();
+
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCrossApp(&start, NULL);
+
+    // the attribute locations are baked into a linked binary, so they are part of its key
+    std::string attributes = crossapp_format_string("%s%s%s", position,
+                                                    color ? "+" kCCAttributeNameColor : "",
+                                                    texCoord ? "+" kCCAttributeNameTexCoord : "");
+    std::string key = programBinaryKey(vert, frag, attributes.c_str());
+
+    if (loadProgramBinary(p, type, key))
+    {
+        ++m_uProgramBinaryHits;
+    }
+    else
+    {
+        p->initWithVertexShaderByteArray(vert, frag);
+
+        p->addAttribute(position, kCCVertexAttrib_Position);
+        if (color)
+        {
+            p->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
+        }
+        if (texCoord)
+        {
+            p->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
+        }
+
+        p->link();
+        saveProgramBinary(p, type, key);
+        ++m_uProgramBinaryMisses;
+    }
+
     p->updateUniforms();
     
     CHECK_GL_ERROR_DEBUG();
+
+    CCTime::gettimeofdayCrossApp(&end, NULL);
+    m_fLoadTime += (float)CCTime::timersubCrossApp(&start, &end);
+}
+
+std::string CAShaderCache::programBinaryKey(const char* vert, const char* frag, const char* attributes)
+{
+    CC_RETURN_IF(!m_bProgramBinaryCacheEnabled) std::string();
+
+    if (m_iProgramBinarySupported == -1)
+    {
+        m_iProgramBinarySupported = CAGLProgram::isProgramBinarySupported() ? 1 : 0;
+
+        // a binary is only good for the driver build that produced it
+        const char* vendor = (const char*)glGetString(GL_VENDOR);
+        const char* renderer = (const char*)glGetString(GL_RENDERER);
+        const char* version = (const char*)glGetString(GL_VERSION);
+        m_sDriver = crossapp_format_string("%s\n%s\n%s",
+                                           vendor ? vendor : "",
+                                           renderer ? renderer : "",
+                                           version ? version : "");
+    }
+    CC_RETURN_IF(m_iProgramBinarySupported == 0) std::string();
+
+    // the full sources rather than a hash of them, the key is compared byte for byte when loading
+    std::string key = m_sDriver;
+    key.append("\n").append(attributes);
+    key.append("\n").append(vert);
+    key.append("\n").append(frag);
+    return key;
+}
+
+bool CAShaderCache::loadProgramBinary(CAGLProgram* p, int type, const std::string& key)
+{
+    CC_RETURN_IF(key.empty()) false;
+
+    std::string path = getProgramBinaryDirectory() + s_tDefaultShaders[type].key + ".bin";
+    CC_RETURN_IF(!FileUtils::getInstance()->isFileExist(path)) false;
+
+    unsigned long size = 0;
+    unsigned char* data = FileUtils::getInstance()->getFileData(path, "rb", &size);
+    CC_RETURN_IF(data == NULL) false;
+
+    bool ret = false;
+    do
+    {
+        CC_BREAK_IF(size < sizeof(ProgramBinaryHeader));
+
+        ProgramBinaryHeader header;
+        memcpy(&header, data, sizeof(header));
+        CC_BREAK_IF(memcmp(header.magic, s_uProgramBinaryMagic, 4) != 0);
+        CC_BREAK_IF(header.version != s_uProgramBinaryVersion);
+        CC_BREAK_IF(header.keyLenght != key.length());
+        CC_BREAK_IF(size != sizeof(header) + (unsigned long)header.keyLenght + header.binaryLenght);
+        CC_BREAK_IF(memcmp(data + sizeof(header), key.data(), key.length()) != 0);
+
+        ret = p->initWithProgramBinary(data + sizeof(header) + header.keyLenght,
+                                       (GLsizei)header.binaryLenght,
+                                       (GLenum)header.binaryFormat);
+    }
+    while (0);
+
+    delete[] data;
+
+    if (!ret)
+    {
+        // stale or rejected by the driver, compiled again and replaced below
+        remove(path.c_str());
+    }
+    return ret;
+}
+
+void CAShaderCache::saveProgramBinary(CAGLProgram* p, int type, const std::string& key)
+{
+    CC_RETURN_IF(key.empty());
+
+    std::string binary;
+    GLenum binaryFormat = 0;
+    CC_RETURN_IF(!p->getProgramBinary(binary, &binaryFormat));
+
+    ProgramBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, s_uProgramBinaryMagic, 4);
+    header.version = s_uProgramBinaryVersion;
+    header.binaryFormat = (unsigned int)binaryFormat;
+    header.keyLenght = (unsigned int)key.length();
+    header.binaryLenght = (unsigned int)binary.length();
+
+    std::string path = getProgramBinaryDirectory() + s_tDefaultShaders[type].key + ".bin";
+    FileUtils::getInstance()->createDirectory(m_sProgramBinaryDirectory);
+
+    // written next to the file and renamed, a crash never leaves half a binary behind
+    std::string temporary = path + ".tmp";
+    FILE* fp = fopen(temporary.c_str(), "wb");
+    CC_RETURN_IF(fp == NULL);
+    bool written = fwrite(&header, 1, sizeof(header), fp) == sizeof(header)
+                && fwrite(key.data(), 1, key.length(), fp) == key.length()
+                && fwrite(binary.data(), 1, binary.length(), fp) == binary.length();
+    fclose(fp);
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    remove(path.c_str());
+#endif
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        remove(temporary.c_str());
+    }
+}
+
+void CAShaderCache::setProgramBinaryCacheEnabled(bool enabled)
+{
+    m_bProgramBinaryCacheEnabled = enabled;
+}
+
+void CAShaderCache::setProgramBinaryDirectory(const std::string& directory)
+{
+    m_sProgramBinaryDirectory = directory;
+    if (!m_sProgramBinaryDirectory.empty() && m_sProgramBinaryDirectory[m_sProgramBinaryDirectory.length() - 1] != '/')
+    {
+        m_sProgramBinaryDirectory += '/';
+    }
+}
+
+const std::string& CAShaderCache::getProgramBinaryDirectory()
+{
+    if (m_sProgramBinaryDirectory.empty())
+    {
+        m_sProgramBinaryDirectory = FileUtils::getInstance()->getWritablePath() + "shader_cache/";
+    }
+    return m_sProgramBinaryDirectory;
+}
+
+void CAShaderCache::removeAllProgramBinaries()
+{
+    for (int type = 0; type < kCCShaderType_MAX; ++type)
+    {
+        remove((getProgramBinaryDirectory() + s_tDefaultShaders[type].key + ".bin").c_str());
+    }
 }
 
 CAGLProgram* CAShaderCache::programForKey(const char* key)
 {
-    return m_mPrograms.getValue(key);
+    CAGLProgram* p = m_mPrograms.getValue(key);
+    if (p == NULL)
+    {
+        int type = defaultShaderTypeForKey(key);
+        if (type != -1)
+        {
+            p = loadDefaultProgram(type);
+        }
+    }
+    return p;
 }
 
 void CAShaderCache::addProgram(CAGLProgram* program, const char* key)
@@ -54,12 +54,49 @@ public:
     /** adds a CAGLProgram to the cache for a given name */
     void addProgram(CAGLProgram* program, const char* key);
 
+    /** Linked default programs are saved to getProgramBinaryDirectory() and restored from there on
+     *  the next launch or context loss instead of being compiled again, when the driver supports
+     *  program binaries. Enabled by default.
+     */
+    void setProgramBinaryCacheEnabled(bool enabled);
+
+    bool isProgramBinaryCacheEnabled() const { return m_bProgramBinaryCacheEnabled; }
+
+    /** defaults to getWritablePath() + "shader_cache/" */
+    void setProgramBinaryDirectory(const std::string& directory);
+
+    const std::string& getProgramBinaryDirectory();
+
+    /** deletes the saved binaries of every default program */
+    void removeAllProgramBinaries();
+
+    /** milliseconds spent building default programs so far */
+    CC_SYNTHESIZE_READONLY(float, m_fLoadTime, LoadTime);
+
+    /** default programs restored from a saved binary so far */
+    CC_SYNTHESIZE_READONLY(unsigned int, m_uProgramBinaryHits, ProgramBinaryHits);
+
+    /** default programs compiled from source so far */
+    CC_SYNTHESIZE_READONLY(unsigned int, m_uProgramBinaryMisses, ProgramBinaryMisses);
+
 private:
     bool init();
+    CAGLProgram* loadDefaultProgram(int type);
     void loadDefaultShader(CAGLProgram *program, int type);
+    std::string programBinaryKey(const char* vert, const char* frag, const char* attributes);
+    bool loadProgramBinary(CAGLProgram* program, int type, const std::string& key);
+    void saveProgramBinary(CAGLProgram* program, int type, const std::string& key);
 
     CAMap<std::string, CAGLProgram*> m_mPrograms;
 
+    bool m_bProgramBinaryCacheEnabled;
+
+    int m_iProgramBinarySupported;     ///< -1 until queried on the current context
+
+    std::string m_sDriver;
+
+    std::string m_sProgramBinaryDirectory;
+
 };
 
 // end of shaders group
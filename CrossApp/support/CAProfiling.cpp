@@ -13,6 +13,7 @@ NS_CC_BEGIN
 bool kCCProfilerCategorySprite = false;
 bool kCCProfilerCategoryBatchSprite = false;
 bool kCCProfilerCategoryParticles = false;
+bool kCCProfilerCategoryTouch = false;
 
 
 static CCProfiler* g_sSharedProfiler = NULL;
@@ -81,6 +81,7 @@ extern CC_DLL void CCProfilingResetTimingBlock(const char *timerName);
 extern bool kCCProfilerCategorySprite;
 extern bool kCCProfilerCategoryBatchSprite;
 extern bool kCCProfilerCategoryParticles;
+extern bool kCCProfilerCategoryTouch;
 
 // end of global group
 /// @}
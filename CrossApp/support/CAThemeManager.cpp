@@ -9,10 +9,90 @@
 #include "CAThemeManager.h"
 #include "platform/CAFileUtils.h"
 #include "platform/CACommon.h"
+#include "images/CAImage.h"
+#include "images/CAImageCache.h"
+#include "support/ccUtils.h"
+#include <string.h>
+#include <algorithm>
+#include <set>
 
 NS_CC_BEGIN
 
-static CAThemeManager::stringMap s_map_null = CAThemeManager::stringMap(std::map<std::string, std::string>());
+static CAThemeManager::stringMap s_map_null;
+
+// a missing color reads as hex2Int("") did before, 0xffffffff, white
+static const CAColor4B s_color_null = ccc4Int(0xffffffff);
+
+static bool compareThemeValues(const CAThemeManager::themeValue& a, const CAThemeManager::themeValue& b)
+{
+    return a.name < b.name;
+}
+
+static bool sameThemeValueName(const CAThemeManager::themeValue& a, const CAThemeManager::themeValue& b)
+{
+    return a.name == b.name;
+}
+
+int CAThemeManager::stringMap::getIndex(const std::string& key) const
+{
+    int low = 0;
+    int high = (int)values.size() - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        int result = values[middle].name.compare(key);
+        if (result == 0)
+        {
+            return middle;
+        }
+        else if (result < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return -1;
+}
+
+const CAThemeManager::themeValue* CAThemeManager::stringMap::find(const std::string& key) const
+{
+    int index = this->getIndex(key);
+    return index < 0 ? NULL : &values[index];
+}
+
+const std::string& CAThemeManager::stringMap::at(const std::string& key) const
+{
+    const themeValue* value = this->find(key);
+    return value ? value->value : string_null;
+}
+
+CAImage* CAThemeManager::stringMap::getImage(const std::string& key) const
+{
+    const themeValue* value = this->find(key);
+    CC_RETURN_IF(value == NULL) NULL;
+
+    if (value->image == NULL)
+    {
+        value->image = CAImageCache::sharedImageCache()->addImage(value->value);
+        CC_SAFE_RETAIN(value->image);
+    }
+    return value->image;
+}
+
+int CAThemeManager::stringMap::getInt(const std::string& key) const
+{
+    const themeValue* value = this->find(key);
+    return value ? value->intValue : 0;
+}
+
+const CAColor4B& CAThemeManager::stringMap::getColor(const std::string& key) const
+{
+    const themeValue* value = this->find(key);
+    return value ? value->color : s_color_null;
+}
 
 CAThemeManager* CAThemeManager::create(const std::string& filePath)
 {
@@ -25,47 +105,58 @@ CAThemeManager* CAThemeManager::create(const std::string& filePath)
 CAThemeManager::CAThemeManager(const std::string& filePath)
 :m_pMyDocument(NULL)
 ,m_sThemePath(filePath)
+,m_uPreloading(0)
 {
     if (m_sThemePath.back() != '/')
     {
         m_sThemePath += "/";
     }
-    unsigned long size = 0;
-    const char* data = (const char*)FileUtils::getInstance()->getFileData(m_sThemePath + "theme.style", "rb", &size);
-    if (size > 0)
+    CAFileBuffer buffer = FileUtils::getInstance()->getFileBuffer(m_sThemePath + "theme.style");
+    if (buffer.getSize() > 0)
     {
-        std::string str;
-        str.resize(size);
-        for (size_t i = 0; i < size; i++)
-        {
-            str[i] = data[i];
-        }
-        
         m_pMyDocument = new tinyxml2::XMLDocument();
-        m_pMyDocument->Parse(data, size);
+        m_pMyDocument->Parse((const char*)buffer.getBytes(), buffer.getSize());
         tinyxml2::XMLElement* rootElement = m_pMyDocument->RootElement();
-        
-        tinyxml2::XMLElement* controlXml = ((tinyxml2::XMLElement*)rootElement->FirstChildElement());
 
+        tinyxml2::XMLElement* controlXml = rootElement ? rootElement->FirstChildElement() : NULL;
+
+        // every entry is resolved here once, the controls only look them up
         while (controlXml)
         {
-            std::map<std::string, std::string> map;
-            const tinyxml2::XMLElement* pathXml = ((tinyxml2::XMLElement*)controlXml->FirstChildElement());;
-            while (pathXml)
+            const char* controlName = controlXml->Attribute("name");
+            if (controlName && m_mIndexes.count(controlName) == 0)
             {
-                std::string pathType = pathXml->Attribute("path");
-                if (pathType.compare("0")==0)
+                stringMap map;
+                const tinyxml2::XMLElement* pathXml = controlXml->FirstChildElement();
+                while (pathXml)
                 {
-                    map.insert(std::make_pair(pathXml->Attribute("name"), pathXml->Attribute("value")));
+                    const char* pathType = pathXml->Attribute("path");
+                    const char* name = pathXml->Attribute("name");
+                    const char* value = pathXml->Attribute("value");
+                    if (pathType && name && value)
+                    {
+                        themeValue entry;
+                        entry.name = name;
+                        entry.isPath = strcmp(pathType, "1") == 0;
+                        entry.value = entry.isPath ? m_sThemePath + value : value;
+                        entry.intValue = atoi(value);
+                        entry.color = ccc4Int(CrossApp::hex2Int(value));
+                        entry.image = NULL;
+                        if (entry.isPath || strcmp(pathType, "0") == 0)
+                        {
+                            map.values.push_back(entry);
+                        }
+                    }
+                    pathXml = pathXml->NextSiblingElement();
                 }
-                else if(pathType.compare("1")==0)
-                {
-                    map.insert(std::make_pair(pathXml->Attribute("name"), (m_sThemePath + pathXml->Attribute("value"))));
-                }
-                pathXml = (tinyxml2::XMLElement*)pathXml->NextSiblingElement();
+
+                // the first of the entries with the same name is kept
+                std::stable_sort(map.values.begin(), map.values.end(), compareThemeValues);
+                map.values.erase(std::unique(map.values.begin(), map.values.end(), sameThemeValueName), map.values.end());
+
+                m_mIndexes[controlName] = (int)m_vThemes.size();
+                m_vThemes.push_back(map);
             }
-            
-            m_mPathss.insert(std::make_pair(controlXml->Attribute("name"), stringMap(map)));
             controlXml = controlXml->NextSiblingElement();
         }
     }
@@ -74,30 +165,110 @@ CAThemeManager::CAThemeManager(const std::string& filePath)
         CAMessageBox("警告", "主题配置文件缺失");
         return;
     }
-    
-    for (auto& var : m_mPathss)
+}
+
+CAThemeManager::~CAThemeManager()
+{
+    for (auto& map : m_vThemes)
     {
-        std::map<std::string, std::string>& map = var.second.map;
-        for (auto& it : map)
+        for (auto& value : map.values)
         {
-            CCLog("name: %s, value: %s", it.first.c_str(), it.second.c_str());
+            CC_SAFE_RELEASE(value.image);
         }
-        CCLog("control   name: %s", var.first.c_str());
     }
+	CC_SAFE_DELETE(m_pMyDocument);
 }
 
-CAThemeManager::~CAThemeManager()
+const CAThemeManager::stringMap& CAThemeManager::getThemeMap(const std::string& key)
 {
-	CC_SAFE_DELETE(m_pMyDocument);
+    return this->getThemeMap(this->getThemeIndex(key));
 }
 
-const CAThemeManager::stringMap& CAThemeManager::getThemeMap(const std::string& key)
+int CAThemeManager::getThemeIndex(const std::string& key) const
+{
+    auto it = m_mIndexes.find(key);
+    return it == m_mIndexes.end() ? -1 : it->second;
+}
+
+const CAThemeManager::stringMap& CAThemeManager::getThemeMap(int index)
 {
-    if (m_mPathss.count(key) == 0)
+    if (index < 0 || index >= (int)m_vThemes.size())
     {
         return s_map_null;
     }
-    return m_mPathss.at(key);
+    return m_vThemes[index];
+}
+
+void CAThemeManager::preloadImages()
+{
+    for (auto& map : m_vThemes)
+    {
+        for (auto& value : map.values)
+        {
+            if (value.isPath)
+            {
+                map.getImage(value.name);
+            }
+        }
+    }
+}
+
+void CAThemeManager::preloadImagesAsync(const std::function<void()>& callback)
+{
+    if (callback)
+    {
+        m_vPreloadCallbacks.push_back(callback);
+    }
+
+    // held while queueing, an image the cache already has is delivered right away
+    ++m_uPreloading;
+
+    std::set<std::string> paths;
+    for (auto& map : m_vThemes)
+    {
+        for (auto& value : map.values)
+        {
+            if (value.isPath && value.image == NULL && paths.insert(value.value).second)
+            {
+                ++m_uPreloading;
+                CAImageCache::sharedImageCache()->addImageAsync(value.value, this, callfuncO_selector(CAThemeManager::onPreloadImage));
+            }
+        }
+    }
+
+    this->onPreloadImage(NULL);
+}
+
+void CAThemeManager::onPreloadImage(CAObject* image)
+{
+    CC_UNUSED_PARAM(image);
+
+    CC_RETURN_IF(--m_uPreloading > 0);
+
+    this->retainImages();
+
+    std::vector<std::function<void()> > callbacks;
+    callbacks.swap(m_vPreloadCallbacks);
+    for (auto& callback : callbacks)
+    {
+        callback();
+    }
+}
+
+void CAThemeManager::retainImages()
+{
+    // only what got into the cache, an image that failed to load isn't tried again here
+    for (auto& map : m_vThemes)
+    {
+        for (auto& value : map.values)
+        {
+            if (value.isPath && value.image == NULL)
+            {
+                value.image = CAImageCache::sharedImageCache()->imageForKey(value.value);
+                CC_SAFE_RETAIN(value.image);
+            }
+        }
+    }
 }
 
-NS_CC_END
\ No newline at end of file
+NS_CC_END
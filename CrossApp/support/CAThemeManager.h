@@ -11,31 +11,57 @@
 
 #include "basics/CAObject.h"
 #include "tinyxml2/tinyxml2.h"
+#include "ccTypes.h"
 #include <map>
+#include <vector>
+#include <unordered_map>
+#include <functional>
 
 NS_CC_BEGIN
 
+class CAImage;
+
 class CC_DLL CAThemeManager : public CAObject
 {
 public:
     
+    /** an entry of a control, resolved once when the theme is loaded */
+    struct themeValue
+    {
+        std::string name;
+        
+        /** the value, with the theme path in front for path="1" */
+        std::string value;
+        
+        bool isPath;
+        
+        int intValue;
+        
+        CAColor4B color;
+        
+        /** retained the first time it is asked for, or by preloadImages */
+        mutable CAImage* image;
+    };
+    
+    /** the entries of one control, sorted by name */
     struct stringMap
     {
-        stringMap(std::map<std::string, std::string> var)
-        {
-            map = var;
-        }
-        
-        const std::string& at(const std::string& key) const
-        {
-            if (map.find(key) == map.end())
-            {
-                return string_null;
-            }
-            return map.at(key);
-        }
-        
-        std::map<std::string, std::string> map;
+        const std::string& at(const std::string& key) const;
+        
+        /** the index of an entry in values, -1 when missing */
+        int getIndex(const std::string& key) const;
+        
+        const themeValue* find(const std::string& key) const;
+        
+        /** the image of a path entry, loaded only the first time */
+        CAImage* getImage(const std::string& key) const;
+        
+        int getInt(const std::string& key) const;
+        
+        /** a 0xRRGGBBAA entry */
+        const CAColor4B& getColor(const std::string& key) const;
+        
+        std::vector<themeValue> values;
         
         std::string string_null;
     };
@@ -49,14 +75,41 @@ public:
     static CAThemeManager *create(const std::string& filePath);
     
     const stringMap& getThemeMap(const std::string& key);
+    
+    /** the index of a control for getThemeMap(int), -1 when the theme doesn't have it */
+    int getThemeIndex(const std::string& key) const;
+    
+    const stringMap& getThemeMap(int index);
+    
+    /** loads every image of the theme now */
+    void preloadImages();
+    
+    /**
+     * Loads every image of the theme on the image loading thread, so that the
+     * first controls don't decode them. The callback runs on the UI thread once
+     * they are all in the image cache, right away when they already are.
+     */
+    void preloadImagesAsync(const std::function<void()>& callback = nullptr);
 
 protected:
     
-    std::map<std::string, stringMap> m_mPathss;
+    void onPreloadImage(CAObject* image);
+    
+    void retainImages();
+    
+protected:
+    
+    std::vector<stringMap> m_vThemes;
+    
+    std::unordered_map<std::string, int> m_mIndexes;
 
 	tinyxml2::XMLDocument* m_pMyDocument;
     
     std::string m_sThemePath;
+    
+    unsigned int m_uPreloading;
+    
+    std::vector<std::function<void()> > m_vPreloadCallbacks;
 };
 
 NS_CC_END
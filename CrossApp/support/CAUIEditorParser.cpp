@@ -45,10 +45,13 @@
 NS_CC_BEGIN
 
 
+static bool s_bDefersHiddenViews = false;
+
 CAUIEditorParser::CAUIEditorParser()
 :m_pSupverview(NULL)
 ,m_pViewController(NULL)
 ,m_pMyDocument(NULL)
+,m_pLayoutFile(NULL)
 {
     
 }
@@ -56,16 +59,75 @@ CAUIEditorParser::CAUIEditorParser()
 CAUIEditorParser::~CAUIEditorParser()
 {
 	CC_SAFE_DELETE(m_pMyDocument);
+    CC_SAFE_DELETE(m_pLayoutFile);
+}
+
+void CAUIEditorParser::setDefersHiddenViews(bool var)
+{
+    s_bDefersHiddenViews = var;
+}
+
+bool CAUIEditorParser::isDefersHiddenViews()
+{
+    return s_bDefersHiddenViews;
+}
+
+// the binary layouts have these resolved already
+
+static CAUIControlType getControlType(tinyxml2::XMLElement* viewXml)
+{
+    return CAUILayoutFile::getControlTypeForName(viewXml->Attribute("contrlType"));
+}
+
+static CAUIControlType getControlType(const CAUILayoutElement* viewXml)
+{
+    return viewXml->getControlType();
+}
+
+static bool isHidden(tinyxml2::XMLElement* viewXml)
+{
+    const char* value = viewXml->Attribute("visible");
+    return value && atoi(value) == 0;
+}
+
+static bool isHidden(const CAUILayoutElement* viewXml)
+{
+    return viewXml->isHidden();
+}
+
+// the binary layouts store the numbers, the XML ones are converted as they are read
+
+static int intValue(tinyxml2::XMLElement* viewXml, const char* value)
+{
+    CC_UNUSED_PARAM(viewXml);
+    return value ? atoi(value) : 0;
+}
+
+static int intValue(const CAUILayoutElement* viewXml, const char* value)
+{
+    return viewXml->IntValue(value);
 }
 
-CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::string, CAView*>& map)
+static float floatValue(tinyxml2::XMLElement* viewXml, const char* value)
+{
+    CC_UNUSED_PARAM(viewXml);
+    return value ? atof(value) : 0.0f;
+}
+
+static float floatValue(const CAUILayoutElement* viewXml, const char* value)
+{
+    return viewXml->FloatValue(value);
+}
+
+template <typename Element>
+CAView* layoutView(Element* viewXml, CAView* superview, CAMap<std::string, CAView*>& map)
 {
     CAView* view = NULL;
     
     //DRect bounds = superview->getBounds();
     
-    std::string contrlType = viewXml->Attribute("contrlType");
-    if (contrlType.compare("CAView") == 0)
+    CAUIControlType contrlType = getControlType(viewXml);
+    if (contrlType == CAUIControlTypeView)
     {
         view = CAView::create();
         superview->addSubview(view);
@@ -75,25 +137,25 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         view->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         view->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            view->setZOrder(atoi(value));
+            view->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            view->setColor(ccc4Int(atoi(value)));
+            view->setColor(ccc4Int(intValue(viewXml, value)));
         }
     }
-    else if (contrlType.compare("CAImageView") == 0)
+    else if (contrlType == CAUIControlTypeImageView)
     {
         CAImageView* imageView = CAImageView::create();
         superview->addSubview(imageView);
@@ -103,22 +165,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         imageView->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         imageView->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            imageView->setZOrder(atoi(value));
+            imageView->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            imageView->setColor(ccc4Int(atoi(value)));
+            imageView->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("image"))
@@ -128,10 +190,10 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("scaleType"))
         {
-            imageView->setImageViewScaleType((CAImageViewScaleType)atoi(value));
+            imageView->setImageViewScaleType((CAImageViewScaleType)intValue(viewXml, value));
         }
     }
-    else if (contrlType.compare("CAScale9ImageView") == 0)
+    else if (contrlType == CAUIControlTypeScale9ImageView)
     {
         CAScale9ImageView* scale9ImageVew = CAScale9ImageView::create();
         superview->addSubview(scale9ImageVew);
@@ -141,22 +203,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         scale9ImageVew->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         scale9ImageVew->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            scale9ImageVew->setZOrder(atoi(value));
+            scale9ImageVew->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            scale9ImageVew->setColor(ccc4Int(atoi(value)));
+            scale9ImageVew->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("image"))
@@ -166,30 +228,30 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 
 		if (const char* value = viewXml->Attribute("alpha"))
 		{
-			scale9ImageVew->setAlpha(atof(value));
+			scale9ImageVew->setAlpha(floatValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("insetLeft"))
 		{
-			scale9ImageVew->setInsetLeft(atof(value));
+			scale9ImageVew->setInsetLeft(floatValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("insetTop"))
 		{
-			scale9ImageVew->setInsetTop(atof(value));
+			scale9ImageVew->setInsetTop(floatValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("insetRight"))
 		{
-			scale9ImageVew->setInsetRight(atof(value));
+			scale9ImageVew->setInsetRight(floatValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("insetBottom"))
 		{
-			scale9ImageVew->setInsetBottom(atof(value));
+			scale9ImageVew->setInsetBottom(floatValue(viewXml, value));
 		}
     }
-    else if (contrlType.compare("CALabel") == 0)
+    else if (contrlType == CAUIControlTypeLabel)
     {
         CALabel* label = CALabel::create();
         superview->addSubview(label);
@@ -199,22 +261,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         label->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         label->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            label->setZOrder(atoi(value));
+            label->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("fontColor"))
         {
-            label->setColor(ccc4Int(atoi(value)));
+            label->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("text"))
@@ -224,7 +286,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("fontSize"))
         {
-            label->setFontSize(atoi(value));
+            label->setFontSize(intValue(viewXml, value));
         }
 
 		if (const char* value = viewXml->Attribute("fontName"))
@@ -234,53 +296,53 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 
 		if (const char* value = viewXml->Attribute("bold"))
 		{
-			label->setBold(bool(atoi(value)));
+			label->setBold(bool(intValue(viewXml, value)));
 		}
         
 		if (const char* value = viewXml->Attribute("underLine"))
 		{
-			label->setUnderLine(bool(atoi(value)));
+			label->setUnderLine(bool(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("italics"))
 		{
-			label->setItalics(bool(atoi(value)));
+			label->setItalics(bool(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("lineSpacing"))
 		{
-			label->setLineSpacing(atoi(value));
+			label->setLineSpacing(intValue(viewXml, value));
 		}
         
 		if (const char* value = viewXml->Attribute("textAlignment"))
 		{
-			label->setTextAlignment(CATextAlignment(atoi(value)));
+			label->setTextAlignment(CATextAlignment(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("verticalTextAlignment"))
 		{
-			label->setVerticalTextAlignmet(CAVerticalTextAlignment(atoi(value)));
+			label->setVerticalTextAlignmet(CAVerticalTextAlignment(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("enableCopy"))
 		{
-			label->setEnableCopy(bool(atoi(value)));
+			label->setEnableCopy(bool(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("numberOfLine"))
 		{
-			label->setNumberOfLine(atoi(value));
+			label->setNumberOfLine(intValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("wordWrap"))
 		{
-			label->setWordWrap(atoi(value));
+			label->setWordWrap(intValue(viewXml, value));
 		}
 
     }
-    else if (contrlType.compare("CAButton") == 0)
+    else if (contrlType == CAUIControlTypeButton)
     {
-        CAButton* btn = CAButton::create((CAButtonType)atoi(viewXml->Attribute("type")));
+        CAButton* btn = CAButton::create((CAButtonType)intValue(viewXml, viewXml->Attribute("type")));
         superview->addSubview(btn);
         
         const char* key = viewXml->Attribute("textTag");
@@ -288,27 +350,27 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         btn->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         btn->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            btn->setZOrder(atoi(value));
+            btn->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            btn->setColor(ccc4Int(atoi(value)));
+            btn->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("fontSize"))
         {
-            btn->setTitleFontSize(atoi(value));
+            btn->setTitleFontSize(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("fontName"))
@@ -319,11 +381,11 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         DSize titleOffSize = DSizeZero;
         if (const char* value1 = viewXml->Attribute("titleOffSizeX"))
         {
-            titleOffSize.width = atof(value1);
+            titleOffSize.width = floatValue(viewXml, value1);
         }
         if (const char* value1 = viewXml->Attribute("titleOffSizeY"))
         {
-            titleOffSize.height = atof(value1);
+            titleOffSize.height = floatValue(viewXml, value1);
         }
         btn->setTitleOffset(titleOffSize);
         
@@ -349,43 +411,43 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("titleColorNormal"))
         {
-            btn->setTitleColorForState(CAControlStateNormal, ccc4Int(atoi(value)));
+            btn->setTitleColorForState(CAControlStateNormal, ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("titleColorHighted"))
         {
-            btn->setTitleColorForState(CAControlStateHighlighted, ccc4Int(atoi(value)));
+            btn->setTitleColorForState(CAControlStateHighlighted, ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("titleColorSelected"))
         {
-            btn->setTitleColorForState(CAControlStateSelected, ccc4Int(atoi(value)));
+            btn->setTitleColorForState(CAControlStateSelected, ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("titleColorDisabled"))
         {
-            btn->setTitleColorForState(CAControlStateDisabled, ccc4Int(atoi(value)));
+            btn->setTitleColorForState(CAControlStateDisabled, ccc4Int(intValue(viewXml, value)));
         }
         
         DSize imageOffSize = DSizeZero;
         if (const char* value1 = viewXml->Attribute("imageOffSizeX"))
         {
-            imageOffSize.width = atof(value1);
+            imageOffSize.width = floatValue(viewXml, value1);
         }
         if (const char* value1 = viewXml->Attribute("imageOffSizeY"))
         {
-            imageOffSize.height = atof(value1);
+            imageOffSize.height = floatValue(viewXml, value1);
         }
         btn->setImageOffset(imageOffSize);
         
         DSize imageSize = DSizeZero;
         if (const char* value1 = viewXml->Attribute("imageSizeW"))
         {
-            imageSize.width = atoi(value1);
+            imageSize.width = intValue(viewXml, value1);
         }
         if (const char* value1 = viewXml->Attribute("imageSizeH"))
         {
-            imageSize.height = atoi(value1);
+            imageSize.height = intValue(viewXml, value1);
         }
         btn->setImageSize(imageSize);
         
@@ -411,7 +473,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 
         if (const char* value = viewXml->Attribute("allowsSelected"))
         {
-            btn->setAllowsSelected(atoi(value));
+            btn->setAllowsSelected(intValue(viewXml, value));
         }
         
         if (strcmp(viewXml->Attribute("backgroundType"), "Scale9") == 0)
@@ -501,7 +563,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         {
             if (CAView* backgroundView = btn->getBackgroundViewForState(CAControlStateNormal))
             {
-                backgroundView->setColor(ccc4Int(atoi(value)));
+                backgroundView->setColor(ccc4Int(intValue(viewXml, value)));
             }
         }
         
@@ -509,7 +571,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         {
             if (CAView* backgroundView = btn->getBackgroundViewForState(CAControlStateHighlighted))
             {
-                backgroundView->setColor(ccc4Int(atoi(value)));
+                backgroundView->setColor(ccc4Int(intValue(viewXml, value)));
             }
         }
         
@@ -517,7 +579,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         {
             if (CAView* backgroundView = btn->getBackgroundViewForState(CAControlStateSelected))
             {
-                backgroundView->setColor(ccc4Int(atoi(value)));
+                backgroundView->setColor(ccc4Int(intValue(viewXml, value)));
             }
         }
         
@@ -525,14 +587,14 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         {
             if (CAView* backgroundView = btn->getBackgroundViewForState(CAControlStateDisabled))
             {
-                backgroundView->setColor(ccc4Int(atoi(value)));
+                backgroundView->setColor(ccc4Int(intValue(viewXml, value)));
             }
         }
 
 
 		if (const char* value = viewXml->Attribute("controlState"))
 		{
-			CAControlState state = CAControlState(atoi(value));
+			CAControlState state = CAControlState(intValue(viewXml, value));
 
 			if (state == CAControlStateNormal)
 			{
@@ -572,15 +634,15 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 			}
 		}
     }
-	else if (contrlType.compare("CATextField") == 0)
+	else if (contrlType == CAUIControlTypeTextField)
 	{
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
 
         CATextField* textField = CATextField::createWithLayout(layout);
 		superview->addSubview(textField);
@@ -592,47 +654,47 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 
         if (const char* value = viewXml->Attribute("z"))
         {
-            textField->setZOrder(atoi(value));
+            textField->setZOrder(intValue(viewXml, value));
         }
         
 		if (const char* value = viewXml->Attribute("textColor"))
 		{
-			textField->setTextColor(ccc4Int(atoi(value)));
+			textField->setTextColor(ccc4Int(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("keyboartType"))
 		{
-			textField->setKeyboardType(CATextField::KeyboardType(atoi(value)));
+			textField->setKeyboardType(CATextField::KeyboardType(intValue(viewXml, value)));
 		}
 		
 		if (const char* value = viewXml->Attribute("returnType"))
 		{
-			textField->setReturnType(CATextField::ReturnType(atoi(value)));
+			textField->setReturnType(CATextField::ReturnType(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("clearButtonMode"))
 		{
-			textField->setClearButtonMode(CATextField::ClearButtonMode(atoi(value)));
+			textField->setClearButtonMode(CATextField::ClearButtonMode(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("textFieldAlign"))
 		{
-			textField->setTextFieldAlign(CATextField::TextFieldAlign(atoi(value)));
+			textField->setTextFieldAlign(CATextField::TextFieldAlign(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("fontSize"))
 		{
-			textField->setFontSize(atoi(value));
+			textField->setFontSize(intValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("maxLenght"))
 		{
-			textField->setMaxLenght(atoi(value));
+			textField->setMaxLenght(intValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("maginLeft"))
 		{
-			textField->setMarginLeft(atoi(value));
+			textField->setMarginLeft(intValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("maginLeftImage"))
@@ -640,18 +702,18 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 			DSize leftSize = DSizeZero;
 			if (const char* value = viewXml->Attribute("maginLeftImageSize_w"))
 			{
-				leftSize.width = atoi(value);
+				leftSize.width = intValue(viewXml, value);
 			}
 			if (const char* value = viewXml->Attribute("maginLeftImageSize_h"))
 			{
-				leftSize.height= atoi(value);
+				leftSize.height= intValue(viewXml, value);
 			}
 			textField->setMarginImageLeft(leftSize,value);
 		}
 
 		if (const char* value = viewXml->Attribute("maginRight"))
 		{
-			textField->setMarginRight(atoi(value));
+			textField->setMarginRight(intValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("maginRightImage"))
@@ -659,18 +721,18 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 			DSize rightSize = DSizeZero;
 			if (const char* value = viewXml->Attribute("maginRightImageSize_w"))
 			{
-				rightSize.width = atoi(value);
+				rightSize.width = intValue(viewXml, value);
 			}
 			if (const char* value = viewXml->Attribute("maginRightImageSize_h"))
 			{
-				rightSize.height = atoi(value);
+				rightSize.height = intValue(viewXml, value);
 			}
 			textField->setMarginImageLeft(rightSize, value);
 		}
 
 		if (const char* value = viewXml->Attribute("placeGolderColor"))
 		{
-			textField->setPlaceHolderColor(ccc4Int(atoi(value)));
+			textField->setPlaceHolderColor(ccc4Int(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("background"))
@@ -688,7 +750,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 			textField->setText(value);
 		}
 	}
-    else if (contrlType.compare("CASwitch") == 0)
+    else if (contrlType == CAUIControlTypeSwitch)
     {
         CASwitch* sw = CASwitch::create();
         superview->addSubview(sw);
@@ -698,27 +760,27 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         sw->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         sw->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            sw->setZOrder(atoi(value));
+            sw->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            sw->setColor(ccc4Int(atoi(value)));
+            sw->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
 		if (const char* value = viewXml->Attribute("isOn"))
 		{
-			sw->setIsOn(bool(atoi(value)),false);
+			sw->setIsOn(bool(intValue(viewXml, value)),false);
 		}
 
         if (const char* value = viewXml->Attribute("onImage"))
@@ -736,9 +798,9 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
             sw->setThumbTintImage(CAImage::create(value));
         }
     }
-    else if (contrlType.compare("CASegmentedControl") == 0)
+    else if (contrlType == CAUIControlTypeSegmentedControl)
     {
-		int itemCount = atoi(viewXml->Attribute("itemCount"));
+		int itemCount = intValue(viewXml, viewXml->Attribute("itemCount"));
 
 		CASegmentedControl* segmentControl = CASegmentedControl::create(itemCount);
         superview->addSubview(segmentControl);
@@ -748,22 +810,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         segmentControl->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         segmentControl->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            segmentControl->setZOrder(atoi(value));
+            segmentControl->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            segmentControl->setColor(ccc4Int(atoi(value)));
+            segmentControl->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("background"))
@@ -778,7 +840,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 
 		if (const char* value = viewXml->Attribute("fontSize"))
 		{
-			segmentControl->setTitleFontSize(atoi(value));
+			segmentControl->setTitleFontSize(intValue(viewXml, value));
 		}
 
         if (const char* value = viewXml->Attribute("segmentItemImage"))
@@ -788,17 +850,17 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("titleColorNormal"))
         {
-            segmentControl->setTitleColor(ccc4Int(atoi(value)));
+            segmentControl->setTitleColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("titleColorSelected"))
         {
-            segmentControl->setTitleSelectedColor(ccc4Int(atoi(value)));
+            segmentControl->setTitleSelectedColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("tintColor"))
         {
-            segmentControl->setTintColor(ccc4Int(atoi(value)));
+            segmentControl->setTintColor(ccc4Int(intValue(viewXml, value)));
         }
 
 		if (const char* value = viewXml->Attribute("image"))
@@ -808,10 +870,10 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("selectedAtIndex"))
         {
-            segmentControl->setSelectedAtIndex(atoi(value));
+            segmentControl->setSelectedAtIndex(intValue(viewXml, value));
         }
 		
-		tinyxml2::XMLElement* itemXml = NULL;
+		Element* itemXml = NULL;
 		
 		for (int index = 0; index < itemCount; index++)
 		{
@@ -842,32 +904,32 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 			DSize size = DSizeZero;
 			if (const char* value = itemXml->Attribute("imageSize_w"))
 			{
-				size.width = atoi(value);
+				size.width = intValue(viewXml, value);
 			}
 			if (const char* value = itemXml->Attribute("imageSize_h"))
 			{
-				size.height = atoi(value);
+				size.height = intValue(viewXml, value);
 			}
 			segmentControl->setImageSizeAtIndex(size, index);
 
 			DSize offset = DSizeZero;
 			if (const char* value = itemXml->Attribute("imageOffSize_x"))
 			{
-				offset.width = atoi(value);
+				offset.width = intValue(viewXml, value);
 			}
 			if (const char* value = itemXml->Attribute("imageOffSize_y"))
 			{
-				offset.height = atoi(value);
+				offset.height = intValue(viewXml, value);
 			}
 			segmentControl->setContentOffsetForSegmentAtIndex(offset, index);
 
 			if (const char* value = itemXml->Attribute("isEnabled"))
 			{
-				segmentControl->setEnabledForSegmentAtIndex((bool)atoi(value), index);
+				segmentControl->setEnabledForSegmentAtIndex((bool)intValue(viewXml, value), index);
 			}
 		}
     }
-    else if (contrlType.compare("CAProgress") == 0)
+    else if (contrlType == CAUIControlTypeProgress)
     {
         CAProgress* progress = CAProgress::create();
         superview->addSubview(progress);
@@ -877,22 +939,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         progress->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         progress->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            progress->setZOrder(atoi(value));
+            progress->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            progress->setColor(ccc4Int(atoi(value)));
+            progress->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("trackImage"))
@@ -907,28 +969,28 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("trackColor"))
         {
-            progress->setProgressTrackColor(ccc4Int(atoi(value)));
+            progress->setProgressTrackColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("tintolor"))
         {
-            progress->setProgressTintColor(ccc4Int(atoi(value)));
+            progress->setProgressTintColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("progress"))
         {
-            progress->setProgress(atof(value)/100);
+            progress->setProgress(floatValue(viewXml, value)/100);
         }
     }
-	else if (contrlType.compare("CATextView") == 0)
+	else if (contrlType == CAUIControlTypeTextView)
 	{
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
 
 		CATextView* textView = CATextView::createWithLayout(layout);
 		superview->addSubview(textView);
@@ -939,22 +1001,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 
         if (const char* value = viewXml->Attribute("z"))
         {
-            textView->setZOrder(atoi(value));
+            textView->setZOrder(intValue(viewXml, value));
         }
 
 		if (const char* value = viewXml->Attribute("titleColor"))
 		{
-			textView->setTextColor(ccc4Int(atoi(value)));
+			textView->setTextColor(ccc4Int(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("textViewAlign"))
 		{
-			textView->setTextViewAlign(CATextView::TextViewAlign(atoi(value)));
+			textView->setTextViewAlign(CATextView::TextViewAlign(intValue(viewXml, value)));
 		}
 
 		if (const char* value = viewXml->Attribute("fontSize"))
 		{
-			textView->setFontSize(atoi(value));
+			textView->setFontSize(intValue(viewXml, value));
 		}
 
 		if (const char* value = viewXml->Attribute("text"))
@@ -968,7 +1030,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 		}
 
 	}
-    else if (contrlType.compare("CASlider") == 0)
+    else if (contrlType == CAUIControlTypeSlider)
     {
         CASlider* slider = CASlider::create();
         superview->addSubview(slider);
@@ -978,22 +1040,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         slider->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         slider->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            slider->setZOrder(atoi(value));
+            slider->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            slider->setColor(ccc4Int(atoi(value)));
+            slider->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("minTrackImage"))
@@ -1013,27 +1075,27 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("minValue"))
         {
-            slider->setMinValue(atof(value));
+            slider->setMinValue(floatValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("maxValue"))
         {
-            slider->setMaxValue(atof(value));
+            slider->setMaxValue(floatValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("sliderValue"))
         {
-            slider->setValue(atof(value));
+            slider->setValue(floatValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("trackHeight"))
         {
-            slider->setTrackHeight(atof(value));
+            slider->setTrackHeight(floatValue(viewXml, value));
         }
     }
-    else if (contrlType.compare("CAStepper") == 0)
+    else if (contrlType == CAUIControlTypeStepper)
     {
-        CAStepper* stepper = CAStepper::create((CAStepperOrientation)(atoi(viewXml->Attribute("orientation"))));
+        CAStepper* stepper = CAStepper::create((CAStepperOrientation)(intValue(viewXml, viewXml->Attribute("orientation"))));
         superview->addSubview(stepper);
         
         const char* key = viewXml->Attribute("textTag");
@@ -1041,22 +1103,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         stepper->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         stepper->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            stepper->setZOrder(atoi(value));
+            stepper->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            stepper->setColor(ccc4Int(atoi(value)));
+            stepper->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("increntmentImage"))
@@ -1084,7 +1146,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 			stepper->setBackgroundImage(CAImage::create(value), CAControlStateNormal);
         }
     }
-    else if (contrlType.compare("CAActivityIndicatorView") == 0)
+    else if (contrlType == CAUIControlTypeActivityIndicatorView)
     {
         CAActivityIndicatorView* activity = CAActivityIndicatorView::create();
         superview->addSubview(activity);
@@ -1094,27 +1156,27 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         activity->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         activity->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            activity->setZOrder(atoi(value));
+            activity->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            activity->setColor(ccc4Int(atoi(value)));
+            activity->setColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("style"))
         {
-            activity->setStyle((CAActivityIndicatorViewStyle)(atoi(value)));
+            activity->setStyle((CAActivityIndicatorViewStyle)(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("imageNormal"))
@@ -1122,12 +1184,12 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 			DSize imageSize = CrossApp::DSizeZero;
 			if (const char* value = viewXml->Attribute("imageWidth"))
 			{
-				imageSize.width = atoi(value);
+				imageSize.width = intValue(viewXml, value);
 			}
 
 			if (const char* value = viewXml->Attribute("imageHeight"))
 			{
-				imageSize.height = atoi(value);
+				imageSize.height = intValue(viewXml, value);
 			}
 
             CAImage* image = CAImage::create(value);
@@ -1151,12 +1213,12 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 			DSize backgroundSize = CrossApp::DSizeZero;
 			if (const char* value = viewXml->Attribute("backgroundWidth"))
 			{
-				backgroundSize.width = atoi(value);
+				backgroundSize.width = intValue(viewXml, value);
 			}
 
 			if (const char* value = viewXml->Attribute("backgroundHeight"))
 			{
-				backgroundSize.height = atoi(value);
+				backgroundSize.height = intValue(viewXml, value);
 			}
 
             CAImage* image = CAImage::create(value);
@@ -1174,15 +1236,15 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
             activity->setActivityBackView(imageView);
         }
     }
-    else if (contrlType.compare("CAPickerView") == 0)
+    else if (contrlType == CAUIControlTypePickerView)
     {
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         
         CAPickerView* pickerView = CAPickerView::createWithLayout(layout);
         superview->addSubview(pickerView);
@@ -1193,50 +1255,50 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            pickerView->setZOrder(atoi(value));
+            pickerView->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("color"))
         {
-            pickerView->setColor(ccc4Int(atoi(value)));
+            pickerView->setColor(ccc4Int(intValue(viewXml, value)));
         }
 
         if (const char* value = viewXml->Attribute("fontSizeNormal"))
         {
-            pickerView->setFontSizeNormal(atoi(value));
+            pickerView->setFontSizeNormal(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("fontSizeSelected"))
         {
-            pickerView->setFontSizeSelected(atoi(value));
+            pickerView->setFontSizeSelected(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("fontColorNormal"))
         {
-            pickerView->setFontColorNormal(ccc4Int(atoi(value)));
+            pickerView->setFontColorNormal(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("fontColorSelected"))
         {
-            pickerView->setFontColorSelected(ccc4Int(atoi(value)));
+            pickerView->setFontColorSelected(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("separateColor"))
         {
-            pickerView->setSeparateColor(ccc4Int(atoi(value)));
+            pickerView->setSeparateColor(ccc4Int(intValue(viewXml, value)));
         }
     }
-	else if (contrlType.compare("CADatePickerView") == 0)
+	else if (contrlType == CAUIControlTypeDatePickerView)
 	{
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
-
-		CADatePickerView* datePicker = CADatePickerView::createWithLayout(layout, (CADatePickerMode)atoi(viewXml->Attribute("mode")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
+
+		CADatePickerView* datePicker = CADatePickerView::createWithLayout(layout, (CADatePickerMode)intValue(viewXml, viewXml->Attribute("mode")));
 		superview->addSubview(datePicker);
 		
         const char* key = viewXml->Attribute("textTag");
@@ -1245,23 +1307,23 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 
         if (const char* value = viewXml->Attribute("z"))
         {
-            datePicker->setZOrder(atoi(value));
+            datePicker->setZOrder(intValue(viewXml, value));
         }
         
 		if (const char* value = viewXml->Attribute("color"))
 		{
-			datePicker->setColor(ccc4Int(atoi(value)));
+			datePicker->setColor(ccc4Int(intValue(viewXml, value)));
 		}
 	}
-    else if (contrlType.compare("CAWebView") == 0)
+    else if (contrlType == CAUIControlTypeWebView)
     {
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         
         CAWebView* webView = CAWebView::createWithLayout(layout);
         superview->addSubview(webView);
@@ -1272,7 +1334,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            webView->setZOrder(atoi(value));
+            webView->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("url"))
@@ -1280,7 +1342,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
             webView->loadURL(value);
         }
     }
-	else if (contrlType.compare("CAGifView") == 0)
+	else if (contrlType == CAUIControlTypeGifView)
 	{
 		CAGif* gif = NULL;
 		if (const char* value = viewXml->Attribute("path"))
@@ -1296,29 +1358,29 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         gifView->setTextTag(key);
         
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         gifView->setLayout(layout);
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            gifView->setZOrder(atoi(value));
+            gifView->setZOrder(intValue(viewXml, value));
         }
 
 	}
-    else if (contrlType.compare("CAScrollView") == 0)
+    else if (contrlType == CAUIControlTypeScrollView)
     {
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         
         CAScrollView* scrollView = CAScrollView::createWithLayout(layout);
         superview->addSubview(scrollView);
@@ -1329,12 +1391,12 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            scrollView->setZOrder(atoi(value));
+            scrollView->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("backgroundColor"))
         {
-            scrollView->setBackgroundColor(ccc4Int(atoi(value)));
+            scrollView->setBackgroundColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("backgroundImage"))
@@ -1345,72 +1407,72 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         DSize viewSize = CrossApp::DSizeZero;
         if (const char* value = viewXml->Attribute("viewSize_w"))
         {
-            viewSize.width = atoi(value);
+            viewSize.width = intValue(viewXml, value);
         }
         
         if (const char* value = viewXml->Attribute("viewSize_h"))
         {
-            viewSize.height = atoi(value);
+            viewSize.height = intValue(viewXml, value);
         }
         scrollView->setViewSize(viewSize);
         
         DPoint contentOffSet = DPointZero;
         if (const char* value = viewXml->Attribute("contentOffSet_x"))
         {
-            contentOffSet.x = atoi(value);
+            contentOffSet.x = intValue(viewXml, value);
         }
         if (const char* value = viewXml->Attribute("contentOffSet_y"))
         {
-            contentOffSet.y = atoi(value);
+            contentOffSet.y = intValue(viewXml, value);
         }
         scrollView->setContentOffset(contentOffSet, false);
         
         if (const char* value = viewXml->Attribute("minZoomScale"))
         {
-            scrollView->setMinimumZoomScale(atoi(value));
+            scrollView->setMinimumZoomScale(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("maxZoomScale"))
         {
-            scrollView->setMaximumZoomScale(atoi(value));
+            scrollView->setMaximumZoomScale(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("touchEnabledAtSubviews"))
         {
-            scrollView->setTouchEnabledAtSubviews(bool(atoi(value)));
+            scrollView->setTouchEnabledAtSubviews(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("showsHorizontalScrollIndicator"))
         {
-            scrollView->setShowsHorizontalScrollIndicator(bool(atoi(value)));
+            scrollView->setShowsHorizontalScrollIndicator(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("showsVerticalScrollIndicator"))
         {
-            scrollView->setShowsVerticalScrollIndicator(bool(atoi(value)));
+            scrollView->setShowsVerticalScrollIndicator(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("bounceHorizontal"))
         {
-            scrollView->setBounceHorizontal(bool(atoi(value)));
+            scrollView->setBounceHorizontal(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("bounceVertical"))
         {
-            scrollView->setBounceVertical(bool(atoi(value)));
+            scrollView->setBounceVertical(bool(intValue(viewXml, value)));
         }
     }
-    else if (contrlType.compare("CAPageView") == 0)
+    else if (contrlType == CAUIControlTypePageView)
     {
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         
-        CAPageView* pageView = CAPageView::createWithLayout(layout, (CAPageView::Orientation)(atoi(viewXml->Attribute("orientation"))));
+        CAPageView* pageView = CAPageView::createWithLayout(layout, (CAPageView::Orientation)(intValue(viewXml, viewXml->Attribute("orientation"))));
         
         superview->addSubview(pageView);
         
@@ -1420,12 +1482,12 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            pageView->setZOrder(atoi(value));
+            pageView->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("backgroundColor"))
         {
-            pageView->setBackgroundColor(ccc4Int(atoi(value)));
+            pageView->setBackgroundColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("backgroundImage"))
@@ -1435,38 +1497,38 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if(const char* value = viewXml->Attribute("spacing"))
         {
-            pageView->setSpacing(atoi(value));
+            pageView->setSpacing(intValue(viewXml, value));
         }
         
         if(const char* value = viewXml->Attribute("spacing"))
         {
-            pageView->setSpacing(atoi(value));
+            pageView->setSpacing(intValue(viewXml, value));
         }
         
         if(const char* value = viewXml->Attribute("showsScrollIndicator"))
         {
-            pageView->setShowsScrollIndicators(atoi(value));
+            pageView->setShowsScrollIndicators(intValue(viewXml, value));
         }
         
         if(const char* value = viewXml->Attribute("currPage"))
         {
-            pageView->setCurrPage(atoi(value),false);
+            pageView->setCurrPage(intValue(viewXml, value),false);
         }
         
         if(const char* value = viewXml->Attribute("bounce"))
         {
-            pageView->CAScrollView::setBounces(atoi(value));
+            pageView->CAScrollView::setBounces(intValue(viewXml, value));
         }
     }
-    else if (contrlType.compare("CAListView") == 0)
+    else if (contrlType == CAUIControlTypeListView)
     {
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         
         CAListView* listView = CAListView::createWithLayout(layout);
         superview->addSubview(listView);
@@ -1477,12 +1539,12 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
  
         if (const char* value = viewXml->Attribute("z"))
         {
-            listView->setZOrder(atoi(value));
+            listView->setZOrder(intValue(viewXml, value));
         }
 
         if (const char* value = viewXml->Attribute("backgroundColor"))
         {
-            listView->setBackgroundColor(ccc4Int(atoi(value)));
+            listView->setBackgroundColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("backgroundImage"))
@@ -1492,42 +1554,42 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("orientation"))
         {
-            listView->setOrientation((CAListView::Orientation)atoi(value));
+            listView->setOrientation((CAListView::Orientation)intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("headerHeight"))
         {
-            listView->setListHeaderHeight(atoi(value));
+            listView->setListHeaderHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("footerHeight"))
         {
-            listView->setListFooterHeight(atoi(value));
+            listView->setListFooterHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("separatorHeight"))
         {
-            listView->setSeparatorViewHeight(atoi(value));
+            listView->setSeparatorViewHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("separatorColor"))
         {
-            listView->setSeparatorColor(ccc4Int(atoi(value)));
+            listView->setSeparatorColor(ccc4Int(intValue(viewXml, value)));
         }
 
         if (const char* value = viewXml->Attribute("bounce"))
         {
-            listView->CAScrollView::setBounces(bool(atoi(value)));
+            listView->CAScrollView::setBounces(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("showsScrollIndicator"))
         {
-            listView->setShowsScrollIndicators(bool(atoi(value)));
+            listView->setShowsScrollIndicators(bool(intValue(viewXml, value)));
         }
 
         if (const char* value = viewXml->Attribute("headerRefreshView"))
         {
-            if(bool(atoi(value)))
+            if(bool(intValue(viewXml, value)))
             {
                 CrossApp::CAPullToRefreshView *pullview = CAPullToRefreshView::create(CrossApp::CAPullToRefreshView::Header);
                 listView->setHeaderRefreshView(pullview);
@@ -1536,22 +1598,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("footerRefreshView"))
         {
-            if(bool(atoi(value)))
+            if(bool(intValue(viewXml, value)))
             {
                 CrossApp::CAPullToRefreshView *pullview = CAPullToRefreshView::create(CrossApp::CAPullToRefreshView::Footer);
                 listView->setFooterRefreshView(pullview);
             }
         }
     }
-    else if (contrlType.compare("CATableView") == 0)
+    else if (contrlType == CAUIControlTypeTableView)
     {
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         
         CATableView* tableView = CATableView::createWithLayout(layout);
         superview->addSubview(tableView);
@@ -1562,12 +1624,12 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            tableView->setZOrder(atoi(value));
+            tableView->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("backgroundColor"))
         {
-            tableView->setBackgroundColor(ccc4Int(atoi(value)));
+            tableView->setBackgroundColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("backgroundImage"))
@@ -1577,37 +1639,37 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("headerHeight"))
         {
-            tableView->setTableHeaderHeight(atoi(value));
+            tableView->setTableHeaderHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("footerHeight"))
         {
-            tableView->setTableFooterHeight(atoi(value));
+            tableView->setTableFooterHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("separatorHeight"))
         {
-            tableView->setSeparatorViewHeight(atoi(value));
+            tableView->setSeparatorViewHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("separatorColor"))
         {
-            tableView->setSeparatorColor(ccc4Int(atoi(value)));
+            tableView->setSeparatorColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("bounce"))
         {
-            tableView->CAScrollView::setBounces(bool(atoi(value)));
+            tableView->CAScrollView::setBounces(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("showsScrollIndicator"))
         {
-            tableView->setShowsScrollIndicators(bool(atoi(value)));
+            tableView->setShowsScrollIndicators(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("headerRefreshView"))
         {
-            if(bool(atoi(value)))
+            if(bool(intValue(viewXml, value)))
             {
                 CrossApp::CAPullToRefreshView *pullview = CAPullToRefreshView::create(CrossApp::CAPullToRefreshView::Header);
                 tableView->setHeaderRefreshView(pullview);
@@ -1616,7 +1678,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("footerRefreshView"))
         {
-            if(bool(atoi(value)))
+            if(bool(intValue(viewXml, value)))
             {
                 CrossApp::CAPullToRefreshView *pullview = CAPullToRefreshView::create(CrossApp::CAPullToRefreshView::Footer);
                 tableView->setFooterRefreshView(pullview);
@@ -1625,24 +1687,24 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("alwaysTopSectionHeader"))
         {
-            tableView->setAlwaysTopSectionHeader(bool(atoi(value)));
+            tableView->setAlwaysTopSectionHeader(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("alwaysBottomSectionFooter"))
         {
-            tableView->setAlwaysBottomSectionFooter(bool(atoi(value)));
+            tableView->setAlwaysBottomSectionFooter(bool(intValue(viewXml, value)));
         }
     }
 
-    else if (contrlType.compare("CAAutoCollectionView") == 0)
+    else if (contrlType == CAUIControlTypeAutoCollectionView)
     {
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         
         CAAutoCollectionView* collectionView = CAAutoCollectionView::createWithLayout(layout);
         superview->addSubview(collectionView);
@@ -1653,12 +1715,12 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
   
         if (const char* value = viewXml->Attribute("z"))
         {
-            collectionView->setZOrder(atoi(value));
+            collectionView->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("backgroundColor"))
         {
-            collectionView->setBackgroundColor(ccc4Int(atoi(value)));
+            collectionView->setBackgroundColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("backgroundImage"))
@@ -1668,62 +1730,62 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("orientation"))
         {
-            collectionView->setOrientation((CAAutoCollectionView::Orientation)atoi(value));
+            collectionView->setOrientation((CAAutoCollectionView::Orientation)intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("horiCellInterval"))
         {
-            collectionView->setHoriCellInterval(atoi(value));
+            collectionView->setHoriCellInterval(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("vertCellInterval"))
         {
-            collectionView->setVertCellInterval(atoi(value));
+            collectionView->setVertCellInterval(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("horiMargins"))
         {
-            collectionView->setHoriMargins(atoi(value));
+            collectionView->setHoriMargins(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("vertMargins"))
         {
-            collectionView->setVertMargins(atoi(value));
+            collectionView->setVertMargins(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("headerHeight"))
         {
-            collectionView->setCollectionHeaderHeight(atoi(value));
+            collectionView->setCollectionHeaderHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("footerHeight"))
         {
-            collectionView->setCollectionFooterHeight(atoi(value));
+            collectionView->setCollectionFooterHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("horiCellInterval"))
         {
-            collectionView->setHoriCellInterval(atoi(value));
+            collectionView->setHoriCellInterval(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("vertCellInterval"))
         {
-            collectionView->setVertCellInterval(atoi(value));
+            collectionView->setVertCellInterval(intValue(viewXml, value));
         }
 
         if (const char* value = viewXml->Attribute("bounce"))
         {
-            collectionView->CAScrollView::setBounces(bool(atoi(value)));
+            collectionView->CAScrollView::setBounces(bool(intValue(viewXml, value)));
         }
 
         if (const char* value = viewXml->Attribute("showsScrollIndicator"))
         {
-            collectionView->setShowsScrollIndicators(bool(atoi(value)));
+            collectionView->setShowsScrollIndicators(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("headerRefreshView"))
         {
-            if(bool(atoi(value)))
+            if(bool(intValue(viewXml, value)))
             {
                 CrossApp::CAPullToRefreshView *pullview = CAPullToRefreshView::create(CrossApp::CAPullToRefreshView::Header);
                 collectionView->setHeaderRefreshView(pullview);
@@ -1732,7 +1794,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("footerRefreshView"))
         {
-            if(bool(atoi(value)))
+            if(bool(intValue(viewXml, value)))
             {
                 CrossApp::CAPullToRefreshView *pullview = CAPullToRefreshView::create(CrossApp::CAPullToRefreshView::Footer);
                 collectionView->setFooterRefreshView(pullview);
@@ -1741,33 +1803,33 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("alwaysTopSectionHeader"))
         {
-            collectionView->setAlwaysTopSectionHeader(bool(atoi(value)));
+            collectionView->setAlwaysTopSectionHeader(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("alwaysBottomSectionFooter"))
         {
-            collectionView->setAlwaysBottomSectionFooter(bool(atoi(value)));
+            collectionView->setAlwaysBottomSectionFooter(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("allowsSelection"))
         {
-            collectionView->setAllowsSelection(bool(atoi(value)));
+            collectionView->setAllowsSelection(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("allowsMultipleSelection"))
         {
-            collectionView->setAllowsMultipleSelection(bool(atoi(value)));
+            collectionView->setAllowsMultipleSelection(bool(intValue(viewXml, value)));
         }
     }
-    else if (contrlType.compare("CAWaterfallView") == 0)
+    else if (contrlType == CAUIControlTypeWaterfallView)
     {
         DLayout layout;
-        layout.horizontal = DHorizontalLayout(atof(viewXml->Attribute("h_var1")),
-                                              atof(viewXml->Attribute("h_var2")),
-                                              (DHorizontalLayout::Type)atoi(viewXml->Attribute("HLayoutType")));
-        layout.vertical = DVerticalLayout(atof(viewXml->Attribute("v_var1")),
-                                          atof(viewXml->Attribute("v_var2")),
-                                          (DVerticalLayout::Type)atoi(viewXml->Attribute("VLayoutType")));
+        layout.horizontal = DHorizontalLayout(floatValue(viewXml, viewXml->Attribute("h_var1")),
+                                              floatValue(viewXml, viewXml->Attribute("h_var2")),
+                                              (DHorizontalLayout::Type)intValue(viewXml, viewXml->Attribute("HLayoutType")));
+        layout.vertical = DVerticalLayout(floatValue(viewXml, viewXml->Attribute("v_var1")),
+                                          floatValue(viewXml, viewXml->Attribute("v_var2")),
+                                          (DVerticalLayout::Type)intValue(viewXml, viewXml->Attribute("VLayoutType")));
         
         CAWaterfallView* waterfallView = CAWaterfallView::createWithLayout(layout);
         superview->addSubview(waterfallView);
@@ -1778,12 +1840,12 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("z"))
         {
-            waterfallView->setZOrder(atoi(value));
+            waterfallView->setZOrder(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("backgroundColor"))
         {
-            waterfallView->setBackgroundColor(ccc4Int(atoi(value)));
+            waterfallView->setBackgroundColor(ccc4Int(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("backgroundImage"))
@@ -1793,42 +1855,42 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("headerHeight"))
         {
-            waterfallView->setWaterfallHeaderHeight(atoi(value));
+            waterfallView->setWaterfallHeaderHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("footerHeight"))
         {
-            waterfallView->setWaterfallFooterHeight(atoi(value));
+            waterfallView->setWaterfallFooterHeight(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("columnCount"))
         {
-            waterfallView->setColumnCount(atoi(value));
+            waterfallView->setColumnCount(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("itemMargin"))
         {
-            waterfallView->setItemMargin(atoi(value));
+            waterfallView->setItemMargin(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("columnMargin"))
         {
-            waterfallView->setColumnMargin(atoi(value));
+            waterfallView->setColumnMargin(intValue(viewXml, value));
         }
         
         if (const char* value = viewXml->Attribute("bounce"))
         {
-            waterfallView->CAScrollView::setBounces(bool(atoi(value)));
+            waterfallView->CAScrollView::setBounces(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("showsScrollIndicator"))
         {
-            waterfallView->setShowsScrollIndicators(bool(atoi(value)));
+            waterfallView->setShowsScrollIndicators(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("headerRefreshView"))
         {
-            if(bool(atoi(value)))
+            if(bool(intValue(viewXml, value)))
             {
                 CrossApp::CAPullToRefreshView *pullview = CAPullToRefreshView::create(CrossApp::CAPullToRefreshView::Header);
                 waterfallView->setHeaderRefreshView(pullview);
@@ -1837,7 +1899,7 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("footerRefreshView"))
         {
-            if(bool(atoi(value)))
+            if(bool(intValue(viewXml, value)))
             {
                 CrossApp::CAPullToRefreshView *pullview = CAPullToRefreshView::create(CrossApp::CAPullToRefreshView::Footer);
                 waterfallView->setFooterRefreshView(pullview);
@@ -1846,22 +1908,22 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
         
         if (const char* value = viewXml->Attribute("alwaysTopSectionHeader"))
         {
-            waterfallView->setAlwaysTopSectionHeader(bool(atoi(value)));
+            waterfallView->setAlwaysTopSectionHeader(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("alwaysBottomSectionFooter"))
         {
-            waterfallView->setAlwaysBottomSectionFooter(bool(atoi(value)));
+            waterfallView->setAlwaysBottomSectionFooter(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("allowsSelection"))
         {
-            waterfallView->setAllowsSelection(bool(atoi(value)));
+            waterfallView->setAllowsSelection(bool(intValue(viewXml, value)));
         }
         
         if (const char* value = viewXml->Attribute("allowsMultipleSelection"))
         {
-            waterfallView->setAllowsMultipleSelection(bool(atoi(value)));
+            waterfallView->setAllowsMultipleSelection(bool(intValue(viewXml, value)));
         }
     }
     
@@ -1870,40 +1932,231 @@ CAView* layoutView(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::
 
 }
 
-void parserXml(tinyxml2::XMLElement* viewXml, CAView* superview, CAMap<std::string, CAView*>& map)
+template <typename Element>
+void CAUIEditorParser::parseViews(Element* viewXml, CAView* superview)
 {
-    while (viewXml)
+    for (int index = 0; viewXml; ++index)
     {
-        CAView* view = layoutView(viewXml, superview, map);
-		if (view)
-		{
-			if (typeid(*view) == typeid(CAView) || typeid(*view) == typeid(CAScrollView))
-			{
-				parserXml(((tinyxml2::XMLElement*)viewXml->FirstChildElement()), view, map);
-			}
-		}
+        if (!(s_bDefersHiddenViews && isHidden(viewXml) && this->deferView(viewXml, superview, index)))
+        {
+            this->parseView(viewXml, superview);
+        }
 
         viewXml = viewXml->NextSiblingElement();
     }
 }
 
+template <typename Element>
+CAView* CAUIEditorParser::parseView(Element* viewXml, CAView* superview)
+{
+    CAView* view = layoutView(viewXml, superview, m_mViews);
+    if (view)
+    {
+        if (isHidden(viewXml))
+        {
+            view->setVisible(false);
+        }
+
+        if (typeid(*view) == typeid(CAView) || typeid(*view) == typeid(CAScrollView))
+        {
+            this->parseViews(viewXml->FirstChildElement(), view);
+        }
+    }
+    return view;
+}
+
+static void setDeferredElement(tinyxml2::XMLElement* viewXml, tinyxml2::XMLElement** xml, const CAUILayoutElement** element)
+{
+    *xml = viewXml;
+    *element = NULL;
+}
+
+static void setDeferredElement(const CAUILayoutElement* viewXml, tinyxml2::XMLElement** xml, const CAUILayoutElement** element)
+{
+    *xml = NULL;
+    *element = viewXml;
+}
+
+static unsigned int getLastOrderOfArrival(CAView* superview)
+{
+    unsigned int arrival = 0;
+    for (auto& subview : superview->getSubviews())
+    {
+        arrival = MAX(arrival, subview->getOrderOfArrival());
+    }
+    return arrival;
+}
+
+template <typename Element>
+static void getTextTags(Element* viewXml, std::vector<std::string>& tags)
+{
+    if (const char* tag = viewXml->Attribute("textTag"))
+    {
+        tags.push_back(tag);
+    }
+    for (Element* child = viewXml->FirstChildElement(); child; child = child->NextSiblingElement())
+    {
+        getTextTags(child, tags);
+    }
+}
+
+template <typename Element>
+bool CAUIEditorParser::deferView(Element* viewXml, CAView* superview, int index)
+{
+    // a view nobody can ask for by its tag is created at once
+    const char* key = viewXml->Attribute("textTag");
+    CC_RETURN_IF(key == NULL) false;
+
+    DeferredView deferred;
+    setDeferredElement(viewXml, &deferred.xml, &deferred.element);
+    deferred.superview = superview;
+    deferred.arrival = getLastOrderOfArrival(superview);
+    deferred.index = index;
+    m_mDeferredViews[key] = deferred;
+
+    std::vector<std::string> tags;
+    getTextTags(viewXml, tags);
+    for (auto& tag : tags)
+    {
+        m_mDeferredTags[tag] = key;
+    }
+    return true;
+}
+
+void CAUIEditorParser::loadDeferredView(const std::string& textTag)
+{
+    auto it = m_mDeferredViews.find(textTag);
+    CC_RETURN_IF(it == m_mDeferredViews.end());
+
+    DeferredView deferred = it->second;
+    m_mDeferredViews.erase(it);
+
+    for (auto tag = m_mDeferredTags.begin(); tag != m_mDeferredTags.end();)
+    {
+        if (tag->second == textTag)
+        {
+            m_mDeferredTags.erase(tag++);
+        }
+        else
+        {
+            ++tag;
+        }
+    }
+
+    // the hidden views in the subtree are deferred again
+    CAView* view = NULL;
+    if (deferred.xml)
+    {
+        view = this->parseView(deferred.xml, deferred.superview);
+    }
+    else if (deferred.element)
+    {
+        view = this->parseView(deferred.element, deferred.superview);
+    }
+    CC_RETURN_IF(view == NULL);
+
+    // it was added on top of the subviews made after it. It takes the order of arrival of the
+    // first of them and each of them the one of the next, so the same z draws in document order
+    std::vector<CAView*> later;
+    for (auto& subview : deferred.superview->getSubviews())
+    {
+        if (subview != view && subview->getOrderOfArrival() > deferred.arrival)
+        {
+            later.push_back(subview);
+        }
+    }
+    std::sort(later.begin(), later.end(), [](CAView* a, CAView* b)
+    {
+        return a->getOrderOfArrival() < b->getOrderOfArrival();
+    });
+
+    std::vector<unsigned int> arrivals;
+    for (auto& subview : later)
+    {
+        arrivals.push_back(subview->getOrderOfArrival());
+    }
+    arrivals.push_back(view->getOrderOfArrival());
+
+    // addSubview has marked the subviews for sorting already
+    view->setOrderOfArrival(arrivals[0]);
+    for (size_t i = 0; i < later.size(); ++i)
+    {
+        later[i]->setOrderOfArrival(arrivals[i + 1]);
+    }
+
+    // the siblings still deferred keep their place after the views they came after
+    for (auto& other : m_mDeferredViews)
+    {
+        DeferredView& sibling = other.second;
+        CC_CONTINUE_IF(sibling.superview != deferred.superview || sibling.arrival < deferred.arrival);
+
+        if (sibling.arrival == deferred.arrival)
+        {
+            sibling.arrival = sibling.index > deferred.index ? arrivals[0] : sibling.arrival;
+        }
+        else
+        {
+            size_t moved = std::upper_bound(arrivals.begin(), arrivals.end() - 1, sibling.arrival) - arrivals.begin();
+            sibling.arrival = moved > 0 ? arrivals[moved] : sibling.arrival;
+        }
+    }
+}
+
+CAView* CAUIEditorParser::getView(const std::string& textTag)
+{
+    CAView* view = m_mViews.getValue(textTag);
+    if (view == NULL)
+    {
+        auto it = m_mDeferredTags.find(textTag);
+        if (it != m_mDeferredTags.end())
+        {
+            this->loadDeferredView(it->second);
+            view = m_mViews.getValue(textTag);
+        }
+    }
+    return view;
+}
+
 bool CAUIEditorParser::initWithPath(const std::string& filePath, CAView* superview)
 {
     this->init();
+    m_pSupverview = superview;
     
+    // a layout stored uncompressed in the apk or a mounted archive is used where it is
     unsigned long size = 0;
-    const char* data = (const char*)FileUtils::getInstance()->getFileData(filePath.c_str(), "rb", &size);
-    if (size > 0)
+    const unsigned char* data = FileUtils::getInstance()->getFileDataView(filePath, &size);
+    if (data == NULL || ((size_t)data & 3) != 0)
     {
-        std::string str;
-        str.resize(size);
-        for (size_t i = 0; i < size; i++)
+        m_obLayoutData = FileUtils::getInstance()->getFileBuffer(filePath);
+        data = m_obLayoutData.getBytes();
+        size = m_obLayoutData.getSize();
+    }
+    
+    if (CAUILayoutFile::isLayoutData(data, size))
+    {
+        m_pLayoutFile = new CAUILayoutFile();
+        if (m_pLayoutFile->initWithData(data, size))
         {
-            str[i] = data[i];
+            const CAUILayoutElement* entity = m_pLayoutFile->RootElement()->FirstChildElement("ViewList");
+            if (entity)
+            {
+                this->parseViews(entity->FirstChildElement(), superview);
+            }
         }
-        
+        else
+        {
+            CCLOG("CrossApp: CAUIEditorParser: %s is not a valid layout", filePath.c_str());
+            CC_SAFE_DELETE(m_pLayoutFile);
+            m_obLayoutData.clear();
+        }
+    }
+    else if (size > 0)
+    {
         m_pMyDocument = new tinyxml2::XMLDocument();
-		m_pMyDocument->Parse(data, size);
+		m_pMyDocument->Parse((const char*)data, size);
+        // the document has its own copy
+        m_obLayoutData.clear();
+        
 		tinyxml2::XMLElement* rootElement = m_pMyDocument->RootElement();
         
         tinyxml2::XMLElement* entity = NULL;
@@ -1912,8 +2165,10 @@ bool CAUIEditorParser::initWithPath(const std::string& filePath, CAView* supervi
             entity = rootElement->FirstChildElement("ViewList");
         }
         
-        tinyxml2::XMLElement* viewXml = ((tinyxml2::XMLElement*)entity->FirstChildElement());
-        parserXml(viewXml, superview, m_mViews);
+        if (entity)
+        {
+            this->parseViews(entity->FirstChildElement(), superview);
+        }
     }
     
     return true;
@@ -1923,11 +2178,20 @@ void CAUIEditorParser::parseViewControllItems(CAViewController* viewController)
 {
 	m_pViewController = viewController;
 
-    CC_RETURN_IF(!m_pMyDocument);
-    
-	tinyxml2::XMLElement* rootElement = m_pMyDocument->RootElement();
+    if (m_pLayoutFile)
+    {
+        this->parseItems(m_pLayoutFile->RootElement(), viewController);
+    }
+    else if (m_pMyDocument && m_pMyDocument->RootElement())
+    {
+        this->parseItems(m_pMyDocument->RootElement(), viewController);
+    }
+}
 
-	tinyxml2::XMLElement* entity = NULL;
+template <typename Element>
+void CAUIEditorParser::parseItems(Element* rootElement, CAViewController* viewController)
+{
+	Element* entity = NULL;
 
     entity = rootElement->FirstChildElement("CATabBarItem");
 
@@ -1975,9 +2239,9 @@ void CAUIEditorParser::parseViewControllItems(CAViewController* viewController)
 			}
 			if (navigationBarItem)
 			{
-				tinyxml2::XMLElement* leftXml = entity->FirstChildElement();
+				Element* leftXml = entity->FirstChildElement();
 
-				tinyxml2::XMLElement* lElementXml = leftXml->FirstChildElement();
+				Element* lElementXml = leftXml->FirstChildElement();
 
 				while (lElementXml)
 				{
@@ -2003,9 +2267,9 @@ void CAUIEditorParser::parseViewControllItems(CAViewController* viewController)
 				}
 
 
-				tinyxml2::XMLElement* rightXml = leftXml->NextSiblingElement();
+				Element* rightXml = leftXml->NextSiblingElement();
 
-				tinyxml2::XMLElement* rElementXml = rightXml->FirstChildElement();
+				Element* rElementXml = rightXml->FirstChildElement();
 
 				while (rElementXml)
 				{
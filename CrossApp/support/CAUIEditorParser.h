@@ -1,43 +1,92 @@
-//
-//  CAUIEditorParser.hpp
-//  CrossApp
-//
-//  Created by 栗元峰 on 15/11/26.
-//  Copyright © 2015年 http://www.9miao.com. All rights reserved.
-//
-
-#ifndef CAUIEditorParser_h
-#define CAUIEditorParser_h
-
-#include "basics/CAObject.h"
-#include "basics/CASTLContainer.h"
-#include "tinyxml2/tinyxml2.h"
-
-
-NS_CC_BEGIN
-class CAViewController;
-class CC_DLL CAUIEditorParser : public CAObject
-{
-public:
-    
-    CAUIEditorParser();
-    
-    virtual ~CAUIEditorParser();
-    
-    bool initWithPath(const std::string& filePath, CAView* superview);
-    
-	void parseViewControllItems(CAViewController* viewController);
-
-    CAMap<std::string, CAView*> m_mViews;
-    
-protected:
-    
-    CAView* m_pSupverview;
-
-	CAViewController* m_pViewController;
-
-	tinyxml2::XMLDocument* m_pMyDocument;
-};
-
-NS_CC_END
-#endif /* CAUIEditorParser_h */
+//
+//  CAUIEditorParser.hpp
+//  CrossApp
+//
+//  Created by 栗元峰 on 15/11/26.
+//  Copyright © 2015年 http://www.9miao.com. All rights reserved.
+//
+
+#ifndef CAUIEditorParser_h
+#define CAUIEditorParser_h
+
+#include "basics/CAObject.h"
+#include "basics/CASTLContainer.h"
+#include "platform/CAFileUtils.h"
+#include "tinyxml2/tinyxml2.h"
+#include "CAUILayoutFile.h"
+
+
+NS_CC_BEGIN
+class CAViewController;
+class CC_DLL CAUIEditorParser : public CAObject
+{
+public:
+    
+    CAUIEditorParser();
+    
+    virtual ~CAUIEditorParser();
+    
+    /**
+     * Builds the views of a UIEdit layout, the XML or the binary layout tools/ui-layout-converter
+     * makes of it, which opens without parsing anything.
+     */
+    bool initWithPath(const std::string& filePath, CAView* superview);
+    
+	void parseViewControllItems(CAViewController* viewController);
+
+    /** the view with a textTag, the hidden views that were deferred are created when asked for */
+    CAView* getView(const std::string& textTag);
+
+    /**
+     * Whether the views that start hidden (visible="0") and their subviews are only created
+     * when getView asks for one of them. They take their place among their siblings then,
+     * as if they had been created with them.
+     */
+    static void setDefersHiddenViews(bool var);
+
+    static bool isDefersHiddenViews();
+
+    CAMap<std::string, CAView*> m_mViews;
+    
+protected:
+    
+    template <typename Element>
+    void parseViews(Element* viewXml, CAView* superview);
+
+    template <typename Element>
+    CAView* parseView(Element* viewXml, CAView* superview);
+
+    template <typename Element>
+    bool deferView(Element* viewXml, CAView* superview, int index);
+
+    template <typename Element>
+    void parseItems(Element* rootElement, CAViewController* viewController);
+
+    void loadDeferredView(const std::string& textTag);
+
+    struct DeferredView
+    {
+        tinyxml2::XMLElement* xml;
+        const CAUILayoutElement* element;
+        CAView* superview;
+        unsigned int arrival;       ///< the last order of arrival among the subviews before it
+        int index;                  ///< its place among the elements of its superview
+    };
+
+    CAView* m_pSupverview;
+
+	CAViewController* m_pViewController;
+
+	tinyxml2::XMLDocument* m_pMyDocument;
+
+    CAUILayoutFile* m_pLayoutFile;
+
+    CAFileBuffer m_obLayoutData;
+
+    std::map<std::string, DeferredView> m_mDeferredViews;
+
+    std::map<std::string, std::string> m_mDeferredTags;   ///< a textTag in a deferred subtree, and the tag of its root
+};
+
+NS_CC_END
+#endif /* CAUIEditorParser_h */
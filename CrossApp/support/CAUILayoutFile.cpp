@@ -0,0 +1,353 @@
+//
+//  CAUILayoutFile.cpp
+//  CrossApp
+//
+//  Copyright (c) 2014 http://www.9miao.com All rights reserved.
+//
+
+#include "CAUILayoutFile.h"
+#include "tinyxml2/tinyxml2.h"
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <algorithm>
+
+NS_CC_BEGIN
+
+static const struct
+{
+    const char* name;
+    CAUIControlType type;
+}
+s_tControlTypes[] =
+{
+    { "CAView",                     CAUIControlTypeView },
+    { "CAImageView",                CAUIControlTypeImageView },
+    { "CAScale9ImageView",          CAUIControlTypeScale9ImageView },
+    { "CALabel",                    CAUIControlTypeLabel },
+    { "CAButton",                   CAUIControlTypeButton },
+    { "CATextField",                CAUIControlTypeTextField },
+    { "CASwitch",                   CAUIControlTypeSwitch },
+    { "CASegmentedControl",         CAUIControlTypeSegmentedControl },
+    { "CAProgress",                 CAUIControlTypeProgress },
+    { "CATextView",                 CAUIControlTypeTextView },
+    { "CASlider",                   CAUIControlTypeSlider },
+    { "CAStepper",                  CAUIControlTypeStepper },
+    { "CAActivityIndicatorView",    CAUIControlTypeActivityIndicatorView },
+    { "CAPickerView",               CAUIControlTypePickerView },
+    { "CADatePickerView",           CAUIControlTypeDatePickerView },
+    { "CAWebView",                  CAUIControlTypeWebView },
+    { "CAGifView",                  CAUIControlTypeGifView },
+    { "CAScrollView",               CAUIControlTypeScrollView },
+    { "CAPageView",                 CAUIControlTypePageView },
+    { "CAListView",                 CAUIControlTypeListView },
+    { "CATableView",                CAUIControlTypeTableView },
+    { "CAAutoCollectionView",       CAUIControlTypeAutoCollectionView },
+    { "CAWaterfallView",            CAUIControlTypeWaterfallView },
+};
+
+CAUIControlType CAUILayoutFile::getControlTypeForName(const char* name)
+{
+    if (name)
+    {
+        for (size_t i = 0; i < sizeof(s_tControlTypes) / sizeof(s_tControlTypes[0]); ++i)
+        {
+            if (strcmp(s_tControlTypes[i].name, name) == 0)
+            {
+                return s_tControlTypes[i].type;
+            }
+        }
+    }
+    return CAUIControlTypeUnknown;
+}
+
+const char* CAUILayoutElement::Name() const
+{
+    return m_pFile->getString(m_pNode->name);
+}
+
+const char* CAUILayoutElement::Attribute(const char* name) const
+{
+    // the attributes of a node are sorted by name
+    const CAUILayoutAttribute* first = m_pFile->getAttributes() + m_pNode->firstAttribute;
+    int low = 0;
+    int high = (int)m_pNode->attributeCount - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        int result = strcmp(m_pFile->getString(first[middle].name), name);
+        if (result == 0)
+        {
+            return m_pFile->getString(first[middle].value);
+        }
+        else if (result < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return NULL;
+}
+
+int CAUILayoutElement::IntValue(const char* value) const
+{
+    return value ? m_pFile->getValue(value)->intValue : 0;
+}
+
+float CAUILayoutElement::FloatValue(const char* value) const
+{
+    return value ? m_pFile->getValue(value)->floatValue : 0.0f;
+}
+
+const CAUILayoutElement* CAUILayoutElement::FirstChildElement(const char* name) const
+{
+    const CAUILayoutElement* child = m_pFile->getElement(m_pNode->firstChild);
+    while (child && name && strcmp(child->Name(), name) != 0)
+    {
+        child = child->NextSiblingElement();
+    }
+    return child;
+}
+
+const CAUILayoutElement* CAUILayoutElement::NextSiblingElement() const
+{
+    return m_pFile->getElement(m_pNode->nextSibling);
+}
+
+CAUILayoutFile::CAUILayoutFile()
+: m_pData(NULL)
+, m_pNodes(NULL)
+, m_pAttributes(NULL)
+, m_pStrings(NULL)
+{
+}
+
+CAUILayoutFile::~CAUILayoutFile()
+{
+}
+
+bool CAUILayoutFile::isLayoutData(const unsigned char* data, unsigned long size)
+{
+    return data && size >= sizeof(CAUILayoutHeader) && memcmp(data, CAUI_LAYOUT_MAGIC, 4) == 0;
+}
+
+// the CAUILayoutValue in front of a string is in the table too
+static bool isStringOffset(unsigned int offset, unsigned int stringsSize)
+{
+    return offset >= sizeof(CAUILayoutValue) && offset % 4 == 0 && offset < stringsSize;
+}
+
+bool CAUILayoutFile::initWithData(const unsigned char* data, unsigned long size)
+{
+    m_pData = data;
+    m_vElements.clear();
+
+    do
+    {
+        if (!isLayoutData(data, size) || ((size_t)data & 3) != 0)
+        {
+            break;
+        }
+
+        const CAUILayoutHeader* header = (const CAUILayoutHeader*)data;
+        if (header->version != CAUI_LAYOUT_VERSION || header->nodeCount == 0)
+        {
+            break;
+        }
+
+        unsigned long long nodesEnd = header->nodesOffset + (unsigned long long)header->nodeCount * sizeof(CAUILayoutNode);
+        unsigned long long attributesEnd = header->attributesOffset + (unsigned long long)header->attributeCount * sizeof(CAUILayoutAttribute);
+        unsigned long long stringsEnd = header->stringsOffset + (unsigned long long)header->stringsSize;
+        if (nodesEnd > size || attributesEnd > size || stringsEnd > size
+            || header->nodesOffset % 4 != 0 || header->attributesOffset % 4 != 0 || header->stringsOffset % 4 != 0
+            || header->stringsSize == 0 || data[stringsEnd - 1] != '\0')
+        {
+            break;
+        }
+
+        m_pNodes = (const CAUILayoutNode*)(data + header->nodesOffset);
+        m_pAttributes = (const CAUILayoutAttribute*)(data + header->attributesOffset);
+        m_pStrings = (const char*)(data + header->stringsOffset);
+
+        // every offset is checked once here, so that the elements never read out of the data
+        bool valid = true;
+        for (unsigned int i = 0; i < header->attributeCount && valid; ++i)
+        {
+            valid = isStringOffset(m_pAttributes[i].name, header->stringsSize) && isStringOffset(m_pAttributes[i].value, header->stringsSize);
+        }
+        for (unsigned int i = 0; i < header->nodeCount && valid; ++i)
+        {
+            const CAUILayoutNode& node = m_pNodes[i];
+            valid = isStringOffset(node.name, header->stringsSize)
+                && node.firstAttribute + (unsigned long long)node.attributeCount <= header->attributeCount
+                && (node.firstChild == -1 || (node.firstChild > (int)i && node.firstChild < (int)header->nodeCount))
+                && (node.nextSibling == -1 || (node.nextSibling > (int)i && node.nextSibling < (int)header->nodeCount));
+        }
+        if (!valid)
+        {
+            break;
+        }
+
+        m_vElements.resize(header->nodeCount);
+        for (unsigned int i = 0; i < header->nodeCount; ++i)
+        {
+            m_vElements[i].m_pFile = this;
+            m_vElements[i].m_pNode = &m_pNodes[i];
+        }
+        return true;
+    }
+    while (0);
+
+    m_pData = NULL;
+    m_pNodes = NULL;
+    m_pAttributes = NULL;
+    m_pStrings = NULL;
+    return false;
+}
+
+const CAUILayoutElement* CAUILayoutFile::RootElement() const
+{
+    return this->getElement(0);
+}
+
+const CAUILayoutElement* CAUILayoutFile::getElement(int index) const
+{
+    return index >= 0 && index < (int)m_vElements.size() ? &m_vElements[index] : NULL;
+}
+
+// converter
+
+struct LayoutWriter
+{
+    std::vector<CAUILayoutNode> nodes;
+    std::vector<CAUILayoutAttribute> attributes;
+    std::string strings;
+    std::map<std::string, unsigned int> stringOffsets;
+
+    unsigned int addString(const char* string)
+    {
+        auto it = stringOffsets.find(string);
+        if (it != stringOffsets.end())
+        {
+            return it->second;
+        }
+        CAUILayoutValue value;
+        value.intValue = atoi(string);
+        value.floatValue = atof(string);
+        strings.append((const char*)&value, sizeof(value));
+
+        unsigned int offset = (unsigned int)strings.size();
+        strings.append(string);
+        strings.push_back('\0');
+        strings.resize((strings.size() + 3) & ~3, '\0');
+        stringOffsets[string] = offset;
+        return offset;
+    }
+
+    static bool compareAttributes(const tinyxml2::XMLAttribute* a, const tinyxml2::XMLAttribute* b)
+    {
+        return strcmp(a->Name(), b->Name()) < 0;
+    }
+
+    int addElement(const tinyxml2::XMLElement* element, std::string& error)
+    {
+        int index = (int)nodes.size();
+        nodes.push_back(CAUILayoutNode());
+
+        std::vector<const tinyxml2::XMLAttribute*> sorted;
+        for (const tinyxml2::XMLAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+        {
+            sorted.push_back(attribute);
+        }
+        std::sort(sorted.begin(), sorted.end(), compareAttributes);
+        if (sorted.size() > 0xffff)
+        {
+            error = std::string("too many attributes in ") + element->Name();
+            return -1;
+        }
+
+        CAUILayoutNode node;
+        node.name = addString(element->Name());
+        node.firstChild = -1;
+        node.nextSibling = -1;
+        node.firstAttribute = (unsigned int)attributes.size();
+        node.attributeCount = (unsigned short)sorted.size();
+        node.controlType = (unsigned short)CAUILayoutFile::getControlTypeForName(element->Attribute("contrlType"));
+        node.flags = 0;
+        if (const char* visible = element->Attribute("visible"))
+        {
+            node.flags |= atoi(visible) == 0 ? CAUILayoutNodeHidden : 0;
+        }
+
+        for (auto attribute : sorted)
+        {
+            CAUILayoutAttribute value;
+            value.name = addString(attribute->Name());
+            value.value = addString(attribute->Value());
+            attributes.push_back(value);
+        }
+
+        int previous = -1;
+        for (const tinyxml2::XMLElement* child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+        {
+            int childIndex = addElement(child, error);
+            if (childIndex < 0)
+            {
+                return -1;
+            }
+            if (previous < 0)
+            {
+                node.firstChild = childIndex;
+            }
+            else
+            {
+                nodes[previous].nextSibling = childIndex;
+            }
+            previous = childIndex;
+        }
+
+        nodes[index] = node;
+        return index;
+    }
+};
+
+bool CAUILayoutFile::convertXml(const char* xml, size_t size, std::string& out, std::string& error)
+{
+    tinyxml2::XMLDocument document;
+    if (document.Parse(xml, size) != tinyxml2::XML_SUCCESS || document.RootElement() == NULL)
+    {
+        error = "not a valid XML document";
+        return false;
+    }
+
+    LayoutWriter writer;
+    if (writer.addElement(document.RootElement(), error) < 0)
+    {
+        return false;
+    }
+
+    CAUILayoutHeader header;
+    memcpy(header.magic, CAUI_LAYOUT_MAGIC, 4);
+    header.version = CAUI_LAYOUT_VERSION;
+    header.nodeCount = (unsigned int)writer.nodes.size();
+    header.attributeCount = (unsigned int)writer.attributes.size();
+    header.stringsSize = (unsigned int)writer.strings.size();
+    header.nodesOffset = sizeof(CAUILayoutHeader);
+    header.attributesOffset = header.nodesOffset + header.nodeCount * sizeof(CAUILayoutNode);
+    header.stringsOffset = header.attributesOffset + header.attributeCount * sizeof(CAUILayoutAttribute);
+
+    out.clear();
+    out.append((const char*)&header, sizeof(header));
+    out.append((const char*)&writer.nodes[0], writer.nodes.size() * sizeof(CAUILayoutNode));
+    if (!writer.attributes.empty())
+    {
+        out.append((const char*)&writer.attributes[0], writer.attributes.size() * sizeof(CAUILayoutAttribute));
+    }
+    out.append(writer.strings);
+    return true;
+}
+
+NS_CC_END
@@ -0,0 +1,196 @@
+//
+//  CAUILayoutFile.h
+//  CrossApp
+//
+//  Copyright (c) 2014 http://www.9miao.com All rights reserved.
+//
+
+#ifndef __CAUILAYOUTFILE_H__
+#define __CAUILAYOUTFILE_H__
+
+#include <string>
+#include <vector>
+#include "platform/CCPlatformConfig.h"
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * The binary form of a UIEdit layout, written by tools/ui-layout-converter.
+ *
+ * It is the element tree of the XML with the control types resolved, the attributes
+ * of every element sorted by name and all the strings interned in one table, so it is
+ * used in place: loading it checks the offsets, nothing is parsed or copied.
+ * Every string is preceded by the numbers atoi and atof make of it, so the numeric
+ * attributes are read as they are stored. All the numbers are little endian.
+ */
+
+#define CAUI_LAYOUT_MAGIC       "CAUI"
+#define CAUI_LAYOUT_VERSION     2
+
+typedef enum
+{
+    CAUIControlTypeUnknown = 0,
+    CAUIControlTypeView,
+    CAUIControlTypeImageView,
+    CAUIControlTypeScale9ImageView,
+    CAUIControlTypeLabel,
+    CAUIControlTypeButton,
+    CAUIControlTypeTextField,
+    CAUIControlTypeSwitch,
+    CAUIControlTypeSegmentedControl,
+    CAUIControlTypeProgress,
+    CAUIControlTypeTextView,
+    CAUIControlTypeSlider,
+    CAUIControlTypeStepper,
+    CAUIControlTypeActivityIndicatorView,
+    CAUIControlTypePickerView,
+    CAUIControlTypeDatePickerView,
+    CAUIControlTypeWebView,
+    CAUIControlTypeGifView,
+    CAUIControlTypeScrollView,
+    CAUIControlTypePageView,
+    CAUIControlTypeListView,
+    CAUIControlTypeTableView,
+    CAUIControlTypeAutoCollectionView,
+    CAUIControlTypeWaterfallView
+}
+CAUIControlType;
+
+enum
+{
+    CAUILayoutNodeHidden = 1 << 0   ///< visible="0", the view starts hidden
+};
+
+struct CAUILayoutHeader
+{
+    char magic[4];
+    unsigned int version;
+    unsigned int nodeCount;
+    unsigned int attributeCount;
+    unsigned int stringsSize;
+    unsigned int nodesOffset;
+    unsigned int attributesOffset;
+    unsigned int stringsOffset;
+};
+
+/** an element, the elements are stored in document order so children come after their parent */
+struct CAUILayoutNode
+{
+    unsigned int name;              ///< string offset
+    int firstChild;                 ///< node index, -1 for none
+    int nextSibling;                ///< node index, -1 for none
+    unsigned int firstAttribute;
+    unsigned short attributeCount;
+    unsigned short controlType;     ///< CAUIControlType of the contrlType attribute
+    unsigned int flags;
+};
+
+struct CAUILayoutAttribute
+{
+    unsigned int name;              ///< string offset
+    unsigned int value;             ///< string offset
+};
+
+/** in front of every string of the table, string offsets are 4 bytes aligned */
+struct CAUILayoutValue
+{
+    int intValue;                   ///< atoi of the string
+    float floatValue;               ///< atof of the string
+};
+
+class CAUILayoutFile;
+
+/**
+ * An element of a CAUILayoutFile, it reads like the tinyxml2::XMLElement it was converted from.
+ */
+class CC_DLL CAUILayoutElement
+{
+public:
+
+    const char* Name() const;
+
+    /** the value of an attribute, NULL when the element doesn't have it */
+    const char* Attribute(const char* name) const;
+
+    /** what atoi makes of value, a string Attribute returned; 0 for NULL */
+    int IntValue(const char* value) const;
+
+    /** what atof makes of value, a string Attribute returned; 0 for NULL */
+    float FloatValue(const char* value) const;
+
+    /** the first child, or the first one with that name */
+    const CAUILayoutElement* FirstChildElement(const char* name = NULL) const;
+
+    const CAUILayoutElement* NextSiblingElement() const;
+
+    CAUIControlType getControlType() const { return (CAUIControlType)m_pNode->controlType; }
+
+    bool isHidden() const { return (m_pNode->flags & CAUILayoutNodeHidden) != 0; }
+
+private:
+
+    friend class CAUILayoutFile;
+
+    const CAUILayoutFile* m_pFile;
+
+    const CAUILayoutNode* m_pNode;
+};
+
+class CC_DLL CAUILayoutFile
+{
+public:
+
+    CAUILayoutFile();
+
+    ~CAUILayoutFile();
+
+    /** whether data starts like a binary layout */
+    static bool isLayoutData(const unsigned char* data, unsigned long size);
+
+    /**
+     * Uses a binary layout in place.
+     * @param data The layout, 4 bytes aligned. It must stay valid until the file is destroyed.
+     * @return false when the data is not a valid layout.
+     */
+    bool initWithData(const unsigned char* data, unsigned long size);
+
+    /** the root element of the document */
+    const CAUILayoutElement* RootElement() const;
+
+    const char* getString(unsigned int offset) const { return m_pStrings + offset; }
+
+    /** the numbers stored with a string of the table */
+    const CAUILayoutValue* getValue(const char* string) const { return (const CAUILayoutValue*)string - 1; }
+
+    const CAUILayoutAttribute* getAttributes() const { return m_pAttributes; }
+
+    const CAUILayoutElement* getElement(int index) const;
+
+    /**
+     * Converts a UIEdit XML layout into the binary layout.
+     * @param error The reason of a failure.
+     */
+    static bool convertXml(const char* xml, size_t size, std::string& out, std::string& error);
+
+    /** the CAUIControlType of a contrlType name */
+    static CAUIControlType getControlTypeForName(const char* name);
+
+private:
+
+    const unsigned char* m_pData;
+
+    const CAUILayoutNode* m_pNodes;
+
+    const CAUILayoutAttribute* m_pAttributes;
+
+    const char* m_pStrings;
+
+    std::vector<CAUILayoutElement> m_vElements;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(CAUILayoutFile);
+};
+
+NS_CC_END
+
+#endif // __CAUILAYOUTFILE_H__
@@ -0,0 +1,928 @@
+//
+//  CAJsonDocument.cpp
+//  CrossApp
+//
+//  Copyright (c) 2014 http://www.9miao.com All rights reserved.
+//
+
+#include "CAJsonDocument.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+#include <algorithm>
+
+NS_CC_BEGIN
+
+static const char* s_pStoppedByHandler = "stopped by the handler";
+
+// the powers of ten that are exact doubles
+static const double s_dPow10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static size_t encodeUTF8(unsigned int code, char* out)
+{
+    if (code < 0x80)
+    {
+        out[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800)
+    {
+        out[0] = (char)(0xC0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (code < 0x10000)
+    {
+        out[0] = (char)(0xE0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+// CAJsonReader
+
+CAJsonReader::CAJsonReader()
+: m_uMaxDepth(512)
+, m_pBegin(NULL)
+, m_pCurrent(NULL)
+, m_pEnd(NULL)
+, m_bInsitu(false)
+, m_pHandler(NULL)
+, m_uErrorOffset(0)
+{
+}
+
+bool CAJsonReader::parseInsitu(char* buffer, size_t size, CAJsonHandler* handler)
+{
+    m_bInsitu = true;
+    return this->parseDocument(buffer, size, handler);
+}
+
+bool CAJsonReader::parse(const char* json, size_t size, CAJsonHandler* handler)
+{
+    // without m_bInsitu nothing is written to the buffer
+    m_bInsitu = false;
+    return this->parseDocument(const_cast<char*>(json), size, handler);
+}
+
+bool CAJsonReader::parseDocument(char* buffer, size_t size, CAJsonHandler* handler)
+{
+    m_pBegin = m_pCurrent = buffer;
+    m_pEnd = buffer + size;
+    m_pHandler = handler;
+    m_sError.clear();
+    m_uErrorOffset = 0;
+
+    // a UTF-8 byte order mark
+    if (size >= 3 && memcmp(buffer, "\xEF\xBB\xBF", 3) == 0)
+    {
+        m_pCurrent += 3;
+    }
+
+    this->skipWhitespace();
+    CC_RETURN_IF(!this->parseValue(0)) false;
+    this->skipWhitespace();
+    if (m_pCurrent != m_pEnd)
+    {
+        return this->fail("unexpected data after the root value");
+    }
+    return true;
+}
+
+bool CAJsonReader::fail(const char* error)
+{
+    if (m_sError.empty())
+    {
+        m_sError = error;
+        m_uErrorOffset = m_pCurrent - m_pBegin;
+    }
+    return false;
+}
+
+void CAJsonReader::skipWhitespace()
+{
+    while (m_pCurrent < m_pEnd)
+    {
+        char c = *m_pCurrent;
+        CC_BREAK_IF(c != ' ' && c != '\n' && c != '\r' && c != '\t');
+        ++m_pCurrent;
+    }
+}
+
+bool CAJsonReader::parseValue(unsigned int depth)
+{
+    if (m_pCurrent == m_pEnd)
+    {
+        return this->fail("unexpected end of data");
+    }
+
+    switch (*m_pCurrent)
+    {
+        case '{':
+            return this->parseObject(depth + 1);
+        case '[':
+            return this->parseArray(depth + 1);
+        case '"':
+        {
+            const char* value = NULL;
+            unsigned int length = 0;
+            CC_RETURN_IF(!this->parseString(&value, &length)) false;
+            return m_pHandler->onString(value, length) || this->fail(s_pStoppedByHandler);
+        }
+        case 't':
+            return this->parseLiteral("true", 4) && (m_pHandler->onBool(true) || this->fail(s_pStoppedByHandler));
+        case 'f':
+            return this->parseLiteral("false", 5) && (m_pHandler->onBool(false) || this->fail(s_pStoppedByHandler));
+        case 'n':
+            return this->parseLiteral("null", 4) && (m_pHandler->onNull() || this->fail(s_pStoppedByHandler));
+        default:
+            return this->parseNumber();
+    }
+}
+
+bool CAJsonReader::parseLiteral(const char* literal, size_t length)
+{
+    if ((size_t)(m_pEnd - m_pCurrent) < length || memcmp(m_pCurrent, literal, length) != 0)
+    {
+        return this->fail("invalid value");
+    }
+    m_pCurrent += length;
+    return true;
+}
+
+bool CAJsonReader::parseObject(unsigned int depth)
+{
+    if (depth > m_uMaxDepth)
+    {
+        return this->fail("too deeply nested");
+    }
+    ++m_pCurrent;
+    CC_RETURN_IF(!m_pHandler->onStartObject()) this->fail(s_pStoppedByHandler);
+
+    unsigned int count = 0;
+    this->skipWhitespace();
+    if (m_pCurrent < m_pEnd && *m_pCurrent == '}')
+    {
+        ++m_pCurrent;
+        return m_pHandler->onEndObject(0) || this->fail(s_pStoppedByHandler);
+    }
+
+    while (true)
+    {
+        if (m_pCurrent == m_pEnd || *m_pCurrent != '"')
+        {
+            return this->fail("expected a member name");
+        }
+        const char* key = NULL;
+        unsigned int length = 0;
+        CC_RETURN_IF(!this->parseString(&key, &length)) false;
+        CC_RETURN_IF(!m_pHandler->onKey(key, length)) this->fail(s_pStoppedByHandler);
+
+        this->skipWhitespace();
+        if (m_pCurrent == m_pEnd || *m_pCurrent != ':')
+        {
+            return this->fail("expected ':'");
+        }
+        ++m_pCurrent;
+        this->skipWhitespace();
+        CC_RETURN_IF(!this->parseValue(depth)) false;
+        ++count;
+
+        this->skipWhitespace();
+        if (m_pCurrent == m_pEnd)
+        {
+            return this->fail("unexpected end of data");
+        }
+        if (*m_pCurrent == ',')
+        {
+            ++m_pCurrent;
+            this->skipWhitespace();
+        }
+        else if (*m_pCurrent == '}')
+        {
+            ++m_pCurrent;
+            return m_pHandler->onEndObject(count) || this->fail(s_pStoppedByHandler);
+        }
+        else
+        {
+            return this->fail("expected ',' or '}'");
+        }
+    }
+}
+
+bool CAJsonReader::parseArray(unsigned int depth)
+{
+    if (depth > m_uMaxDepth)
+    {
+        return this->fail("too deeply nested");
+    }
+    ++m_pCurrent;
+    CC_RETURN_IF(!m_pHandler->onStartArray()) this->fail(s_pStoppedByHandler);
+
+    unsigned int count = 0;
+    this->skipWhitespace();
+    if (m_pCurrent < m_pEnd && *m_pCurrent == ']')
+    {
+        ++m_pCurrent;
+        return m_pHandler->onEndArray(0) || this->fail(s_pStoppedByHandler);
+    }
+
+    while (true)
+    {
+        CC_RETURN_IF(!this->parseValue(depth)) false;
+        ++count;
+
+        this->skipWhitespace();
+        if (m_pCurrent == m_pEnd)
+        {
+            return this->fail("unexpected end of data");
+        }
+        if (*m_pCurrent == ',')
+        {
+            ++m_pCurrent;
+            this->skipWhitespace();
+        }
+        else if (*m_pCurrent == ']')
+        {
+            ++m_pCurrent;
+            return m_pHandler->onEndArray(count) || this->fail(s_pStoppedByHandler);
+        }
+        else
+        {
+            return this->fail("expected ',' or ']'");
+        }
+    }
+}
+
+bool CAJsonReader::parseString(const char** value, unsigned int* length)
+{
+    ++m_pCurrent;
+
+    // in situ the unescaped string is written over the source, it is never longer
+    char* start = m_pCurrent;
+    char* write = m_pCurrent;
+    m_sScratch.clear();
+
+    while (true)
+    {
+        char* run = m_pCurrent;
+        while (m_pCurrent < m_pEnd)
+        {
+            unsigned char c = (unsigned char)*m_pCurrent;
+            CC_BREAK_IF(c == '"' || c == '\\' || c < 0x20);
+            ++m_pCurrent;
+        }
+
+        size_t runLength = m_pCurrent - run;
+        if (m_bInsitu)
+        {
+            if (write != run)
+            {
+                memmove(write, run, runLength);
+            }
+            write += runLength;
+        }
+        else
+        {
+            m_sScratch.append(run, runLength);
+        }
+
+        if (m_pCurrent == m_pEnd)
+        {
+            return this->fail("unterminated string");
+        }
+        if (*m_pCurrent == '"')
+        {
+            break;
+        }
+        if (*m_pCurrent != '\\')
+        {
+            return this->fail("control character in string");
+        }
+        if (++m_pCurrent == m_pEnd)
+        {
+            return this->fail("unterminated string");
+        }
+
+        char decoded[4];
+        size_t decodedLength = 1;
+        switch (*m_pCurrent++)
+        {
+            case '"':   decoded[0] = '"';   break;
+            case '\\':  decoded[0] = '\\';  break;
+            case '/':   decoded[0] = '/';   break;
+            case 'b':   decoded[0] = '\b';  break;
+            case 'f':   decoded[0] = '\f';  break;
+            case 'n':   decoded[0] = '\n';  break;
+            case 'r':   decoded[0] = '\r';  break;
+            case 't':   decoded[0] = '\t';  break;
+            case 'u':
+            {
+                unsigned int code = 0;
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                    if (m_pEnd - m_pCurrent < 4)
+                    {
+                        return this->fail("invalid unicode escape");
+                    }
+                    unsigned int unit = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        int digit = hexValue(m_pCurrent[i]);
+                        if (digit < 0)
+                        {
+                            return this->fail("invalid unicode escape");
+                        }
+                        unit = (unit << 4) | digit;
+                    }
+                    m_pCurrent += 4;
+
+                    if (pass == 0)
+                    {
+                        if (unit >= 0xDC00 && unit <= 0xDFFF)
+                        {
+                            return this->fail("invalid surrogate pair");
+                        }
+                        code = unit;
+                        CC_BREAK_IF(unit < 0xD800 || unit > 0xDBFF);
+
+                        // a high surrogate, the low one follows
+                        if (m_pEnd - m_pCurrent < 2 || m_pCurrent[0] != '\\' || m_pCurrent[1] != 'u')
+                        {
+                            return this->fail("invalid surrogate pair");
+                        }
+                        m_pCurrent += 2;
+                    }
+                    else
+                    {
+                        if (unit < 0xDC00 || unit > 0xDFFF)
+                        {
+                            return this->fail("invalid surrogate pair");
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (unit - 0xDC00);
+                    }
+                }
+                decodedLength = encodeUTF8(code, decoded);
+                break;
+            }
+            default:
+                --m_pCurrent;
+                return this->fail("invalid escape");
+        }
+
+        if (m_bInsitu)
+        {
+            memcpy(write, decoded, decodedLength);
+            write += decodedLength;
+        }
+        else
+        {
+            m_sScratch.append(decoded, decodedLength);
+        }
+    }
+
+    if (m_bInsitu)
+    {
+        // over the closing quote at the latest
+        *write = '\0';
+        *value = start;
+        *length = (unsigned int)(write - start);
+    }
+    else
+    {
+        *value = m_sScratch.c_str();
+        *length = (unsigned int)m_sScratch.length();
+    }
+    ++m_pCurrent;
+    return true;
+}
+
+bool CAJsonReader::parseNumber()
+{
+    char* start = m_pCurrent;
+    bool negative = false;
+    if (*m_pCurrent == '-')
+    {
+        negative = true;
+        ++m_pCurrent;
+    }
+    if (m_pCurrent == m_pEnd || !isDigit(*m_pCurrent))
+    {
+        m_pCurrent = start;
+        return this->fail("invalid value");
+    }
+
+    // the significant digits, as long as they fit
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool integer = true;
+
+    if (*m_pCurrent == '0')
+    {
+        ++m_pCurrent;
+    }
+    else
+    {
+        for (; m_pCurrent < m_pEnd && isDigit(*m_pCurrent); ++m_pCurrent)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*m_pCurrent - '0');
+                digits += mantissa > 0 ? 1 : 0;
+            }
+            else
+            {
+                ++exponent;
+                ++digits;
+            }
+        }
+    }
+
+    if (m_pCurrent < m_pEnd && *m_pCurrent == '.')
+    {
+        integer = false;
+        ++m_pCurrent;
+        if (m_pCurrent == m_pEnd || !isDigit(*m_pCurrent))
+        {
+            return this->fail("invalid number");
+        }
+        for (; m_pCurrent < m_pEnd && isDigit(*m_pCurrent); ++m_pCurrent)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*m_pCurrent - '0');
+                digits += mantissa > 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+
+    if (m_pCurrent < m_pEnd && (*m_pCurrent == 'e' || *m_pCurrent == 'E'))
+    {
+        integer = false;
+        ++m_pCurrent;
+        bool negativeExponent = false;
+        if (m_pCurrent < m_pEnd && (*m_pCurrent == '+' || *m_pCurrent == '-'))
+        {
+            negativeExponent = *m_pCurrent == '-';
+            ++m_pCurrent;
+        }
+        if (m_pCurrent == m_pEnd || !isDigit(*m_pCurrent))
+        {
+            return this->fail("invalid number");
+        }
+        int value = 0;
+        for (; m_pCurrent < m_pEnd && isDigit(*m_pCurrent); ++m_pCurrent)
+        {
+            if (value < 100000)
+            {
+                value = value * 10 + (*m_pCurrent - '0');
+            }
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+
+    if (integer && digits <= 19)
+    {
+        if (!negative && mantissa <= (unsigned long long)LLONG_MAX)
+        {
+            return m_pHandler->onInt((long long)mantissa) || this->fail(s_pStoppedByHandler);
+        }
+        if (negative && mantissa <= (unsigned long long)LLONG_MAX + 1)
+        {
+            long long value = mantissa == (unsigned long long)LLONG_MAX + 1 ? LLONG_MIN : -(long long)mantissa;
+            return m_pHandler->onInt(value) || this->fail(s_pStoppedByHandler);
+        }
+    }
+
+    double value = 0;
+    if (digits <= 15 && exponent >= -22 && exponent <= 22)
+    {
+        // both operands are exact, so the one rounding is the correct one
+        value = (double)mantissa;
+        value = exponent < 0 ? value / s_dPow10[-exponent] : value * s_dPow10[exponent];
+        value = negative ? -value : value;
+    }
+    else
+    {
+        std::string token(start, m_pCurrent - start);
+        value = strtod(token.c_str(), NULL);
+    }
+    return m_pHandler->onDouble(value) || this->fail(s_pStoppedByHandler);
+}
+
+// CAJsonValue
+
+const CAJsonValue CAJsonValue::Null;
+
+bool CAJsonValue::asBool(bool defaultValue) const
+{
+    switch (m_eType)
+    {
+        case Type::Bool:
+            return m_tData.b;
+        case Type::Int:
+            return m_tData.i != 0;
+        case Type::Double:
+            return m_tData.d != 0;
+        default:
+            return defaultValue;
+    }
+}
+
+int CAJsonValue::asInt(int defaultValue) const
+{
+    switch (m_eType)
+    {
+        case Type::Bool:
+            return m_tData.b ? 1 : 0;
+        case Type::Int:
+            return (int)m_tData.i;
+        case Type::Double:
+            return (int)m_tData.d;
+        default:
+            return defaultValue;
+    }
+}
+
+long long CAJsonValue::asInt64(long long defaultValue) const
+{
+    switch (m_eType)
+    {
+        case Type::Bool:
+            return m_tData.b ? 1 : 0;
+        case Type::Int:
+            return m_tData.i;
+        case Type::Double:
+            return (long long)m_tData.d;
+        default:
+            return defaultValue;
+    }
+}
+
+double CAJsonValue::asDouble(double defaultValue) const
+{
+    switch (m_eType)
+    {
+        case Type::Bool:
+            return m_tData.b ? 1 : 0;
+        case Type::Int:
+            return (double)m_tData.i;
+        case Type::Double:
+            return m_tData.d;
+        default:
+            return defaultValue;
+    }
+}
+
+const char* CAJsonValue::asCString() const
+{
+    return m_eType == Type::String ? m_tData.s.string : "";
+}
+
+std::string CAJsonValue::asString() const
+{
+    char buffer[32];
+    switch (m_eType)
+    {
+        case Type::String:
+            return std::string(m_tData.s.string, m_tData.s.length);
+        case Type::Bool:
+            return m_tData.b ? "true" : "false";
+        case Type::Int:
+            snprintf(buffer, sizeof(buffer), "%lld", m_tData.i);
+            return buffer;
+        case Type::Double:
+            snprintf(buffer, sizeof(buffer), "%.17g", m_tData.d);
+            return buffer;
+        default:
+            return "";
+    }
+}
+
+unsigned int CAJsonValue::getStringLength() const
+{
+    return m_eType == Type::String ? m_tData.s.length : 0;
+}
+
+unsigned int CAJsonValue::size() const
+{
+    return m_eType == Type::Array || m_eType == Type::Object ? m_tData.c.count : 0;
+}
+
+const CAJsonValue& CAJsonValue::operator[](unsigned int index) const
+{
+    CC_RETURN_IF(m_eType != Type::Array || index >= m_tData.c.count) Null;
+    return ((const CAJsonValue*)m_tData.c.elements)[index];
+}
+
+const CAJsonValue& CAJsonValue::operator[](const char* key) const
+{
+    const CAJsonValue* value = this->findMember(key);
+    return value ? *value : Null;
+}
+
+const CAJsonValue* CAJsonValue::findMember(const char* key) const
+{
+    CC_RETURN_IF(m_eType != Type::Object || key == NULL) NULL;
+
+    // the members are few enough that a scan of the flat array beats hashing
+    size_t length = strlen(key);
+    const CAJsonMember* members = (const CAJsonMember*)m_tData.c.elements;
+    for (unsigned int i = 0; i < m_tData.c.count; ++i)
+    {
+        if (members[i].getNameLength() == length && memcmp(members[i].getName(), key, length) == 0)
+        {
+            return &members[i].getValue();
+        }
+    }
+    return NULL;
+}
+
+const CAJsonMember* CAJsonValue::getMembers() const
+{
+    return m_eType == Type::Object ? (const CAJsonMember*)m_tData.c.elements : NULL;
+}
+
+CAValue CAJsonValue::toValue() const
+{
+    switch (m_eType)
+    {
+        case Type::Bool:
+            return CAValue(m_tData.b);
+        case Type::Int:
+            if (m_tData.i >= INT_MIN && m_tData.i <= INT_MAX)
+            {
+                return CAValue((int)m_tData.i);
+            }
+            return CAValue((double)m_tData.i);
+        case Type::Double:
+            return CAValue(m_tData.d);
+        case Type::String:
+            return CAValue(std::string(m_tData.s.string, m_tData.s.length));
+        case Type::Array:
+        {
+            CAValueVector vector;
+            vector.reserve(m_tData.c.count);
+            for (unsigned int i = 0; i < m_tData.c.count; ++i)
+            {
+                vector.push_back((*this)[i].toValue());
+            }
+            return CAValue(std::move(vector));
+        }
+        case Type::Object:
+        {
+            CAValueMap map;
+            map.reserve(m_tData.c.count);
+            const CAJsonMember* members = this->getMembers();
+            for (unsigned int i = 0; i < m_tData.c.count; ++i)
+            {
+                // a repeated name keeps the last value
+                map[std::string(members[i].getName(), members[i].getNameLength())] = members[i].getValue().toValue();
+            }
+            return CAValue(std::move(map));
+        }
+        default:
+            return CAValue();
+    }
+}
+
+// CAJsonDocument
+
+CAJsonDocument::CAJsonDocument()
+: m_pKey(NULL)
+, m_uKeyLength(0)
+, m_uBlockUsed(0)
+, m_uBlockSize(0)
+, m_pBuffer(NULL)
+{
+}
+
+CAJsonDocument::~CAJsonDocument()
+{
+    this->clear();
+}
+
+void CAJsonDocument::clear()
+{
+    for (size_t i = 0; i < m_vBlocks.size(); ++i)
+    {
+        free(m_vBlocks[i]);
+    }
+    m_vBlocks.clear();
+    m_uBlockUsed = 0;
+    m_uBlockSize = 0;
+
+    if (m_pBuffer)
+    {
+        free(m_pBuffer);
+        m_pBuffer = NULL;
+    }
+
+    m_vStack.clear();
+    m_pKey = NULL;
+    m_uKeyLength = 0;
+    m_obRoot = CAJsonValue();
+}
+
+bool CAJsonDocument::parse(const char* json, size_t size)
+{
+    this->clear();
+    CC_RETURN_IF(json == NULL) false;
+
+    m_pBuffer = (char*)malloc(size + 1);
+    CC_RETURN_IF(m_pBuffer == NULL) false;
+    memcpy(m_pBuffer, json, size);
+    m_pBuffer[size] = '\0';
+
+    // parseInsitu starts with clear(), the copy is owned again once parsed
+    char* buffer = m_pBuffer;
+    m_pBuffer = NULL;
+    bool result = this->parseInsitu(buffer, size);
+    if (result)
+    {
+        m_pBuffer = buffer;
+    }
+    else
+    {
+        free(buffer);
+    }
+    return result;
+}
+
+bool CAJsonDocument::parseInsitu(char* buffer, size_t size)
+{
+    this->clear();
+    CC_RETURN_IF(buffer == NULL) false;
+
+    if (!m_obReader.parseInsitu(buffer, size, this) || m_vStack.size() != 1)
+    {
+        CCLOG("CAJsonDocument: %s at %lu", m_obReader.getParseError().c_str(), (unsigned long)m_obReader.getErrorOffset());
+        this->clear();
+        return false;
+    }
+
+    m_obRoot = m_vStack[0].m_obValue;
+    m_vStack.clear();
+    return true;
+}
+
+CAValue CAJsonDocument::parseToValue(const char* json, size_t size)
+{
+    CAJsonDocument document;
+    CC_RETURN_IF(!document.parse(json, size)) CAValue();
+    return document.getRoot().toValue();
+}
+
+void* CAJsonDocument::allocate(size_t size)
+{
+    size = (size + 7) & ~(size_t)7;
+    if (m_vBlocks.empty() || m_uBlockUsed + size > m_uBlockSize)
+    {
+        // the blocks double up to 1 MB, a larger request gets a block of its own
+        size_t blockSize = m_uBlockSize == 0 ? 16 * 1024 : std::min(m_uBlockSize * 2, (size_t)1024 * 1024);
+        blockSize = std::max(blockSize, size);
+        char* block = (char*)malloc(blockSize);
+        CC_RETURN_IF(block == NULL) NULL;
+        m_vBlocks.push_back(block);
+        m_uBlockSize = blockSize;
+        m_uBlockUsed = 0;
+    }
+    void* result = m_vBlocks.back() + m_uBlockUsed;
+    m_uBlockUsed += size;
+    return result;
+}
+
+bool CAJsonDocument::push(const CAJsonValue& value)
+{
+    CAJsonMember member;
+    member.m_pName = m_pKey;
+    member.m_uNameLength = m_uKeyLength;
+    member.m_obValue = value;
+    m_vStack.push_back(member);
+    m_pKey = NULL;
+    m_uKeyLength = 0;
+    return true;
+}
+
+bool CAJsonDocument::closeContainer(CAJsonValue::Type type, unsigned int count, size_t elementSize)
+{
+    // the children are the last entries of the stack, above the container
+    size_t first = m_vStack.size() - count;
+    CAJsonValue& container = m_vStack[first - 1].m_obValue;
+    container.m_eType = type;
+    container.m_tData.c.count = count;
+    container.m_tData.c.elements = NULL;
+
+    if (count > 0)
+    {
+        char* elements = (char*)this->allocate(count * elementSize);
+        CC_RETURN_IF(elements == NULL) false;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (type == CAJsonValue::Type::Object)
+            {
+                memcpy(elements + i * elementSize, &m_vStack[first + i], sizeof(CAJsonMember));
+            }
+            else
+            {
+                memcpy(elements + i * elementSize, &m_vStack[first + i].m_obValue, sizeof(CAJsonValue));
+            }
+        }
+        container.m_tData.c.elements = elements;
+    }
+    m_vStack.resize(first);
+    return true;
+}
+
+bool CAJsonDocument::onNull()
+{
+    return this->push(CAJsonValue());
+}
+
+bool CAJsonDocument::onBool(bool value)
+{
+    CAJsonValue json;
+    json.m_eType = CAJsonValue::Type::Bool;
+    json.m_tData.b = value;
+    return this->push(json);
+}
+
+bool CAJsonDocument::onInt(long long value)
+{
+    CAJsonValue json;
+    json.m_eType = CAJsonValue::Type::Int;
+    json.m_tData.i = value;
+    return this->push(json);
+}
+
+bool CAJsonDocument::onDouble(double value)
+{
+    CAJsonValue json;
+    json.m_eType = CAJsonValue::Type::Double;
+    json.m_tData.d = value;
+    return this->push(json);
+}
+
+bool CAJsonDocument::onString(const char* value, unsigned int length)
+{
+    CAJsonValue json;
+    json.m_eType = CAJsonValue::Type::String;
+    json.m_tData.s.string = value;
+    json.m_tData.s.length = length;
+    return this->push(json);
+}
+
+bool CAJsonDocument::onStartObject()
+{
+    return this->push(CAJsonValue());
+}
+
+bool CAJsonDocument::onKey(const char* key, unsigned int length)
+{
+    m_pKey = key;
+    m_uKeyLength = length;
+    return true;
+}
+
+bool CAJsonDocument::onEndObject(unsigned int memberCount)
+{
+    return this->closeContainer(CAJsonValue::Type::Object, memberCount, sizeof(CAJsonMember));
+}
+
+bool CAJsonDocument::onStartArray()
+{
+    return this->push(CAJsonValue());
+}
+
+bool CAJsonDocument::onEndArray(unsigned int elementCount)
+{
+    return this->closeContainer(CAJsonValue::Type::Array, elementCount, sizeof(CAJsonValue));
+}
+
+NS_CC_END
@@ -0,0 +1,347 @@
+//
+//  CAJsonDocument.h
+//  CrossApp
+//
+//  Copyright (c) 2014 http://www.9miao.com All rights reserved.
+//
+
+#ifndef __CAJSONDOCUMENT_H__
+#define __CAJSONDOCUMENT_H__
+
+#include <string>
+#include <vector>
+#include "platform/CCPlatformMacros.h"
+#include "basics/CAValue.h"
+
+NS_CC_BEGIN
+
+/**
+ * Receives the events of CAJsonReader, in document order.
+ * Returning false from any of them stops the parsing with an error.
+ *
+ * The strings are NUL terminated and unescaped; with an in situ parse they
+ * point into the parsed buffer, otherwise they are only valid during the call.
+ */
+class CC_DLL CAJsonHandler
+{
+public:
+
+    virtual ~CAJsonHandler() {}
+
+    virtual bool onNull() = 0;
+
+    virtual bool onBool(bool value) = 0;
+
+    /** a number without fraction or exponent that fits in 64 bits */
+    virtual bool onInt(long long value) = 0;
+
+    virtual bool onDouble(double value) = 0;
+
+    virtual bool onString(const char* value, unsigned int length) = 0;
+
+    virtual bool onStartObject() = 0;
+
+    virtual bool onKey(const char* key, unsigned int length) = 0;
+
+    virtual bool onEndObject(unsigned int memberCount) = 0;
+
+    virtual bool onStartArray() = 0;
+
+    virtual bool onEndArray(unsigned int elementCount) = 0;
+};
+
+/**
+ * A SAX parser of RFC 8259 JSON, nothing is allocated while parsing.
+ */
+class CC_DLL CAJsonReader
+{
+public:
+
+    CAJsonReader();
+
+    /**
+     * Parses in situ: the strings are unescaped inside the buffer, which is modified.
+     * @param buffer The document, it doesn't need to be NUL terminated.
+     */
+    bool parseInsitu(char* buffer, size_t size, CAJsonHandler* handler);
+
+    /** parses a buffer that is left untouched, each string is copied once to unescape it */
+    bool parse(const char* json, size_t size, CAJsonHandler* handler);
+
+    const std::string& getParseError() const { return m_sError; }
+
+    /** the byte offset of the error */
+    size_t getErrorOffset() const { return m_uErrorOffset; }
+
+    /** nesting deeper than this fails, 512 by default */
+    CC_SYNTHESIZE(unsigned int, m_uMaxDepth, MaxDepth);
+
+private:
+
+    bool parseDocument(char* buffer, size_t size, CAJsonHandler* handler);
+
+    bool parseValue(unsigned int depth);
+
+    bool parseObject(unsigned int depth);
+
+    bool parseArray(unsigned int depth);
+
+    bool parseString(const char** value, unsigned int* length);
+
+    bool parseNumber();
+
+    bool parseLiteral(const char* literal, size_t length);
+
+    void skipWhitespace();
+
+    bool fail(const char* error);
+
+private:
+
+    char* m_pBegin;
+
+    char* m_pCurrent;
+
+    char* m_pEnd;
+
+    std::string m_sScratch;
+
+    bool m_bInsitu;
+
+    CAJsonHandler* m_pHandler;
+
+    std::string m_sError;
+
+    size_t m_uErrorOffset;
+};
+
+class CAJsonMember;
+
+/**
+ * A read only value of a CAJsonDocument. Arrays and objects are flat arrays
+ * allocated in the arena of their document.
+ */
+class CC_DLL CAJsonValue
+{
+public:
+
+    enum class Type
+    {
+        Null = 0,
+        Bool,
+        Int,
+        Double,
+        String,
+        Array,
+        Object
+    };
+
+    CAJsonValue() : m_eType(Type::Null) { m_tData.i = 0; }
+
+    Type getType() const { return m_eType; }
+
+    bool isNull() const { return m_eType == Type::Null; }
+
+    bool isBool() const { return m_eType == Type::Bool; }
+
+    bool isInt() const { return m_eType == Type::Int; }
+
+    bool isNumber() const { return m_eType == Type::Int || m_eType == Type::Double; }
+
+    bool isString() const { return m_eType == Type::String; }
+
+    bool isArray() const { return m_eType == Type::Array; }
+
+    bool isObject() const { return m_eType == Type::Object; }
+
+    bool asBool(bool defaultValue = false) const;
+
+    int asInt(int defaultValue = 0) const;
+
+    long long asInt64(long long defaultValue = 0) const;
+
+    double asDouble(double defaultValue = 0) const;
+
+    /** the string, "" when the value is not a string */
+    const char* asCString() const;
+
+    std::string asString() const;
+
+    /** the length of the string in bytes */
+    unsigned int getStringLength() const;
+
+    /** the number of elements or members */
+    unsigned int size() const;
+
+    /** an array element, a null value when out of range */
+    const CAJsonValue& operator[](unsigned int index) const;
+
+    /** an object member, a null value when missing */
+    const CAJsonValue& operator[](const char* key) const;
+
+    const CAJsonValue& operator[](const std::string& key) const { return (*this)[key.c_str()]; }
+
+    /** the member, NULL when missing */
+    const CAJsonValue* findMember(const char* key) const;
+
+    bool hasMember(const char* key) const { return this->findMember(key) != NULL; }
+
+    /** the members of an object, in document order */
+    const CAJsonMember* getMembers() const;
+
+    /** converts to CAValue, objects become CAValueMap and arrays CAValueVector */
+    CAValue toValue() const;
+
+    static const CAJsonValue Null;
+
+private:
+
+    friend class CAJsonDocument;
+
+    union
+    {
+        bool b;
+        long long i;
+        double d;
+        struct
+        {
+            const char* string;
+            unsigned int length;
+        }
+        s;
+        struct
+        {
+            const void* elements;
+            unsigned int count;
+        }
+        c;
+    }
+    m_tData;
+
+    Type m_eType;
+};
+
+class CC_DLL CAJsonMember
+{
+public:
+
+    const char* getName() const { return m_pName; }
+
+    unsigned int getNameLength() const { return m_uNameLength; }
+
+    const CAJsonValue& getValue() const { return m_obValue; }
+
+private:
+
+    friend class CAJsonDocument;
+
+    const char* m_pName;
+
+    unsigned int m_uNameLength;
+
+    CAJsonValue m_obValue;
+};
+
+/**
+ * A JSON DOM built by CAJsonReader.
+ *
+ * Every node comes from one arena that is freed with the document, and with
+ * parseInsitu the strings stay in the parsed buffer instead of being copied,
+ * which then has to outlive the document.
+ *
+ *     CAJsonDocument document;
+ *     if (document.parse(data.c_str(), data.length()))
+ *     {
+ *         const CAJsonValue& list = document.getRoot()["result"];
+ *         for (unsigned int i = 0; i < list.size(); ++i)
+ *         {
+ *             CCLog("%s", list[i]["title"].asCString());
+ *         }
+ *     }
+ */
+class CC_DLL CAJsonDocument : private CAJsonHandler
+{
+public:
+
+    CAJsonDocument();
+
+    virtual ~CAJsonDocument();
+
+    /** parses a copy of json, the strings are unescaped in the copy */
+    bool parse(const char* json, size_t size);
+
+    bool parse(const std::string& json) { return this->parse(json.c_str(), json.length()); }
+
+    /** parses and keeps the strings in buffer, which must outlive the document */
+    bool parseInsitu(char* buffer, size_t size);
+
+    /** the root value, null when parsing failed */
+    const CAJsonValue& getRoot() const { return m_obRoot; }
+
+    const CAJsonValue& operator[](const char* key) const { return m_obRoot[key]; }
+
+    const std::string& getParseError() const { return m_obReader.getParseError(); }
+
+    size_t getErrorOffset() const { return m_obReader.getErrorOffset(); }
+
+    /** parses json into CAValue, an empty value on error */
+    static CAValue parseToValue(const char* json, size_t size);
+
+    /** frees the values and the arena */
+    void clear();
+
+private:
+
+    void* allocate(size_t size);
+
+    bool push(const CAJsonValue& value);
+
+    bool closeContainer(CAJsonValue::Type type, unsigned int count, size_t elementSize);
+
+    virtual bool onNull();
+
+    virtual bool onBool(bool value);
+
+    virtual bool onInt(long long value);
+
+    virtual bool onDouble(double value);
+
+    virtual bool onString(const char* value, unsigned int length);
+
+    virtual bool onStartObject();
+
+    virtual bool onKey(const char* key, unsigned int length);
+
+    virtual bool onEndObject(unsigned int memberCount);
+
+    virtual bool onStartArray();
+
+    virtual bool onEndArray(unsigned int elementCount);
+
+private:
+
+    CAJsonReader m_obReader;
+
+    CAJsonValue m_obRoot;
+
+    /** the values of the open containers, with their keys */
+    std::vector<CAJsonMember> m_vStack;
+
+    const char* m_pKey;
+
+    unsigned int m_uKeyLength;
+
+    std::vector<char*> m_vBlocks;
+
+    size_t m_uBlockUsed;
+
+    size_t m_uBlockSize;
+
+    char* m_pBuffer;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(CAJsonDocument);
+};
+
+NS_CC_END
+
+#endif // __CAJSONDOCUMENT_H__
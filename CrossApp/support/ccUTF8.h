@@ -6,6 +6,7 @@
 #include "platform/CCPlatformMacros.h"
 #include <vector>
 #include <string>
+#include <string.h>
 #include "ConvertUTF.h"
 
 NS_CC_BEGIN
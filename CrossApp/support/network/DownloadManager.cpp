@@ -1153,6 +1153,7 @@ bool CADownloadResponse::downLoad()
     
     fclose(fp);
 	rename(outFileName.c_str(), _fileName.c_str());
+	FileUtils::getInstance()->purgeMissingEntries();
 
     return true;
 }
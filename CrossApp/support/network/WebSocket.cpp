@@ -3,16 +3,25 @@
 #include "basics/CAScheduler.h"
 
 #include <thread>
+#include <atomic>
 #include <mutex>
 #include <queue>
-#include <list>
+#include <deque>
+#include <algorithm>
 #include <signal.h>
 #include <errno.h>
 
 #include "libwebsockets.h"
 
 #define WS_RX_BUFFER_SIZE (65536)
-#define WS_RESERVE_RECEIVE_BUFFER_SIZE (4096)
+#define WS_WRITE_SIZE_PER_CALLBACK (WS_RX_BUFFER_SIZE * 4)
+#define WS_SEND_QUEUE_HIGH_WATER_MARK (1024 * 1024)
+#define WS_SEND_QUEUE_LOW_WATER_MARK (256 * 1024)
+
+// The pooled buffers are 256 bytes to 128 KB, a whole frame with its LWS_PRE fits in the largest
+#define WS_BUFFER_POOL_MIN_SIZE (256)
+#define WS_BUFFER_POOL_CLASS_COUNT (10)
+#define WS_BUFFER_POOL_FREE_BYTES (512 * 1024)
 
 #define  LOG_TAG    "WebSocket.cpp"
 
@@ -66,13 +75,155 @@ NS_CC_BEGIN
 
 namespace network {
 
+/**
+ *  @brief A message buffer, the bytes follow it in the same allocation.
+ *         The buffers come from a pool shared by the websockets, so a steady stream
+ *         of messages doesn't allocate.
+ */
+class WsBuffer
+{
+public:
+    // nullptr when the memory can't be allocated
+    static WsBuffer* create(size_t capacity);
+
+    // Copies the first len bytes to a buffer of at least capacity and releases this one,
+    // nullptr when the memory can't be allocated, this one is released anyway.
+    WsBuffer* grow(size_t len, size_t capacity);
+
+    void release();
+
+    unsigned char* getBytes() { return reinterpret_cast<unsigned char*>(this + 1); }
+    size_t getCapacity() const { return _capacity; }
+
+private:
+    friend class WsBufferPool;
+    size_t _capacity;
+    WsBuffer* _next;
+};
+
+class WsBufferPool
+{
+public:
+    static WsBufferPool* getInstance();
+
+    WsBuffer* acquire(size_t capacity);
+    void release(WsBuffer* buffer);
+
+private:
+    WsBufferPool();
+    static int getSizeClass(size_t capacity);
+
+    std::mutex _mutex;
+    WsBuffer* _freeBuffers[WS_BUFFER_POOL_CLASS_COUNT];
+    size_t _freeBytes[WS_BUFFER_POOL_CLASS_COUNT];
+};
+
+WsBufferPool* WsBufferPool::getInstance()
+{
+    // Never deleted, the messages delivered to the Cocos thread can outlive the websockets
+    static WsBufferPool* s_pool = new (std::nothrow) WsBufferPool();
+    return s_pool;
+}
+
+WsBufferPool::WsBufferPool()
+{
+    memset(_freeBuffers, 0, sizeof(_freeBuffers));
+    memset(_freeBytes, 0, sizeof(_freeBytes));
+}
+
+int WsBufferPool::getSizeClass(size_t capacity)
+{
+    size_t size = WS_BUFFER_POOL_MIN_SIZE;
+    for (int i = 0; i < WS_BUFFER_POOL_CLASS_COUNT; ++i, size <<= 1)
+    {
+        if (capacity <= size)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+WsBuffer* WsBufferPool::acquire(size_t capacity)
+{
+    int sizeClass = getSizeClass(capacity);
+    if (sizeClass >= 0)
+    {
+        capacity = (size_t)WS_BUFFER_POOL_MIN_SIZE << sizeClass;
+
+        std::lock_guard<std::mutex> lk(_mutex);
+        WsBuffer* buffer = _freeBuffers[sizeClass];
+        if (buffer)
+        {
+            _freeBuffers[sizeClass] = buffer->_next;
+            _freeBytes[sizeClass] -= capacity;
+            return buffer;
+        }
+    }
+
+    WsBuffer* buffer = (WsBuffer*)malloc(sizeof(WsBuffer) + capacity);
+    if (buffer == nullptr)
+    {
+        return nullptr;
+    }
+    buffer->_capacity = capacity;
+    buffer->_next = nullptr;
+    return buffer;
+}
+
+void WsBufferPool::release(WsBuffer* buffer)
+{
+    int sizeClass = getSizeClass(buffer->_capacity);
+    if (sizeClass >= 0 && buffer->_capacity == ((size_t)WS_BUFFER_POOL_MIN_SIZE << sizeClass))
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (_freeBytes[sizeClass] + buffer->_capacity <= WS_BUFFER_POOL_FREE_BYTES)
+        {
+            buffer->_next = _freeBuffers[sizeClass];
+            _freeBuffers[sizeClass] = buffer;
+            _freeBytes[sizeClass] += buffer->_capacity;
+            return;
+        }
+    }
+    free(buffer);
+}
+
+WsBuffer* WsBuffer::create(size_t capacity)
+{
+    return WsBufferPool::getInstance()->acquire(capacity);
+}
+
+WsBuffer* WsBuffer::grow(size_t len, size_t capacity)
+{
+    if (capacity <= _capacity)
+    {
+        return this;
+    }
+
+    WsBuffer* buffer = create(std::max(capacity, _capacity * 2));
+    if (buffer != nullptr)
+    {
+        memcpy(buffer->getBytes(), getBytes(), len);
+    }
+    release();
+    return buffer;
+}
+
+void WsBuffer::release()
+{
+    WsBufferPool::getInstance()->release(this);
+}
+
 class WsMessage
 {
 public:
-    WsMessage() : id(++__id), what(0), obj(nullptr){}
+    WsMessage() : id(++__id), what(0), buffer(nullptr), len(0), issued(0), frameIssued(0){}
     unsigned int id;
     unsigned int what; // message type
-    void* obj;
+    WsBuffer* buffer;  // the payload starts at LWS_PRE, lws writes the header of each frame right before it
+    size_t len;
+    size_t issued;      // the bytes of the frames sent
+    size_t frameIssued; // the bytes of the current frame sent
 
 private:
     static unsigned int __id;
@@ -97,20 +248,19 @@ public:
     // Sends message to Cocos thread. It's needed to be invoked in Websocket thread.
     void sendMessageToCocosThread(const std::function<void()>& cb);
 
-    // Sends message to Websocket thread. It's needs to be invoked in Cocos thread.
-    void sendMessageToWebSocketThread(WsMessage *msg);
-
     // Waits the sub-thread (websocket thread) to exit,
     void joinWebSocketThread();
 
 protected:
     void wsThreadEntryFunc();
 private:
-    std::list<WsMessage*>* _subThreadWsMessageQueue;
+    // Pushed by WebSocket::send in Cocos thread, popped in websocket thread
+    std::deque<WsMessage> _subThreadWsMessageQueue;
+    size_t       _subThreadWsMessageQueueBytes;
     std::mutex   _subThreadWsMessageQueueMutex;
     std::thread* _subThreadInstance;
     WebSocket* _ws;
-    bool _needQuit;
+    std::atomic<bool> _needQuit;
     friend class WebSocket;
 };
 
@@ -137,18 +287,21 @@ public:
 
 // Implementation of WsThreadHelper
 WsThreadHelper::WsThreadHelper()
-: _subThreadInstance(nullptr)
+: _subThreadWsMessageQueueBytes(0)
+, _subThreadInstance(nullptr)
 , _ws(nullptr)
 , _needQuit(false)
 {
-    _subThreadWsMessageQueue = new (std::nothrow) std::list<WsMessage*>();
 }
 
 WsThreadHelper::~WsThreadHelper()
 {
     joinWebSocketThread();
     CC_SAFE_DELETE(_subThreadInstance);
-    delete _subThreadWsMessageQueue;
+    for (auto& msg : _subThreadWsMessageQueue)
+    {
+        msg.buffer->release();
+    }
 }
 
 bool WsThreadHelper::createWebSocketThread(const WebSocket& ws)
@@ -163,6 +316,13 @@ bool WsThreadHelper::createWebSocketThread(const WebSocket& ws)
 void WsThreadHelper::quitWebSocketThread()
 {
     _needQuit = true;
+
+    // Doesn't wait for the timeout of lws_service
+    std::lock_guard<std::mutex> lk(_subThreadWsMessageQueueMutex);
+    if (_ws->_wsContext != nullptr)
+    {
+        lws_cancel_service(_ws->_wsContext);
+    }
 }
 
 void WsThreadHelper::wsThreadEntryFunc()
@@ -185,12 +345,6 @@ void WsThreadHelper::sendMessageToCocosThread(const std::function<void()>& cb)
     CAScheduler::getScheduler()->performFunctionInUIThread(cb);
 }
 
-void WsThreadHelper::sendMessageToWebSocketThread(WsMessage *msg)
-{
-    std::lock_guard<std::mutex> lk(_subThreadWsMessageQueueMutex);
-    _subThreadWsMessageQueue->push_back(msg);
-}
-
 void WsThreadHelper::joinWebSocketThread()
 {
     if (_subThreadInstance->joinable())
@@ -199,60 +353,6 @@ void WsThreadHelper::joinWebSocketThread()
     }
 }
 
-// Define a WebSocket frame
-class WebSocketFrame
-{
-public:
-    WebSocketFrame()
-        : _payload(nullptr)
-        , _payloadLength(0)
-        , _frameLength(0)
-    {
-    }
-
-    bool init(unsigned char* buf, ssize_t len)
-    {
-        if (buf == nullptr && len > 0)
-            return false;
-
-        if (!_data.empty())
-        {
-            LOGD("WebSocketFrame was initialized, should not init it again!\n");
-            return false;
-        }
-
-        _data.reserve(LWS_PRE + len);
-        _data.resize(LWS_PRE, 0x00);
-        if (len > 0)
-        {
-            _data.insert(_data.end(), buf, buf + len);
-        }
-
-        _payload = _data.data() + LWS_PRE;
-        _payloadLength = len;
-        _frameLength = len;
-        return true;
-    }
-
-    void update(ssize_t issued)
-    {
-        _payloadLength -= issued;
-        _payload += issued;
-    }
-
-    unsigned char* getPayload() const { return _payload; }
-    ssize_t getPayloadLength() const { return _payloadLength; }
-    ssize_t getFrameLength() const { return _frameLength; }
-private:
-    unsigned char* _payload;
-    ssize_t _payloadLength;
-
-    ssize_t _frameLength;
-    std::vector<unsigned char> _data;
-};
-//
-
-
 enum WS_MSG {
     WS_MSG_TO_SUBTRHEAD_SENDING_STRING = 0,
     WS_MSG_TO_SUBTRHEAD_SENDING_BINARY,
@@ -279,6 +379,14 @@ void WebSocket::closeAllConnections()
 WebSocket::WebSocket()
 : _readyState(State::CONNECTING)
 , _port(80)
+, _receivedBuffer(nullptr)
+, _receivedLength(0)
+, _receivedMessagesPosted(false)
+, _sendQueueHighWaterMark(WS_SEND_QUEUE_HIGH_WATER_MARK)
+, _sendQueueLowWaterMark(WS_SEND_QUEUE_LOW_WATER_MARK)
+, _sendQueueMaxBytes(0)
+, _sendQueueFull(false)
+, _sendQueueDrainPosted(false)
 , _wsHelper(nullptr)
 , _wsInstance(nullptr)
 , _wsContext(nullptr)
@@ -287,8 +395,6 @@ WebSocket::WebSocket()
 , _SSLConnection(0)
 , _wsProtocols(nullptr)
 {
-    // reserve data buffer to avoid allocate memory frequently
-    _receivedData.reserve(WS_RESERVE_RECEIVE_BUFFER_SIZE);
     if (__websocketInstances == nullptr)
     {
         __websocketInstances = new (std::nothrow) std::vector<WebSocket*>();
@@ -309,6 +415,15 @@ WebSocket::~WebSocket()
     LOGD("In the destructor of WebSocket (%p)\n", this);
     CC_SAFE_DELETE(_wsHelper);
 
+    if (_receivedBuffer != nullptr)
+    {
+        _receivedBuffer->release();
+    }
+    for (auto& message : _receivedMessages)
+    {
+        message.buffer->release();
+    }
+
     if (_wsProtocols != nullptr)
     {
         for (int i = 0; _wsProtocols[i].callback != nullptr; ++i)
@@ -421,56 +536,125 @@ bool WebSocket::init(const Delegate& delegate,
     return ret;
 }
 
-void WebSocket::send(const std::string& message)
+bool WebSocket::send(const std::string& message)
+{
+    return sendMessage(WS_MSG_TO_SUBTRHEAD_SENDING_STRING, message.c_str(), message.length());
+}
+
+bool WebSocket::send(const unsigned char* binaryMsg, unsigned int len)
+{
+    return sendMessage(WS_MSG_TO_SUBTRHEAD_SENDING_BINARY, binaryMsg, len);
+}
+
+bool WebSocket::sendMessage(unsigned int what, const void* bytes, size_t len)
 {
-    if (_readyState == State::OPEN)
+    if (getReadyState() != State::OPEN)
     {
-        // In main thread
-        Data* data = new (std::nothrow) Data();
-        data->bytes = (char*)malloc(message.length() + 1);
-        // Make sure the last byte is '\0'
-        data->bytes[message.length()] = '\0';
-        strcpy(data->bytes, message.c_str());
-        data->len = static_cast<ssize_t>(message.length());
+        LOGD("Couldn't send message since websocket wasn't opened!\n");
+        return false;
+    }
 
-        WsMessage* msg = new (std::nothrow) WsMessage();
-        msg->what = WS_MSG_TO_SUBTRHEAD_SENDING_STRING;
-        msg->obj = data;
-        _wsHelper->sendMessageToWebSocketThread(msg);
+    // In main thread, the only copy of the message, lws frames it in place
+    WsMessage msg;
+    msg.what = what;
+    msg.len = len;
+    msg.buffer = WsBuffer::create(LWS_PRE + len);
+    if (msg.buffer == nullptr)
+    {
+        LOGD("Couldn't send message since its buffer couldn't be allocated!\n");
+        return false;
     }
-    else
+    if (len > 0)
     {
-        LOGD("Couldn't send message since websocket wasn't opened!\n");
+        memcpy(msg.buffer->getBytes() + LWS_PRE, bytes, len);
     }
-}
 
-void WebSocket::send(const unsigned char* binaryMsg, unsigned int len)
-{
-    if (_readyState == State::OPEN)
+    bool full = false;
     {
-        // In main thread
-        Data* data = new (std::nothrow) Data();
-        if (len == 0)
+        std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+        size_t& queueBytes = _wsHelper->_subThreadWsMessageQueueBytes;
+        if (_sendQueueMaxBytes > 0 && queueBytes + len > _sendQueueMaxBytes)
         {
-            // If data length is zero, allocate 1 byte for safe.
-            data->bytes = (char*)malloc(1);
-            data->bytes[0] = '\0';
+            LOGD("Couldn't send message since the send queue is full, %d bytes queued!\n", (int)queueBytes);
+            msg.buffer->release();
+            return false;
         }
-        else
+
+        bool wasEmpty = _wsHelper->_subThreadWsMessageQueue.empty();
+        _wsHelper->_subThreadWsMessageQueue.push_back(msg);
+        queueBytes += len;
+
+        // Wakes websocket thread up instead of letting the message wait for the timeout of lws_service
+        if (wasEmpty && _wsContext != nullptr)
         {
-            data->bytes = (char*)malloc(len);
-            memcpy((void*)data->bytes, (void*)binaryMsg, len);
+            lws_cancel_service(_wsContext);
         }
-        data->len = len;
 
-        WsMessage* msg = new (std::nothrow) WsMessage();
-        msg->what = WS_MSG_TO_SUBTRHEAD_SENDING_BINARY;
-        msg->obj = data;
-        _wsHelper->sendMessageToWebSocketThread(msg);
+        if (_sendQueueHighWaterMark > 0 && !_sendQueueFull && queueBytes >= _sendQueueHighWaterMark)
+        {
+            _sendQueueFull = true;
+            full = true;
+        }
     }
-    else
+
+    if (full)
     {
-        LOGD("Couldn't send message since websocket wasn't opened!\n");
+        _delegate->onSendQueueFull(this);
+    }
+    return true;
+}
+
+void WebSocket::setSendQueueLimits(size_t highWaterMark, size_t lowWaterMark, size_t maxBytes)
+{
+    std::unique_lock<std::mutex> lk;
+    if (_wsHelper != nullptr)
+    {
+        lk = std::unique_lock<std::mutex>(_wsHelper->_subThreadWsMessageQueueMutex);
+    }
+    _sendQueueHighWaterMark = highWaterMark;
+    _sendQueueLowWaterMark = std::min(lowWaterMark, highWaterMark);
+    _sendQueueMaxBytes = maxBytes;
+}
+
+size_t WebSocket::getBufferedAmount()
+{
+    if (_wsHelper == nullptr)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+    return _wsHelper->_subThreadWsMessageQueueBytes;
+}
+
+void WebSocket::onSendQueueDrained()
+{
+    // In UI thread
+    {
+        std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+        _sendQueueDrainPosted = false;
+        _sendQueueFull = false;
+    }
+
+    std::shared_ptr<bool> isDestroyed = _isDestroyed;
+    _delegate->onSendQueueDrained(this);
+    if (*isDestroyed)
+    {
+        return;
+    }
+
+    // The queue may have filled up again since websocket thread found it drained
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+        if (_sendQueueHighWaterMark > 0 && !_sendQueueFull && _wsHelper->_subThreadWsMessageQueueBytes >= _sendQueueHighWaterMark)
+        {
+            _sendQueueFull = true;
+            full = true;
+        }
+    }
+    if (full)
+    {
+        _delegate->onSendQueueFull(this);
     }
 }
 
@@ -516,7 +700,7 @@ void WebSocket::onSubThreadLoop()
     {
         _readStateMutex.unlock();
         _wsHelper->_subThreadWsMessageQueueMutex.lock();
-        bool isEmpty = _wsHelper->_subThreadWsMessageQueue->empty();
+        bool isEmpty = _wsHelper->_subThreadWsMessageQueue.empty();
         _wsHelper->_subThreadWsMessageQueueMutex.unlock();
         if (!isEmpty)
         {
@@ -574,7 +758,12 @@ void WebSocket::onSubThreadStarted()
     int log_level = LLL_ERR | LLL_WARN | LLL_NOTICE/* | LLL_INFO | LLL_DEBUG | LLL_PARSER*/ | LLL_HEADER | LLL_EXT | LLL_CLIENT | LLL_LATENCY;
     lws_set_log_level(log_level, printWebSocketLog);
 
-    _wsContext = lws_create_context(&info);
+    // WebSocket::send reads it under the queue lock to wake the context up
+    struct lws_context* context = lws_create_context(&info);
+    {
+        std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+        _wsContext = context;
+    }
 
     if (nullptr != _wsContext)
     {
@@ -611,64 +800,80 @@ void WebSocket::onSubThreadStarted()
 
 void WebSocket::onSubThreadEnded()
 {
-    if (_wsContext != nullptr)
+    // WebSocket::send wakes the context up, it mustn't see it while it's destroyed
+    struct lws_context* context = nullptr;
     {
-        lws_context_destroy(_wsContext);
+        std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+        std::swap(context, _wsContext);
     }
-}
 
-void WebSocket::onClientWritable()
-{
-    std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
-
-    if (_wsHelper->_subThreadWsMessageQueue->empty())
+    if (context != nullptr)
     {
-        return;
+        lws_context_destroy(context);
     }
+}
 
-    std::list<WsMessage*>::iterator iter = _wsHelper->_subThreadWsMessageQueue->begin();
-
-    ssize_t bytesWrite = 0;
-    if (iter != _wsHelper->_subThreadWsMessageQueue->end())
+void WebSocket::onClientWritable()
+{
+    // Pops the front message once it was sent or dropped
+    auto popMessage = [this]()
     {
-        WsMessage* subThreadMsg = *iter;
-        Data* data = (Data*)subThreadMsg->obj;
-
-        const size_t c_bufferSize = WS_RX_BUFFER_SIZE;
-
-        const size_t remaining = data->len - data->issued;
-        const size_t n = MIN(remaining, c_bufferSize );
+        WsBuffer* buffer = nullptr;
+        bool drained = false;
+        {
+            std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+            WsMessage& front = _wsHelper->_subThreadWsMessageQueue.front();
+            buffer = front.buffer;
+            _wsHelper->_subThreadWsMessageQueueBytes -= front.len;
+            _wsHelper->_subThreadWsMessageQueue.pop_front();
 
-        WebSocketFrame* frame = nullptr;
+            if (_sendQueueFull && !_sendQueueDrainPosted && _wsHelper->_subThreadWsMessageQueueBytes <= _sendQueueLowWaterMark)
+            {
+                _sendQueueDrainPosted = true;
+                drained = true;
+            }
+        }
+        buffer->release();
 
-        if (data->ext)
+        if (drained)
         {
-            frame = (WebSocketFrame*)data->ext;
+            std::shared_ptr<bool> isDestroyed = _isDestroyed;
+            _wsHelper->sendMessageToCocosThread([this, isDestroyed](){
+                if (*isDestroyed)
+                {
+                    LOGD("WebSocket instance was destroyed!\n");
+                }
+                else
+                {
+                    onSendQueueDrained();
+                }
+            });
         }
-        else
+    };
+
+    // Writes frames until the socket would block, the rest waits for the next writable callback.
+    // Only this thread pops the queue, so the front message stays valid while Cocos thread pushes.
+    size_t bytesWritten = 0;
+    while (bytesWritten < WS_WRITE_SIZE_PER_CALLBACK && !lws_send_pipe_choked(_wsInstance))
+    {
+        WsMessage* subThreadMsg = nullptr;
         {
-            frame = new (std::nothrow) WebSocketFrame();
-            bool success = frame && frame->init((unsigned char*)(data->bytes + data->issued), n);
-            if (success)
+            std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+            if (_wsHelper->_subThreadWsMessageQueue.empty())
             {
-                data->ext = frame;
-            }
-            else
-            { // If frame initialization failed, delete the frame and drop the sending data
-              // These codes should never be called.
-                LOGD("WebSocketFrame initialization failed, drop the sending data, msg(%d)\n", (int)subThreadMsg->id);
-                delete frame;
-                CC_SAFE_FREE(data->bytes);
-                CC_SAFE_DELETE(data);
-                _wsHelper->_subThreadWsMessageQueue->erase(iter);
-                CC_SAFE_DELETE(subThreadMsg);
                 return;
             }
+            subThreadMsg = &_wsHelper->_subThreadWsMessageQueue.front();
         }
 
+        const size_t c_bufferSize = WS_RX_BUFFER_SIZE;
+
+        const size_t remaining = subThreadMsg->len - subThreadMsg->issued;
+        const size_t n = MIN(remaining, c_bufferSize);
+
         int writeProtocol;
 
-        if (data->issued == 0)
+        if (subThreadMsg->issued == 0)
         {
             if (WS_MSG_TO_SUBTRHEAD_SENDING_STRING == subThreadMsg->what)
             {
@@ -680,7 +885,7 @@ void WebSocket::onClientWritable()
             }
 
             // If we have more than 1 fragment
-            if (data->len > c_bufferSize)
+            if (subThreadMsg->len > c_bufferSize)
                 writeProtocol |= LWS_WRITE_NO_FIN;
         } else {
             // we are in the middle of fragments
@@ -690,7 +895,11 @@ void WebSocket::onClientWritable()
                 writeProtocol |= LWS_WRITE_NO_FIN;
         }
 
-        bytesWrite = lws_write(_wsInstance, frame->getPayload(), frame->getPayloadLength(), (lws_write_protocol)writeProtocol);
+        // The header goes in the LWS_PRE bytes before the payload, over bytes already sent
+        unsigned char* payload = subThreadMsg->buffer->getBytes() + LWS_PRE + subThreadMsg->issued + subThreadMsg->frameIssued;
+        const size_t payloadLength = n - subThreadMsg->frameIssued;
+
+        ssize_t bytesWrite = lws_write(_wsInstance, payload, payloadLength, (lws_write_protocol)writeProtocol);
 
         // Handle the result of lws_write
         // Buffer overrun?
@@ -698,68 +907,68 @@ void WebSocket::onClientWritable()
         {
             LOGD("ERROR: msg(%u), lws_write return: %d, but it should be %d, drop this message.\n", subThreadMsg->id, (int)bytesWrite, (int)n);
             // socket error, we need to close the socket connection
-            CC_SAFE_FREE(data->bytes);
-            delete ((WebSocketFrame*)data->ext);
-            data->ext = nullptr;
-            CC_SAFE_DELETE(data);
-            _wsHelper->_subThreadWsMessageQueue->erase(iter);
-            CC_SAFE_DELETE(subThreadMsg);
-
+            popMessage();
             closeAsync();
+            return;
         }
-        else if (bytesWrite < frame->getPayloadLength())
+        else if ((size_t)bytesWrite < payloadLength)
         {
-            frame->update(bytesWrite);
-            LOGD("frame wasn't sent completely, bytesWrite: %d, remain: %d\n", (int)bytesWrite, (int)frame->getPayloadLength());
+            subThreadMsg->frameIssued += bytesWrite;
+            LOGD("frame wasn't sent completely, bytesWrite: %d, remain: %d\n", (int)bytesWrite, (int)(payloadLength - bytesWrite));
         }
         // Do we have another fragments to send?
-        else if (remaining > frame->getFrameLength() && bytesWrite == frame->getPayloadLength())
+        else if (remaining > n)
         {
-            // A frame was totally sent, plus data->issued to send next frame
-            LOGD("msg(%u) append: %d + %d = %d\n", subThreadMsg->id, (int)data->issued, (int)frame->getFrameLength(), (int)(data->issued + frame->getFrameLength()));
-            data->issued += frame->getFrameLength();
-            delete ((WebSocketFrame*)data->ext);
-            data->ext = nullptr;
+            // A frame was totally sent, plus issued to send next frame
+            LOGD("msg(%u) append: %d + %d = %d\n", subThreadMsg->id, (int)subThreadMsg->issued, (int)n, (int)(subThreadMsg->issued + n));
+            subThreadMsg->issued += n;
+            subThreadMsg->frameIssued = 0;
         }
         // Safely done!
         else
         {
-            LOGD("Safely done, msg(%d)!\n", subThreadMsg->id);
-            if (remaining == frame->getFrameLength())
-            {
-                LOGD("msg(%u) append: %d + %d = %d\n", subThreadMsg->id, (int)data->issued, (int)frame->getFrameLength(), (int)(data->issued + frame->getFrameLength()));
-                LOGD("msg(%u) was totally sent!\n", subThreadMsg->id);
-            }
-            else
-            {
-                LOGD("ERROR: msg(%u), remaining(%d) < bytesWrite(%d)\n", subThreadMsg->id, (int)remaining, (int)frame->getFrameLength());
-                LOGD("Drop the msg(%u)\n", subThreadMsg->id);
-                closeAsync();
-            }
-
-            CC_SAFE_FREE(data->bytes);
-            delete ((WebSocketFrame*)data->ext);
-            data->ext = nullptr;
-            CC_SAFE_DELETE(data);
-            _wsHelper->_subThreadWsMessageQueue->erase(iter);
-            CC_SAFE_DELETE(subThreadMsg);
-
-            LOGD("-----------------------------------------------------------\n");
+            LOGD("msg(%u) was totally sent!\n", subThreadMsg->id);
+            popMessage();
         }
+
+        bytesWritten += bytesWrite;
     }
 }
 
-void WebSocket::onClientReceivedData(void* in, ssize_t len)
+bool WebSocket::onClientReceivedData(void* in, ssize_t len)
 {
     // In websocket thread
     static int packageIndex = 0;
     packageIndex++;
-    if (in != nullptr && len > 0)
+
+    // The rest of the frame is only what the server announces, so up to WS_RX_BUFFER_SIZE of it
+    // is reserved ahead and the buffer doubles as the bytes arrive past that.
+    // The extra byte is for the '\0' of a text message.
+    size_t remainingSize = lws_remaining_packet_payload(_wsInstance);
+    size_t receivedSize = (in != nullptr && len > 0) ? len : 0;
+    size_t capacity = _receivedLength + receivedSize + std::min(remainingSize, (size_t)WS_RX_BUFFER_SIZE) + 1;
+    if (_receivedBuffer == nullptr)
+    {
+        _receivedBuffer = WsBuffer::create(capacity);
+    }
+    else
+    {
+        _receivedBuffer = _receivedBuffer->grow(_receivedLength, capacity);
+    }
+
+    if (_receivedBuffer == nullptr)
+    {
+        LOGD("Couldn't receive a message of more than %d bytes, closing the connection!\n", (int)capacity);
+        _receivedLength = 0;
+        return false;
+    }
+
+    if (receivedSize > 0)
     {
         LOGD("Receiving data:index:%d, len=%d\n", packageIndex, (int)len);
 
-        unsigned char* inData = (unsigned char*)in;
-        _receivedData.insert(_receivedData.end(), inData, inData + len);
+        memcpy(_receivedBuffer->getBytes() + _receivedLength, in, receivedSize);
+        _receivedLength += receivedSize;
     }
     else
     {
@@ -767,47 +976,86 @@ void WebSocket::onClientReceivedData(void* in, ssize_t len)
     }
 
     // If no more data pending, send it to the client thread
-    size_t remainingSize = lws_remaining_packet_payload(_wsInstance);
     int isFinalFragment = lws_is_final_fragment(_wsInstance);
 //    LOGD("remainingSize: %d, isFinalFragment: %d\n", (int)remainingSize, isFinalFragment);
 
     if (remainingSize == 0 && isFinalFragment)
     {
-        std::vector<char>* frameData = new (std::nothrow) std::vector<char>(std::move(_receivedData));
+        ReceivedMessage message;
+        message.buffer = _receivedBuffer;
+        message.len = _receivedLength;
+        message.isBinary = lws_frame_is_binary(_wsInstance);
 
-        // reset capacity of received data buffer
-        _receivedData.reserve(WS_RESERVE_RECEIVE_BUFFER_SIZE);
+        if (!message.isBinary)
+        {
+            message.buffer->getBytes()[message.len] = '\0';
+        }
 
-        ssize_t frameSize = frameData->size();
+        _receivedBuffer = nullptr;
+        _receivedLength = 0;
 
-        bool isBinary = lws_frame_is_binary(_wsInstance);
+        // The messages of a frame are delivered together, the first one posts the delivery
+        bool post = false;
+        {
+            std::lock_guard<std::mutex> lk(_receivedMessagesMutex);
+            _receivedMessages.push_back(message);
+            post = !_receivedMessagesPosted;
+            _receivedMessagesPosted = true;
+        }
 
-        if (!isBinary)
+        if (post)
         {
-            frameData->push_back('\0');
+            std::shared_ptr<bool> isDestroyed = _isDestroyed;
+            _wsHelper->sendMessageToCocosThread([this, isDestroyed](){
+                if (*isDestroyed)
+                {
+                    LOGD("WebSocket instance was destroyed!\n");
+                }
+                else
+                {
+                    onMessagesReceived();
+                }
+            });
         }
+    }
+    return true;
+}
 
-        std::shared_ptr<bool> isDestroyed = _isDestroyed;
-        _wsHelper->sendMessageToCocosThread([this, frameData, frameSize, isBinary, isDestroyed](){
-            // In UI thread
-            LOGD("Notify data len %d to Cocos thread.\n", (int)frameSize);
+void WebSocket::onMessagesReceived()
+{
+    // In UI thread
+    std::vector<ReceivedMessage> messages;
+    {
+        std::lock_guard<std::mutex> lk(_receivedMessagesMutex);
+        messages.swap(_receivedMessages);
+        _receivedMessagesPosted = false;
+    }
 
-            Data data;
-            data.isBinary = isBinary;
-            data.bytes = (char*)frameData->data();
-            data.len = frameSize;
+    LOGD("Notify %d messages to Cocos thread.\n", (int)messages.size());
 
-            if (*isDestroyed)
-            {
-                LOGD("WebSocket instance was destroyed!\n");
-            }
-            else
-            {
-                _delegate->onMessage(this, data);
-            }
+    std::shared_ptr<bool> isDestroyed = _isDestroyed;
+    for (auto& message : messages)
+    {
+        if (!*isDestroyed)
+        {
+            Data data;
+            data.isBinary = message.isBinary;
+            data.bytes = (char*)message.buffer->getBytes();
+            data.len = message.len;
+            _delegate->onMessage(this, data);
+        }
+        message.buffer->release();
+    }
 
-            delete frameData;
-        });
+    // Gives the vector back so that its capacity is reused
+    if (!*isDestroyed)
+    {
+        messages.clear();
+        std::lock_guard<std::mutex> lk(_receivedMessagesMutex);
+        if (_receivedMessages.empty())
+        {
+            _receivedMessages.swap(messages);
+        }
     }
 }
 
@@ -909,7 +1157,11 @@ int WebSocket::onSocketCallback(struct lws *wsi,
             break;
 
         case LWS_CALLBACK_CLIENT_RECEIVE:
-            onClientReceivedData(in, len);
+            if (!onClientReceivedData(in, len))
+            {
+                // lws closes the connection, the message can't be held
+                return -1;
+            }
             break;
 
         case LWS_CALLBACK_CLIENT_WRITEABLE:
@@ -26,6 +26,7 @@ class EventListenerCustom;
 namespace network {
 
 class WsThreadHelper;
+class WsBuffer;
 
 /**
  * WebSocket is wrapper of the libwebsockets-protocol, let the develop could call the websocket easily.
@@ -130,6 +131,20 @@ public:
          * @param error WebSocket::ErrorCode enum,would be ErrorCode::TIME_OUT or ErrorCode::CONNECTION_FAILURE.
          */
         virtual void onError(WebSocket* ws, const ErrorCode& error) = 0;
+        /**
+         * This function is to be called when the bytes waiting to be sent reach the high water mark,
+         * see setSendQueueLimits. It's a good time to stop sending until onSendQueueDrained.
+         *
+         * @param ws The WebSocket object connected.
+         */
+        virtual void onSendQueueFull(WebSocket* ws) {}
+        /**
+         * This function is to be called after onSendQueueFull, when the bytes waiting to be sent
+         * fell back to the low water mark.
+         *
+         * @param ws The WebSocket object connected.
+         */
+        virtual void onSendQueueDrained(WebSocket* ws) {}
     };
 
 
@@ -149,18 +164,34 @@ public:
      *  @brief Sends string data to websocket server.
      *  
      *  @param message string data.
+     *  @return false when the websocket isn't open or the send queue is full, the message is dropped.
      *  @lua sendstring
      */
-    void send(const std::string& message);
+    bool send(const std::string& message);
 
     /**
      *  @brief Sends binary data to websocket server.
      *  
      *  @param binaryMsg binary string data.
      *  @param len the size of binary string data.
+     *  @return false when the websocket isn't open or the send queue is full, the message is dropped.
      *  @lua sendstring
      */
-    void send(const unsigned char* binaryMsg, unsigned int len);
+    bool send(const unsigned char* binaryMsg, unsigned int len);
+
+    /**
+     *  @brief Limits the bytes sent and not yet written to the socket.
+     *  @param highWaterMark Delegate::onSendQueueFull is called when the queue reaches it, 0 to never call it.
+     *                       1 MB by default.
+     *  @param lowWaterMark  Delegate::onSendQueueDrained is called when it fell back to it, 256 KB by default.
+     *  @param maxBytes      A message that would queue more is dropped, 0 for no limit, the default.
+     */
+    void setSendQueueLimits(size_t highWaterMark, size_t lowWaterMark, size_t maxBytes);
+
+    /**
+     *  @brief Gets the bytes sent and not yet written to the socket.
+     */
+    size_t getBufferedAmount();
 
     /**
      *  @brief Closes the connection to server synchronously.
@@ -183,6 +214,10 @@ public:
     State getReadyState();
 
 private:
+    bool sendMessage(unsigned int what, const void* bytes, size_t len);
+    void onSendQueueDrained();
+    void onMessagesReceived();
+
     void onSubThreadStarted();
     void onSubThreadLoop();
     void onSubThreadEnded();
@@ -191,7 +226,7 @@ private:
     int onSocketCallback(struct lws *wsi, int reason, void *user, void *in, ssize_t len);
 
     void onClientWritable();
-    void onClientReceivedData(void* in, ssize_t len);
+    bool onClientReceivedData(void* in, ssize_t len);
     void onConnectionOpened();
     void onConnectionError();
     void onConnectionClosed();
@@ -203,7 +238,28 @@ private:
     unsigned int _port;
     std::string  _path;
 
-    std::vector<char> _receivedData;
+    struct ReceivedMessage
+    {
+        WsBuffer* buffer;
+        size_t len;
+        bool isBinary;
+    };
+
+    // The message being received, in a buffer of the pool of WebSocket.cpp
+    WsBuffer*    _receivedBuffer;
+    size_t       _receivedLength;
+
+    // The messages received and not yet delivered, they are delivered together once per frame
+    std::mutex   _receivedMessagesMutex;
+    std::vector<ReceivedMessage> _receivedMessages;
+    bool         _receivedMessagesPosted;
+
+    // Guarded by the message queue mutex of _wsHelper
+    size_t       _sendQueueHighWaterMark;
+    size_t       _sendQueueLowWaterMark;
+    size_t       _sendQueueMaxBytes;
+    bool         _sendQueueFull;
+    bool         _sendQueueDrainPosted;
 
     friend class WsThreadHelper;
     friend class WebSocketCallbackWrapper;
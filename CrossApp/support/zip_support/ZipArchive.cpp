@@ -0,0 +1,445 @@
+
+#include <zlib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ZipArchive.h"
+#include "ccMacros.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+NS_CC_BEGIN
+
+// zip records, all little endian
+#define ZIP_LOCAL_HEADER_SIGNATURE          0x04034b50
+#define ZIP_CENTRAL_HEADER_SIGNATURE        0x02014b50
+#define ZIP_END_OF_CENTRAL_DIR_SIGNATURE    0x06054b50
+#define ZIP64_END_OF_CENTRAL_DIR_SIGNATURE  0x06064b50
+#define ZIP64_LOCATOR_SIGNATURE             0x07064b50
+#define ZIP64_EXTRA_FIELD_ID                0x0001
+
+#define ZIP_LOCAL_HEADER_SIZE               30
+#define ZIP_CENTRAL_HEADER_SIZE             46
+#define ZIP_END_OF_CENTRAL_DIR_SIZE         22
+#define ZIP64_LOCATOR_SIZE                  20
+#define ZIP64_END_OF_CENTRAL_DIR_SIZE       56
+
+#define ZIP_METHOD_STORED                   0
+#define ZIP_METHOD_DEFLATED                 8
+#define ZIP_FLAG_ENCRYPTED                  0x0001
+
+static inline unsigned short readUInt16(const unsigned char* p)
+{
+    return (unsigned short)(p[0] | (p[1] << 8));
+}
+
+static inline unsigned int readUInt32(const unsigned char* p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static inline unsigned long long readUInt64(const unsigned char* p)
+{
+    return (unsigned long long)readUInt32(p) | ((unsigned long long)readUInt32(p + 4) << 32);
+}
+
+ZipArchive::ZipArchive()
+: _data(NULL)
+, _size(0)
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+, _fileHandle(INVALID_HANDLE_VALUE)
+, _mappingHandle(NULL)
+#endif
+{
+    pthread_mutex_init(&_streamsMutex, NULL);
+}
+
+ZipArchive::~ZipArchive()
+{
+    close();
+
+    for (size_t i = 0; i < _streams.size(); ++i)
+    {
+        z_stream* stream = (z_stream*)_streams[i];
+        inflateEnd(stream);
+        delete stream;
+    }
+    _streams.clear();
+
+    pthread_mutex_destroy(&_streamsMutex);
+}
+
+bool ZipArchive::open(const std::string &zipFile, const std::string &filter)
+{
+    close();
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    int length = MultiByteToWideChar(CP_UTF8, 0, zipFile.c_str(), -1, NULL, 0);
+    std::wstring widePath(length > 0 ? length : 0, L'\0');
+    if (length > 0)
+    {
+        MultiByteToWideChar(CP_UTF8, 0, zipFile.c_str(), -1, &widePath[0], length);
+    }
+
+    HANDLE fileHandle = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    CC_RETURN_IF(fileHandle == INVALID_HANDLE_VALUE) false;
+
+    LARGE_INTEGER fileSize;
+    HANDLE mappingHandle = NULL;
+    if (GetFileSizeEx(fileHandle, &fileSize) && fileSize.QuadPart > 0)
+    {
+        mappingHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    if (mappingHandle == NULL)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    void* mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (mapping == NULL)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    _fileHandle = fileHandle;
+    _mappingHandle = mappingHandle;
+    _size = (unsigned long long)fileSize.QuadPart;
+#else
+    int fd = ::open(zipFile.c_str(), O_RDONLY);
+    CC_RETURN_IF(fd < 0) false;
+
+    struct stat st;
+    // 32-bit processes can't map an archive larger than their address space
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (unsigned long long)st.st_size > (size_t)-1)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // the mapping keeps the file alive, the descriptor is not needed any more
+    void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    CC_RETURN_IF(mapping == MAP_FAILED) false;
+
+    _size = (unsigned long long)st.st_size;
+#endif
+
+    _data = (const unsigned char*)mapping;
+    _path = zipFile;
+
+    if (!readCentralDirectory(filter))
+    {
+        CCLOG("CrossApp: ZipArchive: %s is not a zip archive", zipFile.c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ZipArchive::close()
+{
+    if (_data)
+    {
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+        UnmapViewOfFile(_data);
+        CloseHandle((HANDLE)_mappingHandle);
+        CloseHandle((HANDLE)_fileHandle);
+        _mappingHandle = NULL;
+        _fileHandle = INVALID_HANDLE_VALUE;
+#else
+        munmap((void*)_data, (size_t)_size);
+#endif
+    }
+    _data = NULL;
+    _size = 0;
+    _path.clear();
+    _entries.clear();
+    _directories.clear();
+}
+
+bool ZipArchive::readCentralDirectory(const std::string &filter)
+{
+    CC_RETURN_IF(_size < ZIP_END_OF_CENTRAL_DIR_SIZE) false;
+
+    // the end record sits behind an archive comment of at most 64k
+    unsigned long long minOffset = _size > ZIP_END_OF_CENTRAL_DIR_SIZE + 0xFFFF ? _size - ZIP_END_OF_CENTRAL_DIR_SIZE - 0xFFFF : 0;
+    unsigned long long eocd = _size - ZIP_END_OF_CENTRAL_DIR_SIZE;
+    while (readUInt32(_data + eocd) != ZIP_END_OF_CENTRAL_DIR_SIGNATURE)
+    {
+        CC_RETURN_IF(eocd == minOffset) false;
+        --eocd;
+    }
+
+    unsigned long long count = readUInt16(_data + eocd + 10);
+    unsigned long long directorySize = readUInt32(_data + eocd + 12);
+    unsigned long long directoryOffset = readUInt32(_data + eocd + 16);
+
+    // OBBs over 4GB or with more than 65535 files keep the real values in the zip64 record
+    if (eocd >= ZIP64_LOCATOR_SIZE && readUInt32(_data + eocd - ZIP64_LOCATOR_SIZE) == ZIP64_LOCATOR_SIGNATURE)
+    {
+        unsigned long long zip64 = readUInt64(_data + eocd - ZIP64_LOCATOR_SIZE + 8);
+        if (zip64 + ZIP64_END_OF_CENTRAL_DIR_SIZE <= _size && readUInt32(_data + zip64) == ZIP64_END_OF_CENTRAL_DIR_SIGNATURE)
+        {
+            count = readUInt64(_data + zip64 + 32);
+            directorySize = readUInt64(_data + zip64 + 40);
+            directoryOffset = readUInt64(_data + zip64 + 48);
+        }
+    }
+
+    CC_RETURN_IF(directoryOffset > _size || directorySize > _size - directoryOffset) false;
+
+    _entries.reserve((size_t)count);
+
+    const unsigned char* p = _data + directoryOffset;
+    const unsigned char* end = p + directorySize;
+    for (unsigned long long i = 0; i < count; ++i)
+    {
+        CC_RETURN_IF(end - p < ZIP_CENTRAL_HEADER_SIZE || readUInt32(p) != ZIP_CENTRAL_HEADER_SIGNATURE) false;
+
+        unsigned short flags = readUInt16(p + 8);
+        unsigned short nameLength = readUInt16(p + 28);
+        unsigned short extraLength = readUInt16(p + 30);
+        unsigned short commentLength = readUInt16(p + 32);
+        CC_RETURN_IF(end - p < ZIP_CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength) false;
+
+        Entry entry;
+        entry.method = readUInt16(p + 10);
+        entry.compressedSize = readUInt32(p + 20);
+        entry.uncompressedSize = readUInt32(p + 24);
+        entry.localHeaderOffset = readUInt32(p + 42);
+
+        // zip64 extra field, only the values saturated in the header are present, in this order
+        const unsigned char* extra = p + ZIP_CENTRAL_HEADER_SIZE + nameLength;
+        const unsigned char* extraEnd = extra + extraLength;
+        while (extraEnd - extra >= 4)
+        {
+            unsigned short id = readUInt16(extra);
+            unsigned short size = readUInt16(extra + 2);
+            CC_BREAK_IF(extraEnd - extra - 4 < size);
+            if (id == ZIP64_EXTRA_FIELD_ID)
+            {
+                const unsigned char* field = extra + 4;
+                const unsigned char* fieldEnd = field + size;
+                if (entry.uncompressedSize == 0xFFFFFFFF && fieldEnd - field >= 8)
+                {
+                    entry.uncompressedSize = readUInt64(field);
+                    field += 8;
+                }
+                if (entry.compressedSize == 0xFFFFFFFF && fieldEnd - field >= 8)
+                {
+                    entry.compressedSize = readUInt64(field);
+                    field += 8;
+                }
+                if (entry.localHeaderOffset == 0xFFFFFFFF && fieldEnd - field >= 8)
+                {
+                    entry.localHeaderOffset = readUInt64(field);
+                }
+                break;
+            }
+            extra += 4 + size;
+        }
+
+        std::string name((const char*)p + ZIP_CENTRAL_HEADER_SIZE, nameLength);
+        p += ZIP_CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+
+        // cache info about filtered files only (like 'assets/')
+        CC_CONTINUE_IF(!filter.empty() && name.compare(0, filter.length(), filter) != 0);
+        CC_CONTINUE_IF(name.empty() || name[name.length() - 1] == '/');
+
+        if ((flags & ZIP_FLAG_ENCRYPTED) || (entry.method != ZIP_METHOD_STORED && entry.method != ZIP_METHOD_DEFLATED))
+        {
+            CCLOG("CrossApp: ZipArchive: %s in %s is encrypted or uses an unsupported method", name.c_str(), _path.c_str());
+            continue;
+        }
+
+        for (size_t slash = name.find('/'); slash != std::string::npos; slash = name.find('/', slash + 1))
+        {
+            _directories.insert(name.substr(0, slash));
+        }
+        _entries[name] = entry;
+    }
+    return true;
+}
+
+const ZipArchive::Entry* ZipArchive::findEntry(const std::string &fileName) const
+{
+    std::unordered_map<std::string, Entry>::const_iterator it = _entries.find(fileName);
+    return it != _entries.end() ? &it->second : NULL;
+}
+
+const unsigned char* ZipArchive::getEntryData(const Entry &entry) const
+{
+    // the local header repeats the name, its extra field may differ from the central one
+    CC_RETURN_IF(entry.localHeaderOffset > _size || _size - entry.localHeaderOffset < ZIP_LOCAL_HEADER_SIZE) NULL;
+
+    const unsigned char* header = _data + entry.localHeaderOffset;
+    CC_RETURN_IF(readUInt32(header) != ZIP_LOCAL_HEADER_SIGNATURE) NULL;
+
+    unsigned long long offset = entry.localHeaderOffset + ZIP_LOCAL_HEADER_SIZE + readUInt16(header + 26) + readUInt16(header + 28);
+    CC_RETURN_IF(offset > _size || _size - offset < entry.compressedSize) NULL;
+
+    return _data + offset;
+}
+
+bool ZipArchive::fileExists(const std::string &fileName) const
+{
+    return findEntry(fileName) != NULL;
+}
+
+bool ZipArchive::directoryExists(const std::string &dirName) const
+{
+    std::string name = dirName;
+    while (!name.empty() && name[name.length() - 1] == '/')
+    {
+        name.erase(name.length() - 1);
+    }
+    return _directories.find(name) != _directories.end();
+}
+
+long ZipArchive::getFileSize(const std::string &fileName) const
+{
+    const Entry* entry = findEntry(fileName);
+    return entry ? (long)entry->uncompressedSize : -1;
+}
+
+const unsigned char* ZipArchive::getFileView(const std::string &fileName, unsigned long *pSize) const
+{
+    if (pSize)
+    {
+        *pSize = 0;
+    }
+
+    const Entry* entry = findEntry(fileName);
+    CC_RETURN_IF(entry == NULL || entry->method != ZIP_METHOD_STORED) NULL;
+
+    const unsigned char* data = getEntryData(*entry);
+    if (data && pSize)
+    {
+        *pSize = (unsigned long)entry->uncompressedSize;
+    }
+    return data;
+}
+
+bool ZipArchive::readFile(const std::string &fileName, unsigned char *buffer, unsigned long size)
+{
+    const Entry* entry = findEntry(fileName);
+    CC_RETURN_IF(entry == NULL || entry->uncompressedSize != size) false;
+
+    const unsigned char* source = getEntryData(*entry);
+    CC_RETURN_IF(source == NULL) false;
+
+    if (entry->method == ZIP_METHOD_STORED)
+    {
+        CC_RETURN_IF(entry->compressedSize != entry->uncompressedSize) false;
+        memcpy(buffer, source, size);
+        return true;
+    }
+    return inflateEntry(*entry, source, buffer);
+}
+
+unsigned char* ZipArchive::getFileData(const std::string &fileName, unsigned long *pSize)
+{
+    if (pSize)
+    {
+        *pSize = 0;
+    }
+
+    long size = getFileSize(fileName);
+    CC_RETURN_IF(size < 0) NULL;
+
+    unsigned char* buffer = new unsigned char[size > 0 ? size : 1];
+    if (!readFile(fileName, buffer, (unsigned long)size))
+    {
+        delete[] buffer;
+        return NULL;
+    }
+
+    if (pSize)
+    {
+        *pSize = (unsigned long)size;
+    }
+    return buffer;
+}
+
+bool ZipArchive::inflateEntry(const Entry &entry, const unsigned char *source, unsigned char *buffer)
+{
+    // inflateInit allocates the 32k window, reset streams are handed from one read to the next
+    z_stream* stream = NULL;
+    pthread_mutex_lock(&_streamsMutex);
+    if (!_streams.empty())
+    {
+        stream = (z_stream*)_streams.back();
+        _streams.pop_back();
+    }
+    pthread_mutex_unlock(&_streamsMutex);
+
+    if (stream == NULL)
+    {
+        stream = new z_stream;
+        memset(stream, 0, sizeof(z_stream));
+        // negative window bits: raw deflate data without a zlib header
+        if (inflateInit2(stream, -MAX_WBITS) != Z_OK)
+        {
+            delete stream;
+            return false;
+        }
+    }
+    else
+    {
+        inflateReset(stream);
+    }
+
+    unsigned long long remainingIn = entry.compressedSize;
+    unsigned long long remainingOut = entry.uncompressedSize;
+    stream->next_in = (Bytef*)source;
+    stream->next_out = buffer;
+    stream->avail_in = 0;
+    stream->avail_out = 0;
+
+    int err = Z_OK;
+    for (;;)
+    {
+        // avail_in and avail_out are 32 bits, entries over 4GB are fed in slices
+        if (stream->avail_in == 0 && remainingIn > 0)
+        {
+            stream->avail_in = (uInt)(remainingIn > 0x40000000 ? 0x40000000 : remainingIn);
+            remainingIn -= stream->avail_in;
+        }
+        if (stream->avail_out == 0 && remainingOut > 0)
+        {
+            stream->avail_out = (uInt)(remainingOut > 0x40000000 ? 0x40000000 : remainingOut);
+            remainingOut -= stream->avail_out;
+        }
+
+        err = inflate(stream, Z_NO_FLUSH);
+        CC_BREAK_IF(err == Z_STREAM_END);
+        CC_BREAK_IF(err != Z_OK && err != Z_BUF_ERROR);
+
+        // truncated data, or more data than the directory promised
+        CC_BREAK_IF(stream->avail_in == 0 && remainingIn == 0);
+        CC_BREAK_IF(stream->avail_out == 0 && remainingOut == 0);
+    }
+    bool ret = (err == Z_STREAM_END) && stream->avail_out == 0 && remainingOut == 0;
+
+    pthread_mutex_lock(&_streamsMutex);
+    _streams.push_back(stream);
+    pthread_mutex_unlock(&_streamsMutex);
+
+    if (!ret)
+    {
+        CCLOG("CrossApp: ZipArchive: failed to inflate a file of %s", _path.c_str());
+    }
+    return ret;
+}
+
+NS_CC_END
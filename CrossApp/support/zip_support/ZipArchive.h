@@ -0,0 +1,105 @@
+#ifndef __SUPPORT_ZIPARCHIVE_H__
+#define __SUPPORT_ZIPARCHIVE_H__
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <pthread.h>
+#include "CCPlatformDefine.h"
+#include "platform/CCPlatformConfig.h"
+
+namespace CrossApp
+{
+    /**
+    * Zip archive - memory mapped reader.
+    *
+    * The archive is mapped once and its central directory is parsed into a hash index,
+    * so looking a file up costs one hash lookup instead of a walk of the central directory.
+    * Stored (uncompressed) entries can be read in place through getFileView, deflated
+    * ones are inflated with z_streams that are reused between reads.
+    *
+    * Every const method and readFile / getFileData may be called from any thread.
+    * The file must not be modified while it is open.
+    */
+    class CC_DLL ZipArchive
+    {
+    public:
+        ZipArchive();
+        virtual ~ZipArchive();
+
+        /**
+        * Maps the archive and indexes its files.
+        *
+        * @param zipFile Zip file name, an absolute path
+        * @param filter The first part of file names, which should be accessible.
+        *               For example, "assets/". Other files will be missed.
+        * @return false when the file can't be mapped or is not a zip archive
+        */
+        bool open(const std::string &zipFile, const std::string &filter = std::string());
+
+        void close();
+
+        bool isOpen() const { return _data != NULL; }
+
+        const std::string& getPath() const { return _path; }
+
+        size_t getFileCount() const { return _entries.size(); }
+
+        bool fileExists(const std::string &fileName) const;
+
+        /** whether any indexed file name starts with dirName + "/" */
+        bool directoryExists(const std::string &dirName) const;
+
+        /** the uncompressed size, -1 when the file is not in the archive */
+        long getFileSize(const std::string &fileName) const;
+
+        /**
+        * The bytes of a stored entry inside the mapping, nothing is copied.
+        * Valid until the archive is closed.
+        *
+        * @return NULL when the file is missing or compressed, read it with getFileData then
+        */
+        const unsigned char* getFileView(const std::string &fileName, unsigned long *pSize) const;
+
+        /** uncompresses the file into buffer, which must hold getFileSize(fileName) bytes */
+        bool readFile(const std::string &fileName, unsigned char *buffer, unsigned long size);
+
+        /**
+        * Get resource file data from the archive.
+        * @warning Recall: you are responsible for calling delete[] on any Non-NULL pointer returned.
+        */
+        unsigned char* getFileData(const std::string &fileName, unsigned long *pSize);
+
+    private:
+        struct Entry
+        {
+            unsigned long long localHeaderOffset;
+            unsigned long long compressedSize;
+            unsigned long long uncompressedSize;
+            unsigned short method;
+        };
+
+        const Entry* findEntry(const std::string &fileName) const;
+        const unsigned char* getEntryData(const Entry &entry) const;
+        bool readCentralDirectory(const std::string &filter);
+        bool inflateEntry(const Entry &entry, const unsigned char *source, unsigned char *buffer);
+
+        std::string _path;
+
+        const unsigned char* _data;
+        unsigned long long _size;
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+        void* _fileHandle;
+        void* _mappingHandle;
+#endif
+
+        std::unordered_map<std::string, Entry> _entries;
+        std::unordered_set<std::string> _directories;
+
+        /** z_streams of finished reads, handed to the next one */
+        std::vector<void*> _streams;
+        pthread_mutex_t _streamsMutex;
+    };
+} // end of namespace CrossApp
+#endif // __SUPPORT_ZIPARCHIVE_H__
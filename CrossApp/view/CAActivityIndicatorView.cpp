@@ -130,24 +130,24 @@ void CAActivityIndicatorView::setStyle(CAActivityIndicatorViewStyle style)
         {
             case CAActivityIndicatorViewStyleGray:
             {
-                image = CAImage::create(map.at("image_gray"));
+                image = map.getImage("image_gray");
                 center.size = DSize(40, 40);
             }
                 break;
             case CAActivityIndicatorViewStyleWhite:
             {
-                image = CAImage::create(map.at("image_white"));
+                image = map.getImage("image_white");
                 center.size = DSize(40, 40);
             }                break;
             case CAActivityIndicatorViewStyleGrayLarge:
             {
-                image = CAImage::create(map.at("image_gray"));
+                image = map.getImage("image_gray");
                 center.size = DSize(68, 68);
             }
                 break;
             case CAActivityIndicatorViewStyleWhiteLarge:
             {
-                image = CAImage::create(map.at("image_white"));
+                image = map.getImage("image_white");
                 center.size = DSize(68, 68);
             }
                 break;
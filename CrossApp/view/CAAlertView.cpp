@@ -208,7 +208,7 @@ void CAAlertView::showAlertView() {
     
     m_pScale9BackView = CAScale9ImageView::createWithLayout(DLayout(DHorizontalLayout_W_C(ALERT_VIEW_WIDTH, 0.5f), DVerticalLayout_H_C(m_fAlertViewHeight, 0.5f)));
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAAlertView");
-    m_pScale9BackView->setImage(CAImage::create(map.at("backgroundView")));
+    m_pScale9BackView->setImage(map.getImage("backgroundView"));
     this->addSubview(m_pScale9BackView);
     
     m_pBackView = CAClippingView::create();
@@ -2,6 +2,7 @@
 #include "CABatchView.h"
 #include "ccConfig.h"
 #include "CAView.h"
+#include "CAScale9ImageView.h"
 #include "view/CADrawingPrimitives.h"
 #include "support/CAPointExtension.h"
 #include "shaders/CAShaderCache.h"
@@ -11,6 +12,7 @@
 #include "math/TransformUtils.h"
 #include "support/CAProfiling.h"
 #include "kazmath/GL/matrix.h"
+#include <limits.h>
 
 NS_CC_BEGIN
 
@@ -119,6 +121,7 @@ void CABatchView::sortAllSubview()
     if (m_bReorderChildDirty)
     {
         std::sort(m_obSubviews.begin(), m_obSubviews.end(), compareSubviewZOrder);
+        m_bHitTestGridDirty = true;
         
         if (!m_obSubviews.empty())
         {
@@ -364,6 +367,8 @@ unsigned int CABatchView::atlasIndexForSubview(CAView *view, int nZ)
 
 void CABatchView::insertSubview(CAView *subview, unsigned int uIndex)
 {
+    CCAssert(dynamic_cast<CAScale9ImageView*>(subview) == NULL, "CABatchView has one quad per view, a CAScale9ImageView can't be batched");
+    
     subview->setBatch(this);
     subview->setAtlasIndex(uIndex);
     subview->setDirty(true);
@@ -398,6 +403,8 @@ void CABatchView::insertSubview(CAView *subview, unsigned int uIndex)
 
 void CABatchView::appendSubview(CAView* subview)
 {
+    CCAssert(dynamic_cast<CAScale9ImageView*>(subview) == NULL, "CABatchView has one quad per view, a CAScale9ImageView can't be batched");
+    
     m_bReorderChildDirty=true;
     subview->setBatch(this);
     subview->setDirty(true);
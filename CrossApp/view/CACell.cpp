@@ -58,7 +58,7 @@ bool CACell::initWithReuseIdentifier(const std::string& reuseIdentifier)
 
 CAView* CACell::getViewWithID(const std::string &tag)
 {
-    return m_pParser->m_mViews.getValue(tag);
+    return m_pParser->getView(tag);
 }
 
 void CACell::parser()
@@ -12,9 +12,11 @@ NS_CC_BEGIN
 
 CAGifView::CAGifView()
 :m_iGifIndex(0)
+,m_iUploadedIndex(-1)
 ,m_fDurTime(0.0f)
 ,m_fTimes(1.0f)
 ,m_pGif(NULL)
+,m_pGifCursor(NULL)
 ,m_bIsRepeatForever(true)
 ,m_fLeft(0.0f)
 ,m_fRight(0.0f)
@@ -27,6 +29,7 @@ CAGifView::CAGifView()
 CAGifView::~CAGifView()
 {
     CC_SAFE_RELEASE(m_pGif);
+    CC_SAFE_RELEASE(m_pGifCursor);
 }
 
 CAGifView* CAGifView::createWithFrame(const CrossApp::DRect &rect)
@@ -112,9 +115,20 @@ void CAGifView::setGif(CAGif* gif)
     CC_SAFE_RETAIN(gif);
     CC_SAFE_RELEASE(m_pGif);
     m_pGif = gif;
-    if (m_pGif)
+    // a cursor of its own, other views showing the same gif decode at their own pace
+    CC_SAFE_RELEASE_NULL(m_pGifCursor);
+    m_pGifCursor = CAGif::createWithGif(gif);
+    CC_SAFE_RETAIN(m_pGifCursor);
+    m_iGifIndex = 0;
+    m_iUploadedIndex = -1;
+    m_fDurTime = 0.0f;
+    if (m_pGifCursor)
     {
-        this->setImage(m_pGif->getImages().front());
+        // one texture per view, the frames are streamed into it
+        const unsigned char* pixels = m_pGifCursor->getFramePixels(0);
+        CAImage* image = pixels ? CAImage::createWithRawDataNoCache(pixels, CAImage::PixelFormat_RGBA8888, m_pGif->getPixelsWide(), m_pGif->getPixelsHigh()) : NULL;
+        this->setImage(image);
+        m_iUploadedIndex = image ? 0 : -1;
         
         DRect rect = DRectZero;
         rect.size.width = m_pGif->getPixelsWide();
@@ -123,7 +137,7 @@ void CAGifView::setGif(CAGif* gif)
         
         this->updateGifSize();
         
-        if(m_pGif->getImages().size() > 0)
+        if(m_pGif->getImageCount() > 1)
         {
             CAScheduler::getScheduler()->scheduleSelectorUpdate(this, 0, !m_bRunning);
         }
@@ -171,30 +185,56 @@ void CAGifView::setRepeatForever(bool repeatForever)
 
 void CAGifView::update(float delta)
 {
-    CC_RETURN_IF(!m_pGif);
+    CC_RETURN_IF(!m_pGif || m_pGif->getImageCount() == 0);
     float ldelta = (uint32_t)(delta * 1000) * m_fTimes;
     m_fDurTime += ldelta;
     
-    if(m_fDurTime > m_pGif->getDelay())
+    int count = (int)m_pGif->getImageCount();
+    int index = m_iGifIndex;
+    while (m_fDurTime > m_pGif->getImageDelayWithIndex(index))
     {
-        ++m_iGifIndex;
-        m_iGifIndex %= m_pGif->getImages().size();
-        this->setImage(m_pGif->getImageWithIndex(m_iGifIndex));
-        m_fDurTime -= m_pGif->getDelay();
-        
-        DRect rect = DRectZero;
-        rect.size.width = m_pGif->getPixelsWide();
-        rect.size.height = m_pGif->getPixelsHigh();
-        this->setImageRect(rect);
-
+        m_fDurTime -= m_pGif->getImageDelayWithIndex(index);
+        CC_BREAK_IF(!m_bIsRepeatForever && index >= count - 1);
+        index = (index + 1) % count;
     }
     
-    if (!m_bIsRepeatForever && m_iGifIndex >= m_pGif->getImages().size() - 1)
+    if (index != m_iGifIndex)
+    {
+        m_iGifIndex = index;
+        this->showFrame(m_iGifIndex);
+    }
+    
+    if (!m_bIsRepeatForever && m_iGifIndex >= count - 1)
     {
         CAScheduler::getScheduler()->unscheduleUpdate(this);
     }
 }
 
+void CAGifView::showFrame(int index)
+{
+    CAImage* image = this->getImage();
+    CC_RETURN_IF(image == NULL || index == m_iUploadedIndex);
+    
+    const unsigned char* pixels = m_pGifCursor->getFramePixels(index);
+    CC_RETURN_IF(pixels == NULL);
+    
+    unsigned int wide = m_pGif->getPixelsWide();
+    unsigned int top = 0;
+    unsigned int bottom = m_pGif->getPixelsHigh();
+    if (index == m_iUploadedIndex + 1)
+    {
+        // only the rows touched by this frame (and the disposal of the previous one)
+        m_pGifCursor->getFrameDirtyRows(index, &top, &bottom);
+    }
+    
+    if (bottom > top)
+    {
+        image->updateWithData(pixels + top * wide * 4, 0, top, wide, bottom - top);
+    }
+    m_iUploadedIndex = index;
+    this->updateDraw();
+}
+
 void CAGifView::onEnter()
 {
     CAView::onEnter();
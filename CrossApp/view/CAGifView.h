@@ -60,14 +60,20 @@ protected:
     
     void updateGifSize();
     
+    void showFrame(int index);
+    
 private:
     
     CAGif* m_pGif;
+    
+    CAGif* m_pGifCursor;
 
     bool m_bIsRepeatForever;
     
     int m_iGifIndex;
     
+    int m_iUploadedIndex;
+    
     float m_fDurTime;
     
     float m_fTimes;
@@ -12,6 +12,7 @@
 #include "shaders/CAGLProgram.h"
 #include "animation/CAViewAnimation.h"
 #include "basics/CAScheduler.h"
+#include "platform/CADensityDpi.h"
 
 NS_CC_BEGIN
 
@@ -211,11 +212,7 @@ void CAImageView::setContentSize(const DSize & contentSize)
         m_obAnchorPointInPoints.x = m_obContentSize.width * m_obAnchorPoint.x;
         m_obAnchorPointInPoints.y = m_obContentSize.height * m_obAnchorPoint.y;
 
-        CAVector<CAView*>::iterator itr;
-        for (itr=m_obSubviews.begin(); itr!=m_obSubviews.end(); itr++)
-        {
-            (*itr)->reViewlayout(m_obContentSize);
-        }
+        this->reViewlayoutSubviews();
         
         this->updateByImageViewScaleType();
         this->updateDraw();
@@ -332,6 +329,12 @@ void CAImageView::setImageAsyncWithFile(const std::string& path)
 {
     CAImageCache::sharedImageCache()->addImageFullPathAsync(path, this, callfuncO_selector(CAImageView::asyncFinish));
 }
+
+void CAImageView::setImageAsyncWithFile(const std::string& path, const DSize& decodeSize)
+{
+    DSize pixels = DSize(s_dip_to_px(decodeSize.width), s_dip_to_px(decodeSize.height));
+    CAImageCache::sharedImageCache()->addImageFullPathAsync(path, pixels, this, callfuncO_selector(CAImageView::asyncFinish));
+}
 void CAImageView::setImageRect(const DRect& rect)
 {
     CAView::setImageRect(rect);
@@ -339,6 +342,7 @@ void CAImageView::setImageRect(const DRect& rect)
 void CAImageView::asyncFinish(CrossApp::CAObject *var)
 {
     CAImage* image = dynamic_cast<CAImage*>(var);
+    CC_RETURN_IF(image == NULL);
     this->setImage(image);
 }
 
@@ -51,6 +51,9 @@ public:
 
     virtual void setImageAsyncWithFile(const std::string& path);
     
+    // decodes only as many pixels as displaying at decodeSize (in dips, e.g. the view size) needs
+    virtual void setImageAsyncWithFile(const std::string& path, const DSize& decodeSize);
+    
     virtual void setImageRect(const DRect& rect);
     
     CC_PROPERTY_PASS_BY_REF(CAImageViewScaleType, m_eImageViewScaleType, ImageViewScaleType);
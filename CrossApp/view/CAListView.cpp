@@ -27,7 +27,7 @@ CAListView::CAListView()
 , m_nSeparatorViewHeight(1)
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
-    m_obSeparatorColor = ccc4Int(CrossApp::hex2Int(map.at("separatorColor")));
+    m_obSeparatorColor = map.getColor("separatorColor");
 }
 
 
@@ -718,14 +718,14 @@ void CAListViewCell::normalListViewCell()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
     CC_RETURN_IF(m_pBackgroundView == NULL);
-    m_pBackgroundView->setColor(ccc4Int(CrossApp::hex2Int(map.at("backgroundColor_normal"))));
+    m_pBackgroundView->setColor(map.getColor("backgroundColor_normal"));
 }
 
 void CAListViewCell::highlightedListViewCell()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
     CC_RETURN_IF(m_pBackgroundView == NULL);
-    m_pBackgroundView->setColor(ccc4Int(CrossApp::hex2Int(map.at("backgroundColor_highlighted"))));
+    m_pBackgroundView->setColor(map.getColor("backgroundColor_highlighted"));
 }
 
 
@@ -733,7 +733,7 @@ void CAListViewCell::selectedListViewCell()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
     CC_RETURN_IF(m_pBackgroundView == NULL);
-    m_pBackgroundView->setColor(ccc4Int(CrossApp::hex2Int(map.at("backgroundColor_selected"))));
+    m_pBackgroundView->setColor(map.getColor("backgroundColor_selected"));
 }
 
 
@@ -741,7 +741,7 @@ void CAListViewCell::disabledListViewCell()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
     CC_RETURN_IF(m_pBackgroundView == NULL);
-    m_pBackgroundView->setColor(ccc4Int(CrossApp::hex2Int(map.at("backgroundColor_disabled"))));
+    m_pBackgroundView->setColor(map.getColor("backgroundColor_disabled"));
 }
 
 void CAListViewCell::normalCell()
@@ -61,7 +61,7 @@ bool CAPullToRefreshView::init()
         case CAPullToRefreshTypeHeader:
         {
             
-            this->setPullToImage(CAImage::create(map.at("header")));
+            this->setPullToImage(map.getImage("header"));
             this->setPullToRefreshText("下拉可以刷新");
             this->setReleaseToRefreshText("松开立即刷新");
             this->setRefreshingText("正在帮你刷新...");
@@ -69,7 +69,7 @@ bool CAPullToRefreshView::init()
             break;
         case CAPullToRefreshTypeFooter:
         {
-            this->setPullToImage(CAImage::create(map.at("footer")));
+            this->setPullToImage(map.getImage("footer"));
             this->setPullToRefreshText("上拉可以加载更多数据");
             this->setReleaseToRefreshText("松开立即加载更多数据");
             this->setRefreshingText("正在帮你加载数据...");
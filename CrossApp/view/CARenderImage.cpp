@@ -14,15 +14,40 @@
 // extern
 #include "kazmath/GL/matrix.h"
 #include "CCEGLView.h"
+#include "basics/CAScheduler.h"
+
+// asynchronous read-back needs pixel buffer objects and fences, which GLES2 lacks
+#if defined(GL_PIXEL_PACK_BUFFER) && defined(GL_SYNC_GPU_COMMANDS_COMPLETE)
+#define CC_RENDER_IMAGE_ASYNC_READBACK 1
+#else
+#define CC_RENDER_IMAGE_ASYNC_READBACK 0
+#endif
 
 NS_CC_BEGIN
 
+static bool isAsyncReadbackSupported()
+{
+#if CC_RENDER_IMAGE_ASYNC_READBACK && (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // GLEW resolves these at runtime, drivers without GL 3.2 leave them NULL
+    return glFenceSync != NULL && glClientWaitSync != NULL && glMapBuffer != NULL;
+#elif CC_RENDER_IMAGE_ASYNC_READBACK
+    return true;
+#else
+    return false;
+#endif
+}
+
 // implementation CARenderImage
 CARenderImage::CARenderImage()
 : m_pImageView(NULL)
 , m_uFBO(0)
 , m_uDepthRenderBufffer(0)
 , m_nOldFBO(0)
+, m_uDepthStencilFormat(0)
+, m_uPixelsWide(0)
+, m_uPixelsHigh(0)
+, m_uName(0)
+, m_bTargetLost(false)
 , m_pImage(0)
 , m_ePixelFormat(CAImage::PixelFormat_RGBA8888)
 , m_uClearFlags(0)
@@ -30,9 +55,6 @@ CARenderImage::CARenderImage()
 , m_fClearDepth(0.0f)
 , m_nClearStencil(0)
 , m_bAutoDraw(false)
-, m_uPixelsWide(0)
-, m_uPixelsHigh(0)
-, m_uName(0)
 {
 #if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
     // Listen this event to save render Image before come to background.
@@ -52,8 +74,30 @@ CARenderImage::CARenderImage()
 
 CARenderImage::~CARenderImage()
 {
+    CAScheduler::unschedule(schedule_selector(CARenderImage::updatePixelsRequests), this);
+    for (std::vector<PixelsRequest>::iterator itr=m_vPixelsRequests.begin(); itr!=m_vPixelsRequests.end(); ++itr)
+    {
+#if CC_RENDER_IMAGE_ASYNC_READBACK
+        if (itr->fence)
+        {
+            glDeleteSync((GLsync)itr->fence);
+        }
+        if (itr->buffer)
+        {
+            glDeleteBuffers(1, &itr->buffer);
+        }
+#endif
+        CC_SAFE_FREE(itr->pixels);
+        CC_SAFE_RELEASE(itr->target);
+        CC_SAFE_RELEASE(itr->image);
+    }
+    m_vPixelsRequests.clear();
+    
     CC_SAFE_RELEASE(m_pImageView);
+    // the image owns its own copy of the pixels and may outlive the render target
+    CC_SAFE_RELEASE(m_pImage);
     
+    ccGLDeleteTexture(m_uName);
     glDeleteFramebuffers(1, &m_uFBO);
     if (m_uDepthRenderBufffer)
     {
@@ -74,17 +118,13 @@ void CARenderImage::listenToBackground(CrossApp::CAObject *obj)
 
 void CARenderImage::listenToForeground(CrossApp::CAObject *obj)
 {
-// -- regenerate frame buffer object and attach the texture
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_nOldFBO);
-    
-    glGenFramebuffers(1, &m_uFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
+// -- regenerate the render target, the old names died with the context
+    // the last image was read back before going to background, passes drawn without
+    // a clear continue on top of it
+    unsigned char* data = m_pImage ? m_pImage->getData() : NULL;
+    m_bTargetLost = (data == NULL);
     
-//    m_pImage->setAliasTexParameters();
-    
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pImage->getName(), 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_nOldFBO);
-
+    this->createRenderTarget(data);
 }
 
 CAImageView * CARenderImage::getImageView()
@@ -198,65 +238,20 @@ bool CARenderImage::initWithWidthAndHeight(int w, int h, CAImage::PixelFormat eF
     CCAssert(eFormat != CAImage::PixelFormat_A8, "only RGB and RGBA formats are valid for a render texture");
 
     bool bRet = false;
-    unsigned char *data = NULL;
     do 
     {
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_nOldFBO);
-
         // textures must be power of two squared
         unsigned int powW = (unsigned int)(w + 1) / 2;
         powW *= 2;
         unsigned int powH = (unsigned int)(h + 1) / 2;
         powH *= 2;
         
-        data = (unsigned char *)malloc((unsigned long)(powW * powH * 4));
-        CC_BREAK_IF(! data);
-
-        memset(data, 0, (unsigned long)(powW * powH * 4));
         m_ePixelFormat = eFormat;
         m_uPixelsWide = powW;
         m_uPixelsHigh = powH;
+        m_uDepthStencilFormat = uDepthStencilFormat;
         
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 8);
-        glGenTextures(1, &m_uName);
-        ccGLBindTexture2D(m_uName);
-        
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_uPixelsWide, m_uPixelsHigh, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        
-        GLint oldRBO;
-        glGetIntegerv(GL_RENDERBUFFER_BINDING, &oldRBO);
-        
-        // generate FBO
-        glGenFramebuffers(1, &m_uFBO);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
-
-        // associate Image with FBO
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_uName, 0);
-
-        if (uDepthStencilFormat != 0)
-        {
-            //create and attach depth buffer
-            glGenRenderbuffers(1, &m_uDepthRenderBufffer);
-            glBindRenderbuffer(GL_RENDERBUFFER, m_uDepthRenderBufffer);
-            glRenderbufferStorage(GL_RENDERBUFFER, uDepthStencilFormat, (GLsizei)powW, (GLsizei)powH);
-            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_uDepthRenderBufffer);
-
-            // if depth format is the one with stencil part, bind same render buffer as stencil attachment
-            if (uDepthStencilFormat == GL_DEPTH24_STENCIL8)
-            {
-                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_uDepthRenderBufffer);
-            }
-        }
-//        // check if it worked (probably worth doing :) )
-        CCAssert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Could not attach Image to framebuffer");
-
-        ccGLBindTexture2D( m_uName );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+        CC_BREAK_IF(!this->createRenderTarget(NULL));
 
         CAImageView* imageView = CAImageView::createWithFrame(DRect(0, 0, m_uPixelsWide, m_uPixelsHigh));
         BlendFunc tBlendFunc = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA };
@@ -264,20 +259,72 @@ bool CARenderImage::initWithWidthAndHeight(int w, int h, CAImage::PixelFormat eF
         this->addSubview(imageView);
         this->setImageView(imageView);
         
-        glBindRenderbuffer(GL_RENDERBUFFER, oldRBO);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_nOldFBO);
-        
         // Diabled by default.
         m_bAutoDraw = false;
 
         bRet = true;
     } while (0);
     
-    CC_SAFE_FREE(data);
-    
     return bRet;
 }
 
+bool CARenderImage::createRenderTarget(const unsigned char* data)
+{
+    unsigned char* zeros = NULL;
+    if (data == NULL)
+    {
+        zeros = (unsigned char *)calloc((unsigned long)(m_uPixelsWide * m_uPixelsHigh), 4);
+        CC_RETURN_IF(zeros == NULL) false;
+        data = zeros;
+    }
+    
+    GLint oldFBO = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+    
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 8);
+    glGenTextures(1, &m_uName);
+    ccGLBindTexture2D(m_uName);
+    
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_uPixelsWide, m_uPixelsHigh, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    CC_SAFE_FREE(zeros);
+    
+    GLint oldRBO;
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &oldRBO);
+    
+    // generate FBO
+    glGenFramebuffers(1, &m_uFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
+    
+    // associate Image with FBO
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_uName, 0);
+    
+    if (m_uDepthStencilFormat != 0)
+    {
+        //create and attach depth buffer
+        glGenRenderbuffers(1, &m_uDepthRenderBufffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_uDepthRenderBufffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, m_uDepthStencilFormat, (GLsizei)m_uPixelsWide, (GLsizei)m_uPixelsHigh);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_uDepthRenderBufffer);
+        
+        // if depth format is the one with stencil part, bind same render buffer as stencil attachment
+        if (m_uDepthStencilFormat == GL_DEPTH24_STENCIL8)
+        {
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_uDepthRenderBufffer);
+        }
+    }
+//    // check if it worked (probably worth doing :) )
+    CCAssert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Could not attach Image to framebuffer");
+    
+    glBindRenderbuffer(GL_RENDERBUFFER, oldRBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+    
+    return true;
+}
+
 void CARenderImage::printscreenWithView(CAView* view)
 {
     this->printscreenWithView(view, DPointZero);
@@ -357,6 +404,7 @@ void CARenderImage::begin()
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_nOldFBO);
     glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
     
+    m_bTargetLost = false;
 }
 
 void CARenderImage::beginWithClear(const CAColor4B& backgroundColor)
@@ -423,11 +471,28 @@ void CARenderImage::beginWithClear(const CAColor4B& backgroundColor, float depth
 
 void CARenderImage::end()
 {
-    GLubyte *pBuffer = pBuffer = new GLubyte[m_uPixelsWide * m_uPixelsHigh * 4];
-    GLubyte *pTempData = new GLubyte[m_uPixelsWide * m_uPixelsHigh * 4];
+    // copy the pass into an image of its own on the GPU, images handed out by earlier
+    // passes keep their pixels and the render target stays free for the next pass
+    GLuint name = 0;
+    glGenTextures(1, &name);
+    ccGLBindTexture2D(name);
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, m_uPixelsWide, m_uPixelsHigh, 0);
     
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    glReadPixels(0, 0, m_uPixelsWide, m_uPixelsHigh, GL_RGBA, GL_UNSIGNED_BYTE, pTempData);
+    this->endWithoutImage();
+    
+    CAImage* image = CAImage::createWithTextureName(name, CAImage::PixelFormat_RGBA8888, m_uPixelsWide, m_uPixelsHigh);
+    CC_SAFE_RETAIN(image);
+    CC_SAFE_RELEASE(m_pImage);
+    m_pImage = image;
+    m_pImageView->setImage(m_pImage);
+}
+
+void CARenderImage::endWithoutImage()
+{
     glBindFramebuffer(GL_FRAMEBUFFER, m_nOldFBO);
 
     CAApplication::getApplication()->setViewport();
@@ -436,13 +501,148 @@ void CARenderImage::end()
 	kmGLPopMatrix();
 	kmGLMatrixMode(KM_GL_MODELVIEW);
 	kmGLPopMatrix();
+}
 
-    m_pImage = new CAImage();
-    m_pImage->initWithRawData(pTempData, CAImage::PixelFormat_RGBA8888, m_uPixelsWide, m_uPixelsHigh);
-    m_pImageView->setImage(m_pImage);
-    m_pImage->release();
-    CC_SAFE_DELETE_ARRAY(pBuffer);
-    CC_SAFE_DELETE_ARRAY(pTempData);
+void CARenderImage::readPixelsToBuffer(unsigned char* data)
+{
+    GLint oldFBO = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_uPixelsWide, m_uPixelsHigh, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+}
+
+void CARenderImage::adoptPixels(CAImage* image, unsigned char* data)
+{
+    // hand the buffer to the image as is, setData would copy it once more
+    image->releaseData();
+    image->m_pData = data;
+    image->m_uDataLenght = m_uPixelsWide * m_uPixelsHigh * 4;
+}
+
+bool CARenderImage::readPixels()
+{
+    unsigned char* data = m_pImage ? (unsigned char*)malloc(m_uPixelsWide * m_uPixelsHigh * 4) : NULL;
+    if (data == NULL)
+    {
+        return false;
+    }
+    
+    this->readPixelsToBuffer(data);
+    this->adoptPixels(m_pImage, data);
+    return true;
+}
+
+void CARenderImage::readPixelsAsync(CAObject* target, SEL_CallFuncO selector)
+{
+    CC_RETURN_IF(m_pImage == NULL);
+    
+    PixelsRequest request;
+    request.target = target;
+    request.selector = selector;
+    request.image = m_pImage;
+    request.buffer = 0;
+    request.fence = NULL;
+    request.pixels = NULL;
+    CC_SAFE_RETAIN(target);
+    CC_SAFE_RETAIN(request.image);
+    
+    unsigned long length = m_uPixelsWide * m_uPixelsHigh * 4;
+    
+    if (isAsyncReadbackSupported())
+    {
+#if CC_RENDER_IMAGE_ASYNC_READBACK
+        GLint oldFBO = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
+        
+        glGenBuffers(1, &request.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, request.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, length, NULL, GL_STREAM_READ);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        // with a pack buffer bound this only queues the copy, the CPU does not wait
+        glReadPixels(0, 0, m_uPixelsWide, m_uPixelsHigh, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        
+        glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+        request.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+    }
+    else
+    {
+        request.pixels = (unsigned char*)malloc(length);
+        if (request.pixels)
+        {
+            this->readPixelsToBuffer(request.pixels);
+        }
+    }
+    
+    m_vPixelsRequests.push_back(request);
+    
+    if (!CAScheduler::isScheduled(schedule_selector(CARenderImage::updatePixelsRequests), this))
+    {
+        CAScheduler::schedule(schedule_selector(CARenderImage::updatePixelsRequests), this, 0);
+    }
+}
+
+void CARenderImage::updatePixelsRequests(float dt)
+{
+    std::vector<PixelsRequest> finished;
+    
+    for (std::vector<PixelsRequest>::iterator itr=m_vPixelsRequests.begin(); itr!=m_vPixelsRequests.end();)
+    {
+#if CC_RENDER_IMAGE_ASYNC_READBACK
+        if (itr->fence)
+        {
+            GLenum status = glClientWaitSync((GLsync)itr->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+            {
+                ++itr;
+                continue;
+            }
+            glDeleteSync((GLsync)itr->fence);
+            itr->fence = NULL;
+            
+            unsigned long length = m_uPixelsWide * m_uPixelsHigh * 4;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, itr->buffer);
+            if (void* mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY))
+            {
+                itr->pixels = (unsigned char*)malloc(length);
+                if (itr->pixels)
+                {
+                    memcpy(itr->pixels, mapped, length);
+                }
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glDeleteBuffers(1, &itr->buffer);
+            itr->buffer = 0;
+        }
+#endif
+        finished.push_back(*itr);
+        itr = m_vPixelsRequests.erase(itr);
+    }
+    
+    if (m_vPixelsRequests.empty())
+    {
+        CAScheduler::unschedule(schedule_selector(CARenderImage::updatePixelsRequests), this);
+    }
+    
+    // callbacks may queue new requests, so they run after the pending list is settled
+    for (std::vector<PixelsRequest>::iterator itr=finished.begin(); itr!=finished.end(); ++itr)
+    {
+        if (itr->pixels)
+        {
+            this->adoptPixels(itr->image, itr->pixels);
+        }
+        if (itr->target && itr->selector)
+        {
+            (itr->target->*itr->selector)(itr->image);
+        }
+        CC_SAFE_RELEASE(itr->target);
+        CC_SAFE_RELEASE(itr->image);
+    }
 }
 
 void CARenderImage::clear(const CAColor4B& backgroundColor)
@@ -576,9 +776,9 @@ void CARenderImage::draw()
 bool CARenderImage::saveToFile(const char *szFilePath)
 {
     bool bRet = false;
-    if (m_pImageView->getImage())
+    if (CAImage* image = m_pImageView->getImage())
     {
-        bRet = m_pImageView->getImage()->saveToFile(szFilePath);
+        bRet = image->saveToFile(szFilePath);
     }
     return bRet;
 }
@@ -5,6 +5,7 @@
 #include "CAView.h"
 #include "CAImageView.h"
 #include "kazmath/mat4.h"
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -44,8 +45,21 @@ public:
 
     void clearStencil(int stencilValue);
 
+    // reads the pixels back first when the image has no CPU copy
     bool saveToFile(const char *szFilePath);
 
+    // Every pass hands getImageView()->getImage() a new image holding a GPU copy of the
+    // render target, it has no pixel data until one of these is called.
+
+    // blocking read-back into getImageView()->getImage()->getData(), stalls until the GPU is done
+    bool readPixels();
+
+    // non-blocking read-back through a pixel buffer object; selector receives the image of the
+    // current pass once its data holds the pixels, even if later passes have replaced it.
+    // Without PBO and fence support the pixels are read immediately and the callback still
+    // arrives on a later frame.
+    void readPixelsAsync(CAObject* target, SEL_CallFuncO selector);
+
     void listenToBackground(CAObject *obj);
 
     void listenToForeground(CAObject *obj);
@@ -81,17 +95,43 @@ protected:
     
     void end();
     
+    // ends the pass without copying the target into a new image, for owners that draw m_uName
+    void endWithoutImage();
+    
+    bool createRenderTarget(const unsigned char* data);
+    
     virtual void setContentSize(const DSize& contentSize);
     
+    void updatePixelsRequests(float dt);
+    
+    void readPixelsToBuffer(unsigned char* data);
+    
+    void adoptPixels(CAImage* image, unsigned char* data);
+    
+    struct PixelsRequest
+    {
+        CAObject*       target;
+        SEL_CallFuncO   selector;
+        CAImage*        image;      // the pass that was read, end() may have replaced m_pImage since
+        GLuint          buffer;     // pixel buffer object, 0 when read synchronously
+        void*           fence;      // GLsync of the pending copy
+        unsigned char*  pixels;
+    };
+    
 protected:
     GLuint       m_uFBO;
     GLuint       m_uDepthRenderBufffer;
     GLint        m_nOldFBO;
+    GLuint       m_uDepthStencilFormat;
     
     unsigned int m_uPixelsWide;
     unsigned int m_uPixelsHigh;
     GLuint m_uName;
+    // the target came back from a context loss without its previous pixels
+    bool m_bTargetLost;
     CAImage* m_pImage;
+    
+    std::vector<PixelsRequest> m_vPixelsRequests;
 
     CAImage::PixelFormat m_ePixelFormat;
     
@@ -103,6 +143,8 @@ protected:
     bool         m_bAutoDraw;
     
     friend class CAImage;
+    
+    friend class CAView;
 };
 
 // end of textures group
@@ -7,23 +7,30 @@
 //
 
 #include "CAScale9ImageView.h"
-#include "CABatchView.h"
 #include "animation/CAViewAnimation.h"
+#include "basics/CAApplication.h"
 
 NS_CC_BEGIN
 
+// two triangles for each of the nine slices of the 4x4 vertex grid
+static const GLushort s_uScale9Indices[54] =
+{
+    0, 4, 1,    1, 4, 5,    1, 5, 2,    2, 5, 6,    2, 6, 3,    3, 6, 7,
+    4, 8, 5,    5, 8, 9,    5, 9, 6,    6, 9, 10,   6, 10, 7,   7, 10, 11,
+    8, 12, 9,   9, 12, 13,  9, 13, 10,  10, 13, 14, 10, 14, 11, 11, 14, 15,
+};
+
 CAScale9ImageView::CAScale9ImageView()
-: m_fInsetLeft(0)
+: m_obOriginalSize(DSizeZero)
+, m_obCapInsets(DRectZero)
+, m_fInsetLeft(0)
 , m_fInsetTop(0)
 , m_fInsetRight(0)
 , m_fInsetBottom(0)
-, m_obCapInsets(DRectZero)
-, m_obOriginalSize(DSizeZero)
-, m_pScale9ImageView(NULL)
-, m_bUpdatePositions(false)
+, m_sVertices()
 , m_bAutoCapInsets(true)
 {
-    memset(m_pImageView, 0, sizeof(m_pImageView));
+
 }
 
 CAScale9ImageView::~CAScale9ImageView()
@@ -128,147 +135,52 @@ CAView* CAScale9ImageView::copy()
 
 void CAScale9ImageView::updateWithImage()
 {
-    CAColor4B color = this->getColor();
-
-    if (m_pScale9ImageView)
-    {
-        m_pScale9ImageView->removeAllSubviews();
-        m_pScale9ImageView->removeFromSuperview();
-        m_pScale9ImageView = NULL;
-    }
-    
-    memset(m_pImageView, 0, sizeof(m_pImageView));
-
     CC_RETURN_IF(!m_pobImage);
-
-    m_pScale9ImageView = CABatchView::createWithImage(m_pobImage);
-    m_pScale9ImageView->setLayout(DLayoutFill);
-    this->addSubview(m_pScale9ImageView);
-    
-    m_obOriginalSize = m_pScale9ImageView->getImageAtlas()->getImage()->getContentSize();
-    
-    for (int i=0; i<9; i++)
-    {
-        m_pImageView[i] = CAImageView::createWithImage(m_pScale9ImageView->getImage());
-    }
-    
-    // Centre
-    m_pScale9ImageView->insertSubview(m_pImageView[4], 0);
     
-    // Top
-    m_pScale9ImageView->insertSubview(m_pImageView[1], 1);
-    
-    // Bottom
-    m_pScale9ImageView->insertSubview(m_pImageView[7], 1);
-    
-    // Left
-    m_pScale9ImageView->insertSubview(m_pImageView[3], 1);
-    
-    // Right
-    m_pScale9ImageView->insertSubview(m_pImageView[5], 1);
-    
-    // Top left
-    m_pScale9ImageView->insertSubview(m_pImageView[0], 2);
-    
-    // Top right
-    m_pScale9ImageView->insertSubview(m_pImageView[2], 2);
-    
-    // Bottom left
-    m_pScale9ImageView->insertSubview(m_pImageView[6], 2);
-    
-    // Bottom right
-    m_pScale9ImageView->insertSubview(m_pImageView[8], 2);
+    m_obOriginalSize = m_pobImage->getContentSize();
     
     this->updateCapInset();
     
-    this->setColor(color);
+    this->updateColor();
 }
 
 void CAScale9ImageView::updatePositions()
 {
     CC_RETURN_IF(m_pobImage == NULL);
-    CC_RETURN_IF(m_bUpdatePositions);
-    m_bUpdatePositions = true;
     
     DSize size = this->m_obContentSize;
     
-    DRect newRect[9];
+    const float lenghtX1 = m_obCapInsets.origin.x;
+    const float lenghtX3 = m_obOriginalSize.width - lenghtX1 - m_obCapInsets.size.width;
+    const float lenghtY1 = m_obCapInsets.origin.y;
+    const float lenghtY3 = m_obOriginalSize.height - lenghtY1 - m_obCapInsets.size.height;
     
-    for (int i=0; i<9; i++)
-    {
-        newRect[i] = m_rFrame[i];
-    }
+    // column and row stops, rows measured from the top like the image
+    float x[4] = {0, lenghtX1, size.width - lenghtX3, size.width};
+    float y[4] = {0, lenghtY1, size.height - lenghtY3, size.height};
     
-    if (size.width > m_obOriginalSize.width)
+    // smaller than the image: the caps are scaled down with everything else
+    if (size.width <= m_obOriginalSize.width)
     {
-        const float lenghtX1 = m_rFrame[0].size.width;
-        const float lenghtX3 = m_rFrame[2].size.width;
-        const float lenghtX2 = size.width - lenghtX1 - lenghtX3;
-        
-        newRect[1].origin.x = lenghtX1;
-        newRect[4].origin.x = lenghtX1;
-        newRect[7].origin.x = lenghtX1;
-        
-        newRect[1].size.width = lenghtX2;
-        newRect[4].size.width = lenghtX2;
-        newRect[7].size.width = lenghtX2;
-        
-        newRect[2].origin.x = lenghtX1 + lenghtX2;
-        newRect[5].origin.x = lenghtX1 + lenghtX2;
-        newRect[8].origin.x = lenghtX1 + lenghtX2;
-        
-        newRect[2].size.width = lenghtX3;
-        newRect[5].size.width = lenghtX3;
-        newRect[8].size.width = lenghtX3;
-    }
-    else
-    {
-        float scaleX = size.width / m_obOriginalSize.width;
-        for (int i=0; i<9; i++)
-        {
-            newRect[i].origin.x *= scaleX;
-            newRect[i].size.width *= scaleX;
-        }
+        float scaleX = m_obOriginalSize.width > 0 ? size.width / m_obOriginalSize.width : 0;
+        x[1] = lenghtX1 * scaleX;
+        x[2] = (lenghtX1 + m_obCapInsets.size.width) * scaleX;
     }
     
-    if (size.height > m_obOriginalSize.height)
+    if (size.height <= m_obOriginalSize.height)
     {
-        const float lenghtY1 = m_rFrame[0].size.height;
-        const float lenghtY3 = m_rFrame[6].size.height;
-        const float lenghtY2 = size.height - lenghtY1 - lenghtY3;
-        
-        newRect[3].origin.y = lenghtY1;
-        newRect[4].origin.y = lenghtY1;
-        newRect[5].origin.y = lenghtY1;
-        
-        newRect[3].size.height = lenghtY2;
-        newRect[4].size.height = lenghtY2;
-        newRect[5].size.height = lenghtY2;
-        
-        newRect[6].origin.y = lenghtY1 + lenghtY2;
-        newRect[7].origin.y = lenghtY1 + lenghtY2;
-        newRect[8].origin.y = lenghtY1 + lenghtY2;
-        
-        newRect[6].size.height = lenghtY3;
-        newRect[7].size.height = lenghtY3;
-        newRect[8].size.height = lenghtY3;
+        float scaleY = m_obOriginalSize.height > 0 ? size.height / m_obOriginalSize.height : 0;
+        y[1] = lenghtY1 * scaleY;
+        y[2] = (lenghtY1 + m_obCapInsets.size.height) * scaleY;
     }
-    else
+    
+    for (int row=0; row<4; row++)
     {
-        float scaleY = size.height / m_obOriginalSize.height;
-        for (int i=0; i<9; i++)
+        for (int col=0; col<4; col++)
         {
-            newRect[i].origin.y *= scaleY;
-            newRect[i].size.height *= scaleY;
+            m_sVertices[row * 4 + col].vertices = DPoint3D(x[col], size.height - y[row], m_fVertexZ);
         }
     }
-    
-    for (int i=0; i<9; i++)
-    {
-        m_pImageView[i]->setFrame(newRect[i]);
-    }
-    
-    m_bUpdatePositions = false;
 }
 
 void CAScale9ImageView::setContentSize(const DSize &size)
@@ -280,7 +192,51 @@ void CAScale9ImageView::setContentSize(const DSize &size)
 
 void CAScale9ImageView::draw(void)
 {
-
+    m_uZLevel = CAApplication::getApplication()->getCurrentNumberOfDraws();
+    
+    CC_RETURN_IF(m_pobImage == NULL);
+    CC_RETURN_IF(m_pShaderProgram == NULL);
+    
+    ccGLEnable(m_eGLServerState);
+    m_pShaderProgram->use();
+    m_pShaderProgram->setUniformsForBuiltins(m_tModelViewTransform);
+    
+    ccGLBlendFunc(m_sBlendFunc.src, m_sBlendFunc.dst);
+    ccGLBindTexture2D(m_pobImage->getName());
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_PosColorTex);
+    
+#define kVertexSize sizeof(m_sVertices[0])
+    
+    long offset = (long)m_sVertices;
+    
+    // vertex
+    int diff = offsetof( ccV3F_C4B_T2F, vertices);
+    glVertexAttribPointer(kCCVertexAttrib_Position,
+                          3,
+                          GL_FLOAT,
+                          GL_FALSE,
+                          kVertexSize,
+                          (void*) (offset + diff));
+    
+    // texCoods
+    diff = offsetof( ccV3F_C4B_T2F, texCoords);
+    glVertexAttribPointer(kCCVertexAttrib_TexCoords,
+                          2,
+                          GL_FLOAT,
+                          GL_FALSE,
+                          kVertexSize,
+                          (void*) (offset + diff));
+    
+    // color
+    diff = offsetof( ccV3F_C4B_T2F, colors);
+    glVertexAttribPointer(kCCVertexAttrib_Color,
+                          4,
+                          GL_UNSIGNED_BYTE,
+                          GL_TRUE,
+                          kVertexSize,
+                          (void*)(offset + diff));
+    
+    glDrawElements(GL_TRIANGLES, 54, GL_UNSIGNED_SHORT, s_uScale9Indices);
 }
 
 void CAScale9ImageView::setCapInsets(const DRect& capInsets)
@@ -289,6 +245,7 @@ void CAScale9ImageView::setCapInsets(const DRect& capInsets)
     m_obCapInsets = capInsets;
     m_bAutoCapInsets = false;
     this->updateCapInset();
+    this->updateDraw();
 }
 
 void CAScale9ImageView::updateCapInset()
@@ -308,32 +265,24 @@ void CAScale9ImageView::updateCapInset()
     const float lenghtY2 = m_obCapInsets.size.height;
     const float lenghtY3 = h - lenghtY1 - lenghtY2;
     
-    m_rFrame[0] = DRect(0, 0, lenghtX1, lenghtY1);
-    m_rFrame[1] = DRect(lenghtX1, 0, lenghtX2, lenghtY1);
-    m_rFrame[2] = DRect(lenghtX1 + lenghtX2, 0, lenghtX3, lenghtY1);
-    m_rFrame[3] = DRect(0, lenghtY1, lenghtX1, lenghtY2);
-    m_rFrame[4] = DRect(lenghtX1, lenghtY1, lenghtX2, lenghtY2);
-    m_rFrame[5] = DRect(lenghtX1 + lenghtX2, lenghtY1, lenghtX3, lenghtY2);
-    m_rFrame[6] = DRect(0, lenghtY1 + lenghtY2, lenghtX1, lenghtY3);
-    m_rFrame[7] = DRect(lenghtX1, lenghtY1 + lenghtY2, lenghtX2, lenghtY3);
-    m_rFrame[8] = DRect(lenghtX1 + lenghtX2, lenghtY1 + lenghtY2, lenghtX3, lenghtY3);
     
     CC_RETURN_IF(m_pobImage == NULL);
     
-    if (m_pScale9ImageView)
+    float atlasWidth = (float)m_pobImage->getPixelsWide();
+    float atlasHeight = (float)m_pobImage->getPixelsHigh();
+    
+    float u[4] = {0, lenghtX1, lenghtX1 + lenghtX2, lenghtX1 + lenghtX2 + lenghtX3};
+    float v[4] = {0, lenghtY1, lenghtY1 + lenghtY2, lenghtY1 + lenghtY2 + lenghtY3};
+    
+    for (int row=0; row<4; row++)
     {
-        for (int i=0; i<9; i++)
+        for (int col=0; col<4; col++)
         {
-            m_pImageView[i]->setImageRect(m_rFrame[i]);
+            m_sVertices[row * 4 + col].texCoords = tex2(u[col] / atlasWidth, v[row] / atlasHeight);
         }
-        this->updatePositions();
     }
-}
-
-void CAScale9ImageView::updateDisplayedColor(const CrossApp::CAColor4B &color)
-{
-    CAView::updateDisplayedColor(color);
-    setColor(color);
+    
+    this->updatePositions();
 }
 
 void CAScale9ImageView::setInsetLeft(float insetLeft)
@@ -399,12 +348,15 @@ void CAScale9ImageView::setInsetBottom(float insetBottom)
 void CAScale9ImageView::setColor(const CAColor4B& color)
 {
     CAView::setColor(color);
-    if (m_pScale9ImageView)
+}
+
+void CAScale9ImageView::updateColor(void)
+{
+    CAView::updateColor();
+    
+    for (int i=0; i<16; i++)
     {
-        for (auto& subview : m_pScale9ImageView->getSubviews())
-        {
-            subview->setColor(color);
-        }
+        m_sVertices[i].colors = m_sQuad.bl.colors;
     }
 }
 
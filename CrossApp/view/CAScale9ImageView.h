@@ -13,6 +13,11 @@
 
 NS_CC_BEGIN
 
+/**
+ * Stretches an image by its cap insets. The nine slices are drawn as one
+ * 16-vertex indexed mesh in a single draw call; resizing only moves vertices.
+ * It can't be a subview of a CABatchView, whose atlas holds one quad per view.
+ */
 class CC_DLL CAScale9ImageView : public CAView
 {
 public:
@@ -83,22 +88,16 @@ protected:
     
     virtual void setContentSize(const DSize & size);
 
-    virtual void updateDisplayedColor(const CrossApp::CAColor4B& parentColor);
+    virtual void updateColor(void);
     
     using CAView::initWithColor;
     
 protected:
 
-    CABatchView* m_pScale9ImageView;
-    
-    CAImageView* m_pImageView[9];
-    
-    DRect m_rFrame[9];
+    ccV3F_C4B_T2F m_sVertices[16];  ///< 4x4 grid, row major from the top left corner
     
     bool m_bAutoCapInsets;
     
-    bool m_bUpdatePositions;
-    
 };
 
 // end of GUI group
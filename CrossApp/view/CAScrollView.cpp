@@ -1324,7 +1324,7 @@ bool CAIndicator::init()
     }
     this->setColor(CAColor_clear);
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAIndicator");
-    CAImage* image = CAImage::create(map.at("backgroundView"));
+    CAImage* image = map.getImage("backgroundView");
     
     
     CAScale9ImageView* indicator = CAScale9ImageView::createWithImage(image);
@@ -39,7 +39,7 @@ CATableView::CATableView()
 ,m_bAlwaysBottomSectionFooter(true)
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
-    m_obSeparatorColor = ccc4Int(CrossApp::hex2Int(map.at("separatorColor")));
+    m_obSeparatorColor = map.getColor("separatorColor");
 }
 
 CATableView::~CATableView()
@@ -695,14 +695,14 @@ void CATableViewCell::normalTableViewCell()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
     CC_RETURN_IF(m_pBackgroundView == NULL);
-    m_pBackgroundView->setColor(ccc4Int(CrossApp::hex2Int(map.at("backgroundColor_normal"))));
+    m_pBackgroundView->setColor(map.getColor("backgroundColor_normal"));
 }
 
 void CATableViewCell::highlightedTableViewCell()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
     CC_RETURN_IF(m_pBackgroundView == NULL);
-    m_pBackgroundView->setColor(ccc4Int(CrossApp::hex2Int(map.at("backgroundColor_highlighted"))));
+    m_pBackgroundView->setColor(map.getColor("backgroundColor_highlighted"));
 }
 
 
@@ -710,7 +710,7 @@ void CATableViewCell::selectedTableViewCell()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
     CC_RETURN_IF(m_pBackgroundView == NULL);
-    m_pBackgroundView->setColor(ccc4Int(CrossApp::hex2Int(map.at("backgroundColor_selected"))));
+    m_pBackgroundView->setColor(map.getColor("backgroundColor_selected"));
 }
 
 
@@ -718,7 +718,7 @@ void CATableViewCell::disabledTableViewCell()
 {
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CACell");
     CC_RETURN_IF(m_pBackgroundView == NULL);
-    m_pBackgroundView->setColor(ccc4Int(CrossApp::hex2Int(map.at("backgroundColor_disabled"))));
+    m_pBackgroundView->setColor(map.getColor("backgroundColor_disabled"));
 }
 
 void CATableViewCell::setDraggingLength(unsigned int var)
@@ -93,7 +93,7 @@ void CATextToolBarView::show(CAView* pView)
 
     const CAThemeManager::stringMap& map = CAApplication::getApplication()->getThemeManager()->getThemeMap("CAAlertView");
 	CAScale9ImageView *BackgroundImageView = CAScale9ImageView::createWithFrame(m_pBackView->getBounds());
-	BackgroundImageView->setImage(CAImage::create(map.at("backgroundView")));
+	BackgroundImageView->setImage(map.getImage("backgroundView"));
 	m_pBackView->addSubview(BackgroundImageView);
 	m_pBackView->setStencil(BackgroundImageView->copy());
 
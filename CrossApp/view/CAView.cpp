@@ -9,6 +9,7 @@
 #include "CAView.h"
 #include "support/CAPointExtension.h"
 #include "math/TransformUtils.h"
+#include "math/CAMathUtil.h"
 #include "basics/CACamera.h"
 #include "basics/CAApplication.h"
 #include "basics/CAScheduler.h"
@@ -17,6 +18,7 @@
 #include "CABatchView.h"
 #include "kazmath/GL/matrix.h"
 #include <stdarg.h>
+#include <algorithm>
 #include "dispatcher/CATouchDispatcher.h"
 #include "dispatcher/CAKeypadDispatcher.h"
 #include "shaders/CAShaderCache.h"
@@ -30,6 +32,8 @@
 #include "platform/CADensityDpi.h"
 #include "ccMacros.h"
 #include "game/CGNode.h"
+#include "dispatcher/CAHitTestGrid.h"
+#include "CARenderImage.h"
 
 #include "script_support/CCScriptSupport.h"
 NS_CC_BEGIN;
@@ -39,6 +43,40 @@ static int viewCount = 0;
 
 static int s_globalOrderOfArrival = 1;
 
+static unsigned int s_uModelViewVersion = 0;
+
+// view whose subviews are being visited, subviews visited below it reuse its cached model view matrix
+static CAView* s_pVisitingView = NULL;
+
+// topmost views of the subtrees holding pending layouts
+static CAVector<CAView*> s_vLayoutDirtyRoots;
+
+static bool s_bLayoutPending = false;
+
+static unsigned int s_uLayoutPassCount = 0;
+
+static unsigned int s_uLayoutSolvedCount = 0;
+
+// rasterized views holding a layer texture, not retained
+static std::vector<CAView*> s_vRasterLayers;
+
+static unsigned long s_uRasterCacheLimit = 16 * 1024 * 1024;
+
+static unsigned long s_uRasterCacheBytes = 0;
+
+static unsigned int s_uRasterCacheHitCount = 0;
+
+static unsigned int s_uRasterRenderCount = 0;
+
+static unsigned int nextModelViewVersion()
+{
+    if (++s_uModelViewVersion == 0)
+    {
+        ++s_uModelViewVersion;
+    }
+    return s_uModelViewVersion;
+}
+
 CAView::CAView(void)
 : m_fRotationX(0.0f)
 , m_fRotationY(0.0f)
@@ -53,6 +91,19 @@ CAView::CAView(void)
 , m_obContentSize(DSizeZero)
 , m_obPoint(DPOINT_FLT_MIN)
 , m_fVertexZ(0.0f)
+, m_bLayoutDirty(false)
+, m_bSubviewLayoutDirty(false)
+, m_bViewToWorldDirty(true)
+, m_bWorldToViewDirty(true)
+, m_uModelViewVersion(0)
+, m_uParentModelViewVersion(0)
+, m_pHitTestGrid(NULL)
+, m_bHitTestGridDirty(true)
+, m_bRasterized(false)
+, m_bRasterDirty(true)
+, m_pRasterImage(NULL)
+, m_uRasterBytes(0)
+, m_uRasterFrame(0)
 , m_obRect(DRectZero)
 , m_tAdditionalTransform(Mat4::IDENTITY)
 , m_bTransformDirty(true)
@@ -125,6 +176,8 @@ CAView::~CAView(void)
         subview->setSuperview(NULL);
     }
     m_obSubviews.clear();
+    CC_SAFE_DELETE(m_pHitTestGrid);
+    this->releaseRasterImage();
     
     CC_SAFE_RELEASE(m_pobImage);
     if (m_pCGNode)
@@ -315,7 +368,7 @@ void CAView::setSkewX(float newSkewX)
     else if (m_fSkewX != newSkewX)
     {
         m_fSkewX = newSkewX;
-        this->updateDraw();
+        this->updateDrawTransform();
     }
 }
 
@@ -334,7 +387,7 @@ void CAView::setSkewY(float newSkewY)
     else if (m_fSkewY != newSkewY)
     {
         m_fSkewY = newSkewY;
-        this->updateDraw();
+        this->updateDrawTransform();
     }
 }
 
@@ -389,7 +442,7 @@ void CAView::setVertexZ(float var)
     else if(m_fVertexZ != var)
     {
         m_fVertexZ = var;
-        this->updateDraw();
+        this->updateDrawTransform();
     }
 }
 
@@ -412,7 +465,7 @@ void CAView::setRotation(int newRotation)
     {
         m_fRotationZ = newRotation;
         this->updateRotationQuat();
-        this->updateDraw();
+        this->updateDrawTransform();
     }
 }
 
@@ -432,7 +485,7 @@ void CAView::setRotationX(int fRotationX)
     {
         m_fRotationX = fRotationX;
         this->updateRotationQuat();
-        this->updateDraw();
+        this->updateDrawTransform();
     }
 }
 
@@ -452,7 +505,7 @@ void CAView::setRotationY(int fRotationY)
     {
         m_fRotationY = fRotationY;
         this->updateRotationQuat();
-        this->updateDraw();
+        this->updateDrawTransform();
     }
 }
 
@@ -510,7 +563,7 @@ void CAView::setScaleX(float newScaleX)
     else if (m_fScaleX != newScaleX)
     {
         m_fScaleX = newScaleX;
-        this->updateDraw();
+        this->updateDrawTransform();
     }
 }
 
@@ -531,7 +584,7 @@ void CAView::setScaleY(float newScaleY)
     else if (m_fScaleY != newScaleY)
     {
         m_fScaleY = newScaleY;
-        this->updateDraw();
+        this->updateDrawTransform();
     }
 }
 
@@ -539,7 +592,7 @@ void CAView::setScaleY(float newScaleY)
 void CAView::setPoint(const DPoint& newPoint)
 {
     m_obPoint = newPoint;
-    this->updateDraw();
+    this->updateDrawTransform();
 }
 
 /// children getter
@@ -610,7 +663,7 @@ void CAView::setAnchorPointInPoints(const DPoint& anchorPointInPoints)
             point = PointApplyAffineTransform(point, this->getViewToSuperviewAffineTransform());
             point.y = this->m_pSuperview->m_obContentSize.height - point.y;
             this->setPoint(point);
-            this->updateDraw();
+            this->updateDrawTransform();
         }
     }
 }
@@ -636,7 +689,7 @@ void CAView::setAnchorPoint(const DPoint& anchorPoint)
             point = PointApplyAffineTransform(point, this->getViewToSuperviewAffineTransform());
             point.y = this->m_pSuperview->m_obContentSize.height - point.y;
             this->setPoint(point);
-            this->updateDraw();
+            this->updateDrawTransform();
         }
     }
 }
@@ -660,11 +713,7 @@ void CAView::setContentSize(const DSize & contentSize)
             m_pContentContainer->viewOnSizeTransitionDidChanged();
         }
         
-        CAVector<CAView*>::iterator itr;
-        for (itr=m_obSubviews.begin(); itr!=m_obSubviews.end(); itr++)
-        {
-            (*itr)->reViewlayout(m_obContentSize);
-        }
+        this->reViewlayoutSubviews();
         
         this->updateDraw();
     }
@@ -672,6 +721,7 @@ void CAView::setContentSize(const DSize & contentSize)
 
 const DRect& CAView::getFrame()
 {
+    this->layoutIfNeeded();
     m_obReturn.setType(DRect::Frame);
     m_obReturn.origin = ccpSub(m_obPoint, m_obAnchorPointInPoints);
     m_obReturn.size = m_obContentSize;
@@ -711,6 +761,7 @@ void CAView::setFrame(const DRect &rect)
 
 const DPoint& CAView::getFrameOrigin()
 {
+    this->layoutIfNeeded();
     m_obReturn.origin = ccpSub(m_obPoint, m_obAnchorPointInPoints);
     return m_obReturn.origin;
 }
@@ -734,6 +785,7 @@ void CAView::setFrameOrigin(const DPoint& point)
 
 const DRect& CAView::getCenter()
 {
+    this->layoutIfNeeded();
     m_obReturn.setType(DRect::Center);
     m_obReturn.origin = ccpAdd(ccpSub(m_obPoint, m_obAnchorPointInPoints),
                            ccpMult(m_obContentSize, 0.5f));
@@ -774,6 +826,7 @@ void CAView::setCenter(const DRect& rect)
 
 const DPoint& CAView::getCenterOrigin()
 {
+    this->layoutIfNeeded();
     m_obReturn.origin = ccpAdd(ccpSub(m_obPoint, m_obAnchorPointInPoints),
                   ccpMult(m_obContentSize, 0.5f));
     return m_obReturn.origin;
@@ -799,6 +852,7 @@ void CAView::setCenterOrigin(const DPoint& point)
 
 const DRect& CAView::getBounds()
 {
+    this->layoutIfNeeded();
     m_obReturn.setType(DRect::Frame);
     m_obReturn.origin = DPointZero;
     m_obReturn.size = m_obContentSize;
@@ -820,17 +874,190 @@ void CAView::setLayout(const CrossApp::DLayout &layout)
     
     if (m_bRunning)
     {
-        if (m_pSuperview)
+        if (m_pSuperview
+            && CAViewAnimation::areAnimationsEnabled()
+            && CAViewAnimation::areBeginAnimations())
         {
+            // the animation has to capture the target frame now
+            m_bLayoutDirty = false;
             this->reViewlayout(m_pSuperview->m_obContentSize, true);
         }
-        else if (m_pParentCGNode)
+        else
         {
-            this->reViewlayout(m_pParentCGNode->m_obContentSize);
+            this->setNeedsLayout();
         }
     }
 }
 
+void CAView::setNeedsLayout()
+{
+    CC_RETURN_IF(m_bLayoutDirty);
+    
+    bool queued = m_bSubviewLayoutDirty;
+    m_bLayoutDirty = true;
+    
+    CAView* view = this;
+    while (!queued && view->m_pSuperview)
+    {
+        view = view->m_pSuperview;
+        queued = view->m_bLayoutDirty || view->m_bSubviewLayoutDirty;
+        view->m_bSubviewLayoutDirty = true;
+    }
+    
+    if (!queued)
+    {
+        s_vLayoutDirtyRoots.pushBack(view);
+    }
+    s_bLayoutPending = true;
+    
+    CAApplication::getApplication()->updateDraw();
+}
+
+void CAView::layoutIfNeeded()
+{
+    CC_RETURN_IF(!s_bLayoutPending);
+    
+    if (m_pSuperview)
+    {
+        m_pSuperview->layoutIfNeeded();
+    }
+    
+    if (m_bLayoutDirty)
+    {
+        this->resolveLayout();
+    }
+}
+
+void CAView::layoutDirtyViews()
+{
+    CC_RETURN_IF(s_vLayoutDirtyRoots.empty());
+    
+    ++s_uLayoutPassCount;
+    
+    // resolving a layout can queue new roots, e.g. from viewOnSizeTransitionDidChanged
+    while (!s_vLayoutDirtyRoots.empty())
+    {
+        CAVector<CAView*> roots = s_vLayoutDirtyRoots;
+        s_vLayoutDirtyRoots.clear();
+        
+        for (auto& root : roots)
+        {
+            root->layoutSubviewsIfNeeded();
+        }
+    }
+    
+    s_bLayoutPending = false;
+}
+
+unsigned int CAView::getLayoutPassCount()
+{
+    return s_uLayoutPassCount;
+}
+
+unsigned int CAView::getLayoutSolvedCount()
+{
+    return s_uLayoutSolvedCount;
+}
+
+void CAView::setRasterized(bool var)
+{
+    CC_RETURN_IF(m_bRasterized == var);
+    m_bRasterized = var;
+    m_bRasterDirty = true;
+    if (!m_bRasterized && m_pRasterImage)
+    {
+        this->releaseRasterImage();
+        this->updateContentAlpha();
+    }
+    CAApplication::getApplication()->updateDraw();
+}
+
+bool CAView::isRasterized()
+{
+    return m_bRasterized;
+}
+
+void CAView::setNeedsRasterize()
+{
+    m_bRasterDirty = true;
+    CAApplication::getApplication()->updateDraw();
+}
+
+void CAView::setRasterCacheLimit(unsigned long bytes)
+{
+    s_uRasterCacheLimit = bytes;
+    CAView::reserveRasterBytes(0);
+}
+
+unsigned long CAView::getRasterCacheLimit()
+{
+    return s_uRasterCacheLimit;
+}
+
+unsigned long CAView::getRasterCacheBytes()
+{
+    return s_uRasterCacheBytes;
+}
+
+unsigned int CAView::getRasterCacheHitCount()
+{
+    return s_uRasterCacheHitCount;
+}
+
+unsigned int CAView::getRasterRenderCount()
+{
+    return s_uRasterRenderCount;
+}
+
+void CAView::reViewlayoutSubviews()
+{
+    for (auto& subview : m_obSubviews)
+    {
+        if (m_bRunning && subview->m_eLayoutType == 2)
+        {
+            subview->setNeedsLayout();
+        }
+        else
+        {
+            subview->reViewlayout(m_obContentSize);
+        }
+    }
+}
+
+void CAView::resolveLayout()
+{
+    m_bLayoutDirty = false;
+    ++s_uLayoutSolvedCount;
+    
+    if (m_pSuperview)
+    {
+        this->reViewlayout(m_pSuperview->m_obContentSize);
+    }
+    else if (m_pParentCGNode)
+    {
+        this->reViewlayout(m_pParentCGNode->m_obContentSize);
+    }
+}
+
+void CAView::layoutSubviewsIfNeeded()
+{
+    if (m_bLayoutDirty)
+    {
+        // subviews marked while this view resizes are picked up by the loop below
+        m_bSubviewLayoutDirty = true;
+        this->resolveLayout();
+    }
+    
+    if (m_bSubviewLayoutDirty)
+    {
+        for (unsigned int i=0; i<m_obSubviews.size(); i++)
+        {
+            m_obSubviews.at(i)->layoutSubviewsIfNeeded();
+        }
+        m_bSubviewLayoutDirty = false;
+    }
+}
+
 const DLayout& CAView::getLayout()
 {
     return m_obLayout;
@@ -851,6 +1078,8 @@ CAView * CAView::getSuperview()
 void CAView::setSuperview(CrossApp::CAView * superview)
 {
     m_pSuperview = superview;
+    m_bTransformDirty = m_bInverseDirty = m_bTransformUpdated = true;
+    this->setWorldTransformDirtyRecursively();
 }
 
 unsigned int CAView::getOrderOfArrival()
@@ -1011,6 +1240,34 @@ void CAView::reViewlayout(const DSize& contentSize, bool allowAnimation)
 
 void CAView::updateDraw()
 {
+    m_bRasterDirty = true;
+    this->updateDrawTransform();
+}
+
+void CAView::setSuperviewRasterDirty()
+{
+    // every rasterized layer above has this view baked into its texture
+    if (!s_vRasterLayers.empty())
+    {
+        for (CAView* v = m_pSuperview; v; v = v->m_pSuperview)
+        {
+            v->m_bRasterDirty = true;
+        }
+    }
+}
+
+void CAView::updateDrawTransform()
+{
+    this->setSuperviewRasterDirty();
+    
+    m_bTransformDirty = m_bInverseDirty = m_bTransformUpdated = true;
+    this->setWorldTransformDirtyRecursively();
+    m_bHitTestGridDirty = true;
+    if (m_pSuperview)
+    {
+        m_pSuperview->m_bHitTestGridDirty = true;
+    }
+    
     CAView* v = m_pSuperview;
     CC_RETURN_IF(v == NULL);
     while (v == v->getSuperview())
@@ -1019,7 +1276,6 @@ void CAView::updateDraw()
         CC_RETURN_IF(v->isVisible());
     }
     SET_DIRTY_RECURSIVELY(m_pobBatchView);
-    m_bTransformDirty = m_bInverseDirty = true;
     CAApplication::getApplication()->updateDraw();
 }
 
@@ -1083,6 +1339,7 @@ void CAView::insertSubview(CAView* subview, int z)
     }
     
     m_bReorderChildDirty = true;
+    m_bHitTestGridDirty = true;
     m_obSubviews.pushBack(subview);
     subview->_setZOrder(z);
     
@@ -1176,6 +1433,7 @@ void CAView::removeAllSubviews()
     }
 
     m_bHasChildren = false;
+    m_bHitTestGridDirty = true;
 }
 
 
@@ -1195,6 +1453,7 @@ void CAView::detachSubview(CAView *subview)
     subview->setSuperview(NULL);
     
     m_obSubviews.eraseObject(subview);
+    m_bHitTestGridDirty = true;
     
     this->updateDraw();
 }
@@ -1224,6 +1483,7 @@ void CAView::sortAllSubviews()
     if (m_bReorderChildDirty && !m_obSubviews.empty())
     {
         std::sort(m_obSubviews.begin(), m_obSubviews.end(), compareSubviewZOrder);
+        m_bHitTestGridDirty = true;
     
         if (m_pobBatchView)
         {
@@ -1244,7 +1504,9 @@ void CAView::draw()
     CC_RETURN_IF(m_pobImage == NULL);
     CC_RETURN_IF(m_pShaderProgram == NULL);
     
-    CAIMAGE_DRAW_SETUP();
+    ccGLEnable(m_eGLServerState);
+    m_pShaderProgram->use();
+    m_pShaderProgram->setUniformsForBuiltins(m_tModelViewTransform);
     
     ccGLBlendFunc(m_sBlendFunc.src, m_sBlendFunc.dst);
     ccGLBindTexture2D(m_pobImage->getName());
@@ -1300,9 +1562,9 @@ void CAView::draw()
 
 void CAView::drawShadow(CAImage* i, const ccV3F_C4B_T2F_Quad& q)
 {
-    kmGLPushMatrix();
-    
-    CAIMAGE_DRAW_SETUP();
+    ccGLEnable(m_eGLServerState);
+    m_pShaderProgram->use();
+    m_pShaderProgram->setUniformsForBuiltins(m_tModelViewTransform);
     
     ccGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     ccGLBindTexture2D(i->getName());
@@ -1337,8 +1599,6 @@ void CAView::drawShadow(CAImage* i, const ccV3F_C4B_T2F_Quad& q)
                           (void*)(offset + diff));
     
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    
-    kmGLPopMatrix();
 }
 
 void CAView::drawLeftShadow()
@@ -1453,15 +1713,34 @@ void CAView::visit()
 {
     CC_RETURN_IF(!m_bVisible);
     
-    kmGLPushMatrix();
-
-    this->transform();
+    // visited from outside the view tree (window, CGNode, CARenderImage...),
+    // leave the caller's matrix stack as it was found
+    bool isVisitRoot = (m_pSuperview == NULL || m_pSuperview != s_pVisitingView);
+    if (isVisitRoot)
+    {
+        kmGLPushMatrix();
+    }
+    
+    this->updateModelViewTransform();
     
     this->drawLeftShadow();
     this->drawRightShadow();
     this->drawTopShadow();
     this->drawBottomShadow();
     
+    if (!m_bRasterized || !this->drawRasterized())
+    {
+        this->visitContents();
+    }
+    
+    if (isVisitRoot)
+    {
+        kmGLPopMatrix();
+    }
+}
+
+void CAView::visitContents()
+{
     int minX, maxX, minY, maxY;
     bool isScissor = (bool)glIsEnabled(GL_SCISSOR_TEST);
     if (isScissor)
@@ -1476,7 +1755,7 @@ void CAView::visit()
     //m_bDisplayRange = 1;
     if (!m_bDisplayRange)
     {
-        kmMat4 min;     kmGLGetMatrix(KM_GL_MODELVIEW, &min);
+        const kmMat4& min = m_tModelViewTransform.m;
         
         kmMat4 tm;      kmMat4Identity(&tm);
         tm.mat[12]  =   m_obContentSize.width;
@@ -1520,6 +1799,9 @@ void CAView::visit()
 
     this->sortAllSubviews();
     
+    CAView* visitingView = s_pVisitingView;
+    s_pVisitingView = this;
+    
     CAVector<CAView*>::iterator itr=m_obSubviews.begin();
     while (itr!=m_obSubviews.end())
     {
@@ -1528,6 +1810,8 @@ void CAView::visit()
         itr++;
     }
     
+    // subclasses drawing through CAIMAGE_DRAW_SETUP still read the kazmath matrix
+    kmGLLoadMatrix(&m_tModelViewTransform.m);
     this->draw();
     
     while (itr!=m_obSubviews.end())
@@ -1536,8 +1820,11 @@ void CAView::visit()
         itr++;
     }
     
+    s_pVisitingView = visitingView;
+    
     if (m_pCGNode)
     {
+        kmGLLoadMatrix(&m_tModelViewTransform.m);
         m_pCGNode->visit();
     }
     
@@ -1557,8 +1844,201 @@ void CAView::visit()
             glDisable(GL_SCISSOR_TEST);
         }
     }
+}
+
+bool CAView::drawRasterized()
+{
+    if (m_pCGNode || m_pobBatchView)
+    {
+        return false;
+    }
+    
+    int pixelsWide = (int)ceilf(s_dip_to_px(m_obContentSize.width));
+    int pixelsHigh = (int)ceilf(s_dip_to_px(m_obContentSize.height));
+    if (pixelsWide <= 0 || pixelsHigh <= 0)
+    {
+        return true;
+    }
+    
+    // CARenderImage rounds its texture up to even dimensions
+    unsigned int texturesWide = (pixelsWide + 1) / 2 * 2;
+    unsigned int texturesHigh = (pixelsHigh + 1) / 2 * 2;
+    unsigned long bytes = (unsigned long)texturesWide * texturesHigh * 4;
+    
+    bool hadRasterImage = (m_pRasterImage != NULL);
+    if (m_pRasterImage && m_uRasterBytes != bytes)
+    {
+        this->releaseRasterImage();
+    }
+    
+    m_uRasterFrame = CAApplication::getApplication()->getTotalFrames();
+    
+    if (m_pRasterImage == NULL)
+    {
+        // layers drawn in this frame are never evicted, draw directly rather than thrash them
+        if (CAView::reserveRasterBytes(bytes))
+        {
+            m_pRasterImage = CARenderImage::create(pixelsWide, pixelsHigh);
+            CC_SAFE_RETAIN(m_pRasterImage);
+        }
+        if (m_pRasterImage)
+        {
+            m_uRasterBytes = bytes;
+            s_uRasterCacheBytes += bytes;
+            s_vRasterLayers.push_back(this);
+            m_bRasterDirty = true;
+        }
+        if (hadRasterImage != (m_pRasterImage != NULL))
+        {
+            this->updateContentAlpha();
+        }
+        CC_RETURN_IF(m_pRasterImage == NULL) false;
+    }
+    
+    CC_RETURN_IF(_displayedAlpha <= 0.0f) true;
+    
+    if (m_bRasterDirty || m_pRasterImage->m_bTargetLost)
+    {
+        this->renderRasterImage(texturesWide, texturesHigh);
+        m_bRasterDirty = false;
+        ++s_uRasterRenderCount;
+    }
+    else
+    {
+        ++s_uRasterCacheHitCount;
+    }
+    
+    GLfloat maxS = pixelsWide / (GLfloat)texturesWide;
+    GLfloat maxT = pixelsHigh / (GLfloat)texturesHigh;
+    
+    ccV3F_C4B_T2F_Quad quad;
+    quad.bl.vertices = DPoint3D(0, 0, m_fVertexZ);
+    quad.br.vertices = DPoint3D(m_obContentSize.width, 0, m_fVertexZ);
+    quad.tl.vertices = DPoint3D(0, m_obContentSize.height, m_fVertexZ);
+    quad.tr.vertices = DPoint3D(m_obContentSize.width, m_obContentSize.height, m_fVertexZ);
+    quad.bl.texCoords = tex2(0, 0);
+    quad.br.texCoords = tex2(maxS, 0);
+    quad.tl.texCoords = tex2(0, maxT);
+    quad.tr.texCoords = tex2(maxS, maxT);
+    // the layer holds its contents at full alpha and is faded as a whole here.
+    // Colors are not inherited by subviews, the view's own color is already in the layer
+    GLubyte alpha = (GLubyte)(_displayedAlpha * 255);
+    quad.bl.colors = quad.br.colors = quad.tl.colors = quad.tr.colors = ccc4(alpha, alpha, alpha, alpha);
+    
+    CAGLProgram* program = CAShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionTextureColor);
+    program->use();
+    program->setUniformsForBuiltins(m_tModelViewTransform);
+    
+    // the layer was blended onto transparent black, its colors are premultiplied
+    ccGLBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    ccGLBindTexture2D(m_pRasterImage->m_uName);
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_PosColorTex);
+    
+    long offset = (long)&quad;
+    glVertexAttribPointer(kCCVertexAttrib_Position, 3, GL_FLOAT, GL_FALSE, sizeof(quad.bl), (void*)(offset + offsetof(ccV3F_C4B_T2F, vertices)));
+    glVertexAttribPointer(kCCVertexAttrib_TexCoords, 2, GL_FLOAT, GL_FALSE, sizeof(quad.bl), (void*)(offset + offsetof(ccV3F_C4B_T2F, texCoords)));
+    glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(quad.bl), (void*)(offset + offsetof(ccV3F_C4B_T2F, colors)));
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    
+    return true;
+}
 
-    kmGLPopMatrix();
+void CAView::renderRasterImage(unsigned int texturesWide, unsigned int texturesHigh)
+{
+    // render the subtree in this view's own space, with its bottom left corner on the first pixel.
+    // visit() shifts scissor boxes by half the window in 3D projection, the subtree is shifted back
+    // by the same amount so that clipping subviews still land on the right pixels
+    CAApplication* application = CAApplication::getApplication();
+    DPoint offset = DPointZero;
+    if (application->getProjection() == CAApplication::P3D)
+    {
+        offset = DPoint(application->getWinSize().width/2, application->getWinSize().height/2);
+    }
+    
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLint scissorBox[4];
+    glGetIntegerv(GL_SCISSOR_BOX, scissorBox);
+    bool isScissor = (bool)glIsEnabled(GL_SCISSOR_TEST);
+    glDisable(GL_SCISSOR_TEST);
+    
+    m_pRasterImage->beginWithClear(CAColor_clear);
+    
+    kmGLMatrixMode(KM_GL_PROJECTION);
+    kmGLLoadIdentity();
+    kmMat4 orthoMatrix;
+    kmMat4OrthographicProjection(&orthoMatrix,
+                                 -offset.x,
+                                 -offset.x + s_px_to_dip(texturesWide),
+                                 -offset.y,
+                                 -offset.y + s_px_to_dip(texturesHigh),
+                                 -1024,
+                                 1024);
+    kmGLMultMatrix(&orthoMatrix);
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+    kmGLLoadIdentity();
+    
+    Mat4 modelViewTransform = m_tModelViewTransform;
+    m_tModelViewTransform = Mat4::IDENTITY;
+    m_tModelViewTransform.translate(-offset.x, -offset.y, 0);
+    m_uModelViewVersion = nextModelViewVersion();
+    
+    this->visitContents();
+    
+    m_tModelViewTransform = modelViewTransform;
+    m_uModelViewVersion = nextModelViewVersion();
+    
+    // the layer is drawn straight from the render target, a copy per pass would double its memory
+    m_pRasterImage->endWithoutImage();
+    
+    // end() resets the window viewport, which is wrong inside an enclosing layer
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glScissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+    if (isScissor)
+    {
+        glEnable(GL_SCISSOR_TEST);
+    }
+}
+
+void CAView::releaseRasterImage()
+{
+    CC_RETURN_IF(m_pRasterImage == NULL);
+    
+    std::vector<CAView*>::iterator itr = std::find(s_vRasterLayers.begin(), s_vRasterLayers.end(), this);
+    if (itr != s_vRasterLayers.end())
+    {
+        s_vRasterLayers.erase(itr);
+    }
+    s_uRasterCacheBytes -= m_uRasterBytes;
+    m_uRasterBytes = 0;
+    CC_SAFE_RELEASE_NULL(m_pRasterImage);
+    m_bRasterDirty = true;
+}
+
+bool CAView::reserveRasterBytes(unsigned long bytes)
+{
+    unsigned int frame = CAApplication::getApplication()->getTotalFrames();
+    
+    // evict the least recently drawn layers until the new one fits
+    while (s_uRasterCacheBytes + bytes > s_uRasterCacheLimit)
+    {
+        CAView* oldest = NULL;
+        for (std::vector<CAView*>::iterator itr=s_vRasterLayers.begin(); itr!=s_vRasterLayers.end(); ++itr)
+        {
+            CC_CONTINUE_IF((*itr)->m_uRasterFrame == frame);
+            if (oldest == NULL || (*itr)->m_uRasterFrame < oldest->m_uRasterFrame)
+            {
+                oldest = *itr;
+            }
+        }
+        if (oldest == NULL)
+        {
+            return false;
+        }
+        oldest->releaseRasterImage();
+        oldest->updateContentAlpha();
+    }
+    return true;
 }
 
 void CAView::visitEve(void)
@@ -1620,6 +2100,9 @@ void CAView::onEnter()
         }
     }
 #endif
+    // entering resolves the whole subtree right away, pending layouts inside it are obsolete
+    m_bLayoutDirty = m_bSubviewLayoutDirty = false;
+    
     if (m_pSuperview)
     {
         this->reViewlayout(m_pSuperview->m_obContentSize);
@@ -1913,7 +2396,12 @@ void CAView::setViewToSuperviewTransform(const Mat4& transform)
 {
     m_tTransform = transform;
     m_bTransformDirty = false;
-    m_bTransformUpdated = true;
+    m_bTransformUpdated = m_bInverseDirty = true;
+    this->setWorldTransformDirtyRecursively();
+    if (m_pSuperview)
+    {
+        m_pSuperview->m_bHitTestGridDirty = true;
+    }
 }
 
 void CAView::setAdditionalTransform(const AffineTransform& additionalTransform)
@@ -1935,6 +2423,11 @@ void CAView::setAdditionalTransform(Mat4* additionalTransform)
         m_bUseAdditionalTransform = true;
     }
     m_bTransformUpdated = m_bTransformDirty = m_bInverseDirty = true;
+    this->setWorldTransformDirtyRecursively();
+    if (m_pSuperview)
+    {
+        m_pSuperview->m_bHitTestGridDirty = true;
+    }
 }
 
 
@@ -1960,60 +2453,200 @@ const Mat4& CAView::getSuperviewToViewTransform() const
 
 AffineTransform CAView::getViewToWorldAffineTransform() const
 {
-    return this->getViewToSuperviewAffineTransform(nullptr);
+    AffineTransform ret;
+    GLToCGAffine(this->getViewToWorldTransform().m.mat, &ret);
+    
+    return ret;
 }
 
 Mat4 CAView::getViewToWorldTransform() const
 {
-    return this->getViewToSuperviewTransform(nullptr);
+    if (m_bViewToWorldDirty)
+    {
+        if (m_pSuperview)
+        {
+            Mat4::multiply(m_pSuperview->getViewToWorldTransform(), this->getViewToSuperviewTransform(), &m_tViewToWorldTransform);
+            // stays dirty while the superview can't cache its own
+            m_bViewToWorldDirty = m_pSuperview->m_bViewToWorldDirty;
+        }
+        else if (CGNode *p = m_pParentCGNode)
+        {
+            // CGNode doesn't notify its views when it moves, never keep this one
+            Mat4::multiply(p->getNodeToParentTransform(nullptr), this->getViewToSuperviewTransform(), &m_tViewToWorldTransform);
+        }
+        else
+        {
+            m_tViewToWorldTransform = this->getViewToSuperviewTransform();
+            m_bViewToWorldDirty = false;
+        }
+    }
+    
+    return m_tViewToWorldTransform;
 }
 
 AffineTransform CAView::getWorldToViewAffineTransform() const
 {
-    return AffineTransformInvert(this->getViewToWorldAffineTransform());
+    AffineTransform ret;
+    GLToCGAffine(this->getWorldToViewTransform().m.mat, &ret);
+    
+    return ret;
 }
 
 Mat4 CAView::getWorldToViewTransform() const
 {
-    return getViewToWorldTransform().getInversed();
+    if (m_bWorldToViewDirty || m_bViewToWorldDirty)
+    {
+        m_tWorldToViewTransform = this->getViewToWorldTransform().getInversed();
+        m_bWorldToViewDirty = m_bViewToWorldDirty;
+    }
+    
+    return m_tWorldToViewTransform;
 }
 
-void CAView::transformAncestors()
+void CAView::setWorldTransformDirtyRecursively(void)
 {
-    if( m_pSuperview != NULL  )
+    // a dirty view never has a clean descendant, nothing left to do below it
+    CC_RETURN_IF(m_bViewToWorldDirty);
+    
+    m_bViewToWorldDirty = m_bWorldToViewDirty = true;
+    
+    for (auto& subview : m_obSubviews)
     {
-        m_pSuperview->transformAncestors();
-        m_pSuperview->transform();
+        subview->setWorldTransformDirtyRecursively();
     }
 }
 
-void CAView::transform()
+bool CAView::updateModelViewTransform(void)
 {
-    kmMat4 transfrom4x4 = this->getViewToSuperviewTransform().m;
+    bool dirty = m_bTransformUpdated || m_pCamera != NULL;
+    
+    const Mat4* parentTransform = NULL;
+    
+    if (m_pSuperview && m_pSuperview == s_pVisitingView)
+    {
+        parentTransform = &m_pSuperview->m_tModelViewTransform;
+        if (m_uParentModelViewVersion != m_pSuperview->m_uModelViewVersion)
+        {
+            m_uParentModelViewVersion = m_pSuperview->m_uModelViewVersion;
+            dirty = true;
+        }
+    }
+    else
+    {
+        Mat4 matrixMV;
+        kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV.m);
+        if (m_uParentModelViewVersion != 0
+            || memcmp(matrixMV.m.mat, m_tParentModelViewTransform.m.mat, sizeof(matrixMV.m.mat)) != 0)
+        {
+            m_tParentModelViewTransform = matrixMV;
+            m_uParentModelViewVersion = 0;
+            dirty = true;
+        }
+        parentTransform = &m_tParentModelViewTransform;
+    }
+    
+    if (!dirty)
+    {
+        return false;
+    }
     
-    kmGLMultMatrix( &transfrom4x4 );
+    Mat4::multiply(*parentTransform, this->getViewToSuperviewTransform(), &m_tModelViewTransform);
     
-    // XXX: Expensive calls. Camera should be integrated into the cached affine matrix
-    if ( m_pCamera != NULL)
+    if (m_pCamera != NULL)
     {
         DPoint anchorPointInPoints = DPoint(m_obAnchorPointInPoints.x,
                                             m_obContentSize.height - m_obAnchorPointInPoints.y);
         
-        bool translate = (anchorPointInPoints.x != 0.0f || anchorPointInPoints.y != 0.0f);
-        
-        if( translate )
-            kmGLTranslatef(RENDER_IN_SUBPIXEL(anchorPointInPoints.x),
-                           RENDER_IN_SUBPIXEL(anchorPointInPoints.y),
-                           0 );
+        m_tModelViewTransform.translate(RENDER_IN_SUBPIXEL(anchorPointInPoints.x),
+                                        RENDER_IN_SUBPIXEL(anchorPointInPoints.y),
+                                        0);
         
-        m_pCamera->locate();
+        m_tModelViewTransform.multiply(Mat4(m_pCamera->getLookupMatrix().mat));
         
-        if( translate )
-            kmGLTranslatef(RENDER_IN_SUBPIXEL(-anchorPointInPoints.x),
-                           RENDER_IN_SUBPIXEL(-anchorPointInPoints.y),
-                           0 );
+        m_tModelViewTransform.translate(RENDER_IN_SUBPIXEL(-anchorPointInPoints.x),
+                                        RENDER_IN_SUBPIXEL(-anchorPointInPoints.y),
+                                        0);
+    }
+    
+    m_uModelViewVersion = nextModelViewVersion();
+    m_bTransformUpdated = false;
+    
+    return true;
+}
+
+const CAHitTestGrid* CAView::getHitTestGrid()
+{
+    if (m_obSubviews.size() < CAHitTestGrid::kMinimumItems)
+    {
+        CC_SAFE_DELETE(m_pHitTestGrid);
+        m_bHitTestGridDirty = true;
+        return NULL;
+    }
+
+    if (m_pHitTestGrid == NULL)
+    {
+        m_pHitTestGrid = new CAHitTestGrid();
+        m_bHitTestGridDirty = true;
+    }
+
+    if (m_bHitTestGridDirty)
+    {
+        std::vector<CAHitTestGrid::Box> boxes;
+        boxes.reserve(m_obSubviews.size());
+
+        for (auto& subview : m_obSubviews)
+        {
+            const Mat4& t = subview->getViewToSuperviewTransform();
+
+            // boxes are only exact for transforms that keep the view in the xy plane
+            if (t.m.mat[2] != 0 || t.m.mat[3] != 0 || t.m.mat[6] != 0 || t.m.mat[7] != 0
+                || t.m.mat[8] != 0 || t.m.mat[9] != 0 || t.m.mat[11] != 0 || t.m.mat[15] != 1.0f)
+            {
+                boxes.push_back(CAHitTestGrid::Box::infinite());
+                continue;
+            }
+
+            const DSize& size = subview->m_obContentSize;
+            float xs[4] = {0, size.width, 0, size.width};
+            float ys[4] = {0, 0, size.height, size.height};
+
+            CAHitTestGrid::Box box = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+            for (int i=0; i<4; i++)
+            {
+                float x = t.m.mat[0] * xs[i] + t.m.mat[4] * ys[i] + t.m.mat[12];
+                float y = m_obContentSize.height - (t.m.mat[1] * xs[i] + t.m.mat[5] * ys[i] + t.m.mat[13]);
+                box.minX = MIN(box.minX, x);
+                box.maxX = MAX(box.maxX, x);
+                box.minY = MIN(box.minY, y);
+                box.maxY = MAX(box.maxY, y);
+            }
+
+            // leave room for the rounding of the exact test done through the inverse transform
+            box.minX -= 1.0f, box.minY -= 1.0f, box.maxX += 1.0f, box.maxY += 1.0f;
+            boxes.push_back(box);
+        }
+
+        m_pHitTestGrid->build(boxes);
+        m_bHitTestGridDirty = false;
     }
+
+    return m_pHitTestGrid;
+}
+
+void CAView::transformAncestors()
+{
+    if( m_pSuperview != NULL  )
+    {
+        m_pSuperview->transformAncestors();
+        m_pSuperview->transform();
+    }
+}
+
+void CAView::transform()
+{
+    this->updateModelViewTransform();
     
+    kmGLLoadMatrix(&m_tModelViewTransform.m);
 }
 
 void CAView::updateTransform()
@@ -2041,36 +2674,29 @@ void CAView::updateTransform()
             }
             
             DSize size = m_obContentSize;
-
+            
             float x1 = 0;
             float y1 = 0;
             
             float x2 = x1 + size.width;
             float y2 = y1 + size.height;
             
-            float x = m_tTransformToBatch.m.mat[12];
-            float y = m_tTransformToBatch.m.mat[13];
-            
-            float cr = m_tTransformToBatch.m.mat[0];
-            float sr = m_tTransformToBatch.m.mat[1];
-            float cr2 = m_tTransformToBatch.m.mat[5];
-            float sr2 = -m_tTransformToBatch.m.mat[4];
-            float ax = x1 * cr - y1 * sr2 + x;
-            float ay = x1 * sr + y1 * cr2 + y;
-            
-            float bx = x2 * cr - y1 * sr2 + x;
-            float by = x2 * sr + y1 * cr2 + y;
+            m_sQuad.bl.vertices = DPoint3D(x1, y1, 0);
+            m_sQuad.br.vertices = DPoint3D(x2, y1, 0);
+            m_sQuad.tl.vertices = DPoint3D(x1, y2, 0);
+            m_sQuad.tr.vertices = DPoint3D(x2, y2, 0);
             
-            float cx = x2 * cr - y2 * sr2 + x;
-            float cy = x2 * sr + y2 * cr2 + y;
+            MathUtil::transformQuads(m_tTransformToBatch, &m_sQuad, &m_sQuad, 1);
             
-            float dx = x1 * cr - y2 * sr2 + x;
-            float dy = x1 * sr + y2 * cr2 + y;
-            
-            m_sQuad.bl.vertices = DPoint3D(RENDER_IN_SUBPIXEL(ax), RENDER_IN_SUBPIXEL(ay), m_fVertexZ);
-            m_sQuad.br.vertices = DPoint3D(RENDER_IN_SUBPIXEL(bx), RENDER_IN_SUBPIXEL(by), m_fVertexZ);
-            m_sQuad.tl.vertices = DPoint3D(RENDER_IN_SUBPIXEL(dx), RENDER_IN_SUBPIXEL(dy), m_fVertexZ);
-            m_sQuad.tr.vertices = DPoint3D(RENDER_IN_SUBPIXEL(cx), RENDER_IN_SUBPIXEL(cy), m_fVertexZ);
+            m_sQuad.bl.vertices.z = m_sQuad.br.vertices.z = m_sQuad.tl.vertices.z = m_sQuad.tr.vertices.z = m_fVertexZ;
+#if !CC_NODE_RENDER_SUBPIXEL
+            ccV3F_C4B_T2F* vertex = &m_sQuad.tl;
+            for (int i = 0; i < 4; ++i)
+            {
+                vertex[i].vertices.x = RENDER_IN_SUBPIXEL(vertex[i].vertices.x);
+                vertex[i].vertices.y = RENDER_IN_SUBPIXEL(vertex[i].vertices.y);
+            }
+#endif
         }
         
         if (m_pobImageAtlas)
@@ -2213,6 +2839,10 @@ void CAView::setImageRect(const DRect& rect)
         {
             this->updateImageRect();
         }
+        
+        m_bRasterDirty = true;
+        this->setSuperviewRasterDirty();
+        CAApplication::getApplication()->updateDraw();
     }
 }
 
@@ -2344,7 +2974,11 @@ void CAView::setAlpha(float alpha)
     {
         _realAlpha = alpha;
         
-        float superviewAlpha = m_pSuperview ? m_pSuperview->getDisplayedAlpha() : 1.0f;
+        float superviewAlpha = 1.0f;
+        if (m_pSuperview && m_pSuperview->m_pRasterImage == NULL)
+        {
+            superviewAlpha = m_pSuperview->getDisplayedAlpha();
+        }
         
         this->updateDisplayedAlpha(superviewAlpha);
     }
@@ -2354,11 +2988,27 @@ void CAView::updateDisplayedAlpha(float superviewAlpha)
 {
 	_displayedAlpha = _realAlpha * superviewAlpha;
 	
+    // a cached layer is faded when it is composited, its contents stay as they are
+    if (m_pRasterImage)
+    {
+        this->setSuperviewRasterDirty();
+        CAApplication::getApplication()->updateDraw();
+        return;
+    }
+    
+    this->updateContentAlpha();
+}
+
+void CAView::updateContentAlpha()
+{
+    // the contents of a cached layer are drawn at full alpha
+    float alpha = m_pRasterImage ? 1.0f : _displayedAlpha;
+    
     if (!m_obSubviews.empty())
     {
         CAVector<CAView*>::iterator itr;
         for (itr=m_obSubviews.begin(); itr!=m_obSubviews.end(); itr++)
-            (*itr)->updateDisplayedAlpha(_displayedAlpha);
+            (*itr)->updateDisplayedAlpha(alpha);
     }
 
     this->updateColor();
@@ -2402,7 +3052,7 @@ void CAView::updateDisplayedColor(const CAColor4B& superviewColor)
 void CAView::updateColor(void)
 {
     CAColor4B color4 = _displayedColor;
-    color4.a = color4.a * _displayedAlpha;
+    color4.a = color4.a * (m_pRasterImage ? 1.0f : _displayedAlpha);
     
     if (m_bOpacityModifyRGB)
     {
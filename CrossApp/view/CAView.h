@@ -40,6 +40,7 @@ class CAViewAnimation;
 class CARenderImage;
 class CGNode;
 class CGSprite;
+class CAHitTestGrid;
 
 //script
 enum {
@@ -155,6 +156,48 @@ public:
     
     const DLayout& getLayout();
     
+    /** schedules this view's DLayout to be resolved by the next layout pass instead of right away */
+    void setNeedsLayout();
+    
+    /** resolves the pending DLayout of this view and its superviews now, so its frame can be read */
+    void layoutIfNeeded();
+    
+    /** resolves every pending DLayout top-down, CAApplication calls it once per frame before drawing */
+    static void layoutDirtyViews();
+    
+    /** number of layout passes that had pending views */
+    static unsigned int getLayoutPassCount();
+    
+    /** number of views whose DLayout was resolved by layout passes or layoutIfNeeded */
+    static unsigned int getLayoutSolvedCount();
+    
+    /**
+     * When rasterized, the view renders itself and its subviews once into a texture and
+     * draws that texture as a single quad until something inside the subtree changes.
+     * Meant for complex subtrees that rarely change; content outside the view's bounds
+     * is clipped, and views hosting a CGNode are always drawn directly.
+     */
+    virtual void setRasterized(bool var);
+    
+    bool isRasterized();
+    
+    /** discards the rasterized layer, the subtree is rendered again on its next visit */
+    void setNeedsRasterize();
+    
+    /** upper bound, in bytes, for the textures of all rasterized layers together */
+    static void setRasterCacheLimit(unsigned long bytes);
+    
+    static unsigned long getRasterCacheLimit();
+    
+    /** bytes currently held by rasterized layers */
+    static unsigned long getRasterCacheBytes();
+    
+    /** number of rasterized layers drawn from their cached texture */
+    static unsigned int getRasterCacheHitCount();
+    
+    /** number of times a rasterized layer had to render its subtree */
+    static unsigned int getRasterRenderCount();
+    
     virtual void setVisible(bool visible);
 
     virtual bool isVisible();
@@ -260,6 +303,11 @@ public:
     virtual Mat4 getWorldToViewTransform() const;
     virtual AffineTransform getWorldToViewAffineTransform() const;
     
+    inline const Mat4& getModelViewTransform() const { return m_tModelViewTransform; }
+    
+    /** spatial index of the subviews used for touch hit-testing, NULL when there are too few subviews to need one */
+    const CAHitTestGrid* getHitTestGrid(void);
+    
     void setAdditionalTransform(Mat4* additionalTransform);
     void setAdditionalTransform(const AffineTransform& additionalTransform);
 
@@ -367,6 +415,9 @@ protected:
     
     virtual void updateDraw();
     
+    /** like updateDraw, for changes that only move the view and leave its own content as is */
+    void updateDrawTransform();
+    
     virtual void updateColor(void);
     
     virtual void setPoint(const DPoint &point);
@@ -385,6 +436,18 @@ protected:
     
     virtual void setReorderSubviewDirtyRecursively(void);
     
+    void setWorldTransformDirtyRecursively(void);
+    
+    bool updateModelViewTransform(void);
+    
+    inline void setHitTestGridDirty(void) { m_bHitTestGridDirty = true; }
+    
+    void reViewlayoutSubviews(void);
+    
+    void resolveLayout(void);
+    
+    void layoutSubviewsIfNeeded(void);
+    
     virtual void setDirtyRecursively(bool bValue);
 
     virtual void updateBlendFunc(void);
@@ -403,6 +466,20 @@ protected:
     
     void drawShadow(CAImage* i, const ccV3F_C4B_T2F_Quad& q);
     
+    void visitContents();
+    
+    bool drawRasterized();
+    
+    void renderRasterImage(unsigned int texturesWide, unsigned int texturesHigh);
+    
+    void releaseRasterImage();
+    
+    void setSuperviewRasterDirty();
+    
+    void updateContentAlpha();
+    
+    static bool reserveRasterBytes(unsigned long bytes);
+    
 protected:
  
     CC_SYNTHESIZE(CAContentContainer*, m_pContentContainer, ContentContainer);
@@ -434,6 +511,8 @@ protected:
     DSize                       m_obContentSize;
     
     DLayout                     m_obLayout;
+    bool                        m_bLayoutDirty;              ///< m_obLayout has to be resolved against the superview again
+    bool                        m_bSubviewLayoutDirty;       ///< some descendant has a pending layout
     DRect                       m_obReturn;
     
     CACamera*                   m_pCamera;
@@ -452,8 +531,27 @@ protected:
     bool                        m_bUseAdditionalTransform;   ///< The flag to check whether the additional transform is dirty
     bool                        m_bTransformUpdated;         ///< Whether or not the Transform object was updated since the last
     
+    mutable Mat4                m_tViewToWorldTransform;     ///< cached view to world transform
+    mutable bool                m_bViewToWorldDirty;         ///< set when this view or any ancestor changes its transform
+    mutable Mat4                m_tWorldToViewTransform;     ///< cached world to view transform
+    mutable bool                m_bWorldToViewDirty;         ///< world to view transform dirty flag
+    
+    Mat4                        m_tModelViewTransform;       ///< cached model view matrix used for drawing
+    Mat4                        m_tParentModelViewTransform; ///< model view matrix of the caller when visited outside of its superview
+    unsigned int                m_uModelViewVersion;         ///< changes every time m_tModelViewTransform is recomputed
+    unsigned int                m_uParentModelViewVersion;   ///< superview's m_uModelViewVersion when m_tModelViewTransform was computed, 0 if not derived from it
+    
     Mat4                        m_tTransformToBatch;
     
+    CAHitTestGrid*              m_pHitTestGrid;              ///< subview bounding boxes in this view's node space
+    bool                        m_bHitTestGridDirty;         ///< set when a subview moves, resizes or the subview order changes
+    
+    bool                        m_bRasterized;
+    bool                        m_bRasterDirty;              ///< the subtree changed since m_pRasterImage was rendered
+    CARenderImage*              m_pRasterImage;              ///< cached rendering of the subtree in this view's own space
+    unsigned long               m_uRasterBytes;              ///< texture memory of m_pRasterImage
+    unsigned int                m_uRasterFrame;              ///< last frame the layer was drawn, for eviction
+    
     unsigned int                m_uOrderOfArrival;
     ccGLServerState             m_eGLServerState;
     CAGLProgram*                m_pShaderProgram;
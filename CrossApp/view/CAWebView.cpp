@@ -16,6 +16,10 @@
 #include "platform/win32/CAWebViewImpl.h"
 #endif
 
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#include "platform/linux/CAWebViewImpl.h"
+#endif
+
 
 NS_CC_BEGIN
 
@@ -69,22 +69,16 @@ static void avStreamFPSTimeBase(AVStream *st, float defaultTimeBase, float *pFPS
     }
 }
 
-static void copyFrameData(unsigned char *src, unsigned char **dst, int linesize, int width, int height, int *dstLength)
+#define kDefaultVideoFramePoolSize 16
+
+// behind by more than this, the codec skips frames nothing else refers to
+#define kSkipNonRefFramesLag 0.5f
+
+static double currentTime()
 {
-	if (dst) 
-	{
-        width = MIN(linesize, width);
-        *dst = (unsigned char*)new char[width * height];
-        if (dstLength) {
-            *dstLength = width * height;
-        }
-        unsigned char* tmp = *dst;
-        for (int i=0; i<height; ++i) {
-            memcpy(tmp, src, width);
-            tmp += width;
-            src += linesize;
-        }
-    }
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1000000.0;
 }
 
 static SDL_AudioSpec s_audioSpec;
@@ -114,8 +108,15 @@ VPAudioFrame::~VPAudioFrame()
 VPVideoFrame::VPVideoFrame()
 : m_height(0)
 , m_width(0)
+, m_serial(0)
 {
     m_type = kFrameTypeVideo;
+    m_pAVFrame = av_frame_alloc();
+}
+
+VPVideoFrame::~VPVideoFrame()
+{
+    av_frame_free(&m_pAVFrame);
 }
 
 
@@ -129,7 +130,6 @@ VPVideoFrameRGB::VPVideoFrameRGB()
 
 VPVideoFrameRGB::~VPVideoFrameRGB()
 {
-	CC_SAFE_DELETE_ARRAY(m_data);
 }
 
 VPVideoFrameYUV::VPVideoFrameYUV()
@@ -139,15 +139,14 @@ VPVideoFrameYUV::VPVideoFrameYUV()
 , m_chromaRLength(0)
 , m_luma(NULL)
 , m_lumaLength(0)
+, m_lumaLineSize(0)
+, m_chromaLineSize(0)
 {
     m_format = kVideoFrameFormatYUV;
 }
 
 VPVideoFrameYUV::~VPVideoFrameYUV()
 {
-	CC_SAFE_DELETE_ARRAY(m_luma);
-	CC_SAFE_DELETE_ARRAY(m_chromaB);
-	CC_SAFE_DELETE_ARRAY(m_chromaR);
 }
 
 
@@ -172,7 +171,12 @@ VPDecoder::VPDecoder()
 , m_audioCallback(NULL)
 , m_pAudioCallbackTarget(NULL)
 , m_pAVPicture(NULL)
+, m_uVideoFramePoolSize(kDefaultVideoFramePoolSize)
+, m_uAllocatedVideoFrames(0)
+, m_uVideoFrameSerial(0)
+, m_fDropFramesBefore(0)
 {
+	memset(&m_tDecodeStats, 0, sizeof(VPDecodeStats));
 	av_register_all();
 	avcodec_register_all();
     avformat_network_init();
@@ -226,6 +230,7 @@ float VPDecoder::getPosition()
 void VPDecoder::setPosition(float seconds)
 {
 	m_fPosition = seconds;
+    m_fDropFramesBefore = 0;
     _isEOF = false;
     
 //    if (m_iAudioStream != -1)
@@ -259,6 +264,16 @@ float VPDecoder::getSampleRate()
 }
 
 
+unsigned int VPDecoder::getAudioBytesPerSecond()
+{
+    return s_audioSpec.freq * s_audioSpec.channels * av_get_bytes_per_sample(AV_SAMPLE_FMT_S16);
+}
+
+void VPDecoder::resetDecodeStats()
+{
+    memset(&m_tDecodeStats, 0, sizeof(VPDecodeStats));
+}
+
 bool VPDecoder::isValidAudio()
 {
 	return m_iAudioStream != -1;
@@ -397,6 +412,12 @@ VPError VPDecoder::openVideoStream(int videoStream)
     if (!codec)
         return kErrorCodecNotFound;
     
+    // decode on all cores, and let decoded pictures outlive the next decode call
+    // so the pooled frames can reference them instead of copying
+    codecCtx->thread_count = 0;
+    codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    codecCtx->refcounted_frames = 1;
+    
     // open codec
     if (avcodec_open2(codecCtx, codec, NULL) < 0)
         return kErrorOpenCodec;
@@ -584,6 +605,7 @@ void VPDecoder::closeVideoStream()
     m_iVideoStream = -1;
     
     this->closeScaler();
+    this->clearVideoFramePool();
     
     if (m_pVideoFrame) {
 
@@ -637,23 +659,12 @@ void VPDecoder::closeScaler()
         sws_freeContext(m_pSwsContext);
         m_pSwsContext = NULL;
     }
-    
-	if (m_pAVPicture) {
-		avpicture_free(m_pAVPicture);
-		m_pAVPicture = NULL;
-    }
 }
 
 bool VPDecoder::setupScaler()
 {
     this->closeScaler();
     
-	if (avpicture_alloc(m_pAVPicture,
-		AV_PIX_FMT_RGB24,
-		m_pVideoCodecCtx->width,
-		m_pVideoCodecCtx->height))
-		return false;
-
 	m_pSwsContext = sws_getContext(m_pVideoCodecCtx->width,
 		m_pVideoCodecCtx->height,
 		m_pVideoCodecCtx->pix_fmt,
@@ -670,83 +681,209 @@ VPVideoFrame* VPDecoder::handleVideoFrame()
 	if (m_pVideoFrame==NULL || !m_pVideoFrame->data[0])
         return NULL;
 
-    VPVideoFrame *frame = NULL;
+    const float position = av_frame_get_best_effort_timestamp(m_pVideoFrame) * m_fVideoTimeBase;
+    
+    float duration = 1.0 / _fps;
+	const long long frameDuration = av_frame_get_pkt_duration(m_pVideoFrame);
+    if (frameDuration) {
+        
+        duration = frameDuration * m_fVideoTimeBase + m_pVideoFrame->repeat_pict * m_fVideoTimeBase * 0.5;
+    } 
+    // else: sometimes, ffmpeg unable to determine a frame duration
+    // as example yuvj420p stream from web camera
+    
+    if (position + duration < m_fDropFramesBefore)
+    {
+        // already late, not worth converting or uploading
+        ++m_tDecodeStats.droppedFrames;
+        m_fPosition = position;
+        av_frame_unref(m_pVideoFrame);
+        return NULL;
+    }
+
+    VPVideoFrame *frame = this->obtainVideoFrame();
+    if (frame == NULL)
+    {
+        av_frame_unref(m_pVideoFrame);
+        return NULL;
+    }
+    
+    const int width = m_pVideoCodecCtx->width;
+    const int height = m_pVideoCodecCtx->height;
     
 	if (m_videoFrameFormat == kVideoFrameFormatYUV) {
         
-        VPVideoFrameYUV * yuvFrame = new VPVideoFrameYUV();
+        VPVideoFrameYUV * yuvFrame = (VPVideoFrameYUV *)frame;
+        
+        // take over the decoder's reference, the planes are not copied
+        AVFrame* picture = yuvFrame->getAVFrame();
+        av_frame_move_ref(picture, m_pVideoFrame);
+        
+        const int chromaHeight = (height + 1) / 2;
+        
+        yuvFrame->setLuma((char*)picture->data[0]);
+        yuvFrame->setLumaLineSize(picture->linesize[0]);
+        yuvFrame->setLumaLength(picture->linesize[0] * height);
         
-        unsigned char* data = NULL;
-        int dataLength = 0;
+        yuvFrame->setChromaB((char*)picture->data[1]);
+        yuvFrame->setChromaBLength(picture->linesize[1] * chromaHeight);
         
-		copyFrameData(m_pVideoFrame->data[0], &data,
-						m_pVideoFrame->linesize[0],
-						m_pVideoCodecCtx->width,
-						m_pVideoCodecCtx->height,
-                      &dataLength);
-        yuvFrame->setLuma((char*)data);
-        yuvFrame->setLumaLength(dataLength);
-
-		copyFrameData(m_pVideoFrame->data[1], &data,
-						m_pVideoFrame->linesize[1],
-						m_pVideoCodecCtx->width / 2,
-						m_pVideoCodecCtx->height / 2,
-                      &dataLength);
-        yuvFrame->setChromaB((char*)data);
-        yuvFrame->setChromaBLength(dataLength);
-
-		copyFrameData(m_pVideoFrame->data[2], &data,
-						m_pVideoFrame->linesize[2],
-						m_pVideoCodecCtx->width / 2,
-						m_pVideoCodecCtx->height / 2,
-                      &dataLength);
-        yuvFrame->setChromaR((char*)data);
-        yuvFrame->setChromaRLength(dataLength);
-
-        frame = yuvFrame;
+        yuvFrame->setChromaR((char*)picture->data[2]);
+        yuvFrame->setChromaRLength(picture->linesize[2] * chromaHeight);
+        yuvFrame->setChromaLineSize(picture->linesize[1]);
     }
 	else 
 	{
-        
 		if (!m_pSwsContext && !setupScaler()) {
             
             CCLog("fail setup video scaler");
+            av_frame_unref(m_pVideoFrame);
+            this->recycleFrame(frame);
             return NULL;
         }
         
+        // the pooled frame keeps its rgb buffer between uses
+        AVFrame* picture = frame->getAVFrame();
+        if (picture->data[0] == NULL || picture->width != width || picture->height != height)
+        {
+            av_frame_unref(picture);
+            picture->format = AV_PIX_FMT_RGB24;
+            picture->width = width;
+            picture->height = height;
+            if (av_frame_get_buffer(picture, 1) < 0)
+            {
+                av_frame_unref(m_pVideoFrame);
+                this->recycleFrame(frame);
+                return NULL;
+            }
+        }
+        
 		sws_scale(m_pSwsContext,
 			(const uint8_t **)m_pVideoFrame->data,
 			m_pVideoFrame->linesize,
 			0,
-			m_pVideoCodecCtx->height,
-			m_pAVPicture->data,
-			m_pAVPicture->linesize);
+			height,
+			picture->data,
+			picture->linesize);
         
-        VPVideoFrameRGB *rgbFrame = new VPVideoFrameRGB();
-		rgbFrame->setLineSize(m_pAVPicture->linesize[0]);
-		rgbFrame->setData((char*)m_pAVPicture->data[0]);
-        rgbFrame->setDataLength(rgbFrame->getLineSize() * m_pVideoCodecCtx->height);
-        frame = rgbFrame;
+        VPVideoFrameRGB *rgbFrame = (VPVideoFrameRGB *)frame;
+		rgbFrame->setLineSize(picture->linesize[0]);
+		rgbFrame->setData((char*)picture->data[0]);
+        rgbFrame->setDataLength(rgbFrame->getLineSize() * height);
     }    
     
 	frame->setWidth(m_pVideoCodecCtx->width);
 	frame->setHeight(m_pVideoCodecCtx->height);
-    frame->setPosition(av_frame_get_best_effort_timestamp(m_pVideoFrame)* m_fVideoTimeBase);
+    frame->setPosition(position);
+    frame->setDuration(duration);
+
+    if (m_videoFrameFormat != kVideoFrameFormatYUV)
+    {
+        av_frame_unref(m_pVideoFrame);
+    }
     
-	const long long frameDuration = av_frame_get_pkt_duration(m_pVideoFrame);
-    if (frameDuration) {
+    frame->setSerial(++m_uVideoFrameSerial);
+    return frame;
+}
+
+VPVideoFrame* VPDecoder::obtainVideoFrame()
+{
+    VPVideoFrame* frame = NULL;
+    while (m_vFreeVideoFrames.PopElement(frame))
+    {
+        if (frame->getFormat() == m_videoFrameFormat)
+        {
+            return frame;
+        }
         
-        frame->setDuration(frameDuration * m_fVideoTimeBase);
-		frame->setDuration(frame->getDuration() + m_pVideoFrame->repeat_pict * m_fVideoTimeBase * 0.5);
-    } 
-	else 
-	{
-        // sometimes, ffmpeg unable to determine a frame duration
-        // as example yuvj420p stream from web camera
-        frame->setDuration( 1.0 / _fps );
-    }    
+        // left over from before setupVideoFrameFormat
+        CC_SAFE_DELETE(frame);
+        m_poolLock.Lock();
+        --m_uAllocatedVideoFrames;
+        m_poolLock.UnLock();
+    }
+    
+    CAAutoLock lock(m_poolLock);
+    if (m_uAllocatedVideoFrames >= m_uVideoFramePoolSize)
+    {
+        return NULL;
+    }
+    ++m_uAllocatedVideoFrames;
+    
+    if (m_videoFrameFormat == kVideoFrameFormatYUV)
+    {
+        return new VPVideoFrameYUV();
+    }
+    return new VPVideoFrameRGB();
+}
 
-    return frame;
+bool VPDecoder::hasFreeVideoFrame()
+{
+    if (m_vFreeVideoFrames.GetCount() > 0)
+    {
+        return true;
+    }
+    CAAutoLock lock(m_poolLock);
+    return m_uAllocatedVideoFrames < m_uVideoFramePoolSize;
+}
+
+bool VPDecoder::isVideoFramePoolExhausted()
+{
+    return m_iVideoStream != -1 && !this->hasFreeVideoFrame();
+}
+
+void VPDecoder::setVideoFramePoolSize(unsigned int size)
+{
+    CAAutoLock lock(m_poolLock);
+    m_uVideoFramePoolSize = MAX(size, 2);
+}
+
+void VPDecoder::recycleFrame(VPFrame* frame)
+{
+    if (frame == NULL)
+        return;
+    
+    if (frame->getType() != kFrameTypeVideo)
+    {
+        CC_SAFE_DELETE(frame);
+        return;
+    }
+    
+    VPVideoFrame* videoFrame = (VPVideoFrame*)frame;
+    if (videoFrame->getFormat() == kVideoFrameFormatYUV)
+    {
+        // give the picture back to the decoder right away
+        av_frame_unref(videoFrame->getAVFrame());
+    }
+    
+    m_poolLock.Lock();
+    bool keep = m_uAllocatedVideoFrames <= m_uVideoFramePoolSize;
+    if (!keep)
+    {
+        --m_uAllocatedVideoFrames;
+    }
+    m_poolLock.UnLock();
+    
+    if (keep)
+    {
+        m_vFreeVideoFrames.AddElement(videoFrame);
+    }
+    else
+    {
+        CC_SAFE_DELETE(videoFrame);
+    }
+}
+
+void VPDecoder::clearVideoFramePool()
+{
+    VPVideoFrame* frame = NULL;
+    while (m_vFreeVideoFrames.PopElement(frame))
+    {
+        CC_SAFE_DELETE(frame);
+        m_poolLock.Lock();
+        --m_uAllocatedVideoFrames;
+        m_poolLock.UnLock();
+    }
 }
 
 
@@ -844,18 +981,21 @@ bool VPDecoder::setupVideoFrameFormat(VPVideoFrameFormat format)
     if (format == kVideoFrameFormatYUV && m_pVideoCodecCtx && (m_pVideoCodecCtx->pix_fmt == AV_PIX_FMT_YUV420P || m_pVideoCodecCtx->pix_fmt == AV_PIX_FMT_YUVJ420P)) 
 	{
 		m_videoFrameFormat = kVideoFrameFormatYUV;
-        return true;
+    }
+    else
+    {
+        m_videoFrameFormat = kVideoFrameFormatRGB;
     }
     
-	m_videoFrameFormat = kVideoFrameFormatRGB;
-    return false;
+    this->clearVideoFramePool();
+    return m_videoFrameFormat == kVideoFrameFormatYUV;
 }
 
 void VPDecoder::destroyAllFrames(std::vector<VPFrame*>& frames)
 {
 	for (int i = 0; i < frames.size(); i++)
 	{
-		CC_SAFE_DELETE(frames[i]);
+		this->recycleFrame(frames[i]);
 	}
 	frames.clear();
 }
@@ -879,10 +1019,38 @@ std::vector<VPFrame*> VPDecoder::decodeFrames(float minDuration)
     
     while (!finished) {
         
+        if (m_iVideoStream != -1 && !this->hasFreeVideoFrame())
+        {
+            // wait for the view to hand frames back
+            break;
+        }
+        
 		if (av_read_frame(m_pFormatCtx, &packet) < 0) 
 		{
 			CCLog("decode av_read_frame < 0");
-			destroyAllFrames(result);
+            
+            if (m_iVideoStream != -1)
+            {
+                // threaded decoding holds back the last few pictures, drain them
+                AVPacket flushPacket;
+                av_init_packet(&flushPacket);
+                flushPacket.data = NULL;
+                flushPacket.size = 0;
+                
+                int gotframe = 1;
+                while (gotframe && this->hasFreeVideoFrame())
+                {
+                    gotframe = 0;
+                    if (avcodec_decode_video2(m_pVideoCodecCtx, m_pVideoFrame, &gotframe, &flushPacket) < 0)
+                        break;
+                    
+                    VPVideoFrame *frame = gotframe ? this->handleVideoFrame() : NULL;
+                    if (frame)
+                    {
+                        result.push_back((VPFrame*)frame);
+                    }
+                }
+            }
 			_isEOF = true;
 			break;
         }
@@ -892,10 +1060,13 @@ std::vector<VPFrame*> VPDecoder::decodeFrames(float minDuration)
 			
             int pktSize = packet.size;
             
+            m_pVideoCodecCtx->skip_frame = (m_fDropFramesBefore - m_fPosition > kSkipNonRefFramesLag) ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+            
 				while (pktSize > 0) {
                 
                 int gotframe = 0;
 
+                double start = currentTime();
 				int len = avcodec_decode_video2(m_pVideoCodecCtx, m_pVideoFrame, &gotframe, &packet);
 				if (len < 0) {
 					destroyAllFrames(result);
@@ -906,6 +1077,10 @@ std::vector<VPFrame*> VPDecoder::decodeFrames(float minDuration)
                 if (gotframe) {
                     
                     VPVideoFrame *frame = this->handleVideoFrame();
+                    
+                    ++m_tDecodeStats.decodedFrames;
+                    m_tDecodeStats.decodeTime += currentTime() - start;
+                    
                     if (frame)
                     {
                         result.push_back((VPFrame*)frame);
@@ -84,12 +84,18 @@ class VPVideoFrame : public VPFrame
 {
 public:
     VPVideoFrame();
-    virtual ~VPVideoFrame() {}
+    virtual ~VPVideoFrame();
 
     CC_SYNTHESIZE_PASS_BY_REF(VPVideoFrameFormat, m_format, Format)
     CC_SYNTHESIZE_PASS_BY_REF(unsigned int, m_width, Width);
     CC_SYNTHESIZE_PASS_BY_REF(unsigned int, m_height, Height);
+    CC_SYNTHESIZE_PASS_BY_REF(unsigned long, m_serial, Serial);  // changes every time the frame is refilled
 
+    // the picture the planes point into, owned by the frame
+    AVFrame* getAVFrame() { return m_pAVFrame; }
+
+protected:
+    AVFrame* m_pAVFrame;
 };
 
 class VPVideoFrameRGB : public VPVideoFrame
@@ -103,6 +109,7 @@ public:
     CC_SYNTHESIZE(char*, m_data, Data); // rgb data
 };
 
+// the planes reference the decoder's buffers directly, rows are LineSize bytes apart
 class VPVideoFrameYUV : public VPVideoFrame
 {
 public:
@@ -111,13 +118,23 @@ public:
     
     CC_SYNTHESIZE(char*, m_luma, Luma)
     CC_SYNTHESIZE_PASS_BY_REF(unsigned int, m_lumaLength, LumaLength)
+    CC_SYNTHESIZE_PASS_BY_REF(unsigned int, m_lumaLineSize, LumaLineSize)
     CC_SYNTHESIZE(char*, m_chromaB, ChromaB)
     CC_SYNTHESIZE_PASS_BY_REF(unsigned int, m_chromaBLength, ChromaBLength)
     CC_SYNTHESIZE(char*, m_chromaR, ChromaR)
     CC_SYNTHESIZE_PASS_BY_REF(unsigned int, m_chromaRLength, ChromaRLength)
+    CC_SYNTHESIZE_PASS_BY_REF(unsigned int, m_chromaLineSize, ChromaLineSize)
 };
 
 
+typedef struct VPDecodeStats
+{
+    unsigned int decodedFrames;     // video frames out of the codec
+    unsigned int droppedFrames;     // late video frames thrown away before conversion
+    float decodeTime;               // seconds spent decoding and converting those frames
+} VPDecodeStats;
+
+
 typedef void (CAObject::*SEL_DecoderAudioCallback)(unsigned char *stream, int len, int channels);
 #define decoder_audio_selector(_SELECTOR) (SEL_DecoderAudioCallback)(&_SELECTOR)
 
@@ -139,6 +156,22 @@ public:
     std::vector<VPFrame*> decodeFrames(float minDuration);
 
 	VPVideoFrame* getFirstVideoFrame();
+
+    // video frames come from a fixed pool, hand them back here instead of deleting them
+    void recycleFrame(VPFrame* frame);
+
+    void setVideoFramePoolSize(unsigned int size);
+    unsigned int getVideoFramePoolSize() { return m_uVideoFramePoolSize; }
+
+    // every pooled frame is waiting to be shown, decoding pauses until one is recycled
+    bool isVideoFramePoolExhausted();
+
+    // video frames ending before position are late and dropped before conversion,
+    // far behind it the codec also skips non-reference frames
+    void setDropFramesBefore(float position) { m_fDropFramesBefore = position; }
+
+    VPDecodeStats getDecodeStats() { return m_tDecodeStats; }
+    void resetDecodeStats();
     
     void onAudioCallback(unsigned char *stream, int len);
 
@@ -152,6 +185,8 @@ public:
     float getPosition();
     void setPosition(float seconds);
     float getSampleRate();
+    float getFPS() { return _fps; }
+    unsigned int getAudioBytesPerSecond();
     unsigned int getFrameWidth();
     unsigned int getFrameHeight();
 
@@ -178,6 +213,9 @@ protected:
 	bool setupScaler();
 
 	VPVideoFrame* handleVideoFrame();
+	VPVideoFrame* obtainVideoFrame();
+	bool hasFreeVideoFrame();
+	void clearVideoFramePool();
 	VPAudioFrame* handleAudioFrame();
     
 	static int interrupt_cb(void *ctx);
@@ -213,6 +251,15 @@ private:
 
     bool _isEOF;
     float _fps;
+
+    CASyncQueue<VPVideoFrame*> m_vFreeVideoFrames;
+    unsigned int m_uVideoFramePoolSize;
+    unsigned int m_uAllocatedVideoFrames;
+    unsigned long m_uVideoFrameSerial;
+    CALock m_poolLock;
+
+    float m_fDropFramesBefore;
+    VPDecodeStats m_tDecodeStats;
     
 };
 
@@ -36,10 +36,16 @@ VPAudioFrame::~VPAudioFrame()
 VPVideoFrame::VPVideoFrame()
 : m_height(0)
 , m_width(0)
+, m_serial(0)
+, m_pAVFrame(NULL)
 {
     m_type = kFrameTypeVideo;
 }
 
+VPVideoFrame::~VPVideoFrame()
+{
+}
+
 
 VPVideoFrameRGB::VPVideoFrameRGB()
 : m_data(NULL)
@@ -94,8 +100,9 @@ VPDecoder::VPDecoder()
 , m_audioCallback(NULL)
 , m_pAudioCallbackTarget(NULL)
 , m_pAVPicture(NULL)
+, m_uVideoFramePoolSize(0)
 {
-
+    memset(&m_tDecodeStats, 0, sizeof(VPDecodeStats));
 }
 
 VPDecoder::~VPDecoder()
@@ -244,5 +251,20 @@ std::vector<VPFrame*> VPDecoder::decodeFrames(float minDuration)
     return result;
 }
 
+void VPDecoder::recycleFrame(VPFrame* frame)
+{
+    CC_SAFE_DELETE(frame);
+}
+
+void VPDecoder::setVideoFramePoolSize(unsigned int size)
+{
+    m_uVideoFramePoolSize = size;
+}
+
+void VPDecoder::resetDecodeStats()
+{
+    memset(&m_tDecodeStats, 0, sizeof(VPDecodeStats));
+}
+
 
 NS_CC_EXT_END
\ No newline at end of file
@@ -53,12 +53,15 @@ varying highp vec2 v_texCoord;						\n\
 uniform sampler2D s_texture_y;						\n\
 uniform sampler2D s_texture_u;						\n\
 uniform sampler2D s_texture_v;						\n\
+uniform highp vec2 u_texScale;						\n\
 													\n\
 void main()											\n\
 {													\n\
-	highp float y = texture2D(s_texture_y, v_texCoord).r;			\n\
-	highp float u = texture2D(s_texture_u, v_texCoord).r - 0.5;		\n\
-	highp float v = texture2D(s_texture_v, v_texCoord).r - 0.5;		\n\
+	highp vec2 lumaCoord = vec2(v_texCoord.x * u_texScale.x, v_texCoord.y);		\n\
+	highp vec2 chromaCoord = vec2(v_texCoord.x * u_texScale.y, v_texCoord.y);	\n\
+	highp float y = texture2D(s_texture_y, lumaCoord).r;			\n\
+	highp float u = texture2D(s_texture_u, chromaCoord).r - 0.5;		\n\
+	highp float v = texture2D(s_texture_v, chromaCoord).r - 0.5;		\n\
 													\n\
 	highp float r = y +             1.402 * v;		\n\
 	highp float g = y - 0.344 * u - 0.714 * v;		\n\
@@ -110,6 +113,8 @@ static GLuint compileShader(GLenum type, const char* sources)
 VPFrameRenderRGB::VPFrameRenderRGB()
 {
     _texture = 0;
+    _textureWidth = 0;
+    _textureHeight = 0;
     _uniformSampler = 0;
     _key = "CAVideoPlayerRenderRGB";
 }
@@ -143,27 +148,43 @@ void VPFrameRenderRGB::setFrame(VPVideoFrame* frame)
     
     CCAssert((rgbFrame->getDataLength() == rgbFrame->getWidth() * rgbFrame->getHeight() * 3), "");
     
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    
     if (0 == _texture)
         glGenTextures(1, &_texture);
     
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glBindTexture(GL_TEXTURE_2D, _texture);
     
-    glTexImage2D(GL_TEXTURE_2D,
-                 0,
-                 GL_RGB,
-                 frame->getWidth(),
-                 frame->getHeight(),
-                 0,
-                 GL_RGB,
-                 GL_UNSIGNED_BYTE,
-                 rgbFrame->getData());
+    // allocate once, then only replace the pixels
+    if (_textureWidth != frame->getWidth() || _textureHeight != frame->getHeight())
+    {
+        _textureWidth = frame->getWidth();
+        _textureHeight = frame->getHeight();
+        
+        glTexImage2D(GL_TEXTURE_2D,
+                     0,
+                     GL_RGB,
+                     _textureWidth,
+                     _textureHeight,
+                     0,
+                     GL_RGB,
+                     GL_UNSIGNED_BYTE,
+                     NULL);
+        
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
     
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    0,
+                    0,
+                    0,
+                    _textureWidth,
+                    _textureHeight,
+                    GL_RGB,
+                    GL_UNSIGNED_BYTE,
+                    rgbFrame->getData());
 }
 
 bool VPFrameRenderRGB::prepareRender()
@@ -185,8 +206,13 @@ VPFrameRenderYUV::VPFrameRenderYUV()
 {
     for (int i=0; i<3; i++) {
         _textures[i] = 0;
+        _textureWidths[i] = 0;
+        _textureHeights[i] = 0;
         _uniformSamplers[i] = 0;
     }
+    _uniformTexScale = -1;
+    _lumaScale = 1.0f;
+    _chromaScale = 1.0f;
     
     _key = "CAVideoPlayerRenderYUV";
 }
@@ -212,46 +238,70 @@ void VPFrameRenderYUV::resolveUniforms(GLuint program)
     _uniformSamplers[0] = glGetUniformLocation(program, "s_texture_y");
     _uniformSamplers[1] = glGetUniformLocation(program, "s_texture_u");
     _uniformSamplers[2] = glGetUniformLocation(program, "s_texture_v");
+    _uniformTexScale = glGetUniformLocation(program, "u_texScale");
 }
 
 void VPFrameRenderYUV::setFrame(VPVideoFrame* frame)
 {
     VPVideoFrameYUV *yuvFrame = (VPVideoFrameYUV *)frame;
     
-    CCAssert((yuvFrame->getLumaLength() == yuvFrame->getWidth() * yuvFrame->getHeight()), "");
-    CCAssert((yuvFrame->getChromaBLength() == (yuvFrame->getWidth() * yuvFrame->getHeight())/4), "");
-    CCAssert((yuvFrame->getChromaRLength() == (yuvFrame->getWidth() * yuvFrame->getHeight())/4), "");
-    
     const unsigned int frameWidth = frame->getWidth();
     const unsigned int frameHeight = frame->getHeight();
+    const unsigned int chromaWidth = (frameWidth + 1) / 2;
+    const unsigned int chromaHeight = (frameHeight + 1) / 2;
+    
+    CCAssert((yuvFrame->getLumaLength() == yuvFrame->getLumaLineSize() * frameHeight), "");
+    CCAssert((yuvFrame->getChromaBLength() == yuvFrame->getChromaLineSize() * chromaHeight), "");
+    CCAssert((yuvFrame->getChromaRLength() == yuvFrame->getChromaLineSize() * chromaHeight), "");
     
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     
     if (0 == _textures[0])
         glGenTextures(3, _textures);
     
+    // GLES2 has no GL_UNPACK_ROW_LENGTH, so the planes are uploaded with their padding
+    // straight from the decoder's buffers and the shader crops it
     const char *pixels[3] = { yuvFrame->getLuma(), yuvFrame->getChromaB(), yuvFrame->getChromaR() };
-    const unsigned int widths[3]  = { frameWidth, frameWidth / 2, frameWidth / 2 };
-    const unsigned int heights[3] = { frameHeight, frameHeight / 2, frameHeight / 2 };
+    const unsigned int widths[3]  = { yuvFrame->getLumaLineSize(), yuvFrame->getChromaLineSize(), yuvFrame->getChromaLineSize() };
+    const unsigned int heights[3] = { frameHeight, chromaHeight, chromaHeight };
+    
+    _lumaScale = widths[0] ? (GLfloat)frameWidth / widths[0] : 1.0f;
+    _chromaScale = widths[1] ? (GLfloat)chromaWidth / widths[1] : 1.0f;
     
     for (int i = 0; i < 3; ++i) {
         
         glBindTexture(GL_TEXTURE_2D, _textures[i]);
         
-        glTexImage2D(GL_TEXTURE_2D,
-                     0,
-                     GL_LUMINANCE,
-                     widths[i],
-                     heights[i],
-                     0,
-                     GL_LUMINANCE,
-                     GL_UNSIGNED_BYTE,
-                     pixels[i]);
+        if (_textureWidths[i] != widths[i] || _textureHeights[i] != heights[i])
+        {
+            _textureWidths[i] = widths[i];
+            _textureHeights[i] = heights[i];
+            
+            glTexImage2D(GL_TEXTURE_2D,
+                         0,
+                         GL_LUMINANCE,
+                         widths[i],
+                         heights[i],
+                         0,
+                         GL_LUMINANCE,
+                         GL_UNSIGNED_BYTE,
+                         NULL);
+            
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
         
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexSubImage2D(GL_TEXTURE_2D,
+                        0,
+                        0,
+                        0,
+                        widths[i],
+                        heights[i],
+                        GL_LUMINANCE,
+                        GL_UNSIGNED_BYTE,
+                        pixels[i]);
     }
 }
 
@@ -265,6 +315,7 @@ bool VPFrameRenderYUV::prepareRender()
         glBindTexture(GL_TEXTURE_2D, _textures[i]);
         glUniform1i(_uniformSamplers[i], i);
     }
+    glUniform2f(_uniformTexScale, _lumaScale, _chromaScale);
     
     return true;
 }
@@ -279,6 +330,8 @@ VPFrameRender::VPFrameRender()
     _vertices[5] =  1.0f;
     _vertices[6] =  1.0f;  // x3
     _vertices[7] =  1.0f;  // y3
+    
+    _uploadedSerial = 0;
 }
 
 VPFrameRender::~VPFrameRender()
@@ -337,12 +390,16 @@ void VPFrameRender::draw(VPVideoFrame *frame, long offset)
     pProgram->use();
     pProgram->setUniformsForBuiltins();
     
-    if (frame) {
-        setFrame(frame);
-    } else {
+    if (frame == NULL) {
         return;
     }
     
+    // draw runs every visit, only upload when the view has moved on to another frame
+    if (frame->getSerial() == 0 || frame->getSerial() != _uploadedSerial) {
+        setFrame(frame);
+        _uploadedSerial = frame->getSerial();
+    }
+    
     if (prepareRender()) {
         
     #define kQuadSize sizeof(ccV3F_C4B_T2F)
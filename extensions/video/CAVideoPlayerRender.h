@@ -39,12 +39,15 @@ protected:
 
     GLfloat _vertices[8];
     std::string _key;
+    unsigned long _uploadedSerial;
 };
 
 class VPFrameRenderRGB : public VPFrameRender
 {
     GLint _uniformSampler;
     GLuint _texture;
+    unsigned int _textureWidth;
+    unsigned int _textureHeight;
 
 public:
     VPFrameRenderRGB();
@@ -61,6 +64,13 @@ class VPFrameRenderYUV : public VPFrameRender
 {
     GLint _uniformSamplers[3];
     GLuint _textures[3];
+    unsigned int _textureWidths[3];
+    unsigned int _textureHeights[3];
+    
+    // the textures are as wide as the decoder's padded rows, only this much of them is shown
+    GLint _uniformTexScale;
+    GLfloat _lumaScale;
+    GLfloat _chromaScale;
     
 public:
     VPFrameRenderYUV();
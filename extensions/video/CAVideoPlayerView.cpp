@@ -6,6 +6,8 @@ NS_CC_EXT_BEGIN
 #define LOCAL_MAX_BUFFERED_DURATION   0.4
 #define NETWORK_MIN_BUFFERED_DURATION 1.5
 #define NETWORK_MAX_BUFFERED_DURATION 8.0
+#define MAX_VIDEO_FRAME_POOL_SIZE     64
+#define SYNC_THRESHOLD                0.01
 
 #define ThreadMsgType_SetPosition 1
 #define ThreadMsgType_DecodeFrame 2
@@ -29,9 +31,20 @@ CAVideoPlayerView::CAVideoPlayerView()
 , m_isSetPosWaiting(false)
 , m_fMinBufferedDuration(0)
 , m_fMaxBufferedDuration(0)
+, m_fDecodeLowWatermark(0)
+, m_fLowWatermark(0)
+, m_fHighWatermark(0)
 , m_fBufferedDuration(0)
 , m_fMoviePosition(0)
 , m_tickCorrectionPosition(0)
+, m_eSyncMode(kVPSyncAudioMaster)
+, m_bAudioClockValid(false)
+, m_fAudioClock(0)
+, m_fAudioCallbackDuration(0)
+, m_pNextVideoFrame(NULL)
+, m_uPresentedFrames(0)
+, m_uDroppedFrames(0)
+, m_fClockDrift(0)
 , m_pCurVideoFrame(NULL)
 , m_pCurAudioFrame(NULL)
 , m_uCurAudioFramePos(0)
@@ -48,7 +61,13 @@ CAVideoPlayerView::~CAVideoPlayerView()
 	setPosition(0);
 	CAThread::close();
 
-	CC_SAFE_DELETE(m_pCurVideoFrame);
+	VPFrame* frame = NULL;
+	while (m_vVideoFrames.PopElement(frame)) releaseFrame(frame);
+	while (m_vAudioFrames.PopElement(frame)) releaseFrame(frame);
+	releaseFrame(m_pCurVideoFrame);
+	m_pCurVideoFrame = NULL;
+	releaseFrame(m_pNextVideoFrame);
+	m_pNextVideoFrame = NULL;
 	CC_SAFE_DELETE(m_pCurAudioFrame);
 
 	CC_SAFE_DELETE(m_pRenderer);
@@ -136,8 +155,7 @@ void CAVideoPlayerView::setFirstVideoFrame()
 
 void CAVideoPlayerView::setFullPath(const std::string& szPath, bool showFirstFrame)
 {
-	m_fMinBufferedDuration = LOCAL_MIN_BUFFERED_DURATION;
-	m_fMaxBufferedDuration = LOCAL_MAX_BUFFERED_DURATION;
+	applyBufferWatermarks(LOCAL_MIN_BUFFERED_DURATION, LOCAL_MAX_BUFFERED_DURATION);
 	m_cszPath = szPath;
 	m_isShowFirstFrame = showFirstFrame;
 
@@ -149,8 +167,7 @@ void CAVideoPlayerView::setFullPath(const std::string& szPath, bool showFirstFra
 
 void CAVideoPlayerView::setUrl(const std::string& szUrl, bool showFirstFrame)
 {
-	m_fMinBufferedDuration = NETWORK_MIN_BUFFERED_DURATION;
-	m_fMaxBufferedDuration = NETWORK_MAX_BUFFERED_DURATION;
+	applyBufferWatermarks(NETWORK_MIN_BUFFERED_DURATION, NETWORK_MAX_BUFFERED_DURATION);
 	m_cszPath = szUrl;
 	m_isShowFirstFrame = showFirstFrame;
 
@@ -160,6 +177,72 @@ void CAVideoPlayerView::setUrl(const std::string& szUrl, bool showFirstFrame)
 	}
 }
 
+void CAVideoPlayerView::applyBufferWatermarks(float defaultMin, float defaultMax)
+{
+	m_fMinBufferedDuration = defaultMin;
+	m_fMaxBufferedDuration = m_fHighWatermark > 0 ? m_fHighWatermark : defaultMax;
+	m_fDecodeLowWatermark = m_fLowWatermark > 0 ? m_fLowWatermark : (defaultMin + defaultMax) / 2;
+	m_fDecodeLowWatermark = MIN(m_fDecodeLowWatermark, m_fMaxBufferedDuration);
+	m_fMinBufferedDuration = MIN(m_fMinBufferedDuration, m_fDecodeLowWatermark);
+}
+
+void CAVideoPlayerView::setBufferWatermarks(float low, float high)
+{
+	m_fLowWatermark = low;
+	m_fHighWatermark = high;
+	if (m_fMaxBufferedDuration > 0)
+	{
+		bool network = m_fMaxBufferedDuration > LOCAL_MAX_BUFFERED_DURATION && m_fHighWatermark <= 0;
+		applyBufferWatermarks(network ? NETWORK_MIN_BUFFERED_DURATION : LOCAL_MIN_BUFFERED_DURATION,
+			network ? NETWORK_MAX_BUFFERED_DURATION : LOCAL_MAX_BUFFERED_DURATION);
+	}
+}
+
+void CAVideoPlayerView::setSyncMode(VPSyncMode mode)
+{
+	m_aLock.Lock();
+	m_eSyncMode = mode;
+	m_tickCorrectionTime.tv_sec = 0;
+	m_tickCorrectionTime.tv_usec = 0;
+	m_aLock.UnLock();
+}
+
+VPPlaybackStats CAVideoPlayerView::getPlaybackStats()
+{
+	VPPlaybackStats stats;
+	memset(&stats, 0, sizeof(VPPlaybackStats));
+
+	stats.presentedFrames = m_uPresentedFrames;
+	stats.droppedFrames = m_uDroppedFrames;
+	stats.videoQueueDepth = m_vVideoFrames.GetCount();
+	stats.audioQueueDepth = m_vAudioFrames.GetCount();
+	stats.bufferedDuration = m_fBufferedDuration;
+	stats.clockDrift = m_fClockDrift;
+
+	if (m_pDecoder)
+	{
+		VPDecodeStats decodeStats = m_pDecoder->getDecodeStats();
+		stats.decodedFrames = decodeStats.decodedFrames;
+		stats.droppedFrames += decodeStats.droppedFrames;
+		if (decodeStats.decodedFrames > 0)
+		{
+			stats.averageDecodeTime = decodeStats.decodeTime / decodeStats.decodedFrames;
+		}
+	}
+	return stats;
+}
+
+void CAVideoPlayerView::resetPlaybackStats()
+{
+	m_uPresentedFrames = 0;
+	m_uDroppedFrames = 0;
+	m_fClockDrift = 0;
+	if (m_pDecoder)
+	{
+		m_pDecoder->resetDecodeStats();
+	}
+}
+
 void CAVideoPlayerView::update(float fDelta)
 {
 	if (isDecoderInited())
@@ -185,6 +268,16 @@ void CAVideoPlayerView::update(float fDelta)
                                                  m_obContentSize.height);
         setImageRect(m_viewRect);
         
+        if (m_pDecoder->isValidVideo())
+        {
+            // enough pooled frames to fill the buffer, but never more than the cap:
+            // buffering also ends once the pool is full, so a capped pool cannot stall
+            float fps = MAX(m_pDecoder->getFPS(), 1.0f);
+            unsigned int poolSize = (unsigned int)ceilf(fps * m_fMaxBufferedDuration);
+            poolSize = MAX(poolSize, (unsigned int)ceilf(fps * m_fMinBufferedDuration) * 2);
+            m_pDecoder->setVideoFramePoolSize(MIN(poolSize + 4, MAX_VIDEO_FRAME_POOL_SIZE));
+        }
+        
 		if (!m_pRenderer->loadShaders())
 		{
 			CC_SAFE_DELETE(m_pRenderer);
@@ -298,11 +391,23 @@ void CAVideoPlayerView::draw()
 
 void CAVideoPlayerView::setCurrentFrame(VPVideoFrame *frame)
 {
-	CC_SAFE_DELETE(m_pCurVideoFrame);
+	releaseFrame(m_pCurVideoFrame);
 	m_pCurVideoFrame = frame;
 	showLoadingView(m_pCurVideoFrame == NULL);
 }
 
+void CAVideoPlayerView::releaseFrame(VPFrame* frame)
+{
+	if (m_pDecoder)
+	{
+		m_pDecoder->recycleFrame(frame);
+	}
+	else
+	{
+		CC_SAFE_DELETE(frame);
+	}
+}
+
 void CAVideoPlayerView::play()
 {
 	CC_RETURN_IF(!isDecoderInited());
@@ -427,8 +532,8 @@ bool CAVideoPlayerView::createDecoder()
 void CAVideoPlayerView::setVPPosition(float p)
 {
 	VPFrame* frame = NULL;
-	while (m_vVideoFrames.PopElement(frame)) CC_SAFE_DELETE(frame);
-	while (m_vAudioFrames.PopElement(frame)) CC_SAFE_DELETE(frame);
+	while (m_vVideoFrames.PopElement(frame)) releaseFrame(frame);
+	while (m_vAudioFrames.PopElement(frame)) releaseFrame(frame);
 	
 	float position = MIN(m_pDecoder->getDuration(), MAX(0, p));
 	m_pDecoder->setPosition(position);
@@ -438,6 +543,11 @@ void CAVideoPlayerView::setVPPosition(float p)
 	m_fBufferedDuration = 0;
 	CC_SAFE_DELETE(m_pCurAudioFrame);
 	m_uCurAudioFramePos = 0;
+	releaseFrame(m_pNextVideoFrame);
+	m_pNextVideoFrame = NULL;
+	m_bAudioClockValid = false;
+	m_tickCorrectionTime.tv_sec = 0;
+	m_tickCorrectionTime.tv_usec = 0;
     m_aLock.UnLock();
 }
 
@@ -528,7 +638,7 @@ bool CAVideoPlayerView::addFrames(const std::vector<VPFrame*>& frames)
 			}
 			else
 			{
-				CC_SAFE_DELETE(frame);
+				releaseFrame(frame);
 			}
 			continue;
 		}
@@ -547,7 +657,7 @@ bool CAVideoPlayerView::addFrames(const std::vector<VPFrame*>& frames)
 			}
 			else
 			{
-				CC_SAFE_DELETE(frame);
+				releaseFrame(frame);
 			}
 		}
 	}
@@ -560,36 +670,71 @@ float CAVideoPlayerView::presentFrame()
 
 	if (m_pDecoder->isValidVideo()) 
 	{
-		VPFrame *frame = NULL;
-
 		m_isBuffered = (m_fBufferedDuration<m_fMinBufferedDuration);
-		if (m_pDecoder->isEOF())
+		if (m_pDecoder->isEOF() || m_pDecoder->isVideoFramePoolExhausted())
 		{
 			m_isBuffered = false;
 		}
 
-		while (!m_isBuffered && m_vVideoFrames.PopElement(frame))
+		if (m_isBuffered)
+		{
+			return 0;
+		}
+
+		bool hasClock = m_tickCorrectionTime.tv_sec || (m_eSyncMode == kVPSyncAudioMaster && m_bAudioClockValid);
+		float clock = hasClock ? getMasterClock() : 0;
+
+		VPFrame *frame = m_pNextVideoFrame;
+		m_pNextVideoFrame = NULL;
+
+		while (frame || m_vVideoFrames.PopElement(frame))
 		{
 			m_fBufferedDuration -= frame->getDuration();
 
 			float fCurPos = frame->getPosition();
-			if (fCurPos >= m_fMoviePosition)
+			bool stale = fCurPos < m_fMoviePosition;
+			bool late = hasClock && fCurPos + frame->getDuration() < clock && m_vVideoFrames.GetCount() > 0;
+			if (!stale && !late)
 			{
-				interval = frame->getDuration();
-				m_fMoviePosition = fCurPos;
 				break;
 			}
-			else
+
+			if (late)
 			{
-				interval = 0;
-				CC_SAFE_DELETE(frame);
+				++m_uDroppedFrames;
 			}
+			releaseFrame(frame);
+			frame = NULL;
 		}
+
 		if (frame)
 		{
+			if (!hasClock)
+			{
+				// the first frame starts the external clock
+				gettimeofday(&m_tickCorrectionTime, 0);
+				m_tickCorrectionPosition = frame->getPosition();
+				clock = frame->getPosition();
+				hasClock = true;
+			}
+
+			float delay = frame->getPosition() - clock;
+			if (delay > SYNC_THRESHOLD)
+			{
+				// early, keep it for the next tick
+				m_pNextVideoFrame = (VPVideoFrame*)frame;
+				m_fBufferedDuration += frame->getDuration();
+				return delay;
+			}
+
+			m_fMoviePosition = frame->getPosition();
+			m_fClockDrift = delay;
+			++m_uPresentedFrames;
 			setCurrentFrame((VPVideoFrame*)frame);
+
+			interval = MAX(frame->getPosition() + frame->getDuration() - clock, 0);
+			m_pDecoder->setDropFramesBefore(clock);
 		}
-		
 	}
 	return interval;
 }
@@ -602,7 +747,7 @@ void CAVideoPlayerView::tick(float dt)
 	if (m_pDecoder == NULL || m_pRenderer == NULL)
 		return;
 
-	if (m_isBuffered && ((m_fBufferedDuration > m_fMaxBufferedDuration) || m_pDecoder->isEOF())) {
+	if (m_isBuffered && ((m_fBufferedDuration > m_fMaxBufferedDuration) || m_pDecoder->isEOF() || m_pDecoder->isVideoFramePoolExhausted())) {
 
 		m_tickCorrectionTime.tv_sec = 0;
 		m_tickCorrectionTime.tv_usec = 0;
@@ -625,7 +770,7 @@ void CAVideoPlayerView::tick(float dt)
 	if (m_pDecoder->isEOF()) 
 	{
 		unsigned int leftFrames =
-			(m_pDecoder->isValidVideo() ? m_vVideoFrames.GetCount() : 0) +
+			(m_pDecoder->isValidVideo() ? m_vVideoFrames.GetCount() + (m_pNextVideoFrame ? 1 : 0) : 0) +
 			(m_pDecoder->isValidAudio() ? m_vAudioFrames.GetCount() : 0);
 		if (0 == leftFrames)
 		{
@@ -640,48 +785,39 @@ void CAVideoPlayerView::tick(float dt)
 		}
 	}
 
-	if (m_fBufferedDuration < m_fMaxBufferedDuration)
+	// refill between the watermarks instead of after every frame
+	if (m_fBufferedDuration < (m_isBuffered ? m_fMaxBufferedDuration : m_fDecodeLowWatermark))
 	{
 		asyncDecodeFrames();
 	}
 
-	float correction = tickCorrection();
-	float time = MAX(interval + correction, 0.01f);
+	float time = MAX(interval, 0.01f);
 	CAScheduler::schedule(schedule_selector(CAVideoPlayerView::tick), this, time);
 }
 
-float CAVideoPlayerView::tickCorrection()
+float CAVideoPlayerView::getMasterClock()
 {
-	if (m_isBuffered)
-		return 0;
-
 	struct timeval now;
 	gettimeofday(&now, 0);
 
-	if (!m_tickCorrectionTime.tv_sec) {
-
-		m_tickCorrectionTime = now;
-		m_tickCorrectionPosition = m_fMoviePosition;
-		return 0;
+	if (m_eSyncMode == kVPSyncAudioMaster && m_bAudioClockValid)
+	{
+		// what the device is playing, extrapolated until the next callback
+		float elapsed = (now.tv_sec - m_audioClockTime.tv_sec) + (now.tv_usec - m_audioClockTime.tv_usec) / 1000000.0f;
+		return m_fAudioClock + MIN(MAX(elapsed, 0), m_fAudioCallbackDuration);
 	}
 
-	float dPosition = m_fMoviePosition - m_tickCorrectionPosition;
 	float dTime = (now.tv_sec - m_tickCorrectionTime.tv_sec) + (now.tv_usec - m_tickCorrectionTime.tv_usec) / 1000000.0f;
-	float correction = dPosition - dTime;
-
-	if (correction > 1.f || correction < -1.f) 
-	{
-		correction = 0;
-		m_tickCorrectionTime.tv_sec = 0;
-		m_tickCorrectionTime.tv_usec = 0;
-	}
-	return correction;
+	return m_tickCorrectionPosition + dTime;
 }
 
 void CAVideoPlayerView::audioCallback(unsigned char *stream, int len, int channels)
 {
 	memset(stream, 0, len);
 
+	const float bytesPerSecond = m_pDecoder->getAudioBytesPerSecond();
+	bool clockUpdated = false;
+
     while (len > 0)
     {
 		if (!isPlaying())
@@ -703,7 +839,19 @@ void CAVideoPlayerView::audioCallback(unsigned char *stream, int len, int channe
         
         if (m_pCurAudioFrame)
         {
-			if (!m_pDecoder->isValidVideo())
+			if (!clockUpdated && bytesPerSecond > 0)
+			{
+				// this buffer starts playing once the one the device holds now is done
+				m_aLock.Lock();
+				m_fAudioCallbackDuration = len / bytesPerSecond;
+				m_fAudioClock = m_pCurAudioFrame->getPosition() + m_uCurAudioFramePos / bytesPerSecond - m_fAudioCallbackDuration;
+				gettimeofday(&m_audioClockTime, 0);
+				m_bAudioClockValid = true;
+				m_aLock.UnLock();
+				clockUpdated = true;
+			}
+
+			if (!m_pDecoder->isValidVideo() && m_uCurAudioFramePos == 0)
             {
 				m_aLock.Lock();
 				m_fMoviePosition = m_pCurAudioFrame->getPosition();
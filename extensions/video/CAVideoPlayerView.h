@@ -17,6 +17,25 @@
 
 NS_CC_EXT_BEGIN
 
+typedef enum
+{
+	kVPSyncAudioMaster,     // video follows the audio output, or the external clock while there is none
+	kVPSyncExternalClock,   // video follows the wall clock
+
+} VPSyncMode;
+
+typedef struct VPPlaybackStats
+{
+	unsigned int presentedFrames;
+	unsigned int droppedFrames;     // late video frames, dropped by the decoder or before upload
+	unsigned int decodedFrames;
+	float averageDecodeTime;        // seconds of decoding and conversion per video frame
+	unsigned int videoQueueDepth;
+	unsigned int audioQueueDepth;
+	float bufferedDuration;
+	float clockDrift;               // last presented frame minus the master clock, in seconds
+} VPPlaybackStats;
+
 class CAVideoPlayerView;
 class CAVideoPlayerViewDelegate
 {
@@ -50,6 +69,15 @@ public:
 	void setPosition(float position);
 	void setFirstVideoFrame();
 	
+	void setSyncMode(VPSyncMode mode);
+	VPSyncMode getSyncMode() { return m_eSyncMode; }
+
+	// decoding starts when less than low seconds are buffered and stops at high,
+	// 0 keeps the defaults for local files or network streams
+	void setBufferWatermarks(float low, float high);
+
+	VPPlaybackStats getPlaybackStats();
+	void resetPlaybackStats();
 
 	CC_SYNTHESIZE(CAVideoPlayerViewDelegate*, m_pPlayerViewDelegate, PlayerViewDelegate);
 
@@ -73,8 +101,10 @@ private:
 	bool addFrames(const std::vector<VPFrame*>& frames);
 	float presentFrame();
 	void setCurrentFrame(VPVideoFrame* frame);
+	void releaseFrame(VPFrame* frame);
 	void tick(float dt);
-	float tickCorrection();
+	float getMasterClock();
+	void applyBufferWatermarks(float defaultMin, float defaultMax);
 	void audioCallback(unsigned char *stream, int len, int channels);
 
 private:
@@ -96,13 +126,29 @@ private:
 
 	float m_fMinBufferedDuration;
 	float m_fMaxBufferedDuration;
+	float m_fDecodeLowWatermark;
+	float m_fLowWatermark;
+	float m_fHighWatermark;
 
 	float m_fBufferedDuration;
 	float m_fMoviePosition;
 
+	// the external clock: m_tickCorrectionPosition was due at m_tickCorrectionTime
 	float m_tickCorrectionPosition;
 	struct timeval m_tickCorrectionTime;
 
+	VPSyncMode m_eSyncMode;
+	bool m_bAudioClockValid;
+	float m_fAudioClock;
+	float m_fAudioCallbackDuration;
+	struct timeval m_audioClockTime;
+
+	VPVideoFrame *m_pNextVideoFrame;    // popped but early
+
+	unsigned int m_uPresentedFrames;
+	unsigned int m_uDroppedFrames;
+	float m_fClockDrift;
+
 	VPVideoFrame *m_pCurVideoFrame;
 	VPAudioFrame *m_pCurAudioFrame;
 	unsigned int m_uCurAudioFramePos;
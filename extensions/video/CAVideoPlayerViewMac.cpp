@@ -14,6 +14,8 @@ CAVideoPlayerView::CAVideoPlayerView()
 , m_fBufferedDuration(0)
 , m_fMoviePosition(0)
 , m_tickCorrectionPosition(0)
+, m_eSyncMode(kVPSyncAudioMaster)
+, m_pNextVideoFrame(NULL)
 , m_pCurVideoFrame(NULL)
 , m_pCurAudioFrame(NULL)
 , m_uCurAudioFramePos(0)
@@ -206,4 +208,24 @@ void CAVideoPlayerView::audioCallback(unsigned char *stream, int len, int channe
 {
 }
 
+void CAVideoPlayerView::setSyncMode(VPSyncMode mode)
+{
+	m_eSyncMode = mode;
+}
+
+void CAVideoPlayerView::setBufferWatermarks(float low, float high)
+{
+}
+
+VPPlaybackStats CAVideoPlayerView::getPlaybackStats()
+{
+	VPPlaybackStats stats;
+	memset(&stats, 0, sizeof(VPPlaybackStats));
+	return stats;
+}
+
+void CAVideoPlayerView::resetPlaybackStats()
+{
+}
+
 NS_CC_EXT_END
\ No newline at end of file
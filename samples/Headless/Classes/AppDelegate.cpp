@@ -0,0 +1,48 @@
+#include "AppDelegate.h"
+#include "HeadlessViewController.h"
+
+USING_NS_CC;
+
+AppDelegate::AppDelegate()
+{
+
+}
+
+AppDelegate::~AppDelegate() 
+{
+    
+}
+
+bool AppDelegate::applicationDidFinishLaunching()
+{
+    // initialize director
+    CAApplication* application = CAApplication::getApplication();
+    
+    CCEGLView* pEGLView = CCEGLView::sharedOpenGLView();
+
+    application->setOpenGLView(pEGLView);
+
+    HeadlessViewController* viewController = new HeadlessViewController();
+    viewController->init();
+    viewController->autorelease();
+    
+    CAWindow* window = CAWindow::create();
+    window->setRootViewController(viewController);
+    
+    // run
+    application->runWindow(window);
+
+    return true;
+}
+
+// This function will be called when the app is inactive. When comes a phone call,it's be invoked too
+void AppDelegate::applicationDidEnterBackground()
+{
+    CAApplication::getApplication()->stopAnimation();
+}
+
+// this function will be called when the app is active again
+void AppDelegate::applicationWillEnterForeground()
+{
+    CAApplication::getApplication()->startAnimation();
+}
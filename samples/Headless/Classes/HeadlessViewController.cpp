@@ -0,0 +1,59 @@
+
+#include "HeadlessViewController.h"
+
+HeadlessViewController::HeadlessViewController()
+{
+
+}
+
+HeadlessViewController::~HeadlessViewController()
+{
+
+}
+
+void HeadlessViewController::viewDidLoad()
+{
+    this->getView()->setColor(CAColor_gray);
+    
+    const int columns = 10;
+    const int rows = 16;
+    DSize size = this->getView()->getBounds().size;
+    float width = size.width / columns;
+    float height = size.height / rows;
+    
+    for (int i=0; i<columns * rows; i++)
+    {
+        CAView* cell = CAView::createWithFrame(DRect((i % columns) * width + 4, (i / columns) * height + 4, width - 8, height - 8));
+        cell->setColor(ccc4(40 + (i * 37) % 200, 40 + (i * 71) % 200, 40 + (i * 113) % 200, 255));
+        this->getView()->addSubview(cell);
+        
+        CALabel* label = CALabel::createWithLayout(DLayoutFill);
+        label->setText(crossapp_format_string("%d", i));
+        label->setFontSize(24);
+        label->setColor(CAColor_white);
+        label->setTextAlignment(CATextAlignmentCenter);
+        label->setVerticalTextAlignmet(CAVerticalTextAlignmentCenter);
+        cell->addSubview(label);
+        
+        this->animateCell(cell, i);
+    }
+}
+
+void HeadlessViewController::animateCell(CAView* cell, int index)
+{
+    // endless, so every frame has transforms, alpha and colors to update
+    CAViewAnimation::beginAnimations(crossapp_format_string("cell%d", index), NULL);
+    CAViewAnimation::setAnimationDuration(0.5f + (index % 7) * 0.25f);
+    CAViewAnimation::setAnimationRepeatCount(1000000);
+    CAViewAnimation::setAnimationRepeatAutoreverses(true);
+    cell->setRotation(index % 2 ? 180 : -180);
+    cell->setScale(0.5f);
+    cell->setAlpha(0.3f);
+    CAViewAnimation::commitAnimations();
+}
+
+void HeadlessViewController::viewDidUnload()
+{
+    // Release any retained subviews of the main view.
+    // e.g. self.myOutlet = nil;
+}
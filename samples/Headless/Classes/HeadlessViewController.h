@@ -0,0 +1,31 @@
+
+#ifndef __Headless__HeadlessViewController__
+#define __Headless__HeadlessViewController__
+
+#include <iostream>
+#include "CrossApp.h"
+
+USING_NS_CC;
+
+// a screen full of views, labels and running animations, enough to keep the renderer busy
+class HeadlessViewController: public CAViewController
+{
+    
+public:
+
+	HeadlessViewController();
+    
+	virtual ~HeadlessViewController();
+    
+protected:
+    
+    void viewDidLoad();
+    
+    void viewDidUnload();
+    
+    void animateCell(CAView* cell, int index);
+    
+};
+
+
+#endif /* defined(__Headless__HeadlessViewController__) */
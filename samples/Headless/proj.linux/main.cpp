@@ -0,0 +1,21 @@
+#include "AppDelegate.h"
+#include "CCEGLView.h"
+
+USING_NS_CC;
+
+int main(int argc, char** argv)
+{
+    // create the application instance
+    AppDelegate app;
+    CCEGLView* eglView = CCEGLView::sharedOpenGLView();
+    eglView->setViewName("Headless");
+    eglView->setFrameSize(750, 1334);
+    
+    // CROSSAPP_HEADLESS_FRAMES overrides this, see CCApplication.h
+    if (CCApplication::sharedApplication()->getFrameLimit() == 0)
+    {
+        CCApplication::sharedApplication()->setFrameLimit(600);
+    }
+
+    return CCApplication::sharedApplication()->run();
+}
@@ -31,6 +31,7 @@
 #include "AutoCollectionViewHorizontalTest.h"
 #include "AutoCollectionViewVerticalTest.h"
 #include "WaterfallViewTest.h"
+#include "BenchmarkTest.h"
 
 CDUIShowAutoCollectionView::CDUIShowAutoCollectionView():showImageViewNavigationBar(0),showActivityIndicatorNavigationBar(0),showSliderNavigationBar(0),showLabelNavigationBar(0),showPickerViewNavigationBar(0),showViewAnimationNavigationBar(0),showAutoCollectionVerticalNavigationBar(0),showAutoCollectionHorizontalNavigationBar(0)
 {
@@ -71,6 +72,7 @@ CDUIShowAutoCollectionView::CDUIShowAutoCollectionView():showImageViewNavigation
     
     m_vTitle.push_back("RenderImage");
     m_vTitle.push_back("Animation");
+    m_vTitle.push_back("Benchmark");
     
 }
 
@@ -441,6 +443,15 @@ void CDUIShowAutoCollectionView::collectionViewDidSelectCellAtIndexPath(CAAutoCo
             RootWindow::getInstance()->getRootNavigationController()->pushViewController(ViewContrllerViewAnimationTest, true);
             break;
         }
+        case 28:
+        {
+            BenchmarkTest* ViewContrllerBenchmarkTest = new BenchmarkTest();
+            ViewContrllerBenchmarkTest->init();
+            ViewContrllerBenchmarkTest->setNavigationBarItem(CANavigationBarItem::create(m_vTitle.at(item)));
+            ViewContrllerBenchmarkTest->autorelease();
+            RootWindow::getInstance()->getRootNavigationController()->pushViewController(ViewContrllerBenchmarkTest, true);
+            break;
+        }
         default:
             break;
     }
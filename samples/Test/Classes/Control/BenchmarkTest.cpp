@@ -0,0 +1,617 @@
+
+#include "BenchmarkTest.h"
+#include "math/CAMathUtil.h"
+#include "images/CAPixelKernels.h"
+#include "CrossAppExt.h"
+
+USING_NS_CC_EXT;
+
+typedef std::string (BenchmarkTest::*BenchmarkFunction)();
+
+static const struct
+{
+    const char* title;
+    BenchmarkFunction function;
+}
+s_pBenchmarks[] =
+{
+    { "transformQuads, 10k quads", &BenchmarkTest::transformQuadsBenchmark },
+    { "Pixel kernels, 512x512", &BenchmarkTest::pixelKernelsBenchmark },
+    { "Video decode, 300 frames", &BenchmarkTest::videoDecodeBenchmark },
+    { "JSON parse, 2 MB feed", &BenchmarkTest::jsonParseBenchmark },
+    { "WebSocket echo, 20k messages", &BenchmarkTest::webSocketEchoBenchmark },
+};
+
+// any echo server does, e.g. "websocat -s 9000" on a machine the device can reach
+static const char* s_pEchoServerURL = "ws://127.0.0.1:9000";
+
+static const unsigned int s_uEchoMessageCount = 20000;
+
+static const unsigned int s_uEchoMessageSize = 64;
+
+static const int s_iBenchmarkCount = sizeof(s_pBenchmarks) / sizeof(s_pBenchmarks[0]);
+
+static double currentMilliseconds()
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+BenchmarkTest::BenchmarkTest()
+: m_pResultLabel(NULL)
+, m_pWebSocket(NULL)
+, m_uEchoSent(0)
+, m_uEchoReceived(0)
+, m_uEchoMismatches(0)
+, m_uEchoQueueFull(0)
+, m_bEchoPaused(false)
+, m_dEchoBegin(0)
+{
+    CADrawerController* drawer = (CADrawerController*)CAApplication::getApplication()->getRootWindow()->getRootViewController();
+    drawer->setTouchMoved(false);
+}
+
+BenchmarkTest::~BenchmarkTest()
+{
+    if (m_pWebSocket)
+    {
+        // onClose deletes it
+        m_pWebSocket->close();
+    }
+    
+    CADrawerController* drawer = (CADrawerController*)CAApplication::getApplication()->getRootWindow()->getRootViewController();
+    drawer->setTouchMoved(true);
+}
+
+void BenchmarkTest::viewDidLoad()
+{
+    this->getView()->setColor(CAColor_gray);
+    
+    for (int i=0; i<s_iBenchmarkCount; i++)
+    {
+        CAButton* btn = CAButton::create(CAButtonTypeRoundedRect);
+        btn->setLayout(DLayout(DHorizontalLayout_L_R(40, 40), DVerticalLayout_T_H(40 + i * 90, 70)));
+        btn->setTitleForState(CAControlStateAll, s_pBenchmarks[i].title);
+        btn->setTag(i);
+        btn->addTarget(this, CAControl_selector(BenchmarkTest::benchmarkCallback), CAControlEventTouchUpInSide);
+        this->getView()->addSubview(btn);
+    }
+    
+    m_pResultLabel = CALabel::createWithLayout(DLayout(DHorizontalLayout_L_R(40, 40), DVerticalLayout_T_B(60 + s_iBenchmarkCount * 90, 40)));
+    m_pResultLabel->setFontSize(26);
+    m_pResultLabel->setColor(CAColor_white);
+    m_pResultLabel->setText("Tap a benchmark, release builds only give meaningful numbers.");
+    this->getView()->addSubview(m_pResultLabel);
+}
+
+void BenchmarkTest::benchmarkCallback(CAControl* control, DPoint point)
+{
+    int index = control->getTag();
+    CC_RETURN_IF(index < 0 || index >= s_iBenchmarkCount);
+    
+    m_pResultLabel->setText((this->*s_pBenchmarks[index].function)());
+}
+
+std::string BenchmarkTest::transformQuadsBenchmark()
+{
+    // MathUtil::transformQuads against the scalar Mat4::transformPoint loop it replaced in CAView and CGSprite updateTransform
+    const unsigned int count = 10000;
+    const int rounds = 50;
+    
+    std::vector<ccV3F_C4B_T2F_Quad> src(count);
+    std::vector<ccV3F_C4B_T2F_Quad> scalar(count);
+    std::vector<ccV3F_C4B_T2F_Quad> simd(count);
+    std::vector<Mat4> matrices(count);
+    
+    for (unsigned int i=0; i<count; i++)
+    {
+        float x = (float)(i % 100) * 10.0f;
+        float y = (float)(i / 100) * 10.0f;
+        ccV3F_C4B_T2F_Quad& quad = src[i];
+        quad.tl.vertices = DPoint3D(x, y + 10.0f, 0.0f);
+        quad.bl.vertices = DPoint3D(x, y, 0.0f);
+        quad.tr.vertices = DPoint3D(x + 10.0f, y + 10.0f, 0.0f);
+        quad.br.vertices = DPoint3D(x + 10.0f, y, 0.0f);
+        quad.tl.colors = quad.bl.colors = quad.tr.colors = quad.br.colors = ccc4(255, 255, 255, (GLubyte)(i % 256));
+        quad.tl.texCoords = tex2(0, 0);
+        quad.bl.texCoords = tex2(0, 1);
+        quad.tr.texCoords = tex2(1, 0);
+        quad.br.texCoords = tex2(1, 1);
+        
+        Mat4::createTranslation((float)(i % 7), (float)(i % 13), 0.0f, &matrices[i]);
+        matrices[i].rotateZ((float)i * 0.001f);
+    }
+    
+    Mat4 transform;
+    Mat4::createTranslation(120.0f, 40.0f, 0.0f, &transform);
+    transform.rotateZ(0.3f);
+    transform.scale(1.5f);
+    
+    double begin = currentMilliseconds();
+    for (int r=0; r<rounds; r++)
+    {
+        for (unsigned int i=0; i<count; i++)
+        {
+            ccV3F_C4B_T2F_Quad& quad = scalar[i];
+            quad = src[i];
+            transform.transformPoint(&quad.tl.vertices);
+            transform.transformPoint(&quad.bl.vertices);
+            transform.transformPoint(&quad.tr.vertices);
+            transform.transformPoint(&quad.br.vertices);
+        }
+    }
+    double scalarTime = (currentMilliseconds() - begin) / rounds;
+    
+    begin = currentMilliseconds();
+    for (int r=0; r<rounds; r++)
+    {
+        MathUtil::transformQuads(transform, &src[0], &simd[0], count);
+    }
+    double simdTime = (currentMilliseconds() - begin) / rounds;
+    
+    float maxDifference = 0.0f;
+    bool attributesEqual = true;
+    for (unsigned int i=0; i<count; i++)
+    {
+        const ccV3F_C4B_T2F* a = &scalar[i].tl;
+        const ccV3F_C4B_T2F* b = &simd[i].tl;
+        for (int v=0; v<4; v++)
+        {
+            maxDifference = MAX(maxDifference, fabsf(a[v].vertices.x - b[v].vertices.x));
+            maxDifference = MAX(maxDifference, fabsf(a[v].vertices.y - b[v].vertices.y));
+            maxDifference = MAX(maxDifference, fabsf(a[v].vertices.z - b[v].vertices.z));
+            attributesEqual &= memcmp(&a[v].colors, &b[v].colors, sizeof(CAColor4B)) == 0;
+            attributesEqual &= memcmp(&a[v].texCoords, &b[v].texCoords, sizeof(ccTex2F)) == 0;
+        }
+    }
+    
+    begin = currentMilliseconds();
+    for (int r=0; r<rounds; r++)
+    {
+        for (unsigned int i=0; i<count; i++)
+        {
+            ccV3F_C4B_T2F_Quad& quad = scalar[i];
+            quad = src[i];
+            matrices[i].transformPoint(&quad.tl.vertices);
+            matrices[i].transformPoint(&quad.bl.vertices);
+            matrices[i].transformPoint(&quad.tr.vertices);
+            matrices[i].transformPoint(&quad.br.vertices);
+        }
+    }
+    double scalarBatchTime = (currentMilliseconds() - begin) / rounds;
+    
+    begin = currentMilliseconds();
+    for (int r=0; r<rounds; r++)
+    {
+        MathUtil::transformQuads(&matrices[0], &src[0], &simd[0], count);
+    }
+    double simdBatchTime = (currentMilliseconds() - begin) / rounds;
+    
+    for (unsigned int i=0; i<count; i++)
+    {
+        const ccV3F_C4B_T2F* a = &scalar[i].tl;
+        const ccV3F_C4B_T2F* b = &simd[i].tl;
+        for (int v=0; v<4; v++)
+        {
+            maxDifference = MAX(maxDifference, fabsf(a[v].vertices.x - b[v].vertices.x));
+            maxDifference = MAX(maxDifference, fabsf(a[v].vertices.y - b[v].vertices.y));
+            maxDifference = MAX(maxDifference, fabsf(a[v].vertices.z - b[v].vertices.z));
+        }
+    }
+    
+    return crossapp_format_string("%u quads, mean of %d rounds\n"
+                                  "one matrix: transformPoint %.3f ms, transformQuads %.3f ms (%.1fx)\n"
+                                  "matrix per quad: transformPoint %.3f ms, transformQuads %.3f ms (%.1fx)\n"
+                                  "max vertex difference %g, colors and texCoords %s",
+                                  count, rounds,
+                                  scalarTime, simdTime, scalarTime / MAX(simdTime, 0.001),
+                                  scalarBatchTime, simdBatchTime, scalarBatchTime / MAX(simdBatchTime, 0.001),
+                                  maxDifference, attributesEqual ? "equal" : "DIFFERENT");
+}
+
+// every kernel through one signature, width and height are the size of dst
+typedef void (*PixelKernel)(const unsigned char* src, unsigned char* dst, unsigned int width, unsigned int height);
+
+#define PIXEL_KERNEL_CONVERSION(name)                                                           \
+static void name##Kernel(const unsigned char* src, unsigned char* dst, unsigned int width, unsigned int height) \
+{                                                                                               \
+    CAPixelKernels::name(src, dst, (unsigned long)width * height);                             \
+}
+
+PIXEL_KERNEL_CONVERSION(convertRGB888ToRGBA8888)
+PIXEL_KERNEL_CONVERSION(convertRGBA8888ToRGB888)
+PIXEL_KERNEL_CONVERSION(convertRGB888ToRGB565)
+PIXEL_KERNEL_CONVERSION(convertRGBA8888ToRGB565)
+PIXEL_KERNEL_CONVERSION(convertRGB888ToRGBA4444)
+PIXEL_KERNEL_CONVERSION(convertRGBA8888ToRGBA4444)
+PIXEL_KERNEL_CONVERSION(convertRGB888ToRGB5A1)
+PIXEL_KERNEL_CONVERSION(convertRGBA8888ToRGB5A1)
+
+static void premultiplyRGBA8888Kernel(const unsigned char* src, unsigned char* dst, unsigned int width, unsigned int height)
+{
+    memcpy(dst, src, (unsigned long)width * height * 4);
+    CAPixelKernels::premultiplyRGBA8888(dst, (unsigned long)width * height);
+}
+
+static void downsampleRGB888Kernel(const unsigned char* src, unsigned char* dst, unsigned int width, unsigned int height)
+{
+    CAPixelKernels::downsampleRGB888(src, width * 6, dst, width * 3, width, height);
+}
+
+static void downsampleRGBA8888Kernel(const unsigned char* src, unsigned char* dst, unsigned int width, unsigned int height)
+{
+    CAPixelKernels::downsampleRGBA8888(src, width * 8, dst, width * 4, width, height);
+}
+
+static const struct
+{
+    const char* title;
+    PixelKernel kernel;
+}
+s_pPixelKernels[] =
+{
+    { "RGB888 -> RGBA8888", &convertRGB888ToRGBA8888Kernel },
+    { "RGBA8888 -> RGB888", &convertRGBA8888ToRGB888Kernel },
+    { "RGB888 -> RGB565", &convertRGB888ToRGB565Kernel },
+    { "RGBA8888 -> RGB565", &convertRGBA8888ToRGB565Kernel },
+    { "RGB888 -> RGBA4444", &convertRGB888ToRGBA4444Kernel },
+    { "RGBA8888 -> RGBA4444", &convertRGBA8888ToRGBA4444Kernel },
+    { "RGB888 -> RGB5A1", &convertRGB888ToRGB5A1Kernel },
+    { "RGBA8888 -> RGB5A1", &convertRGBA8888ToRGB5A1Kernel },
+    { "premultiply RGBA8888", &premultiplyRGBA8888Kernel },
+    { "downsample RGB888", &downsampleRGB888Kernel },
+    { "downsample RGBA8888", &downsampleRGBA8888Kernel },
+};
+
+std::string BenchmarkTest::pixelKernelsBenchmark()
+{
+    // every kernel against its scalar reference, the results must be bit-identical.
+    // An odd width leaves a tail behind the vector loops
+    const unsigned int width = 509;
+    const unsigned int height = 512;
+    const int rounds = 20;
+    const char* names[] = { "Scalar", "SSE2", "SSSE3", "NEON" };
+    
+    // the downsample kernels read a 2x2 block for every dst pixel
+    std::vector<unsigned char> src((unsigned long)width * height * 16);
+    std::vector<unsigned char> reference((unsigned long)width * height * 4);
+    std::vector<unsigned char> result((unsigned long)width * height * 4);
+    
+    unsigned int seed = 2016;
+    for (unsigned long i=0; i<src.size(); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        src[i] = (unsigned char)(seed >> 16);
+    }
+    
+    CAPixelKernels::Implementation best = CAPixelKernels::getSupportedImplementation();
+    std::string text = crossapp_format_string("%ux%u pixels, mean of %d rounds, Scalar vs %s\n", width, height, rounds, names[best]);
+    
+    bool allEqual = true;
+    for (unsigned int k=0; k<sizeof(s_pPixelKernels) / sizeof(s_pPixelKernels[0]); k++)
+    {
+        PixelKernel kernel = s_pPixelKernels[k].kernel;
+        
+        CAPixelKernels::setImplementation(CAPixelKernels::Scalar);
+        std::fill(reference.begin(), reference.end(), 0);
+        double begin = currentMilliseconds();
+        for (int r=0; r<rounds; r++)
+        {
+            kernel(&src[0], &reference[0], width, height);
+        }
+        double scalarTime = (currentMilliseconds() - begin) / rounds;
+        
+        CAPixelKernels::setImplementation(best);
+        std::fill(result.begin(), result.end(), 0);
+        begin = currentMilliseconds();
+        for (int r=0; r<rounds; r++)
+        {
+            kernel(&src[0], &result[0], width, height);
+        }
+        double bestTime = (currentMilliseconds() - begin) / rounds;
+        
+        bool equal = (reference == result);
+        allEqual &= equal;
+        text += crossapp_format_string("%s: %.3f ms, %.3f ms (%.1fx) %s\n",
+                                       s_pPixelKernels[k].title,
+                                       scalarTime, bestTime, scalarTime / MAX(bestTime, 0.001),
+                                       equal ? "equal" : "DIFFERENT");
+    }
+    
+    text += allEqual ? "all kernels bit-identical" : "MISMATCH against the scalar reference";
+    return text;
+}
+
+std::string BenchmarkTest::videoDecodeBenchmark()
+{
+    // VPDecoder the way CAVideoPlayerView drives it, every frame goes straight back to the pool.
+    // Put a clip at video/benchmark.mp4 for numbers that do not depend on the network,
+    // otherwise the stream of the video player test is used
+    const unsigned int frames = 300;
+    const VPVideoFrameFormat formats[] = { kVideoFrameFormatYUV, kVideoFrameFormatRGB };
+    const char* names[] = { "RGB", "YUV" };
+    
+    std::string path = FileUtils::getInstance()->fullPathForFilename("video/benchmark.mp4");
+    if (!FileUtils::getInstance()->isFileExist(path))
+    {
+        path = "http://42.62.6.159/big_buck_bunny.mp4";
+    }
+    
+    std::string text;
+    for (int f=0; f<2; f++)
+    {
+        VPDecoder decoder;
+        if (!decoder.openFile(path) || !decoder.isValidVideo())
+        {
+            return "Cannot open " + path;
+        }
+        if (f == 0)
+        {
+            text = crossapp_format_string("%ux%u at %.2f fps\n", decoder.getFrameWidth(), decoder.getFrameHeight(), decoder.getFPS());
+        }
+        
+        // the player falls back to RGB when the codec does not output YUV420P
+        if (decoder.setupVideoFrameFormat(formats[f]) != (formats[f] == kVideoFrameFormatYUV))
+        {
+            text += crossapp_format_string("%s: not supported by the codec\n", names[formats[f]]);
+            continue;
+        }
+        decoder.setVideoFramePoolSize(8);
+        decoder.resetDecodeStats();
+        
+        unsigned int pooled = 0;
+        double begin = currentMilliseconds();
+        // a stalled stream ends the run after 30 s
+        while (decoder.getDecodeStats().decodedFrames < frames && !decoder.isEOF() && currentMilliseconds() - begin < 30000)
+        {
+            std::vector<VPFrame*> decoded = decoder.decodeFrames(0.1f);
+            for (size_t i=0; i<decoded.size(); i++)
+            {
+                pooled += decoded[i]->getType() == kFrameTypeVideo ? 1 : 0;
+                decoder.recycleFrame(decoded[i]);
+            }
+        }
+        double wallTime = currentMilliseconds() - begin;
+        
+        // decodeTime covers decoding and conversion only, wall time also reads the stream
+        VPDecodeStats stats = decoder.getDecodeStats();
+        text += crossapp_format_string("%s: %u frames, %.1f fps decoding, %.1f fps wall, %u handed out\n",
+                                       names[formats[f]],
+                                       stats.decodedFrames,
+                                       stats.decodedFrames / MAX(stats.decodeTime, 0.001f),
+                                       stats.decodedFrames * 1000.0 / MAX(wallTime, 0.001),
+                                       pooled);
+    }
+    return text;
+}
+
+static unsigned int s_uFeedSeed = 0;
+
+static unsigned int nextFeedRandom()
+{
+    s_uFeedSeed = s_uFeedSeed * 1103515245 + 12345;
+    return s_uFeedSeed >> 8;
+}
+
+static void appendFeedString(std::string& json, unsigned int pieces)
+{
+    // plain text with escapes, multibyte UTF-8 and \u sequences mixed in
+    static const char* s_pPieces[] = { "breaking", " news ", "abcdefghij", "\\\"quoted\\\"", "a\\\\b",
+        "http:\\/\\/", "\\n", "\\t", "中文", "é", "\\u4e2d\\u6587", "😀", " klmnop " };
+    
+    json += '"';
+    for (unsigned int i=0; i<pieces; i++)
+    {
+        json += s_pPieces[nextFeedRandom() % (sizeof(s_pPieces) / sizeof(s_pPieces[0]))];
+    }
+    json += '"';
+}
+
+static std::string makeNewsFeed(size_t size)
+{
+    // a news list API response, the kind of document the apps here download
+    static const char* s_pNumbers[] = { "1e-300", "3.14e10", "-0.5", "123456.789e-3", "1.7976931348623157e308" };
+    
+    s_uFeedSeed = 2016;
+    std::string json = "{\"status\":0,\"msg\":\"ok\",\"result\":[";
+    for (unsigned int id=0; json.size() < size; id++)
+    {
+        json += crossapp_format_string("%s{\"id\":%u,\"title\":", id ? "," : "", id);
+        appendFeedString(json, nextFeedRandom() % 12);
+        json += ",\"desc\":";
+        appendFeedString(json, nextFeedRandom() % 40);
+        json += crossapp_format_string(",\"url\":\"http://example.com/news/%u.html\",\"score\":%.6f,\"big\":%lld,\"tags\":[",
+                                       id, (nextFeedRandom() % 1000000) / 1000.0, ((long long)nextFeedRandom() << 38) - ((long long)nextFeedRandom() << 20));
+        for (int t=0; t<4; t++)
+        {
+            json += t ? "," : "";
+            appendFeedString(json, nextFeedRandom() % 4);
+        }
+        json += crossapp_format_string("],\"img\":{\"w\":640,\"h\":480,\"src\":\"http://img.example.com/%u.jpg\",\"ok\":true,\"none\":null},\"e\":%s}",
+                                       id, s_pNumbers[nextFeedRandom() % (sizeof(s_pNumbers) / sizeof(s_pNumbers[0]))]);
+    }
+    json += "]}";
+    return json;
+}
+
+std::string BenchmarkTest::jsonParseBenchmark()
+{
+    // CAJsonDocument against CSJson::Reader on the same document, each run reads a little of the
+    // result so that the parsers can be compared
+    const int rounds = 5;
+    std::string json = makeNewsFeed(2 << 20);
+    
+    double csjsonTime = 0, documentTime = 0, insituTime = 0, valueTime = 0;
+    long long csjsonCheck = 0, documentCheck = 0, insituCheck = 0, valueCheck = 0;
+    for (int r=0; r<rounds; r++)
+    {
+        double begin = currentMilliseconds();
+        {
+            CSJson::Reader reader;
+            CSJson::Value root;
+            bool parsed = reader.parse(json, root);
+            const CSJson::Value& result = root["result"];
+            csjsonCheck = !parsed ? -1 : result.size() + result[result.size() - 1]["id"].asInt() + result[0u]["title"].asString().length();
+        }
+        csjsonTime += currentMilliseconds() - begin;
+        
+        begin = currentMilliseconds();
+        {
+            CAJsonDocument document;
+            bool parsed = document.parse(json);
+            const CAJsonValue& result = document["result"];
+            documentCheck = !parsed ? -2 : result.size() + result[result.size() - 1]["id"].asInt() + result[0u]["title"].asString().length();
+        }
+        documentTime += currentMilliseconds() - begin;
+        
+        // parseInsitu writes into the buffer, the copy isn't timed
+        std::string buffer = json;
+        begin = currentMilliseconds();
+        {
+            CAJsonDocument document;
+            bool parsed = document.parseInsitu(&buffer[0], buffer.size());
+            const CAJsonValue& result = document["result"];
+            insituCheck = !parsed ? -3 : result.size() + result[result.size() - 1]["id"].asInt() + result[0u]["title"].asString().length();
+        }
+        insituTime += currentMilliseconds() - begin;
+        
+        begin = currentMilliseconds();
+        {
+            CAValue value = CAJsonDocument::parseToValue(json.c_str(), json.size());
+            valueCheck = -4;
+            if (value.getType() == CAValue::Type::MAP)
+            {
+                const CAValueVector& result = value.asValueMap()["result"].asValueVector();
+                valueCheck = result.size() + result.back().asValueMap().at("id").asInt() + result.front().asValueMap().at("title").asString().length();
+            }
+        }
+        valueTime += currentMilliseconds() - begin;
+    }
+    
+    std::string text = crossapp_format_string("%.2f MB, mean of %d rounds\n", json.size() / 1048576.0, rounds);
+    text += crossapp_format_string("CSJson::Reader: %.1f ms\n", csjsonTime / rounds);
+    text += crossapp_format_string("CAJsonDocument::parse: %.1f ms (%.1fx)\n", documentTime / rounds, csjsonTime / MAX(documentTime, 0.001));
+    text += crossapp_format_string("CAJsonDocument::parseInsitu: %.1f ms (%.1fx)\n", insituTime / rounds, csjsonTime / MAX(insituTime, 0.001));
+    text += crossapp_format_string("CAJsonDocument::parseToValue: %.1f ms (%.1fx)\n", valueTime / rounds, csjsonTime / MAX(valueTime, 0.001));
+    text += csjsonCheck == documentCheck && csjsonCheck == insituCheck && csjsonCheck == valueCheck ? "all of them read the same" : "MISMATCH between the parsers";
+    return text;
+}
+
+std::string BenchmarkTest::webSocketEchoBenchmark()
+{
+    // 64 B binary messages sent as fast as the send queue takes them, until all of them are echoed.
+    // 20k of them are 1.25 MB, on a slow link they go past the 1 MB high water mark and the sending
+    // waits for onSendQueueDrained
+    if (m_pWebSocket)
+    {
+        CC_RETURN_IF(m_pWebSocket->getReadyState() == network::WebSocket::State::OPEN
+                     && m_uEchoReceived < s_uEchoMessageCount) "The echo benchmark is still running";
+        m_pWebSocket->close();
+    }
+    
+    m_uEchoSent = 0;
+    m_uEchoReceived = 0;
+    m_uEchoMismatches = 0;
+    m_uEchoQueueFull = 0;
+    m_bEchoPaused = false;
+    
+    m_pWebSocket = new network::WebSocket();
+    if (!m_pWebSocket->init(*this, s_pEchoServerURL))
+    {
+        CC_SAFE_DELETE(m_pWebSocket);
+        return crossapp_format_string("Cannot open %s", s_pEchoServerURL);
+    }
+    return crossapp_format_string("Connecting to %s ...", s_pEchoServerURL);
+}
+
+void BenchmarkTest::sendEchoMessages()
+{
+    unsigned char message[s_uEchoMessageSize];
+    while (m_uEchoSent < s_uEchoMessageCount && !m_bEchoPaused)
+    {
+        // the index, then bytes that depend on it
+        memcpy(message, &m_uEchoSent, sizeof(m_uEchoSent));
+        for (unsigned int i=sizeof(m_uEchoSent); i<s_uEchoMessageSize; i++)
+        {
+            message[i] = (unsigned char)(m_uEchoSent + i);
+        }
+        CC_BREAK_IF(!m_pWebSocket->send(message, s_uEchoMessageSize));
+        ++m_uEchoSent;
+    }
+}
+
+void BenchmarkTest::onOpen(network::WebSocket* ws)
+{
+    m_pResultLabel->setText(crossapp_format_string("Echoing %u messages ...", s_uEchoMessageCount));
+    m_dEchoBegin = currentMilliseconds();
+    this->sendEchoMessages();
+}
+
+void BenchmarkTest::onMessage(network::WebSocket* ws, const network::WebSocket::Data& data)
+{
+    CC_RETURN_IF(m_uEchoReceived >= s_uEchoMessageCount);
+    
+    unsigned int index = 0;
+    bool same = data.len == (ssize_t)s_uEchoMessageSize;
+    if (same)
+    {
+        memcpy(&index, data.bytes, sizeof(index));
+        same = index == m_uEchoReceived;
+        for (unsigned int i=sizeof(index); same && i<s_uEchoMessageSize; i++)
+        {
+            same = (unsigned char)data.bytes[i] == (unsigned char)(index + i);
+        }
+    }
+    if (!same)
+    {
+        ++m_uEchoMismatches;
+    }
+    
+    CC_RETURN_IF(++m_uEchoReceived < s_uEchoMessageCount);
+    
+    double time = currentMilliseconds() - m_dEchoBegin;
+    std::string text = crossapp_format_string("%u messages of %u B in %.0f ms\n", s_uEchoMessageCount, s_uEchoMessageSize, time);
+    text += crossapp_format_string("%.0f messages/s, %.2f MB/s each way\n",
+                                   s_uEchoMessageCount * 1000.0 / MAX(time, 0.001),
+                                   s_uEchoMessageCount * s_uEchoMessageSize / 1048.576 / MAX(time, 0.001));
+    text += crossapp_format_string("send queue full %u times\n", m_uEchoQueueFull);
+    text += m_uEchoMismatches == 0 ? "every echo came back intact and in order" : crossapp_format_string("%u echoes MISMATCHED", m_uEchoMismatches);
+    m_pResultLabel->setText(text);
+}
+
+void BenchmarkTest::onClose(network::WebSocket* ws)
+{
+    if (ws == m_pWebSocket)
+    {
+        if (m_uEchoSent > 0 && m_uEchoReceived < s_uEchoMessageCount)
+        {
+            m_pResultLabel->setText(crossapp_format_string("Closed after %u of %u echoes", m_uEchoReceived, s_uEchoMessageCount));
+        }
+        m_pWebSocket = NULL;
+    }
+    delete ws;
+}
+
+void BenchmarkTest::onError(network::WebSocket* ws, const network::WebSocket::ErrorCode& error)
+{
+    m_pResultLabel->setText(crossapp_format_string("Cannot connect to %s, start an echo server there", s_pEchoServerURL));
+}
+
+void BenchmarkTest::onSendQueueFull(network::WebSocket* ws)
+{
+    ++m_uEchoQueueFull;
+    m_bEchoPaused = true;
+}
+
+void BenchmarkTest::onSendQueueDrained(network::WebSocket* ws)
+{
+    m_bEchoPaused = false;
+    this->sendEchoMessages();
+}
+
+void BenchmarkTest::viewDidUnload()
+{
+    // Release any retained subviews of the main view.
+    // e.g. self.myOutlet = nil;
+}
@@ -0,0 +1,79 @@
+
+#ifndef __Test__BenchmarkTest__
+#define __Test__BenchmarkTest__
+
+#include <iostream>
+#include "CrossApp.h"
+#include "support/network/WebSocket.h"
+
+USING_NS_CC;
+
+class BenchmarkTest: public CAViewController, public network::WebSocket::Delegate
+{
+    
+public:
+
+	BenchmarkTest();
+    
+	virtual ~BenchmarkTest();
+    
+protected:
+    
+    void viewDidLoad();
+    
+    void viewDidUnload();
+    
+    void benchmarkCallback(CAControl* control, DPoint point);
+    
+public:
+    
+    // every benchmark returns the text shown below the buttons
+    std::string transformQuadsBenchmark();
+    
+    std::string pixelKernelsBenchmark();
+    
+    std::string videoDecodeBenchmark();
+    
+    std::string jsonParseBenchmark();
+    
+    // answers right away, the result shows up once the echoes are back
+    std::string webSocketEchoBenchmark();
+    
+protected:
+    
+    void sendEchoMessages();
+    
+    virtual void onOpen(network::WebSocket* ws);
+    
+    virtual void onMessage(network::WebSocket* ws, const network::WebSocket::Data& data);
+    
+    virtual void onClose(network::WebSocket* ws);
+    
+    virtual void onError(network::WebSocket* ws, const network::WebSocket::ErrorCode& error);
+    
+    virtual void onSendQueueFull(network::WebSocket* ws);
+    
+    virtual void onSendQueueDrained(network::WebSocket* ws);
+    
+public:
+
+    CALabel* m_pResultLabel;
+    
+    network::WebSocket* m_pWebSocket;
+    
+    unsigned int m_uEchoSent;
+    
+    unsigned int m_uEchoReceived;
+    
+    unsigned int m_uEchoMismatches;
+    
+    unsigned int m_uEchoQueueFull;
+    
+    bool m_bEchoPaused;
+    
+    double m_dEchoBegin;
+    
+};
+
+
+#endif /* defined(__Test__BenchmarkTest__) */
@@ -2,6 +2,7 @@
 #include "Scale9ImageViewTest.h"
 
 Scale9ImageViewTest::Scale9ImageViewTest()
+: m_pBenchmarkView(NULL)
 {
     CADrawerController* drawer = (CADrawerController*)CAApplication::getApplication()->getRootWindow()->getRootViewController();
     drawer->setTouchMoved(false);
@@ -11,6 +12,7 @@ Scale9ImageViewTest::~Scale9ImageViewTest()
 {
     CADrawerController* drawer = (CADrawerController*)CAApplication::getApplication()->getRootWindow()->getRootViewController();
     drawer->setTouchMoved(true);
+    CAApplication::getApplication()->setDisplayStats(false);
 }
 
 void Scale9ImageViewTest::viewDidLoad()
@@ -24,6 +26,39 @@ void Scale9ImageViewTest::viewDidLoad()
     CAScale9ImageView* s9image = CAScale9ImageView::createWithImage(CAImage::create("source_material/btn_rounded_normal.png"));
     s9image->setLayout(DLayout(DHorizontalLayout_L_R(200, 200), DVerticalLayout_T_H(400, 200)));
     this->getView()->addSubview(s9image);
+    
+    CAButton* benchmark = CAButton::create(CAButtonTypeRoundedRect);
+    benchmark->setLayout(DLayout(DHorizontalLayout_W_C(300, 0.5), DVerticalLayout_B_H(60, 60)));
+    benchmark->setTitleForState(CAControlStateAll, "500 Buttons");
+    benchmark->addTarget(this, CAControl_selector(Scale9ImageViewTest::benchmarkCallback), CAControlEventTouchUpInSide);
+    this->getView()->insertSubview(benchmark, 1);
+}
+
+void Scale9ImageViewTest::benchmarkCallback(CAControl* control, DPoint point)
+{
+    // every button background is a CAScale9ImageView, compare FPS, SPF and draws with the stats on
+    if (m_pBenchmarkView)
+    {
+        m_pBenchmarkView->removeFromSuperview();
+        m_pBenchmarkView = NULL;
+        CAApplication::getApplication()->setDisplayStats(false);
+        return;
+    }
+    
+    m_pBenchmarkView = CAView::createWithLayout(DLayoutFill);
+    m_pBenchmarkView->setColor(CAColor_gray);
+    this->getView()->insertSubview(m_pBenchmarkView, 0);
+    
+    const int columns = 20;
+    const int rows = 25;
+    for (int i=0; i<columns * rows; i++)
+    {
+        CAButton* btn = CAButton::create(CAButtonTypeRoundedRect);
+        btn->setLayout(DLayout(DHorizontalLayout_L_W(4 + (i % columns) * 36, 32), DVerticalLayout_T_H(4 + (i / columns) * 40, 36)));
+        m_pBenchmarkView->addSubview(btn);
+    }
+    
+    CAApplication::getApplication()->setDisplayStats(true);
 }
 
 void Scale9ImageViewTest::viewDidUnload()
@@ -22,8 +22,11 @@ protected:
     
     void viewDidUnload();
     
+    void benchmarkCallback(CAControl* control, DPoint point);
+    
 public:
 
+    CAView* m_pBenchmarkView;
     
 };
 
@@ -1,4 +1,5 @@
 APP_STL := gnustl_static
+APP_ABI := armeabi armeabi-v7a
 NDK_TOOLCHAIN_VERSION := 4.8
 APP_CPPFLAGS := -frtti -DCC_ENABLE_CHIPMUNK_INTEGRATION=1 -std=c++11 -fsigned-char
 APP_LDFLAGS := -latomic
\ No newline at end of file
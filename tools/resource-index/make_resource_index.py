@@ -0,0 +1,56 @@
+#! /usr/bin/env python
+# coding=utf-8
+
+"""
+Writes the index of the files bundled in a Resources directory, for
+FileUtils::loadResourceIndex. Run it as a build step, after the resources
+are copied, so that the index matches what ships.
+"""
+
+from __future__ import print_function
+
+import os
+import sys
+from optparse import OptionParser
+
+DEFAULT_INDEX_NAME = "resource_index.txt"
+
+
+def list_resources(root, index_name):
+    paths = []
+    for directory, dirs, files in os.walk(root):
+        dirs[:] = [d for d in dirs if not d.startswith(".")]
+        for name in files:
+            if name.startswith("."):
+                continue
+            path = os.path.relpath(os.path.join(directory, name), root).replace(os.sep, "/")
+            if path != index_name:
+                paths.append(path)
+    paths.sort()
+    return paths
+
+
+def main():
+    parser = OptionParser(usage="usage: %prog [-o INDEX] RESOURCES_DIR")
+    parser.add_option("-o", "--output", dest="output", default=None,
+                      help="the index file, RESOURCES_DIR/%s by default" % DEFAULT_INDEX_NAME)
+    (options, args) = parser.parse_args()
+    if len(args) != 1 or not os.path.isdir(args[0]):
+        parser.error("a Resources directory is required")
+
+    root = args[0]
+    output = options.output or os.path.join(root, DEFAULT_INDEX_NAME)
+    index_name = os.path.relpath(os.path.abspath(output), os.path.abspath(root)).replace(os.sep, "/")
+
+    paths = list_resources(root, index_name)
+    with open(output, "w") as f:
+        f.write("# generated by make_resource_index.py, one path per line relative to the resource root\n")
+        for path in paths:
+            f.write(path + "\n")
+
+    print("%d files indexed in %s" % (len(paths), output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,95 @@
+//
+//  ui_layout_converter.cpp
+//  CrossApp
+//
+//  Converts UIEdit layouts (.xib) into the binary layouts CAUIEditorParser opens
+//  without parsing.
+//
+//  Copyright (c) 2014 http://www.9miao.com All rights reserved.
+//
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "support/CAUILayoutFile.h"
+
+using namespace CrossApp;
+
+static bool readFile(const char* path, std::string& data)
+{
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    char buffer[16384];
+    size_t count = 0;
+    while ((count = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        data.append(buffer, count);
+    }
+    bool ok = ferror(fp) == 0;
+    fclose(fp);
+    return ok;
+}
+
+static bool writeFile(const char* path, const std::string& data)
+{
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    bool ok = fwrite(data.data(), 1, data.size(), fp) == data.size();
+    ok = fclose(fp) == 0 && ok;
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2 && argc != 3)
+    {
+        fprintf(stderr, "usage: %s INPUT.xib [OUTPUT]\n", argv[0]);
+        return 2;
+    }
+
+    const char* input = argv[1];
+    const char* output = argc == 3 ? argv[2] : argv[1];
+
+    std::string xml;
+    if (!readFile(input, xml))
+    {
+        fprintf(stderr, "%s: can't read %s\n", argv[0], input);
+        return 1;
+    }
+
+    if (CAUILayoutFile::isLayoutData((const unsigned char*)xml.data(), xml.size()))
+    {
+        if (((const CAUILayoutHeader*)xml.data())->version != CAUI_LAYOUT_VERSION)
+        {
+            fprintf(stderr, "%s: %s was converted by another version, convert the .xib again\n", argv[0], input);
+            return 1;
+        }
+        fprintf(stderr, "%s: %s is converted already\n", argv[0], input);
+        return argc == 3 && !writeFile(output, xml) ? 1 : 0;
+    }
+
+    std::string layout;
+    std::string error;
+    if (!CAUILayoutFile::convertXml(xml.data(), xml.size(), layout, error))
+    {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], input, error.c_str());
+        return 1;
+    }
+
+    if (!writeFile(output, layout))
+    {
+        fprintf(stderr, "%s: can't write %s\n", argv[0], output);
+        return 1;
+    }
+
+    printf("%s: %lu bytes -> %s: %lu bytes\n", input, (unsigned long)xml.size(), output, (unsigned long)layout.size());
+    return 0;
+}